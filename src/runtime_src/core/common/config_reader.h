@@ -142,6 +142,61 @@ get_stall_trace()
   return value;
 }
 
+/**
+ * Interval in msec at which all device monitor counters are sampled
+ * into device_counters_<device>.csv.  0 disables sampling.
+ */
+inline unsigned int
+get_device_counter_sampling()
+{
+  static unsigned int value = (!get_profile()) ? 0 : detail::get_uint_value("Debug.device_counter_sampling",0);
+  return value;
+}
+
+/**
+ * Sampled device trace: off, window (trace_sampling_window msec of
+ * trace every trace_sampling_period msec), or kernel (trace 1 in
+ * trace_sampling_kernels kernel executions)
+ */
+inline std::string
+get_trace_sampling()
+{
+  static std::string value = (!get_profile()) ? "off" : detail::get_string_value("Debug.trace_sampling","off");
+  return value;
+}
+
+inline unsigned int
+get_trace_sampling_window()
+{
+  static unsigned int value = detail::get_uint_value("Debug.trace_sampling_window",10);
+  return value;
+}
+
+inline unsigned int
+get_trace_sampling_period()
+{
+  static unsigned int value = detail::get_uint_value("Debug.trace_sampling_period",1000);
+  return value;
+}
+
+inline unsigned int
+get_trace_sampling_kernels()
+{
+  static unsigned int value = detail::get_uint_value("Debug.trace_sampling_kernels",10);
+  return value;
+}
+
+/**
+ * Interval in seconds at which the profile summary tables are written to
+ * profile_summary_snapshot.csv while the application runs.  0 disables.
+ */
+inline unsigned int
+get_summary_snapshot_interval()
+{
+  static unsigned int value = (!get_profile()) ? 0 : detail::get_uint_value("Debug.summary_snapshot_interval",0);
+  return value;
+}
+
 inline bool
 get_timeline_trace()
 {
@@ -149,6 +204,13 @@ get_timeline_trace()
   return value;
 }
 
+inline bool
+get_chrome_trace()
+{
+  static bool value = get_timeline_trace() && detail::get_bool_value("Debug.chrome_trace",false);
+  return value;
+}
+
 inline std::string
 get_trace_buffer_size()
 {
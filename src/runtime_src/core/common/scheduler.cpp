@@ -94,18 +94,19 @@ init(xclDeviceHandle handle, const axlf* top)
   ecmd->state = ERT_CMD_STATE_NEW;
   ecmd->opcode = ERT_CONFIGURE;
 
-  auto cus = xclbin::get_cus(top, true);
+  auto index = xclbin::load_index(handle,top);
+  const auto& cus = index->cu_addrs_encoded();
 
   ecmd->slot_size = config::get_ert_slotsize();
   ecmd->num_cus = cus.size();
   ecmd->cu_shift = 16;
-  ecmd->cu_base_addr = xclbin::get_cu_base_offset(top);
+  ecmd->cu_base_addr = index->cu_base_offset();
   ecmd->ert = config::get_ert();
   ecmd->polling = xrt_core::config::get_ert_polling();
   ecmd->cu_dma  = xrt_core::config::get_ert_cudma();
-  ecmd->cu_isr  = xrt_core::config::get_ert_cuisr() && xclbin::get_cuisr(top);
+  ecmd->cu_isr  = xrt_core::config::get_ert_cuisr() && index->cuisr();
   ecmd->cq_int  = xrt_core::config::get_ert_cqint();
-  ecmd->dataflow = xclbin::get_dataflow(top) || xrt_core::config::get_feature_toggle("Runtime.dataflow");
+  ecmd->dataflow = index->dataflow() || xrt_core::config::get_feature_toggle("Runtime.dataflow");
 
   // cu addr map
   std::copy(cus.begin(), cus.end(), ecmd->data);
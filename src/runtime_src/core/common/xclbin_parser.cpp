@@ -16,7 +16,15 @@
 
 #include "xclbin_parser.h"
 #include "config_reader.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cstring>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <tuple>
 
 // This is xclbin parser. Update this file if xclbin format has changed.
 
@@ -56,102 +64,329 @@ get_base_addr(const ip_data& ip)
   return addr;
 }
 
-static int
-kernel_max_ctx(const ip_data& ip)
+// Max context of kernel in xrt.ini Runtime.kernel_channels setting
+// e.g. "{kernel_a:4}{kernel_b:8}".  Returns -1 if the kernel is not
+// listed, -2 if the setting is malformed, -3 if out of range.
+static int32_t
+kernel_max_channel_id(const ip_data& ip, const std::string& ctx)
 {
-  auto ctx = xrt_core::config::get_kernel_channel_info();
   if (ctx.empty())
-    return 0;
-  
+    return -1;
+
   std::string knm = reinterpret_cast<const char*>(ip.m_name);
   knm = knm.substr(0,knm.find(":"));
 
   auto pos1 = ctx.find("{"+knm+":");
   if (pos1 == std::string::npos)
-    return 0;
+    return -1;
 
   auto pos2 = ctx.find("}",pos1);
   if (pos2 == std::string::npos || pos2 < pos1+knm.size()+2)
-    return 0;
+    return -2;
 
-  auto ctxid_str = ctx.substr(pos1+knm.size()+2,pos2);
-  auto ctxid = std::stoi(ctxid_str);
+  int ctxid = 0;
+  try {
+    ctxid = std::stoi(ctx.substr(pos1+knm.size()+2,pos2));
+  }
+  catch (const std::exception&) {
+    return -2;
+  }
 
   if (ctxid < 0 || ctxid > 31)
-    throw std::runtime_error("context id must be between 0 and 31");
+    return -3;
 
   return ctxid;
 }
 
+// Identifies the contents an index is built from.  The uuid alone is not
+// enough, xclbinutil replaces sections and keeps the uuid.
+struct index_key
+{
+  std::array<unsigned char,sizeof(axlf_header::uuid)> uuid;
+  uint64_t length;
+  uint64_t hash;
+
+  bool
+  operator<(const index_key& rhs) const
+  {
+    return std::tie(uuid,length,hash) < std::tie(rhs.uuid,rhs.length,rhs.hash);
+  }
+
+  bool
+  operator==(const index_key& rhs) const
+  {
+    return uuid == rhs.uuid && length == rhs.length && hash == rhs.hash;
+  }
+};
+
+// Hash of the sections an index is built from, four lanes of 8 bytes
+static uint64_t
+hash_sections(const axlf* top)
+{
+  const uint64_t prime = 0x100000001b3ULL;
+  uint64_t lane[4] = {0xcbf29ce484222325ULL,0x84222325cbf29ce4ULL,
+                      0x9e3779b97f4a7c15ULL,0xc2b2ae3d27d4eb4fULL};
+  for (auto kind : {IP_LAYOUT,MEM_TOPOLOGY,DEBUG_IP_LAYOUT}) {
+    auto header = ::xclbin::get_axlf_section(top,kind);
+    if (!header)
+      continue;
+    lane[0] = (lane[0] ^ kind) * prime;
+    lane[1] = (lane[1] ^ header->m_sectionSize) * prime;
+    auto data = reinterpret_cast<const char*>(top) + header->m_sectionOffset;
+    uint64_t word[4];
+    uint64_t offset = 0;
+    for (; offset + sizeof(word) <= header->m_sectionSize; offset += sizeof(word)) {
+      std::memcpy(word,data+offset,sizeof(word));
+      for (int i = 0; i < 4; ++i)
+        lane[i] = (lane[i] ^ word[i]) * prime;
+    }
+    std::memset(word,0,sizeof(word));
+    std::memcpy(word,data+offset,header->m_sectionSize-offset);
+    for (int i = 0; i < 4; ++i)
+      lane[i] = (lane[i] ^ word[i]) * prime;
+  }
+  uint64_t hash = 0;
+  for (int i = 0; i < 4; ++i)
+    hash = (hash ^ lane[i] ^ (lane[i] >> 29)) * prime;
+  return hash;
+}
+
+static index_key
+get_index_key(const axlf* top)
+{
+  index_key key;
+  std::memcpy(key.uuid.data(),&top->m_header.uuid,key.uuid.size());
+  key.length = top->m_header.m_length;
+  key.hash = hash_sections(top);
+  return key;
+}
+
 }
 
 namespace xrt_core { namespace xclbin {
 
+index::
+index(const axlf* top)
+{
+  if (auto mem_topology = axlf_section_type<const ::mem_topology*>::get(top,axlf_section_kind::MEM_TOPOLOGY)) {
+    for (int32_t midx=0; midx < mem_topology->m_count; ++midx) {
+      auto& md = mem_topology->m_mem_data[midx];
+      m_mem_tags.emplace_back(reinterpret_cast<const char*>(md.m_tag));
+    }
+  }
+
+  if (auto ip_layout = axlf_section_type<const ::ip_layout*>::get(top,axlf_section_kind::IP_LAYOUT)) {
+    auto ctx = xrt_core::config::get_kernel_channel_info();
+    m_cu_base_offset = std::numeric_limits<uint32_t>::max();
+    m_cuisr = true;
+    for (int32_t count=0; count <ip_layout->m_count; ++count) {
+      const auto& ip_data = ip_layout->m_ip_data[count];
+      uint32_t control = (ip_data.properties & IP_CONTROL_MASK) >> IP_CONTROL_SHIFT;
+      // first IP at an address wins, as with a linear search
+      m_ip_control.emplace(ip_data.m_base_address,control);
+      if (!is_valid_cu(ip_data))
+        continue;
+
+      auto addr = get_base_addr(ip_data);
+      m_cus.push_back({addr,control,kernel_max_channel_id(ip_data,ctx),count,
+                       reinterpret_cast<const char*>(ip_data.m_name)});
+      m_cu_base_offset = std::min(m_cu_base_offset,addr);
+      if (!(ip_data.properties & 0x1))
+        m_cuisr = false;
+      if (control == AP_CTRL_CHAIN)
+        m_dataflow = true;
+    }
+
+    // The sort order determines the CU indices used throughout XRT
+    std::stable_sort(m_cus.begin(),m_cus.end(),
+                     [](const cu_data& lhs, const cu_data& rhs) { return lhs.addr < rhs.addr; });
+
+    m_ip_to_cu.resize(ip_layout->m_count,-1);
+    for (size_t idx=0; idx < m_cus.size(); ++idx) {
+      auto& cu = m_cus[idx];
+      m_ip_to_cu[cu.ip_index] = idx;
+      m_addr_to_cu.emplace(cu.addr,idx);
+      m_cu_addrs.push_back(cu.addr);
+
+      if (cu.max_channel_id == -3)
+        m_encode_error = "context id must be between 0 and 31";
+
+      // encode handshaking control in lower unused address bits [2-0]
+      // encode max context in lower [7-3] bits of addr, assumes IP control
+      // takes three bits only.  This is a hack for now.
+      auto ctxid = static_cast<uint64_t>(std::max(cu.max_channel_id,0));
+      m_cu_addrs_encoded.push_back(cu.addr | cu.control | (ctxid << 3));
+    }
+    std::sort(m_cu_addrs_encoded.begin(),m_cu_addrs_encoded.end());
+  }
+
+  if (auto debug_ip_layout = axlf_section_type<const ::debug_ip_layout*>::
+      get(top,axlf_section_kind::DEBUG_IP_LAYOUT)) {
+    for (int32_t count=0; count < debug_ip_layout->m_count; ++count) {
+      const auto& debug_ip_data = debug_ip_layout->m_debug_ip_data[count];
+      uint64_t addr = debug_ip_data.m_base_address;
+      // There is no size for each debug IP in the xclbin. Use hardcoding size now.
+      // The default size is 64KB.
+      size_t size = 0x10000;
+      if (debug_ip_data.m_type == AXI_MONITOR_FIFO_LITE
+          || debug_ip_data.m_type == AXI_MONITOR_FIFO_FULL)
+        // The size of these two type of IPs is 8KB
+        size = 0x2000;
+
+      m_debug_ips.push_back(std::make_pair(addr, size));
+    }
+    std::sort(m_debug_ips.begin(), m_debug_ips.end());
+  }
+}
+
+const cu_data*
+index::
+find_cu(uint64_t addr) const
+{
+  auto itr = m_addr_to_cu.find(addr);
+  return itr != m_addr_to_cu.end() ? &m_cus[itr->second] : nullptr;
+}
+
+const cu_data*
+index::
+find_ip_cu(int32_t ip_index) const
+{
+  if (ip_index < 0 || ip_index >= static_cast<int32_t>(m_ip_to_cu.size()))
+    return nullptr;
+  auto idx = m_ip_to_cu[ip_index];
+  return idx >= 0 ? &m_cus[idx] : nullptr;
+}
+
+bool
+index::
+find_ip_control(uint64_t addr, uint32_t& control) const
+{
+  auto itr = m_ip_control.find(addr);
+  if (itr == m_ip_control.end())
+    return false;
+  control = itr->second;
+  return true;
+}
+
 std::string
-memidx_to_name(const axlf* top,  int32_t midx)
+index::
+memidx_to_name(int32_t midx) const
 {
-  auto mem_topology = axlf_section_type<const ::mem_topology*>::get(top,axlf_section_kind::MEM_TOPOLOGY);
-  if (!mem_topology)
-    return std::to_string(midx);
-  if (midx >= mem_topology->m_count)
+  if (midx < 0 || midx >= static_cast<int32_t>(m_mem_tags.size()))
     return std::to_string(midx);
+  return m_mem_tags[midx];
+}
+
+const std::vector<uint64_t>&
+index::
+cu_addrs_encoded() const
+{
+  if (!m_encode_error.empty())
+    throw std::runtime_error(m_encode_error);
+  return m_cu_addrs_encoded;
+}
+
+namespace {
+
+std::mutex index_mutex;
+std::map<index_key, std::shared_ptr<const index>> indices;
+
+// Key of the xclbin last loaded on each device
+std::map<const void*, index_key> device_keys;
+
+// Bumped on every xclbin load, the buffer of an xclbin may be reused or
+// rewritten for the next one
+std::atomic<uint64_t> device_generation{0};
+
+// Index of the xclbin buffer last used by a thread; hashing the sections
+// costs about half of building the index, most lookups skip it
+struct last_index
+{
+  const axlf* top = nullptr;
+  index_key key;
+  uint64_t generation = 0;
+  std::shared_ptr<const index> idx;
+};
+
+}
+
+static std::shared_ptr<const index>
+get_cached_index(const axlf* top, const index_key& key)
+{
+  if (std::all_of(key.uuid.begin(),key.uuid.end(),[](unsigned char c) { return c == 0; }))
+    return std::make_shared<const index>(top);
+
+  std::lock_guard<std::mutex> lk(index_mutex);
+  auto& idx = indices[key];
+  if (!idx)
+    idx = std::make_shared<const index>(top);
+  return idx;
+}
+
+std::shared_ptr<const index>
+get_index(const axlf* top)
+{
+  static thread_local last_index last;
+  if (last.idx && top == last.top && last.generation == device_generation
+      && top->m_header.m_length == last.key.length
+      && std::memcmp(&top->m_header.uuid,last.key.uuid.data(),last.key.uuid.size()) == 0)
+    return last.idx;
+
+  auto generation = device_generation.load();
+  auto key = get_index_key(top);
+  auto idx = get_cached_index(top,key);
+  last.top = top;
+  last.key = key;
+  last.generation = generation;
+  last.idx = idx;
+  return idx;
+}
+
+std::shared_ptr<const index>
+load_index(const void* device, const axlf* top)
+{
+  auto key = get_index_key(top);
+  auto idx = get_cached_index(top,key);
+
+  std::lock_guard<std::mutex> lk(index_mutex);
+  auto itr = device_keys.find(device);
+  if (itr == device_keys.end()) {
+    device_keys.emplace(device,key);
+    ++device_generation;
+    return idx;
+  }
 
-  auto& md = mem_topology->m_mem_data[midx];
-  return std::string(reinterpret_cast<const char*>(md.m_tag));
+  auto old_key = itr->second;
+  itr->second = key;
+  ++device_generation;
+  if (old_key == key)
+    return idx;
+
+  // Keep the old index while another device has its xclbin loaded
+  for (auto& dk : device_keys)
+    if (dk.second == old_key)
+      return idx;
+  indices.erase(old_key);
+  return idx;
+}
+
+std::string
+memidx_to_name(const axlf* top,  int32_t midx)
+{
+  return get_index(top)->memidx_to_name(midx);
 }
 
 std::vector<uint64_t>
 get_cus(const axlf* top, bool encode)
 {
-  std::vector<uint64_t> cus;
-  auto ip_layout = axlf_section_type<const ::ip_layout*>::get(top,axlf_section_kind::IP_LAYOUT);
-  if (!ip_layout)
-   return cus;
-
-  for (int32_t count=0; count <ip_layout->m_count; ++count) {
-    const auto& ip_data = ip_layout->m_ip_data[count];
-    if (is_valid_cu(ip_data)) {
-      uint64_t addr = get_base_addr(ip_data);
-      if (encode) {
-        // encode handshaking control in lower unused address bits [2-0]
-        addr |= ((ip_data.properties & IP_CONTROL_MASK) >> IP_CONTROL_SHIFT);
-
-        // encode max context in lower [7-3] bits of addr, assumes IP control
-        // takes three bits only.  This is a hack for now.
-        addr |= (kernel_max_ctx(ip_data) << 3);
-      }
-      cus.push_back(addr);
-    }
-  }
-  std::sort(cus.begin(),cus.end());
-  return cus;
+  auto idx = get_index(top);
+  return encode ? idx->cu_addrs_encoded() : idx->cu_addrs();
 }
 
 std::vector<std::pair<uint64_t, size_t>>
 get_debug_ips(const axlf* top)
 {
-  std::vector<std::pair<uint64_t, size_t>> ips;
-  auto debug_ip_layout = axlf_section_type<const ::debug_ip_layout*>::
-    get(top,axlf_section_kind::DEBUG_IP_LAYOUT);
-  if (!debug_ip_layout)
-    return ips;
-
-  for (int32_t count=0; count < debug_ip_layout->m_count; ++count) {
-    const auto& debug_ip_data = debug_ip_layout->m_debug_ip_data[count];
-    uint64_t addr = debug_ip_data.m_base_address;
-    // There is no size for each debug IP in the xclbin. Use hardcoding size now.
-    // The default size is 64KB.
-    size_t size = 0x10000;
-    if (debug_ip_data.m_type == AXI_MONITOR_FIFO_LITE
-        || debug_ip_data.m_type == AXI_MONITOR_FIFO_FULL)
-       // The size of these two type of IPs is 8KB
-       size = 0x2000;
-
-    ips.push_back(std::make_pair(addr, size));
-  }
-
-  std::sort(ips.begin(), ips.end());
-  return ips;
+  return get_index(top)->debug_ips();
 }
 
 uint32_t
@@ -159,76 +394,39 @@ get_cu_control(const axlf* top, uint64_t cuaddr)
 {
   if (is_sw_emulation())
     return AP_CTRL_HS;
-  
-  auto ip_layout = axlf_section_type<const ::ip_layout*>::get(top,axlf_section_kind::IP_LAYOUT);
-  if (!ip_layout)
+
+  uint32_t control = 0;
+  if (!get_index(top)->find_ip_control(cuaddr,control))
     throw std::runtime_error("No such CU at address: " + std::to_string(cuaddr));
-  for (int32_t count=0; count <ip_layout->m_count; ++count) {
-    const auto& ip_data = ip_layout->m_ip_data[count];
-    if (ip_data.m_base_address == cuaddr)
-      return ((ip_data.properties & IP_CONTROL_MASK) >> IP_CONTROL_SHIFT);
-  }
-  throw std::runtime_error("No such CU at address: " + std::to_string(cuaddr));
+  return control;
 }
 
 uint64_t
 get_cu_base_offset(const axlf* top)
 {
-  std::vector<uint64_t> cus;
-  auto ip_layout = axlf_section_type<const ::ip_layout*>::get(top,axlf_section_kind::IP_LAYOUT);
-  if (!ip_layout)
-    return 0;
-
-  uint64_t base = std::numeric_limits<uint32_t>::max();
-  for (int32_t count=0; count <ip_layout->m_count; ++count) {
-    const auto& ip_data = ip_layout->m_ip_data[count];
-    if (is_valid_cu(ip_data))
-      base = std::min(base,get_base_addr(ip_data));
-  }
-  return base;
+  return get_index(top)->cu_base_offset();
 }
 
 bool
 get_cuisr(const axlf* top)
 {
-  auto ip_layout = axlf_section_type<const ::ip_layout*>::get(top,axlf_section_kind::IP_LAYOUT);
-  if (!ip_layout)
-    return false;
-
-  for (int32_t count=0; count <ip_layout->m_count; ++count) {
-    const auto& ip_data = ip_layout->m_ip_data[count];
-    if (is_valid_cu(ip_data) && !(ip_data.properties & 0x1))
-      return false;
-  }
-  return true;
+  return get_index(top)->cuisr();
 }
 
 bool
 get_dataflow(const axlf* top)
 {
-  auto ip_layout = axlf_section_type<const ::ip_layout*>::get(top,axlf_section_kind::IP_LAYOUT);
-  if (!ip_layout)
-    return false;
-
-  for (int32_t count=0; count <ip_layout->m_count; ++count) {
-    const auto& ip_data = ip_layout->m_ip_data[count];
-    if (is_valid_cu(ip_data) &&
-        ((ip_data.properties & IP_CONTROL_MASK) >> IP_CONTROL_SHIFT) == AP_CTRL_CHAIN)
-        return true;
-  }
-  return false;
+  return get_index(top)->dataflow();
 }
 
 std::vector<std::pair<uint64_t, size_t>>
 get_cus_pair(const axlf* top)
 {
-  std::vector<uint64_t> cus;
   std::vector<std::pair<uint64_t, size_t>> ret;
-  cus = get_cus(top, false);
-
-  for (auto it = cus.begin(); it != cus.end(); ++it)
+  auto idx = get_index(top);
+  for (auto addr : idx->cu_addrs())
     // CU size is 64KB
-    ret.push_back(std::make_pair(*it, 0x10000));
+    ret.push_back(std::make_pair(addr, 0x10000));
 
   return ret;
 }
@@ -236,7 +434,7 @@ get_cus_pair(const axlf* top)
 std::vector<std::pair<uint64_t, size_t>>
 get_dbg_ips_pair(const axlf* top)
 {
-  return get_debug_ips(top);
+  return get_index(top)->debug_ips();
 }
 
 } // namespace xclbin
@@ -18,7 +18,9 @@
 #define xclbin_parser_h_
 
 #include "xclbin.h"
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace xrt_core { namespace xclbin {
@@ -45,6 +47,133 @@ struct axlf_section_type<SectionType*>
   }
 };
 
+/**
+ * struct cu_data - Compute unit meta data collected from IP_LAYOUT
+ *
+ * @addr: base address, streaming CUs are given a max address
+ * @control: IP_CONTROL type of the CU
+ * @max_channel_id: max context from xrt.ini Runtime.kernel_channels, -1 if
+ *  kernel is not listed, -2 if the setting is malformed, -3 if out of range
+ * @ip_index: index of the CU in IP_LAYOUT
+ * @name: IP_LAYOUT name of the CU
+ */
+struct cu_data
+{
+  uint64_t addr;
+  uint32_t control;
+  int32_t max_channel_id;
+  int32_t ip_index;
+  std::string name;
+};
+
+/**
+ * class index - Immutable lookup tables for an xclbin
+ *
+ * The xclbin meta data used by scheduler initialization and per CU
+ * setup is parsed once into an index.  Use get_index() to obtain the
+ * index of an xclbin, it is cached per xclbin contents.
+ */
+class index
+{
+public:
+  explicit
+  index(const axlf* top);
+
+  index(const index&) = delete;
+  index& operator=(const index&) = delete;
+
+  /**
+   * cus() - CUs sorted by base address, position is the CU index
+   */
+  const std::vector<cu_data>&
+  cus() const
+  { return m_cus; }
+
+  /**
+   * find_cu() - CU at base address or nullptr if none
+   */
+  const cu_data*
+  find_cu(uint64_t addr) const;
+
+  /**
+   * find_ip_cu() - CU at IP_LAYOUT index or nullptr if the IP is not a CU
+   */
+  const cu_data*
+  find_ip_cu(int32_t ip_index) const;
+
+  /**
+   * find_ip_control() - IP_CONTROL type of any IP at base address
+   *
+   * Return: false if there is no IP at the address
+   */
+  bool
+  find_ip_control(uint64_t addr, uint32_t& control) const;
+
+  std::string
+  memidx_to_name(int32_t midx) const;
+
+  const std::vector<uint64_t>&
+  cu_addrs() const
+  { return m_cu_addrs; }
+
+  const std::vector<uint64_t>&
+  cu_addrs_encoded() const;
+
+  const std::vector<std::pair<uint64_t, size_t>>&
+  debug_ips() const
+  { return m_debug_ips; }
+
+  uint64_t
+  cu_base_offset() const
+  { return m_cu_base_offset; }
+
+  bool
+  cuisr() const
+  { return m_cuisr; }
+
+  bool
+  dataflow() const
+  { return m_dataflow; }
+
+private:
+  std::vector<cu_data> m_cus;
+  std::vector<int32_t> m_ip_to_cu;                     // ip index -> cu index or -1
+  std::unordered_map<uint64_t, size_t> m_addr_to_cu;
+  std::unordered_map<uint64_t, uint32_t> m_ip_control; // any IP by address
+  std::vector<std::string> m_mem_tags;
+  std::vector<uint64_t> m_cu_addrs;
+  std::vector<uint64_t> m_cu_addrs_encoded;
+  std::string m_encode_error;
+  std::vector<std::pair<uint64_t, size_t>> m_debug_ips;
+  uint64_t m_cu_base_offset = 0;
+  bool m_cuisr = false;
+  bool m_dataflow = false;
+};
+
+/**
+ * get_index() - Get the index of an xclbin
+ *
+ * The index is built on first use and cached per xclbin uuid, length and
+ * IP_LAYOUT, MEM_TOPOLOGY and DEBUG_IP_LAYOUT contents.  An xclbin
+ * without uuid is indexed on every call.  Repeated calls for the same
+ * buffer skip the contents check until the next load_index(), an xclbin
+ * rewritten in place must be loaded to be indexed again.
+ */
+std::shared_ptr<const index>
+get_index(const axlf* top);
+
+/**
+ * load_index() - Get the index of an xclbin loaded on a device
+ *
+ * @device: device the xclbin is loaded on
+ *
+ * Call when an xclbin is loaded on a device.  The cached index of the
+ * xclbin previously loaded on the device is dropped unless another
+ * device still has that xclbin loaded.
+ */
+std::shared_ptr<const index>
+load_index(const void* device, const axlf* top);
+
 /**
  * memidx_to_name() - Convert mem topology memory index to name
  */
@@ -64,6 +193,8 @@ get_debug_ips(const axlf* top);
 
 /**
  * get_cu_control() - Get the IP_CONTROL type of CU at specified address
+ *
+ * Throws if there is no IP at the address
  */
 uint32_t
 get_cu_control(const axlf* top, uint64_t cuaddr);
@@ -48,11 +48,16 @@ mtx.unlock();
     \
     _s_inst->sk_read(ri_buf,ri_msg.ByteSize()); \
     rv = ri_msg.ParseFromArray(ri_buf,ri_msg.ByteSize()); \
-    assert(true == rv);\
-    buf_size = alloc_void(ri_msg.size()); \
-    _s_inst->sk_read(buf,ri_msg.size()); \
-    rv = r_msg.ParseFromArray(buf,ri_msg.size()); \
-    assert(true == rv);\
+    if (rv) { \
+      buf_size = alloc_void(ri_msg.size()); \
+      _s_inst->sk_read(buf,ri_msg.size()); \
+      rv = r_msg.ParseFromArray(buf,ri_msg.size()); \
+    } \
+    /* An empty response reads as not acknowledged / not valid */ \
+    if (!rv) { \
+      std::cerr << "ERROR: Unable to parse the response to " #func_name << std::endl; \
+      r_msg.Clear(); \
+    } \
 
 //RELEASE BUFFER MEMORIES
 #define FREE_BUFFERS() \
@@ -67,6 +67,10 @@ namespace xclemulation{
     mKeepRunDir=false;
     mLauncherArgs = "";
     mSystemDPA = false;
+    mSharedMemoryTransfers = false;
+    mMemModelFile = "";
+    mMemSnapshotLoad = "";
+    mMemSnapshotSave = "";
   }
 
   static bool getBoolValue(std::string& value,bool defaultValue)
@@ -145,6 +149,22 @@ namespace xclemulation{
          setenv("SDX_USE_LEGACY_FMODEL","true",true);
         }
       }
+      else if(name == "shared_memory_transfers")
+      {
+        setSharedMemoryTransfers(getBoolValue(value,false));
+      }
+      else if(name == "mem_model_file")
+      {
+        setMemModelFile(value);
+      }
+      else if(name == "mem_snapshot_load")
+      {
+        setMemSnapshotLoad(value);
+      }
+      else if(name == "mem_snapshot_save")
+      {
+        setMemSnapshotSave(value);
+      }
       else if(name == "keep_run_dir")
       {
         setKeepRunDir(getBoolValue(value,false));
@@ -122,6 +122,10 @@ namespace xclemulation{
       inline void setKeepRunDir(bool _mKeepRundir)              { mKeepRunDir = _mKeepRundir;        }    
       inline void setLauncherArgs(std::string & _mLauncherArgs) { mLauncherArgs = _mLauncherArgs;    }
       inline void setSystemDPA(bool _isDPAEnabled)              { mSystemDPA    = _isDPAEnabled;      }
+      inline void setSharedMemoryTransfers(bool _shared)        { mSharedMemoryTransfers = _shared;  }
+      inline void setMemModelFile(std::string& _memModelFile)   { mMemModelFile = _memModelFile;     }
+      inline void setMemSnapshotLoad(std::string& _file)        { mMemSnapshotLoad = _file;          }
+      inline void setMemSnapshotSave(std::string& _file)        { mMemSnapshotSave = _file;          }
       
       inline bool isDiagnosticsEnabled()        const { return mDiagnostics;    }
       inline bool isUMRChecksEnabled()          const { return mUMRChecks;      }
@@ -144,6 +148,10 @@ namespace xclemulation{
       inline bool isWarningsToBePrintedOnConsole() const { return mPrintWarningsInConsole;}
       inline std::string getLauncherArgs() const { return mLauncherArgs;}
       inline bool isSystemDPAEnabled() const     {return mSystemDPA;              }
+      inline bool isSharedMemoryTransfersEnabled() const { return mSharedMemoryTransfers; }
+      inline std::string getMemModelFile() const { return mMemModelFile; }
+      inline std::string getMemSnapshotLoad() const { return mMemSnapshotLoad; }
+      inline std::string getMemSnapshotSave() const { return mMemSnapshotSave; }
       
       void populateEnvironmentSetup(std::map<std::string,std::string>& mEnvironmentNameValueMap);
 
@@ -170,6 +178,10 @@ namespace xclemulation{
       bool mKeepRunDir;
       std::string mLauncherArgs;
       bool mSystemDPA;
+      bool mSharedMemoryTransfers;
+      std::string mMemModelFile;
+      std::string mMemSnapshotLoad;
+      std::string mMemSnapshotSave;
       
      
       config();
@@ -19,10 +19,10 @@
 namespace xclemulation {
   MemoryManager::MemoryManager(uint64_t size, uint64_t start,
       unsigned alignment) : mSize(size), mStart(start), mAlignment(alignment),
-  mCoalesceThreshold(4), mFreeSize(0)
+  mFreeSize(0)
   {
     assert(start % alignment == 0);
-    mFreeBufferList.push_back(std::make_pair(mStart, mSize));
+    insertFree(mStart, mSize);
     mFreeSize = mSize;
   }
 
@@ -45,100 +45,79 @@ namespace xclemulation {
 
     std::lock_guard<std::mutex> lock(mMemManagerMutex);
 
-    for (PairList::iterator i = mFreeBufferList.begin(), e = mFreeBufferList.end(); i != e; ++i) 
-    {
-      if (i->second < size)
-        continue;
-      result = i->first;
-      if (i->second > size) 
-      {
-        // Resize the existing entry in freelist
-        i->first += size;
-        i->second -= size;
-      }
-      else 
-      {
-        // remove the exact match found
-        mFreeBufferList.erase(i);
-      }
-      mBusyBufferList.push_back(std::make_pair(result, size));
-      mFreeSize -= size;
-      break;
-    }
+    // Smallest free block that fits, lowest address among equals
+    SizeIndex::iterator fit = mFreeBySize.lower_bound(std::make_pair((uint64_t)size, (uint64_t)0));
+    if (fit == mFreeBySize.end())
+      return result;
+
+    result = fit->second;
+    uint64_t blockSize = fit->first;
+    eraseFree(mFreeBuffers.find(result));
+    if (blockSize > size)
+      insertFree(result + size, blockSize - size);
+
+    mBusyBuffers[result] = size;
+    mFreeSize -= size;
     return result;
   }
 
   void MemoryManager::free(uint64_t buf)
   {
     std::lock_guard<std::mutex> lock(mMemManagerMutex);
-    PairList::iterator i = find(buf);
-    if (i == mBusyBufferList.end())
+    BlockMap::iterator i = mBusyBuffers.find(buf);
+    if (i == mBusyBuffers.end())
       return;
-    mFreeSize += i->second;
-    mFreeBufferList.push_back(std::make_pair(i->first, i->second));
-    mBusyBufferList.erase(i);
-    if (mFreeBufferList.size() > mCoalesceThreshold) {
-      coalesce();
+    uint64_t addr = i->first;
+    uint64_t size = i->second;
+    mFreeSize += size;
+    mBusyBuffers.erase(i);
+
+    // Merge with the free blocks right after and right before
+    BlockMap::iterator next = mFreeBuffers.lower_bound(addr);
+    if (next != mFreeBuffers.end() && next->first == addr + size) {
+      size += next->second;
+      eraseFree(next++);
     }
-  }
-
-
-  void MemoryManager::coalesce()
-  {
-    // First sort the free buffers and then attempt to coalesce the neighbors
-    mFreeBufferList.sort();
-
-    PairList::iterator curr = mFreeBufferList.begin();
-    PairList::iterator next = curr;
-    ++next;
-    PairList::iterator last = mFreeBufferList.end();
-    while (next != last) {
-      if ((curr->first + curr->second) != next->first) {
-        // Non contiguous blocks
-        curr = next;
-        ++next;
-        continue;
+    if (next != mFreeBuffers.begin()) {
+      BlockMap::iterator prev = std::prev(next);
+      if (prev->first + prev->second == addr) {
+        addr = prev->first;
+        size += prev->second;
+        eraseFree(prev);
       }
-      // Coalesce curr and next
-      curr->second += next->second;
-      mFreeBufferList.erase(next);
-      next = curr;
-      ++next;
     }
+    insertFree(addr, size);
   }
 
+  void MemoryManager::insertFree(uint64_t addr, uint64_t size)
+  {
+    if (size == 0)
+      return;
+    mFreeBuffers[addr] = size;
+    mFreeBySize.insert(std::make_pair(size, addr));
+  }
 
-  MemoryManager::PairList::iterator MemoryManager::find(uint64_t buf)
+  void MemoryManager::eraseFree(BlockMap::iterator it)
   {
-#if GCC_VERSION >= 40800
-    PairList::iterator i = std::find_if(mBusyBufferList.begin(), mBusyBufferList.end(), [&] (const PairList::value_type& s)
-        { return s.first == buf; });
-#else
-    PairList::iterator i = mBusyBufferList.begin();
-    PairList::iterator last  = mBusyBufferList.end();
-    while(i != last) {
-      if (i->first == buf)
-        break;
-      ++i;
-    }
-#endif
-    return i;
+    mFreeBySize.erase(std::make_pair(it->second, it->first));
+    mFreeBuffers.erase(it);
   }
 
   void MemoryManager::reset()
   {
     std::lock_guard<std::mutex> lock(mMemManagerMutex);
-    mFreeBufferList.clear();
-    mBusyBufferList.clear();
-    mFreeBufferList.push_back(std::make_pair(mStart, mSize));
-    mFreeSize = 0;
+    mFreeBuffers.clear();
+    mFreeBySize.clear();
+    mBusyBuffers.clear();
+    insertFree(mStart, mSize);
+    mFreeSize = mSize;
   }
 
   std::pair<uint64_t, uint64_t> MemoryManager::lookup(uint64_t buf)
   {
     std::lock_guard<std::mutex> lock(mMemManagerMutex);
-    PairList::iterator i = find(buf);
-    if (i != mBusyBufferList.end())
+    BlockMap::iterator i = mBusyBuffers.find(buf);
+    if (i != mBusyBuffers.end())
       return *i;
     // Compiler bug -- Some versions of GCC C++11 compiler do not
     // like mNull directly inside std::make_pair, so capture mNull
@@ -146,5 +125,10 @@ namespace xclemulation {
     const uint64_t v = mNull;
     return std::make_pair(v, v);
   }
-}
 
+  std::vector<std::pair<uint64_t, uint64_t> > MemoryManager::busyBlocks()
+  {
+    std::lock_guard<std::mutex> lock(mMemManagerMutex);
+    return std::vector<std::pair<uint64_t, uint64_t> >(mBusyBuffers.begin(), mBusyBuffers.end());
+  }
+}
@@ -18,7 +18,9 @@
 #define _HWEM_MEMORY_MANAGER_H_
 
 #include <mutex>
-#include <list>
+#include <map>
+#include <set>
+#include <vector>
 #include <cassert>
 #include <algorithm>
 
@@ -27,19 +29,23 @@
 
 namespace xclemulation
 {
+    // Best fit allocator over [start, start + size).  Free blocks are
+    // indexed by address and by size, so alloc and free are O(log n) and a
+    // freed block merges with its free neighbours right away.
     class MemoryManager 
     {
+        typedef std::map<uint64_t, uint64_t> BlockMap;                 // address -> size
+        typedef std::set<std::pair<uint64_t, uint64_t> > SizeIndex;  // (size, address)
+
         std::mutex mMemManagerMutex;
-        std::list<std::pair<uint64_t, uint64_t> > mFreeBufferList;
-        std::list<std::pair<uint64_t, uint64_t> > mBusyBufferList;
+        BlockMap mFreeBuffers;
+        SizeIndex mFreeBySize;
+        BlockMap mBusyBuffers;
         uint64_t mSize;
         uint64_t mStart;
         uint64_t mAlignment;
-        const unsigned mCoalesceThreshold;
         uint64_t mFreeSize;
 
-        typedef std::list<std::pair<uint64_t, uint64_t> > PairList;
-
     public:
         static const uint64_t mNull = 0xffffffffffffffffull;
 
@@ -56,10 +62,12 @@ namespace xclemulation
         static bool isNullAlloc(const std::pair<uint64_t, uint64_t>& buf) { return ((buf.first == mNull) || (buf.second == mNull)); }
 
         std::pair<uint64_t, uint64_t>lookup(uint64_t buf);
+        // (address, size) of every allocated block
+        std::vector<std::pair<uint64_t, uint64_t> > busyBlocks();
 
     private:
-        void coalesce();
-        PairList::iterator find(uint64_t buf);
+        void insertFree(uint64_t addr, uint64_t size);
+        void eraseFree(BlockMap::iterator it);
     };
 }
 
@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+#include "memorymanager.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using xclemulation::MemoryManager;
+
+namespace {
+
+// mNull has no definition outside the class to bind a reference to
+const uint64_t null_alloc = MemoryManager::mNull;
+
+// Allocated blocks are aligned, inside the bank and do not overlap
+void
+check_busy(MemoryManager& mm, uint64_t alignment)
+{
+   auto busy = mm.busyBlocks();
+   std::sort(busy.begin(), busy.end());
+   uint64_t used = 0;
+   for (size_t i = 0; i < busy.size(); ++i) {
+     ASSERT_EQ(busy[i].first % alignment, 0u);
+     ASSERT_GE(busy[i].first, mm.start());
+     ASSERT_LE(busy[i].first + busy[i].second, mm.start() + mm.size());
+     if (i > 0) {
+       ASSERT_LE(busy[i - 1].first + busy[i - 1].second, busy[i].first) << "Blocks overlap at 0x" << std::hex << busy[i].first;
+     }
+     used += busy[i].second;
+   }
+   ASSERT_EQ(used + mm.freeSize(), mm.size());
+}
+
+}
+
+// Fill a bank with buffers of random size, then free a random buffer and
+// allocate a new one at each step; freeing everything merges the bank
+// back into one block
+TEST(MemoryManager, FillChurnCoalesce) {
+   const uint64_t alignment = getpagesize();
+   const uint64_t bank = 1ull << 30;
+   MemoryManager mm(bank, 0, alignment);
+   std::mt19937_64 gen(42);
+   std::uniform_int_distribution<size_t> buf_size(1, 256 << 10);
+   std::vector<uint64_t> live;
+
+   for (int i = 0; i < 2000; ++i) {
+     size_t size = buf_size(gen);
+     uint64_t buf = mm.alloc(size);
+     ASSERT_NE(buf, null_alloc);
+     live.push_back(buf);
+   }
+   check_busy(mm, alignment);
+
+   for (int i = 0; i < 20000; ++i) {
+     size_t victim = gen() % live.size();
+     mm.free(live[victim]);
+     size_t size = buf_size(gen);
+     live[victim] = mm.alloc(size);
+     ASSERT_NE(live[victim], null_alloc);
+   }
+   check_busy(mm, alignment);
+
+   for (auto buf : live)
+     mm.free(buf);
+   ASSERT_EQ(mm.freeSize(), bank);
+   size_t whole = bank;
+   ASSERT_EQ(mm.alloc(whole), 0u) << "Bank did not coalesce.";
+   ASSERT_EQ(mm.freeSize(), 0u);
+}
+
+// The smallest free block that fits is used
+TEST(MemoryManager, BestFit) {
+   const uint64_t alignment = getpagesize();
+   MemoryManager mm(64 * alignment, 0, alignment);
+   size_t size = 8 * alignment;
+   uint64_t big = mm.alloc(size);
+   size = alignment;
+   uint64_t sep1 = mm.alloc(size);
+   size = 2 * alignment;
+   uint64_t small = mm.alloc(size);
+   size = alignment;
+   uint64_t sep2 = mm.alloc(size);
+   ASSERT_NE(sep1, null_alloc);
+   ASSERT_NE(sep2, null_alloc);
+
+   mm.free(big);
+   mm.free(small);
+   size = 2 * alignment;
+   ASSERT_EQ(mm.alloc(size), small);
+   size = 4 * alignment;
+   ASSERT_EQ(mm.alloc(size), big);
+}
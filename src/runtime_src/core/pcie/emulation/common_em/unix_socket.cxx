@@ -23,16 +23,25 @@ unix_socket::unix_socket()
 {
   server_started = false;
   fd = -1;
-  std::string sock_id = "";
+  std::string sock_id = "xcl_sock";
+  char* c_sock_id = getenv("EMULATION_SOCKETID"); 
+  if(c_sock_id)
+    sock_id = c_sock_id;
+  start_server_for(sock_id);
+}
+
+unix_socket::unix_socket(const std::string& sock_id)
+{
+  server_started = false;
+  fd = -1;
+  start_server_for(sock_id);
+}
+
+void unix_socket::start_server_for(const std::string& sock_id)
+{
   char* cUser = getenv("USER");
   if(cUser) {
     std::string user = cUser;
-    char* c_sock_id = getenv("EMULATION_SOCKETID"); 
-    if(c_sock_id) {
-      sock_id = c_sock_id;
-    } else {
-      sock_id = "xcl_sock";
-    }
     std::string pathname =  "/tmp/" + user;
     name = pathname + "/" + sock_id;
     systemUtil::makeSystemCall(pathname, systemUtil::systemOperation::CREATE);
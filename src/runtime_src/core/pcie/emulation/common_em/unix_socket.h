@@ -32,12 +32,15 @@ class unix_socket {
   private:
     int fd;
     void start_server(const std::string sk_desc);
+    void start_server_for(const std::string& sock_id);
     std::string name;
 public:
     bool server_started;
     void set_name(std::string &sock_name) { name = sock_name;}
     std::string get_name() { return name;}
     unix_socket();
+    // Socket named by sock_id instead of EMULATION_SOCKETID
+    unix_socket(const std::string& sock_id);
     ~unix_socket()
     {
        server_started = false;
@@ -344,16 +344,20 @@ namespace xclcpuemhal2 {
 
     // Spawn off the process to run the stub
     bool simDontRun = xclemulation::config::getInstance()->isDontRun();
+    std::string sock_id("");
     if(!simDontRun)
     {
       std::stringstream socket_id;
       socket_id << deviceName << "_" << binaryCounter << "_" << getpid();
-      setenv("EMULATION_SOCKETID",socket_id.str().c_str(),true);
+      sock_id = socket_id.str();
 
       pid_t pid = fork();
       assert(pid >= 0);
       if (pid == 0)
       { 
+        // Only the device process gets the socket id in its environment,
+        // devices launched from other threads would race on it otherwise
+        setenv("EMULATION_SOCKETID",sock_id.c_str(),true);
         std::string childProcessPath("");
         std::string xilinxInstall("");
 
@@ -434,7 +438,7 @@ namespace xclcpuemhal2 {
         exit(0);
       }
     }
-    sock = new unix_socket;
+    sock = sock_id.empty() ? new unix_socket : new unix_socket(sock_id);
   }
 
   int CpuemShim::xclLoadXclBin(const xclBin *header)
@@ -723,6 +727,7 @@ namespace xclcpuemhal2 {
         i->free(offset);
       }
     }
+    unmapSharedBuffer(offset);
     bool ack = true;
     if(sock)
     {
@@ -813,6 +818,12 @@ namespace xclcpuemhal2 {
     src = (unsigned char*)src + seek;
     dest += seek;
 
+    if(void* shared = getSharedBuffer(dest,size))
+    {
+      std::memcpy(shared,src,size);
+      return size;
+    }
+
     void *handle = this;
 
     unsigned int messageSize = get_messagesize();
@@ -850,6 +861,13 @@ namespace xclcpuemhal2 {
       launchTempProcess();
     }
     src += skip;
+
+    if(void* shared = getSharedBuffer(src,size))
+    {
+      std::memcpy(dest,shared,size);
+      return size;
+    }
+
     void *handle = this;
 
     unsigned int messageSize = get_messagesize();
@@ -876,6 +894,50 @@ namespace xclcpuemhal2 {
 
   }
 
+  void CpuemShim::mapSharedBuffer(uint64_t base, size_t size, const std::string& sFileName)
+  {
+    int fd = open(sFileName.c_str(), O_RDWR);
+    if (fd == -1)
+    {
+      if (mLogStream.is_open()) mLogStream << __func__ << " unable to open " << sFileName << std::endl;
+      return;
+    }
+    void* data = nullptr;
+    if (ftruncate(fd, size) == 0)
+      data = mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == nullptr || data == MAP_FAILED)
+    {
+      if (mLogStream.is_open()) mLogStream << __func__ << " unable to map " << sFileName << std::endl;
+      return;
+    }
+    std::lock_guard<std::mutex> lk(mSharedBufferMtx);
+    mSharedBufferMap[base] = std::make_pair(data, size);
+  }
+
+  void CpuemShim::unmapSharedBuffer(uint64_t base)
+  {
+    std::lock_guard<std::mutex> lk(mSharedBufferMtx);
+    auto it = mSharedBufferMap.find(base);
+    if (it == mSharedBufferMap.end())
+      return;
+    munmap(it->second.first, it->second.second);
+    mSharedBufferMap.erase(it);
+  }
+
+  // Host address of [addr, addr+size) when it lies within one shared buffer
+  void* CpuemShim::getSharedBuffer(uint64_t addr, size_t size)
+  {
+    std::lock_guard<std::mutex> lk(mSharedBufferMtx);
+    auto it = mSharedBufferMap.upper_bound(addr);
+    if (it == mSharedBufferMap.begin())
+      return nullptr;
+    --it;
+    if (addr + size > it->first + it->second.second)
+      return nullptr;
+    return (unsigned char*)it->second.first + (addr - it->first);
+  }
+
   void CpuemShim::xclOpen(const char* logfileName)
   {
     xclemulation::config::getInstance()->populateEnvironmentSetup(mEnvironmentNameValueMap);
@@ -974,6 +1036,12 @@ namespace xclcpuemhal2 {
       close(fd);
     }
       mFdToFileNameMap.clear();
+    {
+      std::lock_guard<std::mutex> sharedLk(mSharedBufferMtx);
+      for (auto& it: mSharedBufferMap)
+        munmap(it.second.first, it.second.second);
+      mSharedBufferMap.clear();
+    }
     mCloseAll = true; 
     std::string socketName = sock->get_name();
     if(socketName.empty() == false)// device is active if socketName is non-empty
@@ -1092,8 +1160,17 @@ int CpuemShim::xoclCreateBo(xclemulation::xocl_create_bo* info)
   xobj->flags=info->flags;
   /* check whether buffer is p2p or not*/
   bool p2pBuffer = xocl_bo_p2p(xobj); 
+  /* with shared memory transfers every buffer is file backed like a p2p buffer,
+     and host reads and writes go straight to the file mapping */
+  bool sharedBuffer = !p2pBuffer && xclemulation::config::getInstance()->isSharedMemoryTransfersEnabled();
   std::string sFileName("");
-  xobj->base = xclAllocDeviceBuffer2(size,XCL_MEM_DEVICE_RAM,ddr,p2pBuffer,sFileName);
+  xobj->base = xclAllocDeviceBuffer2(size,XCL_MEM_DEVICE_RAM,ddr,p2pBuffer || sharedBuffer,sFileName);
+  if(sharedBuffer)
+  {
+    if(xobj->base && !sFileName.empty())
+      mapSharedBuffer(xobj->base,size,sFileName);
+    sFileName = "";
+  }
   xobj->filename = sFileName;
   xobj->size = size;
   xobj->userptr = NULL;
@@ -1275,6 +1352,13 @@ void *CpuemShim::xclMapBO(unsigned int boHandle, bool write)
     return nullptr;
   }
 
+  if(void* shared = getSharedBuffer(bo->base,bo->size))
+  {
+    bo->buf = shared;
+    PRINTENDFUNC;
+    return shared;
+  }
+
   std::string sFileName = bo->filename;
   if(!sFileName.empty() )
   {
@@ -1331,6 +1415,13 @@ int CpuemShim::xclSyncBO(unsigned int boHandle, xclBOSyncDirection dir, size_t s
   }
 
   int returnVal = 0;
+  void* mapped = bo->userptr ? bo->userptr : bo->buf;
+  if(mapped && mapped == getSharedBuffer(bo->base,bo->size))
+  {
+    // the host mapping is the device memory
+    PRINTENDFUNC;
+    return returnVal;
+  }
   if(dir == XCL_BO_SYNC_BO_TO_DEVICE)
   {
     void* buffer =  bo->userptr ? bo->userptr : bo->buf;
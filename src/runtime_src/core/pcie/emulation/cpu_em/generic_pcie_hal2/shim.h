@@ -107,6 +107,11 @@ namespace xclcpuemhal2 {
       size_t xclCopyBufferHost2Device(uint64_t dest, const void *src, size_t size, size_t seek);
       size_t xclCopyBufferDevice2Host(void *dest, uint64_t src, size_t size, size_t skip);
 
+      // Device memory mapped into this process as well as the device process
+      void mapSharedBuffer(uint64_t base, size_t size, const std::string& sFileName);
+      void unmapSharedBuffer(uint64_t base);
+      void* getSharedBuffer(uint64_t addr, size_t size);
+
       // Performance monitoring
       // Control
       double xclGetDeviceClockFreqMHz();
@@ -223,6 +228,9 @@ namespace xclcpuemhal2 {
       std::map<int, xclemulation::drm_xocl_bo*> mXoclObjMap;
       static unsigned int mBufferCount;
       static std::map<int, std::tuple<std::string,int,void*> > mFdToFileNameMap;
+      // device address -> (host mapping, size) of buffers shared with the device process
+      std::map<uint64_t, std::pair<void*,size_t> > mSharedBufferMap;
+      std::mutex mSharedBufferMtx;
       // HAL2 RELATED member variables end 
       std::list<std::tuple<uint64_t ,void*, std::map<uint64_t , uint64_t> > > mReqList;
       uint64_t mReqCounter;
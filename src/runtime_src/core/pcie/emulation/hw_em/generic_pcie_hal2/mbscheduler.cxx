@@ -33,6 +33,14 @@ namespace xclhwemhal2 {
     pthread_mutex_init(&state_lock,NULL);
     pthread_cond_init(&state_cond,NULL);
     scheduler_thread = 0;
+    passes = 0;
+    idle_waits = 0;
+    poll_waits = 0;
+    submitted = 0;
+    completed = 0;
+    max_queued = 0;
+    ctrl_writes = 0;
+    ctrl_reads = 0;
   }
 
   xocl_sched::~xocl_sched()
@@ -119,23 +127,35 @@ namespace xclhwemhal2 {
     run_cnt = 0;
   }
 
+  size_t MBScheduler::ctrl_write(uint64_t offset, const void *hostBuf, size_t size)
+  {
+    ++mScheduler->ctrl_writes;
+    return mParent->xclWrite(XCL_ADDR_KERNEL_CTRL, offset, hostBuf, size);
+  }
+
+  size_t MBScheduler::ctrl_read(uint64_t offset, void *hostBuf, size_t size)
+  {
+    ++mScheduler->ctrl_reads;
+    return mParent->xclRead(XCL_ADDR_KERNEL_CTRL, offset, hostBuf, size);
+  }
+
   void MBScheduler::cu_continue(struct xocl_cu *xcu)
   {
     if (!xcu->dataflow)
       return;
 
     // acknowledge done directly to CU (xcu->addr)
-    mParent->xclWrite(XCL_ADDR_KERNEL_CTRL, xcu->base + xcu->addr, (void*)&HwEmShim::CONTROL_AP_CONTINUE,4);
+    ctrl_write(xcu->base + xcu->addr, (void*)&HwEmShim::CONTROL_AP_CONTINUE,4);
 
     // in ert_poll mode acknowlegde done to ERT
     if (xcu->polladdr && xcu->run_cnt) {
-      mParent->xclWrite(XCL_ADDR_KERNEL_CTRL,xcu->base + xcu->polladdr, (void*)&HwEmShim::CONTROL_AP_CONTINUE,4);
+      ctrl_write(xcu->base + xcu->polladdr, (void*)&HwEmShim::CONTROL_AP_CONTINUE,4);
     }
   }
 
   void MBScheduler::cu_poll(struct xocl_cu *xcu)
   {
-    mParent->xclRead(XCL_ADDR_KERNEL_CTRL,xcu->base + xcu->addr,(void*)&(xcu->ctrlreg),4);
+    ctrl_read(xcu->base + xcu->addr,(void*)&(xcu->ctrlreg),4);
     if (xcu->run_cnt && (xcu->ctrlreg & (HwEmShim::CONTROL_AP_DONE | HwEmShim::CONTROL_AP_IDLE)))
     {
       ++xcu->done_cnt;
@@ -163,12 +183,10 @@ namespace xclhwemhal2 {
   {
     unsigned int size = regmap_size(xcmd);
     uint32_t *regmap = cmd_regmap(xcmd);
-    unsigned int idx;
 
-    for (idx = 4; idx < size; ++idx)
-    {
-      mParent->xclWrite(XCL_ADDR_KERNEL_CTRL, xcu->base + xcu->addr + (idx << 2), (void*)(regmap+idx) ,4);
-    }
+    /* the arguments are consecutive registers, write them in one go */
+    if (size > 4)
+      ctrl_write(xcu->base + xcu->addr + (4 << 2), (void*)(regmap+4), (size-4) << 2);
   }
 
   void MBScheduler::cu_configure_ooo(struct xocl_cu *xcu, struct xocl_cmd *xcmd)
@@ -177,12 +195,25 @@ namespace xclhwemhal2 {
     uint32_t *regmap = cmd_regmap(xcmd);
     unsigned int idx;
 
+    /* coalesce runs of (offset,value) pairs to consecutive registers
+     * into a single write */
+    std::vector<uint32_t> vals;
+    uint32_t start = 0;
     for (idx = 4; idx < size - 1; idx += 2)
     {
       uint32_t offset = *(regmap + idx);
       uint32_t val = *(regmap + idx + 1);
-      mParent->xclWrite(XCL_ADDR_KERNEL_CTRL, xcu->base + offset , (void*)(&val) ,4);
+      if (!vals.empty() && offset != start + (vals.size() << 2))
+      {
+        ctrl_write(xcu->base + start, (void*)vals.data(), vals.size() << 2);
+        vals.clear();
+      }
+      if (vals.empty())
+        start = offset;
+      vals.push_back(val);
     }
+    if (!vals.empty())
+      ctrl_write(xcu->base + start, (void*)vals.data(), vals.size() << 2);
   }
 
   bool MBScheduler::cu_start(struct xocl_cu *xcu, struct xocl_cmd *xcmd)
@@ -200,11 +231,11 @@ namespace xclhwemhal2 {
     // start cu.  update local state as we may not be polling prior
     // to next ready check.
     xcu->ctrlreg |= HwEmShim::CONTROL_AP_START;
-    mParent->xclWrite(XCL_ADDR_KERNEL_CTRL, xcu->base + xcu->addr,(void*)& HwEmShim::CONTROL_AP_START, 4);
+    ctrl_write(xcu->base + xcu->addr,(void*)& HwEmShim::CONTROL_AP_START, 4);
 
     // in ert poll mode request ERT to poll CU
     if (xcu->polladdr) {
-      mParent->xclWrite(XCL_ADDR_KERNEL_CTRL, xcu->base + xcu->polladdr, (void*)& HwEmShim::CONTROL_AP_START, 4);
+      ctrl_write(xcu->base + xcu->polladdr, (void*)& HwEmShim::CONTROL_AP_START, 4);
     }
 
     ++xcu->run_cnt;
@@ -284,6 +315,7 @@ namespace xclhwemhal2 {
     mParent = _parent;
     mScheduler = new xocl_sched(this);
     num_pending = 0;
+    num_completions = 0;
   }
 
   MBScheduler::~MBScheduler()
@@ -304,7 +336,7 @@ namespace xclhwemhal2 {
     uint32_t cu_addr = cu_idx_to_addr(exec,cu_idx);
 
     uint32_t mask = 0;
-    mParent->xclRead(XCL_ADDR_KERNEL_CTRL, exec->base + cu_addr, (void*)&mask, 4);
+    ctrl_read(exec->base + cu_addr, (void*)&mask, 4);
     /* done is indicated by AP_DONE(2) alone or by AP_DONE(2) | AP_IDLE(4)
      * but not by AP_IDLE itself.  Since 0x10 | (0x10 | 0x100) = 0x110
      * checking for 0x10 is sufficient. */
@@ -367,11 +399,11 @@ namespace xclhwemhal2 {
     /* can't get memcpy_toio to work */
     /* memcpy_toio(user_bar + cu_addr + 4,ecmd->data + ecmd->extra_cu_masks + 1,(size-1)*4); */
 
-    mParent->xclWrite(XCL_ADDR_KERNEL_CTRL,exec->base + cu_addr + 4 , ecmd->data + ecmd->extra_cu_masks + 1 , size*4);
+    ctrl_write(exec->base + cu_addr + 4 , ecmd->data + ecmd->extra_cu_masks + 1 , size*4);
 
     /* start CU at base + 0x0 */
     int ap_start = 0x1;
-    mParent->xclWrite(XCL_ADDR_KERNEL_CTRL,exec->base + cu_addr, (void*)&ap_start , 4 );
+    ctrl_write(exec->base + cu_addr, (void*)&ap_start , 4 );
   }
 
 //  static unsigned int get_cu_idx(struct exec_core *exec, unsigned int cmd_idx)
@@ -460,12 +492,9 @@ namespace xclhwemhal2 {
       uint32_t csr_addr = ERT_STATUS_REGISTER_ADDR + (cmd_mask_idx<<2);
       //TODO
       uint32_t mask = 0;
-      bool waitForResp = false;
-      if (opcode(xcmd)==ERT_CONFIGURE)
-        waitForResp = true;
-      do{
-        mParent->xclRead(XCL_ADDR_KERNEL_CTRL, xcmd->exec->base + csr_addr, (void*)&mask, 4);
-      }while(waitForResp && !mask);
+      /* a configure command that is not acknowledged yet stays running
+       * and is queried again on the next pass */
+      ctrl_read(xcmd->exec->base + csr_addr, (void*)&mask, 4);
 
       if (mask)
       {
@@ -514,11 +543,11 @@ namespace xclhwemhal2 {
     slot_addr = ERT_CQ_BASE_ADDR + xcmd->slot_idx*slot_size(xcmd->exec);
 
     /* TODO write packet minus header */
-    mParent->xclWrite(XCL_ADDR_KERNEL_CTRL, xcmd->exec->base + slot_addr + 4, xcmd->packet->data,(packet_size(xcmd)-1)*sizeof(uint32_t));
+    ctrl_write(xcmd->exec->base + slot_addr + 4, xcmd->packet->data,(packet_size(xcmd)-1)*sizeof(uint32_t));
     //memcpy_toio(xcmd->exec->base + slot_addr + 4,xcmd->packet->data,(packet_size(xcmd)-1)*sizeof(uint32_t));
 
     /* TODO write header */
-    mParent->xclWrite(XCL_ADDR_KERNEL_CTRL, xcmd->exec->base + slot_addr, (void*)(&xcmd->packet->header) ,4);
+    ctrl_write(xcmd->exec->base + slot_addr, (void*)(&xcmd->packet->header) ,4);
     //iowrite32(xcmd->packet->header,xcmd->exec->base + slot_addr);
 
     /* trigger interrupt to embedded scheduler if feature is enabled */
@@ -526,7 +555,7 @@ namespace xclhwemhal2 {
       uint32_t cq_int_addr = ERT_CQ_STATUS_REGISTER_ADDR + (slot_mask_idx(xcmd->slot_idx)<<2);
       uint32_t mask = 1<<slot_idx_in_mask(xcmd->slot_idx);
       //TODO
-      mParent->xclWrite(XCL_ADDR_KERNEL_CTRL,xcmd->exec->base + cq_int_addr, (void*)(&mask) ,4);
+      ctrl_write(xcmd->exec->base + cq_int_addr, (void*)(&mask) ,4);
         //iowrite32(mask,xcmd->exec->base + cq_int_addr);
     }
 #ifdef EM_DEBUG_KDS
@@ -571,12 +600,9 @@ namespace xclhwemhal2 {
       uint32_t csr_addr = ERT_STATUS_REGISTER_ADDR + (cmd_mask_idx<<2);
       //TODO
       uint32_t mask = 0;
-      bool waitForResp = false;
-      if (opcode(xcmd)==ERT_CONFIGURE)
-        waitForResp = true;
-      do{
-        mParent->xclRead(XCL_ADDR_KERNEL_CTRL, xcmd->exec->base + csr_addr, (void*)&mask, 4);
-      }while(waitForResp && !mask);
+      /* a configure command that is not acknowledged yet stays running
+       * and is queried again on the next pass */
+      ctrl_read(xcmd->exec->base + csr_addr, (void*)&mask, 4);
 
       if (mask)
       {
@@ -693,6 +719,26 @@ namespace xclhwemhal2 {
       client_ctx* entry = it;
       entry->trigger++;
     }
+
+    /* wake up xclExecWait */
+    {
+      std::lock_guard<std::mutex> lk(completion_mutex);
+      num_completions++;
+    }
+    completion_cond.notify_all();
+  }
+
+  int MBScheduler::wait_for_completion(int timeoutMilliSec)
+  {
+    std::unique_lock<std::mutex> lk(completion_mutex);
+    bool completed = completion_cond.wait_for(lk, std::chrono::milliseconds(timeoutMilliSec),
+        [this] { return num_completions > 0 || mScheduler->stop || mScheduler->error; });
+    if (!completed)
+      return 0;
+    /* each completion wakes one waiter; stop and error wake them all */
+    if (num_completions > 0)
+      num_completions--;
+    return 1;
   }
 
   void MBScheduler::mark_cmd_complete(xocl_cmd *xcmd)
@@ -701,6 +747,7 @@ namespace xclhwemhal2 {
     set_cmd_state(xcmd,ERT_CMD_STATE_COMPLETED);
     if (xcmd->exec->polling_mode)
       mScheduler->poll--;
+    mScheduler->completed++;
     release_slot_idx(xcmd->exec,xcmd->slot_idx);
 #ifdef EM_DEBUG_KDS
     std::cout<<"Marking command Complete XCMD: " <<xcmd<<" PACKET: "<<xcmd->packet<< " BO: "<< xcmd->bo << std::endl;
@@ -763,6 +810,7 @@ namespace xclhwemhal2 {
       if (xcmd->exec->polling_mode)
         mScheduler->poll++;
       xcmd->exec->submitted_cmds[xcmd->slot_idx] = xcmd;
+      mScheduler->submitted++;
       retval = true;
     }
 
@@ -884,6 +932,9 @@ namespace xclhwemhal2 {
 
   int MBScheduler::scheduler_wait_condition()
   {
+    /* hold the state lock so that a wake up cannot slip in between the
+     * scheduler thread looking for work and going to sleep */
+    pthread_mutex_lock(&mScheduler->state_lock);
     bool bSchComeOutOfCond = false;
     if (mScheduler->stop || mScheduler->error) {
       bSchComeOutOfCond = true;
@@ -902,17 +953,20 @@ namespace xclhwemhal2 {
       bSchComeOutOfCond = true;
     }
     if(bSchComeOutOfCond)
-    {
       pthread_cond_signal(&mScheduler->state_cond);
-      return 0;
-    }
-    return 1;
+    pthread_mutex_unlock(&mScheduler->state_lock);
+    return bSchComeOutOfCond ? 0 : 1;
+  }
+
+  bool MBScheduler::scheduler_has_work()
+  {
+    return !mScheduler->command_queue.empty() || !mScheduler->running_queue.empty();
   }
 
-  void MBScheduler::scheduler_queue_cmds()
+  bool MBScheduler::scheduler_queue_cmds()
   {
     if(pending_cmds.empty())
-      return;
+      return false;
 
 #ifdef EM_DEBUG_KDS
     std::cout<<"Iterating on pending commands and adding to Scheduler command_queue  "<< std::endl;
@@ -925,75 +979,142 @@ namespace xclhwemhal2 {
       if (opcode(xcmd) == ERT_START_CU || opcode(xcmd) == ERT_EXEC_WRITE)
         xcmd->packet->type = ERT_CU;
 
-      mScheduler->command_queue.push_back(xcmd);
       xcmd->state = ERT_CMD_STATE_QUEUED;
 #ifdef EM_DEBUG_KDS
     std::cout<<xcmd <<" ADDED to Scheduler command_queue  "<< std::endl;
 #endif
       num_pending--;
     }
-    pending_cmds.clear();
+    mScheduler->command_queue.splice(mScheduler->command_queue.end(), pending_cmds);
+    return true;
   }
 
-  void MBScheduler::scheduler_iterate_cmds()
+  bool MBScheduler::scheduler_iterate_cmds()
   {
-     auto end = mScheduler->command_queue.end();
-#ifdef EM_DEBUG_KDS
-     //if(mScheduler->command_queue.size() > 0)
-     //  std::cout<<" command_queue size is "<<mScheduler->command_queue.size()<< std::endl;
-#endif
-     for (auto itr=mScheduler->command_queue.begin(); itr!=end; )
-     {
-       xocl_cmd *xcmd = *itr;
-       if (xcmd->state == ERT_CMD_STATE_QUEUED)
-       {
+    std::list<xocl_cmd*>& queued = mScheduler->command_queue;
+    std::list<xocl_cmd*>& running = mScheduler->running_queue;
+    bool progress = false;
+    bool configuring = false;
+
+    /* query running commands first so that the slots and CUs they free
+     * can be used by queued commands in the same pass */
+    for (auto xcmd : running)
+    {
+      if (xcmd->state == ERT_CMD_STATE_RUNNING)
+        running_to_complete(xcmd);
+      if (xcmd->state == ERT_CMD_STATE_RUNNING && opcode(xcmd) == ERT_CONFIGURE)
+        configuring = true;
+    }
+
+    /* a query can complete other commands of the same status mask, so
+     * collect the completed ones after all queries are done */
+    for (auto itr = running.begin(); itr != running.end(); )
+    {
+      xocl_cmd *xcmd = *itr;
+      if (xcmd->state == ERT_CMD_STATE_COMPLETED)
+      {
 #ifdef EM_DEBUG_KDS
-         std::cout<<xcmd << " is in QUEUED state  "<< std::endl;
+        std::cout<<xcmd << " is in COMPLETED state  "<< std::endl;
 #endif
-         queued_to_running(xcmd);
-       }
-       if (xcmd->state == ERT_CMD_STATE_RUNNING)
-       {
-         running_to_complete(xcmd);
-       }
-
-       if (xcmd->state == ERT_CMD_STATE_COMPLETED)
-       {
+        complete_to_free(xcmd);
+        itr = running.erase(itr);
+        progress = true;
+      }
+      else {
+        ++itr;
+      }
+    }
+
+    /* nothing else is started until the device acknowledged its configuration */
+    if (configuring)
+      return progress;
+
+    for (auto itr = queued.begin(); itr != queued.end(); )
+    {
+      xocl_cmd *xcmd = *itr;
 #ifdef EM_DEBUG_KDS
-         std::cout<<xcmd << " is in COMPLETED state  "<< std::endl;
+      std::cout<<xcmd << " is in QUEUED state  "<< std::endl;
 #endif
-         complete_to_free(xcmd);
-         itr = mScheduler->command_queue.erase(itr);
-         end = mScheduler->command_queue.end();
-       }
-       else {
-         ++itr;
-       }
-     }
-
+      if (!queued_to_running(xcmd))
+      {
+        ++itr;
+        continue;
+      }
+      itr = queued.erase(itr);
+      running.push_back(xcmd);
+      progress = true;
+      if (opcode(xcmd) == ERT_CONFIGURE)
+        break;
+    }
+    return progress;
   }
 
-  void scheduler_loop(xocl_sched *xs)
+  bool scheduler_loop(xocl_sched *xs)
   {
     MBScheduler* pSch = xs->pSch;
-    std::lock_guard<std::mutex> lk(pSch->pending_cmds_mutex);
 
-    if (xs->error) { return; }
+    if (xs->error) { return false; }
 
-    /* queue new pending commands */
-    pSch->scheduler_queue_cmds();
+    /* queue new pending commands, the register traffic of the pass is done
+     * without the lock so that submitters never wait for it */
+    bool progress = false;
+    {
+      std::lock_guard<std::mutex> lk(pSch->pending_cmds_mutex);
+      progress = pSch->scheduler_queue_cmds();
+    }
+    xs->max_queued = std::max(xs->max_queued, xs->command_queue.size() + xs->running_queue.size());
+    ++xs->passes;
 
-    /* iterate all commands */
-    pSch->scheduler_iterate_cmds();
+    /* query running commands and start queued ones */
+    if (pSch->scheduler_iterate_cmds())
+      progress = true;
+
+    return progress;
   }
 
   void* scheduler(void* data)
   {
     xocl_sched *xs = (xocl_sched *)data;
+    MBScheduler* pSch = xs->pSch;
+    unsigned int poll_us = SCHED_MIN_POLL_US;
     while (!xs->stop && !xs->error)
     {
-      scheduler_loop(xs);
-      usleep(10);
+      if (scheduler_loop(xs))
+      {
+        poll_us = SCHED_MIN_POLL_US;
+        continue;
+      }
+
+      pthread_mutex_lock(&xs->state_lock);
+      if (xs->stop || xs->error || pSch->num_pending > 0)
+      {
+        /* woken up while the pass was running */
+      }
+      else if (!pSch->scheduler_has_work())
+      {
+        /* nothing outstanding, sleep until a command is added */
+        ++xs->idle_waits;
+        pthread_cond_wait(&xs->state_cond, &xs->state_lock);
+        poll_us = SCHED_MIN_POLL_US;
+      }
+      else
+      {
+        /* the device reports completions only through its status
+         * registers, so back off while nothing changes. A new command
+         * still wakes the thread right away. */
+        ++xs->poll_waits;
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_nsec += poll_us * 1000L;
+        if (ts.tv_nsec >= 1000000000L)
+        {
+          ts.tv_sec += ts.tv_nsec / 1000000000L;
+          ts.tv_nsec %= 1000000000L;
+        }
+        pthread_cond_timedwait(&xs->state_cond, &xs->state_lock, &ts);
+        poll_us = std::min(poll_us * 2, (unsigned int)SCHED_MAX_POLL_US);
+      }
+      pthread_mutex_unlock(&xs->state_lock);
     }
     return NULL;
   }
@@ -1031,12 +1152,29 @@ namespace xclhwemhal2 {
 
     mScheduler->stop= true;
     scheduler_wait_condition();
+    completion_cond.notify_all();
     mScheduler->bThreadCreated = false;
 
     int retval = pthread_join(mScheduler->scheduler_thread,NULL);
 
+    std::string dMsg = "INFO: [HW-EM 09-0] MB scheduler passes: " + std::to_string(mScheduler->passes)
+      + ", idle waits: " + std::to_string(mScheduler->idle_waits)
+      + ", poll waits: " + std::to_string(mScheduler->poll_waits)
+      + ", commands submitted: " + std::to_string(mScheduler->submitted)
+      + ", completed: " + std::to_string(mScheduler->completed)
+      + ", max outstanding: " + std::to_string(mScheduler->max_queued);
+    mParent->logMessage(dMsg, 1);
+
+    dMsg = "INFO: [HW-EM 09-1] MB scheduler register writes: " + std::to_string(mScheduler->ctrl_writes)
+      + ", register reads: " + std::to_string(mScheduler->ctrl_reads);
+    if (mScheduler->submitted)
+      dMsg += ", writes per command: " + std::to_string(mScheduler->ctrl_writes / mScheduler->submitted)
+        + ", reads per command: " + std::to_string(mScheduler->ctrl_reads / mScheduler->submitted);
+    mParent->logMessage(dMsg, 1);
+
     pending_cmds.clear();
     mScheduler->command_queue.clear();
+    mScheduler->running_queue.clear();
     free_cmds.clear();
 
     return retval;
@@ -1,11 +1,14 @@
 #ifndef _MB_SCHEDULER_H_
 #define _MB_SCHEDULER_H_
 
+#include <atomic>
+#include <condition_variable>
 #include <list>
 #include <mutex>
 #include <cmath>
 #include <cstdint>
 #include <queue>
+#include <vector>
 #include "ert.h"
 
 #define XOCL_U32_MASK 0xFFFFFFFF
@@ -15,6 +18,11 @@
 #define MAX_U32_SLOT_MASKS (((MAX_SLOTS-1)>>5) + 1)
 #define MAX_U32_CU_MASKS (((MAX_CUS-1)>>5) + 1)
 
+/* Bounds of the scheduler thread wait while commands are outstanding but
+ * none of them made progress. The wait doubles each idle pass. */
+#define SCHED_MIN_POLL_US 10
+#define SCHED_MAX_POLL_US 1000
+
 namespace xclhwemhal2 {
   class HwEmShim;
   class xocl_cmd;
@@ -34,12 +42,23 @@ namespace xclhwemhal2 {
       pthread_mutex_t             state_lock;
       pthread_cond_t              state_cond;
       std::list<xocl_cmd*>        command_queue;
+      std::list<xocl_cmd*>        running_queue;
       bool                        bThreadCreated;
       unsigned int                error;
       int                         intc;
       int                         poll;
       bool                        stop;
       MBScheduler*              pSch;
+
+      /* scheduler loop statistics, reported when the thread ends */
+      uint64_t                    passes;
+      uint64_t                    idle_waits;
+      uint64_t                    poll_waits;
+      uint64_t                    submitted;
+      uint64_t                    completed;
+      size_t                      max_queued;
+      uint64_t                    ctrl_writes;
+      uint64_t                    ctrl_reads;
       xocl_sched(MBScheduler*);
       ~xocl_sched();
   };
@@ -144,6 +163,10 @@ namespace xclhwemhal2 {
     uint32_t packet_size(xocl_cmd *xcmd) { return payload_size(xcmd) + 1; }
     uint32_t type(struct xocl_cmd* xcmd) { return xcmd->packet->type; }
 
+    /* kernel control register access, every call is one RPC */
+    size_t ctrl_write(uint64_t offset, const void *hostBuf, size_t size);
+    size_t ctrl_read(uint64_t offset, void *hostBuf, size_t size);
+
     void mb_query(xocl_cmd *xcmd);
     int mb_submit(xocl_cmd *xcmd);
     void penguin_query(xocl_cmd *xcmd);
@@ -165,8 +188,10 @@ namespace xclhwemhal2 {
     xocl_cmd* get_free_xocl_cmd(void) ; 
     int add_cmd(exec_core *exec, xclemulation::drm_xocl_bo* bo) ;
     int scheduler_wait_condition() ;
-    void scheduler_queue_cmds();
-    void scheduler_iterate_cmds();
+    bool scheduler_has_work();
+    bool scheduler_queue_cmds();
+    bool scheduler_iterate_cmds();
+    int wait_for_completion(int timeoutMilliSec);
     int get_free_cu(struct xocl_cmd *xcmd);
     void configure_cu(struct xocl_cmd *xcmd, int cu_idx);
     bool cu_done(struct exec_core *exec, unsigned int cu_idx);
@@ -182,7 +207,7 @@ namespace xclhwemhal2 {
     bool cu_ready(xocl_cu *xcu);
     bool cu_start(xocl_cu *xcu, xocl_cmd *xcmd);
 
-    friend void scheduler_loop(xocl_sched *xs);
+    friend bool scheduler_loop(xocl_sched *xs);
     friend void* scheduler(void* data) ;
 
     int init_scheduler_thread(void) ;
@@ -202,7 +227,12 @@ namespace xclhwemhal2 {
     std::mutex pending_cmds_mutex;
 
     std::mutex m_add_cmd_mutex;
-    int num_pending;
+    std::atomic<int> num_pending;
+
+    /* completions not yet seen by xclExecWait */
+    std::mutex completion_mutex;
+    std::condition_variable completion_cond;
+    unsigned int num_completions;
   };
 }
 
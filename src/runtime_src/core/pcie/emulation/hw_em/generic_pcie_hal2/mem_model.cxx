@@ -16,194 +16,331 @@
 
 #include "mem_model.h"
 
+#include <algorithm>
+#include <fcntl.h>
+#include <new>
+#include <sys/mman.h>
+
+namespace {
+
+const char snapshot_magic[8] = { 'X','E','M','S','N','A','P','1' };
+
+struct snapshot_header
+{
+  char magic[8];
+  uint64_t page_size;
+  uint64_t num_pages;
+  // file offset of the first page, a multiple of the system page size
+  uint64_t data_offset;
+};
+
+bool in_range(const unsigned char* page, const unsigned char* base, size_t size)
+{
+  return base && page >= base && page < base + size;
+}
+
+bool is_zero_page(const unsigned char* page)
+{
+  return page[0] == 0 && memcmp(page, page + 1, PAGESIZE - 1) == 0;
+}
+
+}
+
 mem_model::~ mem_model()
 {
-  serialize();
+  if (mHandoff)
+    serialize();
+  for (auto& page : mPages)
+  {
+    if (!in_range(page.second, mSlab, mSlabSize) && !in_range(page.second, mSnapshot, mSnapshotSize))
+      delete [] page.second;
+  }
+  if (mSlab)
+    munmap(mSlab, mSlabSize);
+  if (mSnapshot)
+    munmap(mSnapshot, mSnapshotSize);
 }
 
-mem_model::mem_model(std::string deviceName):
+mem_model::mem_model(std::string deviceName, const std::string& backingFile, const std::string& snapshotFile):
+  mLastPageIdx(UINT64_MAX),
+  mLastPage(NULL),
+  mSlab(NULL),
+  mSlabSize((size_t)N_1MBARRAYS * PAGESIZE),
+  mSlabPages(0),
+  mSnapshot(NULL),
+  mSnapshotSize(0),
+  mHandoff(true),
   mDeviceName(deviceName),
   module_name("dr_wrapper_dr_i_sdaccel_generic_pcie_0.sdaccel_generic_pcie_model.ddrx_top_tlm_model_0.axi_app_tlm_model_0")
 {
+  // Address space only; the kernel provides pages as they are first touched
+  int fd = -1;
+  int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE;
+  if (!backingFile.empty())
+  {
+    // Pages are handed out in first touch order, not by address, so data
+    // left by an earlier run would show up at some other address
+    fd = open(backingFile.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+    if (fd != -1 && ftruncate(fd, mSlabSize) == 0)
+    {
+      flags = MAP_SHARED | MAP_NORESERVE;
+    }
+    else
+    {
+      std::cerr << "WARNING: unable to use " << backingFile << " for device memory\n";
+      if (fd != -1)
+        close(fd);
+      fd = -1;
+    }
+  }
+  void* slab = mmap(NULL, mSlabSize, PROT_READ | PROT_WRITE, flags, fd, 0);
+  if (fd != -1)
+    close(fd);
+  if (slab != MAP_FAILED)
+    mSlab = (unsigned char*)slab;
+
+  if (!snapshotFile.empty() && !load_snapshot(snapshotFile))
+    std::cerr << "WARNING: unable to restore device memory from " << snapshotFile << "\n";
 }
 
   unsigned int mem_model::writeDevMem(uint64_t offset, const void* src, unsigned int size)
   {
 #ifdef DEBUGMSG
-      cout<<endl<<module_name<<" write offset:"<<std::hex<<offset<<endl;
+      std::cout<<std::endl<<module_name<<" write offset:"<<std::hex<<offset<<std::endl;
 #endif 
       uint64_t written_bytes = 0;
       uint64_t addr = offset;
       while(written_bytes < size){
-          uint64_t src_offset = written_bytes;
-
-          unsigned char* page_ptr  = get_page(addr);
-          uint64_t       page_addr = addr & ~(-1 << ADDRBITS);
-
-          unsigned char* dest_buf_ptr = page_ptr + page_addr;
-          unsigned char* src_buf_ptr  = (unsigned char*)(src)      + src_offset;
-
-          uint64_t remaining_bytes_to_write = size - written_bytes;
-          uint64_t unaligned_bytes_in_addr = (addr & ~(-1 << ADDRBITS));
-          uint64_t bytes_upto_next_alignment = (0x1 << ADDRBITS) - unaligned_bytes_in_addr;
+          uint64_t page_addr = addr & (PAGESIZE - 1);
+          uint64_t buf_size = std::min<uint64_t>(PAGESIZE - page_addr, size - written_bytes);
 
-          uint64_t buf_size = 0;
-          if(bytes_upto_next_alignment > remaining_bytes_to_write)
-          {
-              buf_size = remaining_bytes_to_write;
-          }else{
-              buf_size = bytes_upto_next_alignment;
-          }
-
-          memcpy(dest_buf_ptr,src_buf_ptr,buf_size);
+          unsigned char* page = get_page(addr);
+          if (!page)
+              return 1;
+          memcpy(page + page_addr, (const unsigned char*)src + written_bytes, buf_size);
 
           written_bytes += buf_size;
           addr += buf_size;
       }
-#ifdef DEBUGMSG
-      std::cout << endl;
-      std::cout << "Write Operation size : " << size << endl;
-      for(int i = 0; i < size;i++){
-          cout << std::hex << (unsigned int)(((unsigned char*)src)[i]) << " ";
-      }
-      std::cout << endl;
-      cout << "Write : " ;
-      cout << "Offset --> " << offset << endl;
-#endif    
-
       return 0;
   }
 
   unsigned int mem_model::readDevMem(uint64_t offset, void* dest, unsigned int size){
 #ifdef DEBUGMSG
-	  cout<<endl<<module_name<<" read offset:"<<std::hex<< (uint64_t)offset<<endl;
+	  std::cout<<std::endl<<module_name<<" read offset:"<<std::hex<< (uint64_t)offset<<std::endl;
 #endif 
-	 
 	  uint64_t read_bytes = 0;
 	  uint64_t addr = offset;
 	  while(read_bytes < size){
-		  uint64_t dest_offset = read_bytes;
-
-		  unsigned char* page_ptr  = get_page(addr);
-		  uint64_t       page_addr = addr & ~(-1 << ADDRBITS);
-
-		  unsigned char* src_buf_ptr = page_ptr + page_addr;
-		  unsigned char* dest_buf_ptr  = (unsigned char*)(dest)      + dest_offset;
-
-		  uint64_t remaining_bytes_to_read = size - read_bytes;
-		  uint64_t unaligned_bytes_in_addr = (addr & ~(-1 << ADDRBITS));
-		  uint64_t bytes_upto_next_alignment = (0x1 << ADDRBITS) - unaligned_bytes_in_addr;
-
-		  uint64_t buf_size = 0;
-		  if(bytes_upto_next_alignment > remaining_bytes_to_read)
-		  {
-			  buf_size = remaining_bytes_to_read;
-		  }else{
-			  buf_size = bytes_upto_next_alignment;
-		  }
-	  memcpy(dest_buf_ptr,src_buf_ptr,buf_size);
+		  uint64_t page_addr = addr & (PAGESIZE - 1);
+		  uint64_t buf_size = std::min<uint64_t>(PAGESIZE - page_addr, size - read_bytes);
+
+		  unsigned char* page = get_page(addr);
+		  if (!page)
+			  return 1;
+		  memcpy((unsigned char*)dest + read_bytes, page + page_addr, buf_size);
+
 		  read_bytes += buf_size;
 		  addr += buf_size;
 	  }
-#ifdef DEBUGMSG
-	  std::cout << endl;
-	  std::cout << "Read Operation size : " << size << endl;
-	  for(unsigned int i = 0; i < size;i++){
-		  cout << std::hex << (unsigned int)(((unsigned char*)dest)[i]) << " ";
-	  }
-	  std::cout << endl;
-	  cout << "Read : " ;
-	  cout << "Offset --> " << offset << endl;
-#endif    
-
 	  return 0;
   }
+
   unsigned char* mem_model::get_page(uint64_t offset) {
 	  uint64_t page_idx = offset >> ADDRBITS;
-	  std::string file_name = get_mem_file_name(page_idx);
-	  if(pageCache.size() > N_1MBARRAYS)
+	  if (page_idx == mLastPageIdx)
+		  return mLastPage;
+
+	  unsigned char** entry = page_entry(page_idx);
+	  if (*entry == NULL)
+		  *entry = load_page(page_idx);
+	  if (*entry == NULL)
+		  return NULL;
+
+	  mLastPageIdx = page_idx;
+	  mLastPage = *entry;
+	  return mLastPage;
+  }
+
+  unsigned char** mem_model::page_entry(uint64_t page_idx) {
+	  uint64_t dir_idx = page_idx >> PT_BITS;
+	  if (dir_idx < PT_ENTRIES) {
+		  if (!mPageDir[dir_idx])
+			  mPageDir[dir_idx].reset(new page_table());
+		  return &mPageDir[dir_idx]->pages[page_idx & (PT_ENTRIES - 1)];
+	  }
+	  return &mFarPages[page_idx];
+  }
+
+  unsigned char* mem_model::alloc_page() {
+	  if (mSlab && mSlabPages < N_1MBARRAYS)
+		  return mSlab + (mSlabPages++) * PAGESIZE;
+	  unsigned char* page = new (std::nothrow) unsigned char[PAGESIZE]();
+	  if (!page)
+		  std::cerr << "ERROR: out of host memory for device memory page " << mPages.size() << "\n";
+	  return page;
+  }
+
+  // First touch of a page: start from what an earlier run serialized, if any
+  unsigned char* mem_model::load_page(uint64_t pageIdx) {
+	  unsigned char* page = alloc_page();
+	  if (!page)
+		  return NULL;
+	  mPages.push_back(std::make_pair(pageIdx, page));
+	  if (!mHandoff)
+		  return page;
+
+	  std::string file_name = get_mem_file_name(pageIdx);
+	  FILE* pFile = fopen(file_name.c_str(),"r");
+	  if (pFile == NULL)
+		  return page;
+
+	  int fhandle = fileno(pFile);
+	  if (deserialize_msg.ParseFromFileDescriptor(fhandle) == false)
 	  {
-		  std::cerr << "Out of Memory. DDR model does not support this much of memory\n";
-		  exit(1);
-	  } else {
-      FILE* pFile = NULL;
-		  if(pageCache.find(page_idx) != pageCache.end())
-		  {
-			  return pageCache[page_idx];
-		  } else if(((pFile = fopen(file_name.c_str(),"r")) != NULL)) {
-			  int fhandle = fileno(pFile);
-
-			  if (deserialize_msg.ParseFromFileDescriptor(fhandle) == false)
-        {
-          fclose(pFile);
-          exit(1);
-        }
-			  pageCache[page_idx] = new unsigned char[PAGESIZE];
-
-			  memcpy(pageCache[page_idx],deserialize_msg.data().c_str(),PAGESIZE);
-			  fclose(pFile);
-			  return pageCache[page_idx];
-		  } else {
-			  pageCache[page_idx] = new unsigned char[PAGESIZE];
-			  return pageCache[page_idx];
-		  }
+		  std::cerr << "WARNING: unable to read device memory page from " << file_name << "\n";
+		  fclose(pFile);
+		  return page;
 	  }
+	  memcpy(page,deserialize_msg.data().c_str(),std::min<size_t>(PAGESIZE,deserialize_msg.data().size()));
+	  fclose(pFile);
+	  return page;
   }
 
 
+  std::vector<uint64_t> mem_model::page_addresses() const {
+	  std::vector<uint64_t> addrs;
+	  for (auto& page : mPages) {
+		  if (!is_zero_page(page.second))
+			  addrs.push_back(page.first << ADDRBITS);
+	  }
+	  std::sort(addrs.begin(), addrs.end());
+	  return addrs;
+  }
+
+  bool mem_model::save_snapshot(const std::string& path) {
+	  std::vector<std::pair<uint64_t,unsigned char*>> pages;
+	  for (auto& page : mPages) {
+		  if (!is_zero_page(page.second))
+			  pages.push_back(page);
+	  }
+	  std::sort(pages.begin(), pages.end());
+
+	  snapshot_header header;
+	  memcpy(header.magic, snapshot_magic, sizeof(header.magic));
+	  header.page_size = PAGESIZE;
+	  header.num_pages = pages.size();
+	  uint64_t align = sysconf(_SC_PAGESIZE);
+	  header.data_offset = (sizeof(header) + pages.size() * sizeof(uint64_t) + align - 1) / align * align;
+
+	  // Write a new file and rename it over the old one; a run that has the
+	  // old snapshot mapped keeps seeing the old contents
+	  std::string tmp = path + ".tmp" + std::to_string(getpid());
+	  FILE* pFile = fopen(tmp.c_str(), "w");
+	  if (!pFile)
+		  return false;
+	  bool ok = fwrite(&header, sizeof(header), 1, pFile) == 1;
+	  for (auto& page : pages)
+		  ok = ok && fwrite(&page.first, sizeof(uint64_t), 1, pFile) == 1;
+	  ok = ok && fseek(pFile, header.data_offset, SEEK_SET) == 0;
+	  for (auto& page : pages)
+		  ok = ok && fwrite(page.second, PAGESIZE, 1, pFile) == 1;
+	  ok = (fclose(pFile) == 0) && ok;
+	  if (!ok || rename(tmp.c_str(), path.c_str()) != 0) {
+		  unlink(tmp.c_str());
+		  return false;
+	  }
+	  return true;
+  }
+
+  bool mem_model::load_snapshot(const std::string& path) {
+	  if (!mPages.empty() || mSnapshot)
+		  return false;
+
+	  int fd = open(path.c_str(), O_RDONLY);
+	  if (fd == -1)
+		  return false;
+
+	  snapshot_header header;
+	  std::vector<uint64_t> index;
+	  struct stat statBuf;
+	  bool ok = read(fd, &header, sizeof(header)) == sizeof(header)
+		  && memcmp(header.magic, snapshot_magic, sizeof(header.magic)) == 0
+		  && header.page_size == PAGESIZE
+		  && fstat(fd, &statBuf) == 0
+		  && header.num_pages <= (uint64_t)statBuf.st_size / PAGESIZE
+		  && (uint64_t)statBuf.st_size >= header.data_offset + header.num_pages * PAGESIZE;
+	  if (ok) {
+		  index.resize(header.num_pages);
+		  ssize_t bytes = index.size() * sizeof(uint64_t);
+		  ok = read(fd, index.data(), bytes) == bytes;
+	  }
+	  void* data = MAP_FAILED;
+	  if (ok && header.num_pages)
+		  data = mmap(NULL, header.num_pages * PAGESIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, header.data_offset);
+	  close(fd);
+	  if (!ok || (header.num_pages && data == MAP_FAILED))
+		  return false;
+	  if (!header.num_pages)
+		  return true;
+
+	  mSnapshot = (unsigned char*)data;
+	  mSnapshotSize = header.num_pages * PAGESIZE;
+	  for (uint64_t i = 0; i < header.num_pages; ++i) {
+		  unsigned char* page = mSnapshot + i * PAGESIZE;
+		  *page_entry(index[i]) = page;
+		  mPages.push_back(std::make_pair(index[i], page));
+	  }
+	  mLastPageIdx = UINT64_MAX;
+	  mLastPage = NULL;
+	  return true;
+  }
+
   void mem_model::serialize() {
      FILE *pFile;
      int fhandle;
-     for (pageCacheItr=pageCache.begin(); pageCacheItr != pageCache.end(); ++pageCacheItr)
+     for (auto& pageItr : mPages)
      {
-        std::string file_name = get_mem_file_name(pageCacheItr->first);
+        std::string file_name = get_mem_file_name(pageItr.first);
         pFile = fopen(file_name.c_str(),"w+");
         if(!pFile)
           continue;
         fhandle = fileno(pFile);
-        if(fhandle == -1)
-        {
-          fclose(pFile);
-          exit(1);
-        }
-
-        serialize_msg.set_data(reinterpret_cast<const char*>(pageCacheItr->second),PAGESIZE);
-        if(serialize_msg.SerializeToFileDescriptor(fhandle) == false)
-        {
-          fclose(pFile);
-          exit(1);
-        }
+        serialize_msg.set_data(reinterpret_cast<const char*>(pageItr.second),PAGESIZE);
+        if(fhandle == -1 || serialize_msg.SerializeToFileDescriptor(fhandle) == false)
+          std::cerr << "ERROR: unable to write device memory page to " << file_name << "\n";
         fclose(pFile);
      }
   }
 
  std::string mem_model::get_mem_file_name(uint64_t pageIdx)
  {
-   std::string file_name("");
-   std::string user("");
-   char* cUser = getenv("USER");
-   if(cUser)
+   // The directory is the same for every page; work it out once
+   if (mFilePath.empty())
    {
-     user = cUser;
-   }
-   std::string file_path("");
-   if(mDeviceName.empty() == false)
-     file_path = "/tmp/" + user + "/" + std::to_string(getpid()) + "/hw_em/" + mDeviceName + "/" + module_name + "/";
-    else
-     file_path = "/tmp/" + user + "/hw_em/" + module_name + "/";
-   std::stringstream mkdirCommand;
-   mkdirCommand<<"mkdir -p "<<file_path;;
-   struct stat statBuf;
-   if ( stat(file_path.c_str(), &statBuf) == -1 )
-   {
-     int rV = system(mkdirCommand.str().c_str());
-     if(rV == -1) {std::cout<<"unable to open/create mem file"<<std::endl;}
+     std::string user("");
+     char* cUser = getenv("USER");
+     if(cUser)
+     {
+       user = cUser;
+     }
+     if(mDeviceName.empty() == false)
+       mFilePath = "/tmp/" + user + "/" + std::to_string(getpid()) + "/hw_em/" + mDeviceName + "/" + module_name + "/";
+     else
+       mFilePath = "/tmp/" + user + "/hw_em/" + module_name + "/";
+     std::stringstream mkdirCommand;
+     mkdirCommand<<"mkdir -p "<<mFilePath;
+     struct stat statBuf;
+     if ( stat(mFilePath.c_str(), &statBuf) == -1 )
+     {
+       int rV = system(mkdirCommand.str().c_str());
+       if(rV == -1) {std::cout<<"unable to open/create mem file"<<std::endl;}
+     }
    }
-    file_name = file_path + module_name + "_" + std::to_string(pageIdx);
+   std::string file_name = mFilePath + module_name + "_" + std::to_string(pageIdx);
 #ifdef DEBUGMSG
-      cout<<"ddr fmodel file_name: "<< file_name<<endl;
+   std::cout<<"ddr fmodel file_name: "<< file_name<<std::endl;
 #endif
-    return file_name;
+   return file_name;
  }
 
-
@@ -23,6 +23,8 @@
 #include <sstream> // memcpy
 #include <stdlib.h> //realloc
 #include <map> //realloc
+#include <memory>
+#include <vector>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -34,26 +36,70 @@
 #define PAGESIZE (ONE_MB)
 #define ADDRBITS (20)
 #define N_1MBARRAYS 4096
+// page index bits resolved by each level of the page table
+#define PT_BITS (12)
+#define PT_ENTRIES (1 << PT_BITS)
 
+// Device memory of hw_emu before the simulator is up.  Pages are found
+// through a two level page table covering 2^(ADDRBITS + 2*PT_BITS) bytes.
+// The first N_1MBARRAYS pages are carved out of one MAP_NORESERVE region,
+// so untouched memory costs nothing; later pages come from the heap.
+//
+// The pages can be saved to a snapshot file, which is a header, the index
+// of each page and then the pages themselves, aligned so that a later run
+// maps them in place instead of reading them.
 class mem_model{
 public:
+// Both return 0 on success and 1 when a page could not be allocated
 unsigned int writeDevMem(uint64_t offset, const void* src, unsigned int size);
 unsigned int readDevMem(uint64_t offset, void* dest, unsigned int size);
 
+  // Write every page holding non zero data to a snapshot file
+  bool save_snapshot(const std::string& path);
+  // Map the pages of a snapshot into an empty model.  The mapping is
+  // copy-on-write, writes to device memory never reach the file.
+  bool load_snapshot(const std::string& path);
+  // Device address of every page holding non zero data, in address order
+  std::vector<uint64_t> page_addresses() const;
+  // Whether the model shares page files with the simulator: pages start
+  // out from them and are written back when the model goes away
+  void set_handoff(bool handoff) { mHandoff = handoff; }
+
 protected:
 private:
   unsigned char* get_page(uint64_t offset);
+  unsigned char** page_entry(uint64_t pageIdx);
+  unsigned char* load_page(uint64_t pageIdx);
+  unsigned char* alloc_page();
   std::string get_mem_file_name(uint64_t pageIdx);
-  std::map<uint64_t,unsigned char*> pageCache;
-  std::map<uint64_t,unsigned char*>::iterator pageCacheItr;
 
+  struct page_table { unsigned char* pages[PT_ENTRIES]; };
+  std::unique_ptr<page_table> mPageDir[PT_ENTRIES];
+  // pages above the range of the page table
+  std::map<uint64_t,unsigned char*> mFarPages;
+  // every page in allocation order, for serialize
+  std::vector<std::pair<uint64_t,unsigned char*>> mPages;
+  uint64_t mLastPageIdx;
+  unsigned char* mLastPage;
+
+  unsigned char* mSlab;
+  size_t mSlabSize;
+  size_t mSlabPages;
+  unsigned char* mSnapshot;
+  size_t mSnapshotSize;
+  std::string mFilePath;
+
+  bool mHandoff;
   ddr_mem_msg serialize_msg;
   ddr_mem_msg deserialize_msg;
   void serialize();
   std::string mDeviceName;
   std::string module_name;
 public:
-  mem_model(std::string deviceName);
+  // backingFile: when set, page memory is a sparse file instead of anonymous
+  // memory; it is emptied on open, use snapshotFile to carry data across runs
+  // snapshotFile: when set, device memory starts out as this snapshot
+  mem_model(std::string deviceName, const std::string& backingFile = "", const std::string& snapshotFile = "");
   ~ mem_model();
 };
 
@@ -292,8 +292,15 @@ namespace xclhwemhal2 {
     std::sprintf(fileName.get(), "%s/tempFile_%d", deviceDirectory.c_str(), binaryCounter);
 #endif
 
+    // Once the simulator runs no copy goes through the model, so the
+    // snapshot is restored now and handed over with the rest of the model
+    saveMemSnapshot();
+    mSnapshotPages.clear();
+    if (!xclemulation::config::getInstance()->getMemSnapshotLoad().empty())
+      getMemModel();
     if (mMemModel)
     {
+      mSnapshotPages = mMemModel->page_addresses();
       delete mMemModel;
       mMemModel = NULL;
     }
@@ -901,9 +908,8 @@ uint32_t HwEmShim::getAddressSpace (uint32_t topology)
   {
     if(!sock)
     {
-      if(!mMemModel)
-        mMemModel = new mem_model(deviceName);
-      mMemModel->writeDevMem(dest,src,size);
+      if (getMemModel()->writeDevMem(dest,src,size) != 0)
+        return 0;
       return size;
     }
     src = (unsigned char*)src + seek;
@@ -944,14 +950,82 @@ uint32_t HwEmShim::getAddressSpace (uint32_t topology)
     return size;
   }
 
+  // Device memory before the simulator is up, restored from the
+  // mem_snapshot_load snapshot when one is configured
+  mem_model* HwEmShim::getMemModel()
+  {
+    if (!mMemModel)
+    {
+      xclemulation::config* cfg = xclemulation::config::getInstance();
+      mMemModel = new mem_model(deviceName, cfg->getMemModelFile(), getMemSnapshotFile(cfg->getMemSnapshotLoad()));
+    }
+    return mMemModel;
+  }
+
+  // Save device memory to the mem_snapshot_save snapshot: the model before
+  // the simulator is up, afterwards every allocated buffer and every page
+  // handed over with the model, read back from the simulator
+  void HwEmShim::saveMemSnapshot()
+  {
+    std::string snapshot = getMemSnapshotFile(xclemulation::config::getInstance()->getMemSnapshotSave());
+    if (snapshot.empty())
+      return;
+
+    bool saved = false;
+    if (!sock)
+    {
+      if (!mMemModel)
+        return;
+      saved = mMemModel->save_snapshot(snapshot);
+    }
+    else
+    {
+      mem_model device(deviceName);
+      device.set_handoff(false);
+      std::unique_ptr<unsigned char[]> page(new unsigned char[PAGESIZE]);
+      bool complete = true;
+      auto readBack = [&](uint64_t addr, uint64_t size, uint32_t topology) {
+        for (uint64_t done = 0; done < size; done += PAGESIZE)
+        {
+          size_t chunk = std::min<uint64_t>(PAGESIZE, size - done);
+          if (xclCopyBufferDevice2Host(page.get(), addr + done, chunk, 0, topology) != chunk
+              || device.writeDevMem(addr + done, page.get(), chunk) != 0)
+            complete = false;
+        }
+      };
+      for (uint32_t i = 0; i < mDDRMemoryManager.size(); i++)
+      {
+        xclemulation::MemoryManager* bank = mDDRMemoryManager[i];
+        for (auto& block : bank->busyBlocks())
+          readBack(block.first, block.second, i);
+        for (auto addr : mSnapshotPages)
+        {
+          if (addr >= bank->start() && addr < bank->start() + bank->size())
+            readBack(addr, std::min<uint64_t>(PAGESIZE, bank->start() + bank->size() - addr), i);
+        }
+      }
+      saved = complete && device.save_snapshot(snapshot);
+    }
+    std::string dMsg = saved ? "INFO: [HW-EM 10-0] Device memory saved to " + snapshot
+                             : "WARNING: [HW-EM 10-1] Unable to save device memory to " + snapshot;
+    logMessage(dMsg, saved ? 1 : 0);
+  }
+
+  // Every device has its own snapshot, named after the device
+  std::string HwEmShim::getMemSnapshotFile(const std::string& path)
+  {
+    if (path.empty())
+      return path;
+    return path + "." + deviceName;
+  }
+
   size_t HwEmShim::xclCopyBufferDevice2Host(void *dest, uint64_t src, size_t size, size_t skip, uint32_t topology)
   {
     dest = ((unsigned char*)dest) + skip;
     if(!sock)
     {
-      if(!mMemModel)
-        mMemModel = new mem_model(deviceName);
-      mMemModel->readDevMem(src,dest,size);
+      if (getMemModel()->readDevMem(src,dest,size) != 0)
+        return 0;
       return size;
     }
     if (mLogStream.is_open()) {
@@ -1183,6 +1257,8 @@ uint32_t HwEmShim::getAddressSpace (uint32_t topology)
     }
     mFdToFileNameMap.clear();
 
+    saveMemSnapshot();
+
     if (!sock) 
     {
       if( xclemulation::config::getInstance()->isKeepRunDirEnabled() == false)
@@ -2217,6 +2293,10 @@ int HwEmShim::xclExecWait(int timeoutMilliSec)
  //   mLogStream << __func__ << ", " << std::this_thread::get_id() << ", " << timeoutMilliSec << std::endl;
   }
 
+  /* return as soon as the scheduler completed a command */
+  if (mMBSch && mCore)
+    return mMBSch->wait_for_completion(timeoutMilliSec);
+
   unsigned int tSec = 0;
   static bool bConfig = true;
   tSec = timeoutMilliSec/1000;
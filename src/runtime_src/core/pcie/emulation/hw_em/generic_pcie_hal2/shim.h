@@ -297,6 +297,11 @@ using addr_type = uint64_t;
       clock_t last_clk_time;
       bool mCloseAll;
       mem_model* mMemModel;
+      mem_model* getMemModel();
+      std::string getMemSnapshotFile(const std::string& path);
+      void saveMemSnapshot();
+      // Pages handed to the simulator with the model, read back on save
+      std::vector<uint64_t> mSnapshotPages;
       bool bUnified;
       bool bXPR;
       //MemTopology topology;
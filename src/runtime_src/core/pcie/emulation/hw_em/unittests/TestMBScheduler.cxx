@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+#include "shim.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using xclhwemhal2::MBScheduler;
+
+// Every completion notified wakes exactly one xclExecWait, however many
+// threads wait at the same time and however fast the completions come
+TEST(MBScheduler, OneWaiterPerCompletion) {
+   MBScheduler sched(nullptr);
+   xclhwemhal2::exec_core exec;
+   xclhwemhal2::xocl_cmd cmd;
+   cmd.exec = &exec;
+
+   const int waiters = 8;
+   std::atomic<int> woken(0);
+   std::vector<std::thread> threads;
+   for (int i = 0; i < waiters; ++i)
+     threads.emplace_back([&] { woken += sched.wait_for_completion(2000); });
+
+   // Let the waiters block, then complete in one burst
+   std::this_thread::sleep_for(std::chrono::milliseconds(100));
+   for (int i = 0; i < waiters; ++i)
+     sched.notify_host(&cmd);
+   for (auto& t : threads)
+     t.join();
+
+   ASSERT_EQ(woken, waiters) << "A completion was consumed by another waiter.";
+   ASSERT_EQ(sched.wait_for_completion(10), 0) << "More completions seen than notified.";
+}
+
+// Completions that arrive before anyone waits are each seen once
+TEST(MBScheduler, CompletionsBeforeWait) {
+   MBScheduler sched(nullptr);
+   xclhwemhal2::exec_core exec;
+   xclhwemhal2::xocl_cmd cmd;
+   cmd.exec = &exec;
+
+   sched.notify_host(&cmd);
+   sched.notify_host(&cmd);
+
+   ASSERT_EQ(sched.wait_for_completion(10), 1);
+   ASSERT_EQ(sched.wait_for_completion(10), 1);
+   ASSERT_EQ(sched.wait_for_completion(10), 0);
+}
@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+#include "mem_model.h"
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+// Memory past the N_1MBARRAYS pages of the slab comes from the heap
+// instead of ending the process
+TEST(MemModel, BeyondSlab) {
+   mem_model device("mem_model_test");
+   device.set_handoff(false);
+   const uint64_t num_pages = N_1MBARRAYS + 4;
+   for (uint64_t i = 0; i < num_pages; ++i) {
+     unsigned char value = static_cast<unsigned char>(i + 1);
+     ASSERT_EQ(device.writeDevMem(i * PAGESIZE + 7, &value, 1), 0u);
+   }
+   for (uint64_t i = 0; i < num_pages; ++i) {
+     unsigned char value = 0;
+     ASSERT_EQ(device.readDevMem(i * PAGESIZE + 7, &value, 1), 0u);
+     ASSERT_EQ(value, static_cast<unsigned char>(i + 1)) << "Page " << i;
+   }
+
+   // Heap pages start out cleared like the slab
+   unsigned char value = 1;
+   ASSERT_EQ(device.readDevMem((num_pages - 1) * PAGESIZE, &value, 1), 0u);
+   ASSERT_EQ(value, 0);
+}
+
+namespace {
+
+// Write every address in order, then read it back; the last write of an
+// address wins
+void
+write_read_back(mem_model& device, const std::vector<uint64_t>& addrs, size_t access)
+{
+   std::vector<unsigned char> buf(access);
+   for (auto addr : addrs) {
+     buf[0] = static_cast<unsigned char>(addr >> 12);
+     buf[access - 1] = static_cast<unsigned char>(addr >> 20);
+     ASSERT_EQ(device.writeDevMem(addr, buf.data(), access), 0u);
+   }
+   for (size_t i = addrs.size(); i-- > 0;) {
+     ASSERT_EQ(device.readDevMem(addrs[i], buf.data(), access), 0u);
+     ASSERT_EQ(buf[0], static_cast<unsigned char>(addrs[i] >> 12)) << "Data mismatch at 0x" << std::hex << addrs[i];
+     ASSERT_EQ(buf[access - 1], static_cast<unsigned char>(addrs[i] >> 20)) << "Data mismatch at 0x" << std::hex << addrs[i];
+   }
+}
+
+}
+
+// Accesses straddling pages and spread over a sparse 64 GB range
+TEST(MemModel, SequentialAndRandom) {
+   mem_model device("mem_model_test");
+   device.set_handoff(false);
+   const size_t access = 4096 + 16;
+   const uint64_t range = 64ull * 1024 * ONE_MB;
+
+   std::vector<uint64_t> seq, random;
+   std::mt19937_64 gen(42);
+   for (uint64_t i = 0; i < 4096; ++i) {
+     seq.push_back(i * access);
+     random.push_back(gen() % (range / access) * access);
+   }
+   write_read_back(device, seq, access);
+   write_read_back(device, random, access);
+}
+
+// Pages of a backing file are handed out in first touch order, so the
+// data of an earlier run must not show up in the next one
+TEST(MemModel, BackingFileStartsEmpty) {
+   std::string file = "mem_model_test." + std::to_string(getpid());
+   const uint64_t addr = 5 * PAGESIZE + 3;
+   {
+     mem_model device("mem_model_test", file);
+     device.set_handoff(false);
+     unsigned char value = 0x5a;
+     ASSERT_EQ(device.writeDevMem(addr, &value, 1), 0u);
+   }
+   {
+     mem_model device("mem_model_test", file);
+     device.set_handoff(false);
+     unsigned char value = 0xff;
+     ASSERT_EQ(device.readDevMem(addr, &value, 1), 0u);
+     ASSERT_EQ(value, 0);
+   }
+   unlink(file.c_str());
+}
@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+#include "mem_model.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Device memory snapshot round trip of hw_emu, in the order the shim goes
+// through it when the xclbin is loaded before any buffer is written.  A
+// second mem_model stands in for the simulator: at xclbin load the model,
+// restored from mem_snapshot_load, is handed over to the simulator, after
+// which every copy goes to the simulator.  On save the allocated buffers
+// and the pages handed over are read back from it.
+
+namespace {
+
+typedef std::vector<std::pair<uint64_t, uint64_t>> blocks;
+
+// Buffers the host allocates and writes once the xclbin is loaded; the
+// last one straddles a page boundary
+const blocks buffers = {
+  { 0x0, 4096 },
+  { 3 * PAGESIZE + 128, 64 * ONE_KB },
+  { 40 * PAGESIZE - 512, 2 * ONE_KB },
+};
+
+unsigned char
+pattern(uint64_t addr, unsigned int run)
+{
+  return static_cast<unsigned char>((addr >> 9) + addr + run * 31 + 1);
+}
+
+void
+fill(mem_model& device, const blocks& bufs, unsigned int run)
+{
+  for (auto& buf : bufs) {
+    std::vector<unsigned char> data(buf.second);
+    for (uint64_t i = 0; i < buf.second; ++i)
+      data[i] = pattern(buf.first + i, run);
+    ASSERT_EQ(device.writeDevMem(buf.first, data.data(), data.size()), 0u);
+  }
+}
+
+void
+check(mem_model& device, const blocks& bufs, unsigned int run)
+{
+  for (auto& buf : bufs) {
+    std::vector<unsigned char> data(buf.second);
+    ASSERT_EQ(device.readDevMem(buf.first, data.data(), data.size()), 0u);
+    for (uint64_t i = 0; i < buf.second; ++i)
+      ASSERT_EQ(data[i], pattern(buf.first + i, run)) << "Data mismatch at 0x" << std::hex << buf.first + i;
+  }
+}
+
+// xclLoadBitstreamWorker: restore the snapshot into the model and hand
+// every page of it to the simulator
+std::vector<uint64_t>
+load_xclbin(mem_model& simulator, const std::string& snapshot)
+{
+  mem_model model("snapshot_test", "", snapshot);
+  model.set_handoff(false);
+  std::vector<uint64_t> handed = model.page_addresses();
+  std::unique_ptr<unsigned char[]> page(new unsigned char[PAGESIZE]);
+  for (auto addr : handed) {
+    model.readDevMem(addr, page.get(), PAGESIZE);
+    simulator.writeDevMem(addr, page.get(), PAGESIZE);
+  }
+  return handed;
+}
+
+// saveMemSnapshot with the simulator running
+bool
+save(mem_model& simulator, const blocks& busy, const std::vector<uint64_t>& handed,
+     const std::string& snapshot)
+{
+  mem_model device("snapshot_test");
+  device.set_handoff(false);
+  std::unique_ptr<unsigned char[]> page(new unsigned char[PAGESIZE]);
+  auto readBack = [&](uint64_t addr, uint64_t size) {
+    for (uint64_t done = 0; done < size; done += PAGESIZE) {
+      size_t chunk = std::min<uint64_t>(PAGESIZE, size - done);
+      simulator.readDevMem(addr + done, page.get(), chunk);
+      device.writeDevMem(addr + done, page.get(), chunk);
+    }
+  };
+  for (auto& block : busy)
+    readBack(block.first, block.second);
+  for (auto addr : handed)
+    readBack(addr, PAGESIZE);
+  return device.save_snapshot(snapshot);
+}
+
+std::string
+snapshot_name()
+{
+  return "mem_snapshot_test." + std::to_string(getpid());
+}
+
+}
+
+TEST(MemSnapshot, XclbinLoadedFirst) {
+   std::string snapshot = snapshot_name();
+   unlink(snapshot.c_str());
+   blocks first(buffers.begin(), buffers.begin() + 1);
+   blocks rest(buffers.begin() + 1, buffers.end());
+
+   // Run 1: no snapshot yet, buffers written after the xclbin is loaded
+   {
+     mem_model simulator("snapshot_test");
+     simulator.set_handoff(false);
+     std::vector<uint64_t> handed = load_xclbin(simulator, snapshot);
+     ASSERT_TRUE(handed.empty()) << "Pages handed over without a snapshot.";
+     fill(simulator, buffers, 0);
+     ASSERT_TRUE(save(simulator, buffers, handed, snapshot)) << "Unable to save " << snapshot;
+   }
+
+   // Run 2: the simulator starts out with the buffers of run 1; the host
+   // only allocates the first buffer again and overwrites it
+   {
+     mem_model simulator("snapshot_test");
+     simulator.set_handoff(false);
+     std::vector<uint64_t> handed = load_xclbin(simulator, snapshot);
+     ASSERT_FALSE(handed.empty()) << "Nothing restored from " << snapshot;
+     check(simulator, buffers, 0);
+     fill(simulator, first, 1);
+     ASSERT_TRUE(save(simulator, first, handed, snapshot)) << "Unable to save " << snapshot << " again";
+   }
+
+   // Run 3: the buffers run 2 did not allocate survive the second save
+   {
+     mem_model simulator("snapshot_test");
+     simulator.set_handoff(false);
+     load_xclbin(simulator, snapshot);
+     check(simulator, first, 1);
+     check(simulator, rest, 0);
+   }
+   unlink(snapshot.c_str());
+}
@@ -57,13 +57,28 @@ Section::~Section() {
 void
 Section::purgeBuffers()
 {
-  if (m_pBuffer != nullptr) {
-    delete m_pBuffer;
-    m_pBuffer = nullptr;
+  if (m_pImage) {
+    m_pImage.reset();
+  } else if (m_pBuffer != nullptr) {
+    delete [] m_pBuffer;
   }
+  m_pBuffer = nullptr;
   m_bufferSize = 0;
 }
 
+void
+Section::detachImage()
+{
+  if (!m_pImage) {
+    return;
+  }
+
+  char *pBuffer = new char[m_bufferSize];
+  memcpy(pBuffer, m_pBuffer, m_bufferSize);
+  m_pBuffer = pBuffer;
+  m_pImage.reset();
+}
+
 void
 Section::setName(const std::string &_sSectionName)
 {
@@ -285,6 +300,41 @@ Section::readXclBinBinary(std::fstream& _istream, const axlf_section_header& _se
   XUtil::TRACE(XUtil::format("  m_size: %ld", m_bufferSize));
 }
 
+void
+Section::readXclBinBinary(const std::shared_ptr<XUtil::FileImage>& _image, const axlf_section_header& _sectionHeader) {
+  // Some error checking
+  if ((enum axlf_section_kind)_sectionHeader.m_sectionKind != getSectionKind()) {
+    std::string errMsg = XUtil::format("ERROR: Unexpected section kind.  Expected: %d, Read: %d", getSectionKind(), _sectionHeader.m_sectionKind);
+    throw std::runtime_error(errMsg);
+  }
+
+  if (m_pBuffer != nullptr) {
+    std::string errMsg = "ERROR: Binary buffer already exists.";
+    throw std::runtime_error(errMsg);
+  }
+
+  m_name = (char*)&_sectionHeader.m_sectionName;
+
+  if (_sectionHeader.m_sectionSize > UINT32_MAX) {
+    std::string errMsg ("FATAL ERROR: Section header size exceeds internal representation size.");
+    throw std::runtime_error(errMsg);
+  }
+
+  if ((_sectionHeader.m_sectionOffset > _image->size()) ||
+      (_sectionHeader.m_sectionSize > _image->size() - _sectionHeader.m_sectionOffset)) {
+    std::string errMsg = "ERROR: Input stream for the binary buffer is smaller then the expected size.";
+    throw std::runtime_error(errMsg);
+  }
+
+  // Reference the section in place, it is copied only if written to
+  m_bufferSize = (unsigned int) _sectionHeader.m_sectionSize;
+  m_pBuffer = _image->data() + _sectionHeader.m_sectionOffset;
+  m_pImage = _image;
+
+  XUtil::TRACE(XUtil::format("Section: %s (%d)", getSectionKindAsString().c_str(), (unsigned int)getSectionKind()));
+  XUtil::TRACE(XUtil::format("  m_name: %s", m_name.c_str()));
+  XUtil::TRACE(XUtil::format("  m_size: %ld", m_bufferSize));
+}
 
 void 
 Section::readJSONSectionImage(const boost::property_tree::ptree& _ptSection)
@@ -631,11 +681,7 @@ Section::readSubPayload(std::fstream& _istream,
   readSubPayload(m_pBuffer, m_bufferSize, _istream, _sSubSection, _eFormatType, buffer);
 
   // Now for some how cleaning
-  if (m_pBuffer != nullptr) {
-    delete m_pBuffer;
-    m_pBuffer = nullptr;
-    m_bufferSize = 0;
-  }
+  purgeBuffers();
 
   m_bufferSize = (unsigned int) buffer.tellp();
 
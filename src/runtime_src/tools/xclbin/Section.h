@@ -26,12 +26,14 @@
 #include <fstream>
 #include <map>
 #include <functional>
+#include <memory>
 #include <vector>
 
 #include <boost/property_tree/ptree.hpp>
 
 // ------------ F O R W A R D - D E C L A R A T I O N S ----------------------
 // Forward declarations - use these instead whenever possible...
+namespace XclBinUtilities { class FileImage; }
 
 // ------------------- C L A S S :   S e c t i o n ---------------------------
 
@@ -77,6 +79,7 @@ class Section {
   // Xclbin Binary helper methods - child classes can override them if they choose
   virtual void readXclBinBinary(std::fstream& _istream, const struct axlf_section_header& _sectionHeader);
   virtual void readXclBinBinary(std::fstream& _istream, const boost::property_tree::ptree& _ptSection);
+  virtual void readXclBinBinary(const std::shared_ptr<XclBinUtilities::FileImage>& _image, const struct axlf_section_header& _sectionHeader);
   void readXclBinBinary(std::fstream& _istream, enum FormatType _eFormatType);
   void readJSONSectionImage(const boost::property_tree::ptree& _ptSection);
   void readPayload(std::fstream& _istream, enum FormatType _eFormatType);
@@ -92,6 +95,7 @@ class Section {
 
   void getPayload(boost::property_tree::ptree& _pt) const;
   void purgeBuffers();
+  void detachImage();
   void setName(const std::string &_sSectionName);
 
  protected:
@@ -116,6 +120,8 @@ class Section {
 
   char* m_pBuffer;
   unsigned int m_bufferSize;
+  // When set, m_pBuffer references this image instead of owning its memory
+  std::shared_ptr<XclBinUtilities::FileImage> m_pImage;
   std::string m_name;
 
  private:
@@ -472,7 +472,17 @@ SectionSoftKernel::writeSubPayload(const std::string& _sSubSectionName,
 void
 SectionSoftKernel::readXclBinBinary(std::fstream& _istream, const axlf_section_header& _sectionHeader) {
   Section::readXclBinBinary(_istream, _sectionHeader);
+  updateIndexName();
+}
 
+void
+SectionSoftKernel::readXclBinBinary(const std::shared_ptr<XUtil::FileImage>& _image, const axlf_section_header& _sectionHeader) {
+  Section::readXclBinBinary(_image, _sectionHeader);
+  updateIndexName();
+}
+
+void
+SectionSoftKernel::updateIndexName() {
   // Extract the binary data as a JSON string
   std::ostringstream buffer;
   writeMetadata(buffer);
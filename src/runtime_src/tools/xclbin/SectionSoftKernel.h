@@ -45,6 +45,7 @@ public:
   virtual bool supportsSubSection(const std::string &_sSubSectionName) const;
   virtual bool subSectionExists(const std::string &_sSubSectionName) const;
   virtual void readXclBinBinary(std::fstream& _istream, const struct axlf_section_header& _sectionHeader);
+  virtual void readXclBinBinary(const std::shared_ptr<XclBinUtilities::FileImage>& _image, const struct axlf_section_header& _sectionHeader);
 
 
  protected:
@@ -57,6 +58,7 @@ public:
    virtual void writeSubPayload(const std::string & _sSubSectionName, FormatType _eFormatType, std::fstream&  _oStream) const;
    void writeObjImage(std::ostream& _oStream) const;
    void writeMetadata(std::ostream& _oStream) const;
+   void updateIndexName();
 
  private:
   // Purposefully private and undefined ctors...
@@ -113,18 +113,15 @@ XclBin::printSections(std::ostream &_ostream) const {
 }
 
 void
-XclBin::readXclBinBinaryHeader(std::fstream& _istream) {
+XclBin::readXclBinBinaryHeader(const XUtil::FileImage& _image) {
   // Read in the buffer
-  const unsigned int expectBufferSize = sizeof(axlf);
-
-  _istream.seekg(0);
-  _istream.read((char*)&m_xclBinHeader, sizeof(axlf));
-
-  if (_istream.gcount() != expectBufferSize) {
+  if (_image.size() < sizeof(axlf)) {
     std::string errMsg = "ERROR: Input stream is smaller than the expected header size.";
     throw std::runtime_error(errMsg);
   }
 
+  memcpy(&m_xclBinHeader, _image.data(), sizeof(axlf));
+
   if (FormattedOutput::getMagicAsString(m_xclBinHeader).c_str() != std::string("xclbin2")) {
     std::string errMsg = "ERROR: The XCLBIN appears to be corrupted (header start key value is not what is expected).";
     throw std::runtime_error(errMsg);
@@ -132,32 +129,30 @@ XclBin::readXclBinBinaryHeader(std::fstream& _istream) {
 }
 
 void
-XclBin::readXclBinBinarySections(std::fstream& _istream) {
+XclBin::readXclBinBinarySections(const std::shared_ptr<XUtil::FileImage>& _image) {
   // Read in each section
   unsigned int numberOfSections = m_xclBinHeader.m_header.m_numSections;
 
   for (unsigned int index = 0; index < numberOfSections; ++index) {
     XUtil::TRACE(XUtil::format("Examining Section: %d of %d", index + 1, m_xclBinHeader.m_header.m_numSections));
     // Find the section header data
-    long long sectionOffset = sizeof(axlf) + (index * sizeof(axlf_section_header)) - sizeof(axlf_section_header);
-    _istream.seekg(sectionOffset);
+    uint64_t sectionOffset = sizeof(axlf) + (index * sizeof(axlf_section_header)) - sizeof(axlf_section_header);
 
     // Read in the section header
     axlf_section_header sectionHeader = axlf_section_header {0};
-    const unsigned int expectBufferSize = sizeof(axlf_section_header);
-
-    _istream.read((char*)&sectionHeader, sizeof(axlf_section_header));
 
-    if (_istream.gcount() != expectBufferSize) {
+    if (_image->size() < sectionOffset + sizeof(axlf_section_header)) {
       std::string errMsg = "ERROR: Input stream is smaller than the expected section header size.";
       throw std::runtime_error(errMsg);
     }
 
+    memcpy(&sectionHeader, _image->data() + sectionOffset, sizeof(axlf_section_header));
+
     Section* pSection = Section::createSectionObjectOfKind((enum axlf_section_kind)sectionHeader.m_sectionKind);
 
     // Here for testing purposes, when all segments are supported it should be removed
     if (pSection != nullptr) {
-      pSection->readXclBinBinary(_istream, sectionHeader);
+      pSection->readXclBinBinary(_image, sectionHeader);
       addSection(pSection);
     }
   }
@@ -187,15 +182,19 @@ XclBin::readXclBinBinary(const std::string &_binaryFileName,
 
     // Read in the mirror image
     readXclBinaryMirrorImage(ifXclBin, pt_mirrorData);
+    ifXclBin.close();
   } else {
+    ifXclBin.close();
+
+    // The sections reference the file image instead of copies of it
+    m_pImage = std::make_shared<XUtil::FileImage>(_binaryFileName);
+
     // Read in the header
-    readXclBinBinaryHeader(ifXclBin);
+    readXclBinBinaryHeader(*m_pImage);
 
     // Read the sections
-    readXclBinBinarySections(ifXclBin);
+    readXclBinBinarySections(m_pImage);
   }
-
-  ifXclBin.close();
 }
 
 void
@@ -355,6 +354,17 @@ XclBin::writeXclBinBinary(const std::string &_binaryFileName,
     throw std::runtime_error(errMsg);
   }
 
+  // Sections still referencing the input image must not see it truncated
+  if (m_pImage &&
+      boost::filesystem::exists(_binaryFileName) &&
+      boost::filesystem::equivalent(_binaryFileName, m_pImage->fileName())) {
+    XUtil::TRACE("Output file is the input file, copying the section buffers.");
+    for (Section *pSection : m_sections) {
+      pSection->detachImage();
+    }
+    m_pImage.reset();
+  }
+
   // Write the xclbin file image
   XUtil::TRACE("Writing the xclbin binary file: " + _binaryFileName);
   std::fstream ofXclBin;
@@ -20,12 +20,14 @@
 #include <string>
 #include <fstream>
 #include <vector>
+#include <memory>
 #include <boost/property_tree/ptree.hpp>
 
 #include "xclbin.h"
 #include "ParameterSectionData.h"
 
 class Section;
+namespace XclBinUtilities { class FileImage; }
 
 class XclBin {
  public:
@@ -60,8 +62,8 @@ class XclBin {
 
  private:
   void updateHeaderFromSection(Section *_pSection);
-  void readXclBinBinaryHeader(std::fstream& _istream);
-  void readXclBinBinarySections(std::fstream& _istream);
+  void readXclBinBinaryHeader(const XclBinUtilities::FileImage& _image);
+  void readXclBinBinarySections(const std::shared_ptr<XclBinUtilities::FileImage>& _image);
 
   void findAndReadMirrorData(std::fstream& _istream, boost::property_tree::ptree& _mirrorData) const;
   void readXclBinaryMirrorImage(std::fstream& _istream, const boost::property_tree::ptree& _mirrorData);
@@ -95,6 +97,7 @@ class XclBin {
  private:
   std::vector<Section*> m_sections;
   axlf m_xclBinHeader;
+  std::shared_ptr<XclBinUtilities::FileImage> m_pImage;
 
  protected:
   SchemaVersion m_SchemaVersionMirrorWrite;
@@ -35,6 +35,10 @@
   #include <winsock2.h>
 #else
   #include <arpa/inet.h>
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
 #endif
 
 namespace XUtil = XclBinUtilities;
@@ -596,5 +600,61 @@ XclBinUtilities::write_htonl(std::ostream & _buf, uint32_t _word32)
 }
 
 
+XclBinUtilities::FileImage::FileImage(const std::string& _sFileName)
+    : m_sFileName(_sFileName)
+    , m_pData(nullptr)
+    , m_size(0)
+    , m_bMapped(false) {
+#ifndef _WIN32
+  int fd = open(_sFileName.c_str(), O_RDONLY);
+  if (fd < 0) {
+    std::string errMsg = "ERROR: Unable to open the file for reading: " + _sFileName;
+    throw std::runtime_error(errMsg);
+  }
+
+  struct stat sb;
+  if ((fstat(fd, &sb) == 0) && (sb.st_size > 0)) {
+    void *pAddr = mmap(nullptr, sb.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if (pAddr != MAP_FAILED) {
+      m_pData = (char *) pAddr;
+      m_size = (uint64_t) sb.st_size;
+      m_bMapped = true;
+    }
+  }
+  close(fd);
+
+  if (m_bMapped) {
+    TRACE(XUtil::format("Mapped %ld bytes of '%s'", m_size, _sFileName.c_str()));
+    return;
+  }
+#endif
+
+  std::fstream ifFile;
+  ifFile.open(_sFileName, std::ifstream::in | std::ifstream::binary);
+  if (!ifFile.is_open()) {
+    std::string errMsg = "ERROR: Unable to open the file for reading: " + _sFileName;
+    throw std::runtime_error(errMsg);
+  }
+
+  ifFile.seekg(0, ifFile.end);
+  m_size = (uint64_t) ifFile.tellg();
+  ifFile.seekg(0, ifFile.beg);
 
+  m_pData = new char[m_size];
+  ifFile.read(m_pData, m_size);
+  if (ifFile.gcount() != (std::streamsize) m_size) {
+    delete [] m_pData;
+    std::string errMsg = "ERROR: Unable to read the file: " + _sFileName;
+    throw std::runtime_error(errMsg);
+  }
+}
 
+XclBinUtilities::FileImage::~FileImage() {
+#ifndef _WIN32
+  if (m_bMapped) {
+    munmap(m_pData, m_size);
+    return;
+  }
+#endif
+  delete [] m_pData;
+}
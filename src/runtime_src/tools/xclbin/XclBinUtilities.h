@@ -130,6 +130,28 @@ void printKinds();
 std::string getUUIDAsString( const unsigned char (&_uuid)[16] );
 
 void write_htonl(std::ostream & _buf, uint32_t _word32);
+
+// Image of an entire file.  Where supported the file is mapped private and
+// writable: the pages come from the page cache and only the pages that are
+// written to are copied.  Elsewhere the file is read into memory.
+class FileImage {
+ public:
+  explicit FileImage(const std::string& _sFileName);
+  ~FileImage();
+
+  char* data() const { return m_pData; }
+  uint64_t size() const { return m_size; }
+  const std::string& fileName() const { return m_sFileName; }
+
+ private:
+  FileImage(const FileImage&) = delete;
+  FileImage& operator=(const FileImage&) = delete;
+
+  std::string m_sFileName;
+  char* m_pData;
+  uint64_t m_size;
+  bool m_bMapped;
+};
 };
 
 #endif
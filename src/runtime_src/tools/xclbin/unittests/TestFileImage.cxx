@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include "ParameterSectionData.h"
+#include "XclBinClass.h"
+#include "XclBinUtilities.h"
+#include "Section.h"
+
+namespace XUtil = XclBinUtilities;
+
+static void
+writeFile(const std::string &_sFileName, const std::string &_sContents) {
+   std::ofstream ofFile(_sFileName, std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+   ofFile.write(_sContents.data(), _sContents.size());
+}
+
+static std::string
+readFile(const std::string &_sFileName) {
+   std::ifstream ifFile(_sFileName, std::ifstream::in | std::ifstream::binary);
+   std::ostringstream buf;
+   buf << ifFile.rdbuf();
+   return buf.str();
+}
+
+static std::string
+makePayload(unsigned int _size, unsigned int _seed) {
+   std::string payload(_size, '\0');
+   for (unsigned int index = 0; index < _size; ++index) {
+      payload[index] = (char) ((index * 31 + _seed) & 0xff);
+   }
+   return payload;
+}
+
+// Creates an xclbin holding a DEBUG_DATA and a BITSTREAM section
+static void
+createXclBin(const std::string &_sFileName, const std::string &_sDebugData, const std::string &_sBitstream) {
+   writeFile(_sFileName + ".debug.raw", _sDebugData);
+   writeFile(_sFileName + ".bit.raw", _sBitstream);
+
+   XclBin xclBin;
+   ParameterSectionData psdDebug("DEBUG_DATA:RAW:" + _sFileName + ".debug.raw");
+   xclBin.addSection(psdDebug);
+   ParameterSectionData psdBit("BITSTREAM:RAW:" + _sFileName + ".bit.raw");
+   xclBin.addSection(psdBit);
+   xclBin.writeXclBinBinary(_sFileName, true /* bSkipUUIDInsertion */);
+
+   std::remove((_sFileName + ".debug.raw").c_str());
+   std::remove((_sFileName + ".bit.raw").c_str());
+}
+
+static std::string
+dumpSection(XclBin &_xclBin, const std::string &_sSection) {
+   const std::string sDumpFile = "fileimage_dump.raw";
+   ParameterSectionData psd(_sSection + ":RAW:" + sDumpFile);
+   _xclBin.dumpSection(psd);
+   std::string contents = readFile(sDumpFile);
+   std::remove(sDumpFile.c_str());
+   return contents;
+}
+
+TEST(FileImage, ReadsWholeFile) {
+   const std::string sFileName = "fileimage_whole.bin";
+   const std::string contents = makePayload(10000, 7);
+   writeFile(sFileName, contents);
+
+   XUtil::FileImage image(sFileName);
+   EXPECT_STREQ(sFileName.c_str(), image.fileName().c_str());
+   ASSERT_EQ(contents.size(), image.size());
+   EXPECT_EQ(0, memcmp(contents.data(), image.data(), contents.size()));
+
+   std::remove(sFileName.c_str());
+}
+
+TEST(FileImage, WritesStayPrivate) {
+   const std::string sFileName = "fileimage_private.bin";
+   const std::string contents = makePayload(4096 * 3, 3);
+   writeFile(sFileName, contents);
+
+   {
+      XUtil::FileImage image(sFileName);
+      ASSERT_EQ(contents.size(), image.size());
+      for (uint64_t index = 0; index < image.size(); index += 4096) {
+         image.data()[index] ^= 0xff;
+      }
+   }
+
+   EXPECT_TRUE(readFile(sFileName) == contents) << "Write to the image reached the file.";
+
+   std::remove(sFileName.c_str());
+}
+
+TEST(FileImage, MissingFile) {
+   ASSERT_THROW(XUtil::FileImage("fileimage_missing.bin"), std::runtime_error);
+}
+
+TEST(FileImage, SectionRoundTrip) {
+   const std::string sInput = "fileimage_in.xclbin";
+   const std::string sOutput = "fileimage_out.xclbin";
+   const std::string debugData = makePayload(1000, 1);
+   const std::string bitstream = makePayload(50000, 2);
+   createXclBin(sInput, debugData, bitstream);
+
+   XclBin xclBin;
+   xclBin.readXclBinBinary(sInput, false /* bMigrateForward */);
+
+   const Section * pSection = xclBin.findSection(BITSTREAM);
+   ASSERT_NE(pSection, nullptr) << "Section 'BITSTREAM' not found.";
+   EXPECT_EQ(bitstream.size(), pSection->getSize());
+   EXPECT_TRUE(dumpSection(xclBin, "BITSTREAM") == bitstream);
+
+   // The sections are written from the image of the input file
+   xclBin.writeXclBinBinary(sOutput, true /* bSkipUUIDInsertion */);
+
+   XclBin xclBinOut;
+   xclBinOut.readXclBinBinary(sOutput, false /* bMigrateForward */);
+   EXPECT_TRUE(dumpSection(xclBinOut, "DEBUG_DATA") == debugData);
+   EXPECT_TRUE(dumpSection(xclBinOut, "BITSTREAM") == bitstream);
+
+   std::remove(sInput.c_str());
+   std::remove(sOutput.c_str());
+}
+
+TEST(FileImage, RewriteSameFile) {
+   const std::string sFileName = "fileimage_same.xclbin";
+   const std::string debugData = makePayload(70000, 5);
+   const std::string bitstream = makePayload(50000, 6);
+   createXclBin(sFileName, debugData, bitstream);
+
+   // Removing the first section moves the bitstream to where the debug
+   // data was, so the output overwrites the pages the section references
+   XclBin xclBin;
+   xclBin.readXclBinBinary(sFileName, false /* bMigrateForward */);
+   xclBin.removeSection("DEBUG_DATA");
+   xclBin.writeXclBinBinary(sFileName, true /* bSkipUUIDInsertion */);
+
+   XclBin xclBinOut;
+   xclBinOut.readXclBinBinary(sFileName, false /* bMigrateForward */);
+   EXPECT_EQ(xclBinOut.findSection(DEBUG_DATA), nullptr);
+   EXPECT_TRUE(dumpSection(xclBinOut, "BITSTREAM") == bitstream);
+
+   std::remove(sFileName.c_str());
+}
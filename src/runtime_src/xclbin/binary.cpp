@@ -16,31 +16,91 @@
 
 #include "binary.h"
 
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+#include <cerrno>
+
 namespace xclbin {
 
 std::unique_ptr<binary::impl>
 create_xclbin0(std::vector<char>&& xb);
 
 std::unique_ptr<binary::impl>
-create_xclbin2(std::vector<char>&& xb);
+create_xclbin2(std::unique_ptr<image>&& xb);
 
-binary::
-binary(std::vector<char>&& xb)
-  : m_content(nullptr)
+image::
+image(std::vector<char>&& xb)
+  : m_owned(std::move(xb))
+{
+  m_data = m_owned.data();
+  m_size = m_owned.size();
+}
+
+image::
+image(const std::string& filename)
+{
+  auto fd = open(filename.c_str(),O_RDONLY);
+  if (fd == -1)
+    throw error("Cannot open '" + filename + "' for reading: " + std::strerror(errno));
+
+  struct stat sb;
+  if (fstat(fd,&sb) == -1) {
+    close(fd);
+    throw error("Cannot stat '" + filename + "'");
+  }
+
+  if (sb.st_size == 0) {
+    close(fd);
+    return;
+  }
+
+  auto addr = mmap(nullptr,sb.st_size,PROT_READ,MAP_SHARED,fd,0);
+  close(fd);
+  if (addr == MAP_FAILED)
+    throw error("Cannot map '" + filename + "': " + std::strerror(errno));
+
+  m_data = static_cast<const char*>(addr);
+  m_size = sb.st_size;
+  m_mapped = true;
+}
+
+image::
+~image()
 {
-  if (xb.size()<8)
+  if (m_mapped)
+    munmap(const_cast<char*>(m_data),m_size);
+}
+
+static std::unique_ptr<binary::impl>
+create_binary(std::unique_ptr<image>&& xb)
+{
+  if (xb->size()<8)
     throw error("bad binary");
 
-  const char* raw = &xb[0];
+  const char* raw = xb->data();
 
   // magic version
   std::string v(raw,raw+7);
   if (v=="xclbin2")
-    m_content = create_xclbin2(std::move(xb));
-  else 
-    throw error("bad binary version '" + v + "'");
+    return create_xclbin2(std::move(xb));
+
+  throw error("bad binary version '" + v + "'");
+}
+
+binary::
+binary(std::vector<char>&& xb)
+  : m_content(create_binary(std::make_unique<image>(std::move(xb))))
+{
 }
 
+binary::
+binary(const std::string& filename)
+  : m_content(create_binary(std::make_unique<image>(filename)))
+{
 }
 
+}
 
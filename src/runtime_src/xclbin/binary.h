@@ -20,6 +20,7 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <stdexcept>
 
 /**
  * This file contains a class for an xclbin binary.  It captures
@@ -46,6 +47,46 @@ public:
   {}
 };
 
+/**
+ * Memory holding an entire xclbin.
+ *
+ * The image either owns the xclbin data moved into it, or it maps the
+ * xclbin file read-only and shared.  A mapped image is backed by the
+ * page cache, so any number of images of the same file, in any number
+ * of processes, share one copy of the data.
+ */
+class image
+{
+  const char* m_data = nullptr;
+  size_t m_size = 0;
+  std::vector<char> m_owned;
+  bool m_mapped = false;
+
+public:
+  explicit
+  image(std::vector<char>&& xb);
+
+  /**
+   * Map an xclbin file
+   *
+   * @param filename
+   *  Path to the xclbin file
+   */
+  explicit
+  image(const std::string& filename);
+
+  ~image();
+
+  image(const image&) = delete;
+  image& operator=(const image&) = delete;
+
+  const char*
+  data() const { return m_data; }
+
+  size_t
+  size() const { return m_size; }
+};
+
 /**
  * An xcl binary is managed by the binary class.
  *
@@ -54,10 +95,11 @@ public:
  * an xclbin only.  If an invalid function is called, it will throw
  * an xclbin::error exception.
  *
- * Then entire xclbin binary data is copied into this class, any data
- * returned through APIs maybe referencing a range of the data
- * maintained by the class, so the binary object must stay alive while
- * anything is referencing and sharing xclbin data.
+ * The entire xclbin binary data is held by this class, either moved
+ * into it or mapped from the xclbin file.  Any data returned through
+ * APIs maybe referencing a range of the data maintained by the class,
+ * so the binary object must stay alive while anything is referencing
+ * and sharing xclbin data.
  */
 class binary
 {
@@ -74,6 +116,7 @@ public:
     virtual data_range mem_topology_data() const { throw error("not implemented"); }
     virtual data_range ip_layout_data()    const { throw error("not implemented"); }
     virtual data_range clk_freq_data()    const { throw error("not implemented"); }
+    virtual data_range section_data(int) const { throw error("not implemented"); }
   };
 
 private:
@@ -100,6 +143,18 @@ public:
   explicit
   binary(std::vector<char>&& xb);
 
+  /**
+   * Construct from xclbin file.
+   *
+   * The file is mapped rather than read, no copy of the data is made.
+   * The file must not be truncated while the binary is in use.
+   *
+   * @param filename
+   *  Path to the xclbin file
+   */
+  explicit
+  binary(const std::string& filename);
+
   binary&
   operator=(const binary& rhs)
   {
@@ -137,6 +192,14 @@ public:
 
   data_range
   clk_freq_data() const { return m_content->clk_freq_data(); }
+
+  /**
+   * @return
+   *   View of section of argument kind (axlf_section_kind), or an empty
+   *   range if the xclbin has no such section
+   */
+  data_range
+  section_data(int kind) const { return m_content->section_data(kind); }
 };
 
 } // xclbin
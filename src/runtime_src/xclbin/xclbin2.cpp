@@ -31,21 +31,21 @@ namespace xclbin {
  */
 struct xclbin2 : public binary::impl
 {
-  const std::vector<char> m_xclbin;
+  const std::unique_ptr<image> m_xclbin;
   const char* m_raw = nullptr;
   const axlf* m_axlf = nullptr;
   const axlf_header* m_header = nullptr;
 
   explicit
-  xclbin2(std::vector<char>&& xb)
-    : m_xclbin(std::move(xb)), m_raw(&m_xclbin[0])
+  xclbin2(std::unique_ptr<image>&& xb)
+    : m_xclbin(std::move(xb)), m_raw(m_xclbin->data())
     , m_axlf(reinterpret_cast<const axlf*>(m_raw))
     , m_header(&m_axlf->m_header)
   {
-    if (m_xclbin.size() < sizeof(axlf))
+    if (m_xclbin->size() < sizeof(axlf))
       throw error("bad axlf file");
 
-    if (m_xclbin.size() < m_header->m_length)
+    if (m_xclbin->size() < m_header->m_length)
       throw error ("axlf length mismatch");
   }
 
@@ -138,19 +138,30 @@ struct xclbin2 : public binary::impl
     return std::make_pair(nullptr,nullptr);
   }
 
+  data_range
+  section_data(int kind) const
+  {
+    if (auto header = xclbin::get_axlf_section(m_axlf, static_cast<axlf_section_kind>(kind)))
+    {
+      auto begin = m_raw + header->m_sectionOffset ;
+      return std::make_pair(begin, begin + header->m_sectionSize) ;
+    }
+    return std::make_pair(nullptr,nullptr);
+  }
+
 };
 
 // exposed to binary.cpp
 std::unique_ptr<binary::impl>
-create_xclbin2(std::vector<char>&& xb)
+create_xclbin2(std::unique_ptr<image>&& xb)
 {
   // Before moving do sanity checks for proper xclbin2
-  if (xb.size() < sizeof(axlf))
+  if (xb->size() < sizeof(axlf))
     throw error("bad axlf file");
 
-  auto xb2 = reinterpret_cast<const axlf*>(&xb[0]);
+  auto xb2 = reinterpret_cast<const axlf*>(xb->data());
   auto hdr = &xb2->m_header;
-  if (xb.size() < hdr->m_length)
+  if (xb->size() < hdr->m_length)
     throw error ("axlf length mismatch");
 
   // Ok we are probably good, any throws now breaks
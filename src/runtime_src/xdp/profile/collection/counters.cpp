@@ -116,28 +116,26 @@ namespace xdp {
 
   void ProfileCounters::logFunctionCallStart(const std::string& functionName, double timePoint)
   {
-    auto threadId = std::this_thread::get_id() ;
-    auto key      = std::make_pair(functionName, threadId) ;
-    auto value    = std::make_pair(timePoint, (double)0.0) ;
-
-    if (CallCount.find(key) == CallCount.end())
-    {
-      std::vector<std::pair<double, double>> newValue ;
-      newValue.push_back(value) ;
-      CallCount[key] = newValue ;
-    }
-    else
-    {
-      CallCount[key].push_back(value);
+    uint32_t id = FunctionNames.intern(functionName);
+    if (id >= FunctionCallStats.size()) {
+      FunctionCallStats.resize(id + 1);
+      FunctionCallLatency.resize(id + 1);
     }
+    FunctionCallStarts[std::make_pair(id, std::this_thread::get_id())] = timePoint;
   }
 
   void ProfileCounters::logFunctionCallEnd(const std::string& functionName, double timePoint)
   {
-    auto threadId = std::this_thread::get_id() ;
-    auto key = std::make_pair(functionName, threadId) ;
+    uint32_t id = FunctionNames.intern(functionName);
+    auto itr = FunctionCallStarts.find(std::make_pair(id, std::this_thread::get_id()));
+    if (itr == FunctionCallStarts.end())
+      return;
 
-    CallCount[key].back().second = timePoint ;
+    double startTime = itr->second;
+    FunctionCallStarts.erase(itr);
+    FunctionCallStats[id].logStart(startTime);
+    FunctionCallStats[id].logEnd(timePoint);
+    FunctionCallLatency[id].log(timePoint - startTime);
   }
 
   void ProfileCounters::logKernelExecutionStart(const std::string& kernelName, const std::string& deviceName,
@@ -191,8 +189,8 @@ namespace xdp {
   {
     std::string newCU;
     bool foundKernel = false;
-    for (const auto &pair : ComputeUnitExecutionStats) {
-      auto fullName = pair.first;
+    for (auto id : ComputeUnitExecutionStats.getSortedIds()) {
+      const std::string& fullName = ComputeUnitExecutionStats.getName(id);
       size_t first_index = fullName.find_first_of("|");
       size_t second_index = fullName.find('|', first_index+1);
       size_t third_index = fullName.find('|', second_index+1);
@@ -206,7 +204,8 @@ namespace xdp {
       if (currDeviceName != deviceName || currBinName != xclbinName)
         continue;
       if (currCUName == cuName) {
-        ComputeUnitExecutionStats[fullName].logStats(totalTimeStat, avgTimeStat, maxTimeStat, minTimeStat,
+        CounterComputeUnitStats.insert(id);
+        ComputeUnitExecutionStats.get(id).logStats(totalTimeStat, avgTimeStat, maxTimeStat, minTimeStat,
                                                      totalCalls, clockFreqMhz, flags, maxParallelIter);
         return;
       }
@@ -217,8 +216,10 @@ namespace xdp {
     }
     // CR 1003380 - Runtime does not send all CU Names so we create a key
     if (foundKernel && totalTimeStat > 0.0) {
-      ComputeUnitExecutionStats[newCU].logStats(totalTimeStat, avgTimeStat, maxTimeStat, minTimeStat,
-                                                totalCalls, clockFreqMhz, flags, maxParallelIter);
+      uint32_t id = ComputeUnitExecutionStats.intern(newCU);
+      CounterComputeUnitStats.insert(id);
+      ComputeUnitExecutionStats.get(id).logStats(totalTimeStat, avgTimeStat, maxTimeStat, minTimeStat,
+                                                 totalCalls, clockFreqMhz, flags, maxParallelIter);
     }
   }
 
@@ -348,8 +349,8 @@ namespace xdp {
 #else
     // FYI, method used pre-2015.4
     double totalTime = 0.0;
-    for (const auto &pair : KernelExecutionStats) {
-      TimeStats stats = pair.second;
+    for (uint32_t id = 0; id < KernelExecutionStats.size(); ++id) {
+      TimeStats stats = KernelExecutionStats.get(id);
       totalTime += stats.getTotalTime();
     }
 #endif
@@ -362,18 +363,14 @@ namespace xdp {
   uint32_t ProfileCounters::getComputeUnitCalls(const std::string& deviceName,
       const std::string& cuName) const
   {
-    auto cuIter = ComputeUnitExecutionStats.begin();
-    auto cuEnd  = ComputeUnitExecutionStats.end();
-
-    while (cuIter != cuEnd) {
+    for (auto id : ComputeUnitExecutionStats.getSortedIds()) {
       //"name" is of the form "deviceName|kernelName|globalSize|localSize|cuName|objId"
-      std::string name = cuIter->first;
+      std::string name = ComputeUnitExecutionStats.getName(id);
       name = name.substr(0, name.find_last_of("|"));
       if (name.find(deviceName) != std::string::npos && name.find(cuName) != std::string::npos) {
-        TimeStats cuStats = cuIter->second;
+        TimeStats cuStats = getComputeUnitStats(id);
         return cuStats.getNoOfCalls();
       }
-      cuIter++;
     }
 
     // If CU is not found, return 0
@@ -383,11 +380,11 @@ namespace xdp {
   double ProfileCounters::getComputeUnitTotalTime(const std::string& deviceName,
                                                      const std::string& cuName) const
   {
-    for (const auto &pair : ComputeUnitExecutionStats) {
-      auto fullName = pair.first;
+    for (auto id : ComputeUnitExecutionStats.getSortedIds()) {
+      const std::string& fullName = ComputeUnitExecutionStats.getName(id);
       if (fullName.find(deviceName) != std::string::npos
           && fullName.find(cuName)  != std::string::npos) {
-        auto stat = pair.second;
+        auto stat = getComputeUnitStats(id);
         return stat.getTotalTime();
       }
     }
@@ -405,66 +402,57 @@ namespace xdp {
 
   void ProfileCounters::writeKernelSummary(ProfileWriterI* writer) const
   {
-    for (const auto &pair : KernelExecutionStats) {
-      auto fullName = pair.first;
+    for (auto id : KernelExecutionStats.getSortedIds()) {
+      const std::string& fullName = KernelExecutionStats.getName(id);
       auto kernelName = fullName.substr(0, fullName.find_first_of("|"));
-      writer->writeTimeStats(kernelName, pair.second);
+      writer->writeTimeStats(kernelName, KernelExecutionStats.get(id));
     }
   }
 
   void ProfileCounters::writeComputeUnitSummary(ProfileWriterI* writer) const
   {
-    for (const auto &pair : ComputeUnitExecutionStats) {
-      auto fullName = pair.first;
+    for (auto id : ComputeUnitExecutionStats.getSortedIds()) {
+      const std::string& fullName = ComputeUnitExecutionStats.getName(id);
       auto cuName = fullName.substr(0, fullName.find_last_of("|"));
-      writer->writeComputeUnitSummary(cuName, pair.second);
+      writer->writeComputeUnitSummary(cuName, getComputeUnitStats(id));
     }
   }
 
   void ProfileCounters::writeAcceleratorSummary(ProfileWriterI* writer) const
   {
-    for (const auto &pair : ComputeUnitExecutionStats) {
-      auto fullName = pair.first;
+    for (auto id : ComputeUnitExecutionStats.getSortedIds()) {
+      const std::string& fullName = ComputeUnitExecutionStats.getName(id);
       auto cuName = fullName.substr(0, fullName.find_last_of("|"));
-      writer->writeAcceleratorSummary(cuName, pair.second);
+      writer->writeAcceleratorSummary(cuName, getComputeUnitStats(id));
     }
   }
 
   void ProfileCounters::writeAPISummary(ProfileWriterI* writer) const
   {
     using std::vector;
-    using std::pair;
     using std::sort;
-    using std::string;
-    
-    // Go through all of the call values and consolidate all of the
-    //  API calls from different threads into a single TimeStats object
-    std::map<std::string, TimeStats> consolidated ;
-    for (auto iter : CallCount)
-    {
-      auto functionName = iter.first.first ;
-      auto pairVector   = iter.second ;
-
-      for (unsigned int i = 0 ; i < pairVector.size() ; ++i)
-      {
-	auto doublePair = pairVector[i] ;
-	consolidated[functionName].logStart(doublePair.first) ;
-	consolidated[functionName].logEnd(doublePair.second) ;
-      }
-    }
-
-    // Print it in sorted order of Total Time. To sort it by duration
-    // populate a vector and then using lambda function sort it by duration
 
-    vector<pair<string, TimeStats>> callPairs(consolidated.begin(),
-        consolidated.end());
-    sort(callPairs.begin(), callPairs.end(),
-        [](const pair<string, TimeStats>& A, const pair<string, TimeStats>& B) {
-      return A.second.getTotalTime() > B.second.getTotalTime();
+    // Print it in sorted order of Total Time
+    vector<uint32_t> ids(FunctionCallStats.size());
+    for (uint32_t id = 0; id < ids.size(); ++id)
+      ids[id] = id;
+    sort(ids.begin(), ids.end(), [this](uint32_t A, uint32_t B) {
+      return FunctionCallStats[A].getTotalTime() > FunctionCallStats[B].getTotalTime();
     });
 
-    for (const auto &pair : callPairs) {
-      writer->writeTimeStats(pair.first, pair.second);
+    for (auto id : ids) {
+      if (FunctionCallStats[id].getNoOfCalls() == 0)
+        continue;
+      writer->writeTimeStats(FunctionNames.getName(id), FunctionCallStats[id]);
+    }
+  }
+
+  void ProfileCounters::writeAPILatencySummary(ProfileWriterI* writer) const
+  {
+    for (uint32_t id = 0; id < FunctionCallLatency.size(); ++id) {
+      if (FunctionCallLatency[id].getCount() == 0)
+        continue;
+      writer->writeLatencyStats(FunctionNames.getName(id), FunctionCallLatency[id]);
     }
   }
 
@@ -536,6 +524,16 @@ namespace xdp {
         maxBytesPerTransfer, maxTransferRateMBps);
   }
 
+  TimeStats ProfileCounters::getComputeUnitStats(uint32_t cuId) const
+  {
+    const TimeStats& stats = ComputeUnitExecutionStats.get(cuId);
+    // CU executions seen in device trace are only the sampled ones
+    if (DeviceTraceSampleRatio > 0.0 && DeviceTraceSampleRatio < 1.0
+        && CounterComputeUnitStats.find(cuId) == CounterComputeUnitStats.end())
+      return stats.scaled(1.0 / DeviceTraceSampleRatio);
+    return stats;
+  }
+
   void ProfileCounters::writeDeviceTransferSummary(ProfileWriterI* writer, bool isRead) const
   {
     std::string transferType("DEVICE WRITE BUFFER");
@@ -544,6 +542,11 @@ namespace xdp {
       transferType = "DEVICE READ BUFFER";
       bufferStat = &DeviceBufferReadStat;
     }
+    // Device trace only saw part of the run; extrapolate the totals
+    if (DeviceTraceSampleRatio > 0.0 && DeviceTraceSampleRatio < 1.0) {
+      writer->writeBufferStats(transferType, bufferStat->scaled(1.0 / DeviceTraceSampleRatio));
+      return;
+    }
     writer->writeBufferStats(transferType, *bufferStat);
   }
 
@@ -23,6 +23,7 @@
 #include <limits>
 #include <cstdint>
 #include <map>
+#include <set>
 #include <list>
 #include <string>
 #include <chrono>
@@ -95,6 +96,9 @@ namespace xdp {
                         double duration, uint32_t bitWidth, double clockFreqMhz,
                         bool isKernel, bool isRead, bool isKernelTransfer);
 
+    // Fraction of device activity captured when device trace is sampled
+    void setDeviceTraceSampleRatio(double ratio) { DeviceTraceSampleRatio = ratio; }
+
     void setProfileStartTime(std::chrono::steady_clock::time_point startTime) { m_profileStartTime = startTime; }
     void setProfileEndTime(std::chrono::steady_clock::time_point endTime)     { m_profileEndTime = endTime; }
 
@@ -111,6 +115,7 @@ namespace xdp {
 
     // Profile summary writers
     void writeAPISummary(ProfileWriterI* writer) const;
+    void writeAPILatencySummary(ProfileWriterI* writer) const;
     void writeKernelSummary(ProfileWriterI* writer) const;
     void writeComputeUnitSummary(ProfileWriterI* writer) const;
     void writeTopKernelTransferSummary(
@@ -138,23 +143,32 @@ namespace xdp {
   private:
 	void writeBufferStat(ProfileWriterI* writer, const std::string transferType,
 	    const BufferStats &bufferStat, double maxTransferRateMBps) const;
+    // CU stats extrapolated by the device trace sampling ratio
+    TimeStats getComputeUnitStats(uint32_t cuId) const;
 
   private:
     BufferStats DeviceBufferReadStat;
     BufferStats DeviceBufferWriteStat;
     BufferStats DeviceKernelStat;
+    double DeviceTraceSampleRatio = 1.0;
+    // CU stats reported by accelerator monitor counters are exact and
+    // are not extrapolated when device trace is sampled
+    std::set<uint32_t> CounterComputeUnitStats;
     std::map<RTUtil::e_profile_command_kind, BufferStats> BufferTransferStats;
     std::map<std::string, double> DeviceCUStartTimes;
     std::map<std::string, double> DeviceStartTimes;
     std::map<std::string, double> DeviceEndTimes;
 
-    // For every API function called in every thread, keep track
-    //  of the start and stop time.
-    std::map<std::pair<std::string, std::thread::id>,
-             std::vector<std::pair<double, double>>> CallCount;
+    // API calls are consolidated as they end.  Only the start time of the
+    //  call in flight for every (function, thread) is kept, so memory does
+    //  not grow with the number of calls.
+    StringTable FunctionNames;
+    std::vector<TimeStats> FunctionCallStats;
+    std::vector<LatencyHistogram> FunctionCallLatency;
+    std::map<std::pair<uint32_t, std::thread::id>, double> FunctionCallStarts;
 
-    std::map<std::string, TimeStats> KernelExecutionStats;
-    std::map<std::string, TimeStats> ComputeUnitExecutionStats;
+    StatsTable<TimeStats> KernelExecutionStats;
+    StatsTable<TimeStats> ComputeUnitExecutionStats;
     std::map<std::string, BufferStats> DeviceKernelReadSummaryStats;
     std::map<std::string, BufferStats> DeviceKernelWriteSummaryStats;
     TimeTraceSortedTopUsage<KernelTrace> TopKernelTimes;
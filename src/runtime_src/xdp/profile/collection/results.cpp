@@ -60,6 +60,59 @@ namespace xdp {
     log(size, duration);
   }
 
+  BufferStats BufferStats::scaled(double factor) const {
+    BufferStats result(*this);
+    result.Count = static_cast<size_t>(Count * factor + 0.5);
+    result.TotalSize = static_cast<uint64_t>(TotalSize * factor + 0.5);
+    result.TotalTime = TotalTime * factor;
+    return result;
+  }
+
+  //
+  // LatencyHistogram
+  //
+
+  void LatencyHistogram::log(double durationMsec) {
+    uint64_t ns = (durationMsec > 0.0) ? static_cast<uint64_t>(durationMsec * 1.0e6) : 0;
+    size_t bucket = 0;
+    if (ns < SubBuckets) {
+      bucket = static_cast<size_t>(ns);
+    }
+    else {
+      unsigned int msb = 0;
+      for (uint64_t v = ns >> 1; v; v >>= 1)
+        ++msb;
+      unsigned int shift = msb - SubBucketBits;
+      if (shift > MaxShift)
+        bucket = NumBuckets - 1;
+      else
+        bucket = (shift + 1) * SubBuckets + ((ns >> shift) & (SubBuckets - 1));
+    }
+    Buckets[bucket]++;
+    Count++;
+  }
+
+  double LatencyHistogram::getPercentile(double pct) const {
+    if (Count == 0)
+      return 0.0;
+    uint64_t target = static_cast<uint64_t>((pct / 100.0) * Count + 0.5);
+    if (target == 0)
+      target = 1;
+    uint64_t seen = 0;
+    for (size_t b = 0; b < NumBuckets; ++b) {
+      seen += Buckets[b];
+      if (seen < target)
+        continue;
+      // Report the middle of the bucket
+      if (b < SubBuckets)
+        return b / 1.0e6;
+      unsigned int shift = static_cast<unsigned int>(b / SubBuckets) - 1;
+      uint64_t low = (static_cast<uint64_t>(SubBuckets) + (b % SubBuckets)) << shift;
+      return (low + ((1ULL << shift) / 2)) / 1.0e6;
+    }
+    return 0.0;
+  }
+
   //
   // TimeStats
   //
@@ -101,6 +154,13 @@ namespace xdp {
     Flags = flags;
   }
 
+  TimeStats TimeStats::scaled(double factor) const {
+    TimeStats result(*this);
+    result.TotalTime = TotalTime * factor;
+    result.NoOfCalls = static_cast<uint32_t>(NoOfCalls * factor + 0.5);
+    return result;
+  }
+
   //
   // Kernel Trace
   //
@@ -18,8 +18,11 @@
 #define __XDP_COLLECTION_RESULTS_H
 
 #include <limits>
+#include <algorithm>
 #include <cstdint>
+#include <array>
 #include <map>
+#include <unordered_map>
 #include <list>
 #include <vector>
 #include <string>
@@ -86,6 +89,10 @@ namespace xdp {
     inline void setClockFreqMhz(double clockFreqMhz) { ClockFreqMhz = clockFreqMhz; }
     inline void setDeviceName(std::string& deviceName) { DeviceName = deviceName; }
 
+    // Estimate totals when only a fraction of events was observed
+    // (averages, min and max are kept as observed)
+    BufferStats scaled(double factor) const;
+
   private:
     size_t Count;
     size_t Min;
@@ -127,6 +134,9 @@ namespace xdp {
     void logStats(double totalTimeStat, double avgTimeStat, double maxTimeStat,
                   double minTimeStat, uint32_t totalCalls, uint32_t clockFreqMhz,
                    uint32_t flags, uint64_t metadata);
+    // Estimate totals when only a fraction of executions was observed
+    // (averages, min and max are kept as observed)
+    TimeStats scaled(double factor) const;
     inline double getTotalTime() const { return TotalTime; }
     inline double getAveTime() const { return AveTime; }
     inline double getMaxTime() const { return MaxTime; }
@@ -148,6 +158,84 @@ namespace xdp {
     uint64_t StatMetadata;
   };
 
+  // Fixed size latency histogram (HDR style)
+  // Durations are bucketed in ns by power of two with SubBuckets linear
+  // sub-buckets each, so memory is constant no matter how many calls are
+  // logged and percentiles are within 1/SubBuckets of the true value.
+  // Values at or above 2^(MaxShift+SubBucketBits+1) ns (~37 min) land in
+  // the last bucket.
+  class LatencyHistogram {
+  public:
+    static const unsigned int SubBucketBits = 3;
+    static const unsigned int SubBuckets = 1 << SubBucketBits;
+    static const unsigned int MaxShift = 38;
+    static const unsigned int NumBuckets = (MaxShift + 2) * SubBuckets;
+
+    LatencyHistogram() : Count( 0 ) { Buckets.fill(0); }
+  public:
+    void log(double durationMsec);
+    inline uint64_t getCount() const { return Count; }
+    // pct in [0,100], result in ms
+    double getPercentile(double pct) const;
+  private:
+    std::array<uint64_t, NumBuckets> Buckets;
+    uint64_t Count;
+  };
+
+  // Maps names to dense integer ids so per-call bookkeeping can use
+  // vectors indexed by id instead of string keyed maps
+  class StringTable {
+  public:
+    uint32_t intern(const std::string& name)
+    {
+      auto itr = Ids.find(name);
+      if (itr != Ids.end())
+        return itr->second;
+      uint32_t id = static_cast<uint32_t>(Names.size());
+      Names.push_back(name);
+      Ids.emplace(name, id);
+      return id;
+    }
+    inline const std::string& getName(uint32_t id) const { return Names[id]; }
+    inline size_t size() const { return Names.size(); }
+  private:
+    std::unordered_map<std::string, uint32_t> Ids;
+    std::vector<std::string> Names;
+  };
+
+  // Stats keyed by an interned name: one hash lookup per logged event and
+  // the stats themselves in a dense vector.  getSortedIds() gives the
+  // name order the summary tables are written in.
+  template <typename T>
+  class StatsTable {
+  public:
+    uint32_t intern(const std::string& name)
+    {
+      uint32_t id = Names.intern(name);
+      if (id >= Stats.size())
+        Stats.resize(id + 1);
+      return id;
+    }
+    inline T& operator[](const std::string& name) { return Stats[intern(name)]; }
+    inline T& get(uint32_t id) { return Stats[id]; }
+    inline const T& get(uint32_t id) const { return Stats[id]; }
+    inline const std::string& getName(uint32_t id) const { return Names.getName(id); }
+    inline size_t size() const { return Stats.size(); }
+    std::vector<uint32_t> getSortedIds() const
+    {
+      std::vector<uint32_t> ids(Stats.size());
+      for (uint32_t id = 0; id < ids.size(); ++id)
+        ids[id] = id;
+      std::sort(ids.begin(), ids.end(), [this](uint32_t A, uint32_t B) {
+        return Names.getName(A) < Names.getName(B);
+      });
+      return ids;
+    }
+  private:
+    StringTable Names;
+    std::vector<T> Stats;
+  };
+
   // Class to store time trace of kernel execution, buffer read, or buffer write
   // Timestamp is in double precision value of unit ms
   class TimeTrace {
@@ -191,6 +191,7 @@ namespace xdp {
   // Record wall-clock time points for start and end of profiling. Used to get an approximate total host time
   void RTProfile::setProfileStartTime(std::chrono::steady_clock::time_point t) { mProfileCounters->setProfileStartTime(t); }
   void RTProfile::setProfileEndTime(std::chrono::steady_clock::time_point t)   { mProfileCounters->setProfileEndTime(t); }
+  void RTProfile::setDeviceTraceSampleRatio(double ratio) { mProfileCounters->setDeviceTraceSampleRatio(ratio); }
 
   // ***************************************************************************
   // Profile & Trace Writers
@@ -239,6 +240,15 @@ namespace xdp {
     mWriter->writeProfileSummary(this);
   }
 
+  void RTProfile::writeProfileSummarySnapshot(ProfileWriterI* writer) {
+    if (!isApplicationProfileOn())
+      return;
+
+    // Hold off host and device counter logging while the summary is read
+    std::lock_guard<std::mutex> lock(mLogger->getLogMutex());
+    writer->writeSummary(this);
+  }
+
   // ***************************************************************************
   // Names & Strings
   // ***************************************************************************
@@ -315,6 +325,8 @@ namespace xdp {
   void RTProfile::logDeviceCounters(const std::string& deviceName, const std::string& binaryName, uint32_t programId,
       xclPerfMonType type, xclCounterResults& counterResults, uint64_t timeNsec, bool firstReadAfterProgram)
   {
+    // Counter results feed the CU summary stats, which a snapshot may be reading
+    std::lock_guard<std::mutex> lock(mLogger->getLogMutex());
     mWriter->logDeviceCounters(deviceName, binaryName, programId, type, counterResults, timeNsec, firstReadAfterProgram);
   }
 
@@ -322,6 +334,10 @@ namespace xdp {
   {
     mWriter->writeAPISummary(writer);
   }
+  void RTProfile::writeAPILatencySummary(ProfileWriterI* writer) const
+  {
+    mWriter->writeAPILatencySummary(writer);
+  }
   void RTProfile::writeKernelSummary(ProfileWriterI* writer) const
   {
     mWriter->writeKernelSummary(writer);
@@ -83,9 +83,13 @@ namespace xdp {
     // Record wall-clock time points for start and end of profiling. Used to get an approximate total host time
     void setProfileStartTime(std::chrono::steady_clock::time_point t);
     void setProfileEndTime(std::chrono::steady_clock::time_point t);
+    // Fraction of device activity captured by sampled device trace
+    void setDeviceTraceSampleRatio(double ratio);
 
   public:
     void writeProfileSummary();
+    // Write the summary tables so far while the application keeps running
+    void writeProfileSummarySnapshot(ProfileWriterI* writer);
     void addDeviceName(const std::string& deviceName) { mDeviceNames.push_back(deviceName); }
     std::string getDeviceNames(const std::string& sep) const;
     // Intentionally not a reference to the underlying container.
@@ -108,6 +112,7 @@ namespace xdp {
   public:
     // External access to writer
     void writeAPISummary(ProfileWriterI* writer) const;
+    void writeAPILatencySummary(ProfileWriterI* writer) const;
     void writeKernelSummary(ProfileWriterI* writer) const;
     void writeStallSummary(ProfileWriterI* writer) const;
     void writeKernelStreamSummary(ProfileWriterI* writer);
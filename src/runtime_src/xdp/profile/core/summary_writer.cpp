@@ -264,6 +264,11 @@ namespace xdp {
     mProfileCounters->writeAPISummary(writer);
   }
 
+  void SummaryWriter::writeAPILatencySummary(ProfileWriterI* writer) const
+  {
+    mProfileCounters->writeAPILatencySummary(writer);
+  }
+
   void SummaryWriter::writeKernelSummary(ProfileWriterI* writer) const
   {
     mProfileCounters->writeKernelSummary(writer);
@@ -56,6 +56,7 @@ namespace xdp {
 
     // Summaries of counts
     void writeAPISummary(ProfileWriterI* writer) const;
+    void writeAPILatencySummary(ProfileWriterI* writer) const;
     void writeKernelSummary(ProfileWriterI* writer) const;
     void writeStallSummary(ProfileWriterI* writer) const;
     void writeKernelStreamSummary(ProfileWriterI* writer);
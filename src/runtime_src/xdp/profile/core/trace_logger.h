@@ -108,6 +108,9 @@ namespace xdp {
     int getHostP2PTransfers() const { return mHostP2PTransfers;}
     std::string getCurrentBinaryName() const {return mCurrentBinaryName;}
     const std::set<std::thread::id>& getThreadIds() {return mThreadIdSet;}
+    // Also guards the summary tables: device counter logging and summary
+    // snapshots take it around every ProfileCounters update and read
+    std::mutex& getLogMutex() {return mLogMutex;}
 
   private:
     // helpers
@@ -0,0 +1,262 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "counter_sampler.h"
+#include "device_intf.h"
+#include "xcl_perfmon_parameters.h"
+
+#include <cstring>
+
+namespace xdp {
+
+namespace {
+
+// Difference of two reads of a counter that wraps at widthBits
+inline uint64_t
+counterDelta(uint64_t prev, uint64_t curr, unsigned int widthBits)
+{
+  uint64_t mask = (widthBits >= 64) ? ~0ULL : ((1ULL << widthBits) - 1);
+  return (curr - prev) & mask;
+}
+
+inline double
+percent(uint64_t cycles, double intervalCycles)
+{
+  if (intervalCycles <= 0.0)
+    return 0.0;
+  double pct = 100.0 * static_cast<double>(cycles) / intervalCycles;
+  return (pct > 100.0) ? 100.0 : pct;
+}
+
+inline size_t
+roundUpPow2(size_t value)
+{
+  size_t result = 1;
+  while (result < value)
+    result <<= 1;
+  return result;
+}
+
+}
+
+// ***************************************************************************
+// CounterSampleRing
+// ***************************************************************************
+
+CounterSampleRing::CounterSampleRing(size_t capacity)
+  : mSlots(roundUpPow2(capacity < 2 ? 2 : capacity))
+  , mMask(mSlots.size() - 1)
+{
+}
+
+bool CounterSampleRing::push(const sample& s)
+{
+  size_t head = mHead.load(std::memory_order_relaxed);
+  size_t tail = mTail.load(std::memory_order_acquire);
+  if (head - tail == mSlots.size()) {
+    mDropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  mSlots[head & mMask] = s;
+  mHead.store(head + 1, std::memory_order_release);
+  return true;
+}
+
+bool CounterSampleRing::pop(sample& s)
+{
+  size_t tail = mTail.load(std::memory_order_relaxed);
+  size_t head = mHead.load(std::memory_order_acquire);
+  if (tail == head)
+    return false;
+  s = mSlots[tail & mMask];
+  mTail.store(tail + 1, std::memory_order_release);
+  return true;
+}
+
+// ***************************************************************************
+// DeviceCounterSampler
+// ***************************************************************************
+
+DeviceCounterSampler::DeviceCounterSampler(DeviceIntf* dIntf,
+                                           const std::string& deviceName,
+                                           double deviceClockMHz,
+                                           uint32_t intervalMsec,
+                                           size_t ringCapacity)
+  : mDeviceIntf(dIntf)
+  , mDeviceName(deviceName)
+  , mDeviceClockMHz(deviceClockMHz)
+  , mInterval(intervalMsec ? intervalMsec : 1)
+  , mRing(ringCapacity)
+{
+}
+
+DeviceCounterSampler::~DeviceCounterSampler()
+{
+  stop();
+}
+
+void DeviceCounterSampler::start()
+{
+  if (!mDeviceIntf || mRunning.load())
+    return;
+
+  // Monitor names are fixed once debug_ip_layout is read
+  char name[128];
+  for (uint32_t i = 0; i < mDeviceIntf->getNumMonitors(XCL_PERF_MON_MEMORY); ++i) {
+    mDeviceIntf->getMonitorName(XCL_PERF_MON_MEMORY, i, name, 128);
+    mAimNames.emplace_back(name);
+    uint32_t props = mDeviceIntf->getMonitorProperties(XCL_PERF_MON_MEMORY, i);
+    mAimWidths.push_back((props & XAIM_64BIT_PROPERTY_MASK) ? 64 : 32);
+  }
+  for (uint32_t i = 0; i < mDeviceIntf->getNumMonitors(XCL_PERF_MON_ACCEL); ++i) {
+    mDeviceIntf->getMonitorName(XCL_PERF_MON_ACCEL, i, name, 128);
+    mAmNames.emplace_back(name);
+    uint32_t props = mDeviceIntf->getMonitorProperties(XCL_PERF_MON_ACCEL, i);
+    mAmWidths.push_back((props & XAM_64BIT_PROPERTY_MASK) ? 64 : 32);
+  }
+  for (uint32_t i = 0; i < mDeviceIntf->getNumMonitors(XCL_PERF_MON_STR); ++i) {
+    mDeviceIntf->getMonitorName(XCL_PERF_MON_STR, i, name, 128);
+    mAsmNames.emplace_back(name);
+  }
+
+  mOutput.open("device_counters_" + mDeviceName + ".csv", std::ios::out);
+  writeHeader();
+
+  mRunning = true;
+  mWriteThread = std::thread(&DeviceCounterSampler::writeLoop, this);
+  mSampleThread = std::thread(&DeviceCounterSampler::sampleLoop, this);
+}
+
+void DeviceCounterSampler::stop()
+{
+  if (!mRunning.exchange(false))
+    return;
+
+  if (mSampleThread.joinable())
+    mSampleThread.join();
+  if (mWriteThread.joinable())
+    mWriteThread.join();
+
+  // Anything pushed after the writer's last pass
+  drain();
+  mOutput.close();
+}
+
+void DeviceCounterSampler::sampleLoop()
+{
+  CounterSampleRing::sample s;
+  auto next = std::chrono::steady_clock::now();
+
+  while (mRunning.load()) {
+    mDeviceIntf->readCounters(XCL_PERF_MON_MEMORY, s.counters);
+    s.timestampNsec = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+    if (mRing.push(s))
+      ++mNumSamples;
+
+    // Fixed rate: a slow read shortens the next sleep instead of
+    // skewing every following sample
+    next += mInterval;
+    auto now = std::chrono::steady_clock::now();
+    if (next < now)
+      next = now;
+    std::this_thread::sleep_until(next);
+  }
+}
+
+void DeviceCounterSampler::writeLoop()
+{
+  // Wake up often enough that the ring never fills at the sample rate
+  auto period = mInterval * 4;
+  if (period > std::chrono::milliseconds(100))
+    period = std::chrono::milliseconds(100);
+
+  while (mRunning.load()) {
+    drain();
+    std::this_thread::sleep_for(period);
+  }
+}
+
+void DeviceCounterSampler::drain()
+{
+  while (mRing.pop(mCurrent)) {
+    if (!mHavePrevious) {
+      mStartNsec = mCurrent.timestampNsec;
+      mHavePrevious = true;
+    }
+    else {
+      writeDeltas(mPrevious, mCurrent);
+    }
+    std::memcpy(&mPrevious, &mCurrent, sizeof(CounterSampleRing::sample));
+  }
+  mOutput.flush();
+}
+
+void DeviceCounterSampler::writeHeader()
+{
+  mOutput << "timestamp_ms,interval_ms,monitor,slot,name,"
+          << "read_bytes_per_sec,write_bytes_per_sec,read_tranx,write_tranx,"
+          << "executions,busy_pct,stall_pct,starve_pct" << std::endl;
+}
+
+void DeviceCounterSampler::writeDeltas(const CounterSampleRing::sample& prev,
+                                       const CounterSampleRing::sample& curr)
+{
+  double intervalSec = (curr.timestampNsec - prev.timestampNsec) / 1.0e9;
+  if (intervalSec <= 0.0)
+    return;
+  double intervalCycles = intervalSec * mDeviceClockMHz * 1.0e6;
+  double timestampMsec = (curr.timestampNsec - mStartNsec) / 1.0e6;
+  double intervalMsec = intervalSec * 1.0e3;
+
+  const xclCounterResults& p = prev.counters;
+  const xclCounterResults& c = curr.counters;
+
+  for (size_t s = 0; s < mAimNames.size(); ++s) {
+    unsigned int w = mAimWidths[s];
+    uint64_t rd = counterDelta(p.ReadBytes[s], c.ReadBytes[s], w);
+    uint64_t wr = counterDelta(p.WriteBytes[s], c.WriteBytes[s], w);
+    mOutput << timestampMsec << "," << intervalMsec << ",AIM," << s << "," << mAimNames[s] << ","
+            << (rd / intervalSec) << "," << (wr / intervalSec) << ","
+            << counterDelta(p.ReadTranx[s], c.ReadTranx[s], w) << ","
+            << counterDelta(p.WriteTranx[s], c.WriteTranx[s], w) << ",,,,\n";
+  }
+
+  // AM stall counters have no upper words; ASM counters are always 64 bit
+  for (size_t s = 0; s < mAmNames.size(); ++s) {
+    unsigned int w = mAmWidths[s];
+    uint64_t busy = counterDelta(p.CuBusyCycles[s], c.CuBusyCycles[s], w);
+    uint64_t stall = counterDelta(p.CuStallIntCycles[s], c.CuStallIntCycles[s], 32)
+                   + counterDelta(p.CuStallStrCycles[s], c.CuStallStrCycles[s], 32)
+                   + counterDelta(p.CuStallExtCycles[s], c.CuStallExtCycles[s], 32);
+    mOutput << timestampMsec << "," << intervalMsec << ",AM," << s << "," << mAmNames[s] << ",,,,,"
+            << counterDelta(p.CuExecCount[s], c.CuExecCount[s], w) << ","
+            << percent(busy, intervalCycles) << ","
+            << percent(stall, intervalCycles) << ",\n";
+  }
+
+  for (size_t s = 0; s < mAsmNames.size(); ++s) {
+    uint64_t bytes = counterDelta(p.StrDataBytes[s], c.StrDataBytes[s], 64);
+    mOutput << timestampMsec << "," << intervalMsec << ",ASM," << s << "," << mAsmNames[s] << ","
+            << (bytes / intervalSec) << ",,"
+            << counterDelta(p.StrNumTranx[s], c.StrNumTranx[s], 64) << ",,,"
+            << percent(counterDelta(p.StrBusyCycles[s], c.StrBusyCycles[s], 64), intervalCycles) << ","
+            << percent(counterDelta(p.StrStallCycles[s], c.StrStallCycles[s], 64), intervalCycles) << ","
+            << percent(counterDelta(p.StrStarveCycles[s], c.StrStarveCycles[s], 64), intervalCycles) << "\n";
+  }
+}
+
+} //  xdp
@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2019 Xilinx Inc - All rights reserved
+ * Xilinx Debug & Profile (XDP) APIs
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef XDP_PROFILE_DEVICE_COUNTER_SAMPLER_H
+#define XDP_PROFILE_DEVICE_COUNTER_SAMPLER_H
+
+#include "xclperf.h"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace xdp {
+
+class DeviceIntf;
+
+/**
+ * Single producer / single consumer ring of counter snapshots
+ *
+ * The sampling thread is the only producer and the writer thread is
+ * the only consumer, so head and tail are each written by exactly one
+ * thread and no lock is needed.  Slots are allocated once up front;
+ * a full ring drops the new sample rather than blocking the sampler.
+ */
+class CounterSampleRing {
+public:
+  struct sample {
+    uint64_t timestampNsec;
+    xclCounterResults counters;
+  };
+
+  explicit CounterSampleRing(size_t capacity);
+
+  bool push(const sample& s);
+  bool pop(sample& s);
+  uint64_t getDropped() const { return mDropped.load(); }
+
+private:
+  std::vector<sample> mSlots;
+  size_t mMask;
+  std::atomic<size_t> mHead {0};
+  std::atomic<size_t> mTail {0};
+  std::atomic<uint64_t> mDropped {0};
+};
+
+/**
+ * Periodic sampler of all AIM/AM/ASM counters on one device
+ *
+ * Description:
+ *
+ * A sampling thread snapshots every monitor counter through
+ * DeviceIntf::readCounters at a fixed interval and pushes the
+ * snapshot into a CounterSampleRing.  A separate writer thread drains
+ * the ring, computes per-interval deltas and appends them to
+ * device_counters_<device>.csv as a time series:
+ *   AIM : read/write bytes per second and transactions per slot
+ *   AM  : executions and CU busy percentage per slot
+ *   ASM : data bytes per second, busy/stall/starve percentage per slot
+ *
+ * Note:
+ *
+ * Only DeviceIntf is used to access the device, so the sampler works
+ * with any xdp::Device backing (xrt::device or HAL handle, including
+ * the HAL emulation devices).
+ */
+class DeviceCounterSampler {
+public:
+  DeviceCounterSampler(DeviceIntf* dIntf /** < [in] initialized device interface */,
+                       const std::string& deviceName,
+                       double deviceClockMHz,
+                       uint32_t intervalMsec,
+                       size_t ringCapacity = 256);
+  ~DeviceCounterSampler();
+
+  void start();
+  void stop();
+  bool isRunning() const { return mRunning.load(); }
+
+  uint64_t getNumSamples() const { return mNumSamples.load(); }
+  uint64_t getNumDropped() const { return mRing.getDropped(); }
+
+private:
+  void sampleLoop();
+  void writeLoop();
+  void drain();
+  void writeHeader();
+  void writeDeltas(const CounterSampleRing::sample& prev,
+                   const CounterSampleRing::sample& curr);
+
+private:
+  DeviceIntf* mDeviceIntf;
+  std::string mDeviceName;
+  double mDeviceClockMHz;
+  std::chrono::milliseconds mInterval;
+
+  CounterSampleRing mRing;
+  std::atomic<bool> mRunning {false};
+  std::atomic<uint64_t> mNumSamples {0};
+  std::thread mSampleThread;
+  std::thread mWriteThread;
+
+  // Writer thread state
+  std::ofstream mOutput;
+  bool mHavePrevious = false;
+  CounterSampleRing::sample mPrevious;
+  CounterSampleRing::sample mCurrent;
+  uint64_t mStartNsec = 0;
+  std::vector<std::string> mAimNames;
+  std::vector<std::string> mAmNames;
+  std::vector<std::string> mAsmNames;
+  // Counter width in bits per AIM/AM slot, from the 64 bit property
+  std::vector<unsigned int> mAimWidths;
+  std::vector<unsigned int> mAmWidths;
+};
+
+} //  xdp
+
+#endif
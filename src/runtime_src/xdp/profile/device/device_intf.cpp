@@ -24,6 +24,7 @@
 #include <cstdio>
 #include <cstring>
 //#include <algorithm>
+#include <mutex>
 #include <thread>
 #include <vector>
 //#include <time.h>
@@ -240,6 +241,8 @@ DeviceIntf::~DeviceIntf()
       << ", Read device counters..." << std::endl;
     }
 
+    std::lock_guard<std::mutex> lock(mCounterLock);
+
     // Initialize all values in struct to 0
     memset(&counterResults, 0, sizeof(xclCounterResults));
 
@@ -286,6 +289,7 @@ DeviceIntf::~DeviceIntf()
                 << ", Start device tracing..." << std::endl;
     }
     size_t size = 0;
+    mTraceOption = startTrigger;
 
     // This just writes to trace control register
     // Axi Interface Mons
@@ -323,6 +327,26 @@ DeviceIntf::~DeviceIntf()
 
     return fifoCtrl->reset();
   }
+  // Open/close trace output of all monitors (used for sampled trace)
+  size_t DeviceIntf::gateTrace(bool enable)
+  {
+    if (!mIsDeviceProfiling)
+      return 0;
+
+    uint32_t traceOption = enable ? mTraceOption : 0;
+    size_t size = 0;
+    for(auto mon : aimList) {
+        size += mon->triggerTrace(traceOption);
+    }
+    for(auto mon : amList) {
+        size += mon->triggerTrace(traceOption);
+    }
+    for(auto mon : asmList) {
+        size += mon->triggerTrace(traceOption);
+    }
+    return size;
+  }
+
 
   // Get trace word count
   uint32_t DeviceIntf::getTraceCount(xclPerfMonType type) {
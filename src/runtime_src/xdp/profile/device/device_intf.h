@@ -37,6 +37,7 @@
 #include <list>
 #include <map>
 #include <cassert>
+#include <mutex>
 #include <vector>
 
 namespace xdp {
@@ -44,6 +45,11 @@ namespace xdp {
   class DeviceIntf {
   public:
     DeviceIntf() {}
+    // Owns the monitors and the counter lock of one device
+    DeviceIntf(const DeviceIntf&) = delete;
+    DeviceIntf& operator=(const DeviceIntf&) = delete;
+    DeviceIntf(DeviceIntf&&) = delete;
+    DeviceIntf& operator=(DeviceIntf&&) = delete;
     ~DeviceIntf();
 
   public:
@@ -82,6 +88,8 @@ namespace xdp {
     size_t startTrace(xclPerfMonType type, uint32_t startTrigger);
     size_t stopTrace(xclPerfMonType type);
     size_t readTrace(xclPerfMonType type, xclTraceResultsVector& traceVector);
+    // Turn monitor trace output on/off without resetting FIFO or clock training
+    size_t gateTrace(bool enable);
 
     /** Trace S2MM Management
      */
@@ -104,6 +112,13 @@ namespace xdp {
     // Depending on OpenCL or HAL flow, "mDevice" is populated with xrt::device handle or HAL handle
     xdp::Device* mDevice = nullptr;
 
+    // Counter reads latch the sample registers, so callback reads and
+    // the periodic counter sampler on this device must not interleave
+    std::mutex mCounterLock;
+
+    // Trace option last passed to startTrace; restored when trace gate opens
+    uint32_t mTraceOption = 0;
+
     std::vector<AIM*> aimList;
     std::vector<AM*>  amList;
     std::vector<ASM*> asmList;
@@ -86,6 +86,7 @@ namespace xdp {
     // Start counters
     if (deviceCountersProfilingOn()) {
       startCounters();
+      startCounterSampling();
     }
 
     // Start trace
@@ -119,9 +120,18 @@ namespace xdp {
       return;
     }
 
+    // Stop periodic sampling before the final read
+    stopCounterSampling();
+
     // Log Counter Data
     logDeviceCounters(true, true, true);  // reads and logs device counters for all monitors in all flows
 
+    // Close sampled trace before the final flush and record how much was seen
+    if (TraceSampler) {
+      TraceSampler->stop_sampling();
+      getProfileManager()->setDeviceTraceSampleRatio(TraceSampler->getSampleRatio());
+    }
+
     // With new XDP flow, HW Emu should be similar to Device flow. So, multiple calls to trace/counters should not be needed.
     // But needed for older flow
     // Log Trace Data
@@ -171,7 +181,7 @@ namespace xdp {
       DeviceIntf* dInt = nullptr;
       auto xdevice = device->get_xrt_device();
       if ((Plugin->getFlowMode() == xdp::RTUtil::DEVICE) || (Plugin->getFlowMode() == xdp::RTUtil::HW_EM && Plugin->getSystemDPAEmulation())) {
-        dInt = &(itr->second.mDeviceIntf);
+        dInt = itr->second.mDeviceIntf.get();
         dInt->setDevice(new xdp::XrtDevice(xdevice));
         dInt->readDebugIPlayout();
       }       
@@ -224,6 +234,41 @@ namespace xdp {
     } // for all active devices
   }
 
+  // Periodic time series of all monitor counters (Debug.device_counter_sampling)
+  void OCLProfiler::startCounterSampling()
+  {
+    stopCounterSampling();
+    unsigned int intervalMsec = xrt::config::get_device_counter_sampling();
+    if (intervalMsec == 0)
+      return;
+    if (!(Plugin->getFlowMode() == xdp::RTUtil::DEVICE
+          || (Plugin->getFlowMode() == xdp::RTUtil::HW_EM && Plugin->getSystemDPAEmulation())))
+      return;
+
+    auto platform = getclPlatformID();
+    for (auto device : platform->get_device_range()) {
+      if(!device->is_active()) {
+        continue;
+      }
+      auto itr = DeviceData.find(device);
+      if (itr==DeviceData.end()) {
+        continue;
+      }
+      double deviceClockMHz = device->get_xrt_device()->getDeviceClock().get();
+      auto sampler = std::make_unique<DeviceCounterSampler>(itr->second.mDeviceIntf.get(),
+          device->get_unique_name(), deviceClockMHz, intervalMsec);
+      sampler->start();
+      CounterSamplerList.push_back(std::move(sampler));
+    }
+  }
+
+  void OCLProfiler::stopCounterSampling()
+  {
+    for (auto& sampler : CounterSamplerList)
+      sampler->stop();
+    CounterSamplerList.clear();
+  }
+
   void OCLProfiler::startTrace()
   {
     auto platform = getclPlatformID();
@@ -241,7 +286,7 @@ namespace xdp {
       auto xdevice = device->get_xrt_device();
       DeviceIntf* dInt = nullptr;
       if((Plugin->getFlowMode() == xdp::RTUtil::DEVICE) || (Plugin->getFlowMode() == xdp::RTUtil::HW_EM && Plugin->getSystemDPAEmulation())) {
-        dInt = &(itr->second.mDeviceIntf);
+        dInt = itr->second.mDeviceIntf.get();
         dInt->setDevice(new xdp::XrtDevice(xdevice));
         dInt->readDebugIPlayout();
       }
@@ -268,6 +313,8 @@ namespace xdp {
       if(dInt) {
         // Configure monitor IP and FIFO if present
         dInt->startTrace(XCL_PERF_MON_MEMORY, traceOption);
+        if (TraceSampler)
+          TraceSampler->add_device(dInt);
         // Configure DMA if present
         if (dInt->hasTs2mm()) {
           info->ts2mm_en = allocateDeviceDDRBufferForTrace(dInt, xdevice);
@@ -296,6 +343,9 @@ namespace xdp {
 
     if(Plugin->getFlowMode() == xdp::RTUtil::DEVICE)
       Plugin->setTraceMemory(trace_memory);
+
+    if (TraceSampler)
+      TraceSampler->start_sampling();
   }
 
   void OCLProfiler::endTrace()
@@ -313,7 +363,7 @@ namespace xdp {
       auto xdevice = device->get_xrt_device();
       xdp::xoclp::platform::device::data* info = &(itr->second);
       if (info->ts2mm_en) {
-        auto dInt  = &(info->mDeviceIntf);
+        auto dInt  = info->mDeviceIntf.get();
         clearDeviceDDRBufferForTrace(dInt, xdevice);
         info->ts2mm_en = false;
       }
@@ -394,6 +444,15 @@ namespace xdp {
     ProfileMgr->setTransferTrace(data_transfer_trace);
     ProfileMgr->setStallTrace(stall_trace);
 
+    // Sampled device trace (window or 1-in-N kernels)
+    if (deviceTraceProfilingOn()) {
+      auto sampler = std::make_unique<OclTraceSampler>(xrt::config::get_trace_sampling(),
+          xrt::config::get_trace_sampling_window(), xrt::config::get_trace_sampling_period(),
+          xrt::config::get_trace_sampling_kernels());
+      if (sampler->isEnabled())
+        TraceSampler = std::move(sampler);
+    }
+
     // Enable profile summary if profile is on
     std::string profileFile("profile_summary");
     ProfileMgr->turnOnFile(xdp::RTUtil::FILE_SUMMARY);
@@ -418,6 +477,13 @@ namespace xdp {
     TraceWriters.push_back(csvTraceWriter);
     ProfileMgr->attach(csvTraceWriter);
 
+    // Same timeline in Chrome trace event format for Perfetto
+    if (xrt::config::get_chrome_trace()) {
+      xdp::ChromeTraceWriter* chromeTraceWriter = new xdp::ChromeTraceWriter(timelineFile, Plugin.get());
+      TraceWriters.push_back(chromeTraceWriter);
+      ProfileMgr->attach(chromeTraceWriter);
+    }
+
 #if 0
     // Not Used
     if (std::getenv("SDX_NEW_PROFILE")) {
@@ -432,11 +498,68 @@ namespace xdp {
     // Add functions to callback for profiling kernel/CU scheduling
     xocl::add_command_start_callback(xoclp::get_cu_start);
     xocl::add_command_done_callback(xoclp::get_cu_done);
+
+    // Long running applications can dump the summary while running
+    unsigned int snapshotInterval = xrt::config::get_summary_snapshot_interval();
+    if (snapshotInterval > 0) {
+      for (auto& w: ProfileWriters)
+        w->enableLatencyTable();
+      startSummarySnapshots(snapshotInterval);
+    }
+  }
+
+  void OCLProfiler::startSummarySnapshots(unsigned int intervalSec)
+  {
+    std::lock_guard<std::mutex> lock(SnapshotLock);
+    SnapshotRunning = true;
+    SnapshotThread = std::thread([this, intervalSec] {
+      std::unique_lock<std::mutex> lock(SnapshotLock);
+      while (SnapshotRunning) {
+        if (SnapshotCond.wait_for(lock, std::chrono::seconds(intervalSec),
+                                  [this] { return !SnapshotRunning; }))
+          break;
+        lock.unlock();
+        writeSummarySnapshot();
+        lock.lock();
+      }
+    });
+  }
+
+  void OCLProfiler::stopSummarySnapshots()
+  {
+    {
+      std::lock_guard<std::mutex> lock(SnapshotLock);
+      SnapshotRunning = false;
+    }
+    SnapshotCond.notify_all();
+    if (SnapshotThread.joinable())
+      SnapshotThread.join();
+  }
+
+  // Write the summary so far, then move it into place so a crash never
+  // leaves a partially written snapshot behind
+  void OCLProfiler::writeSummarySnapshot()
+  {
+    std::string partFile("profile_summary_snapshot.part");
+    std::string snapshotFile;
+    try {
+      xdp::CSVProfileWriter writer(Plugin.get(), "Xilinx", partFile);
+      writer.enableLatencyTable();
+      ProfileMgr->writeProfileSummarySnapshot(&writer);
+      snapshotFile = writer.getFileName();
+    }
+    catch (const std::exception& ex) {
+      xrt::message::send(xrt::message::severity_level::XRT_WARNING,
+          std::string("Unable to write profile summary snapshot: ") + ex.what());
+      return;
+    }
+    std::rename(snapshotFile.c_str(), "profile_summary_snapshot.csv");
   }
 
   // Wrap up profiling by writing files
   void OCLProfiler::endProfiling()
   {
+    stopSummarySnapshots();
     ProfileMgr->setProfileEndTime(std::chrono::steady_clock::now());
 
     configureWriters();
@@ -472,7 +595,7 @@ namespace xdp {
           if (itr==DeviceData.end()) {
             itr = DeviceData.emplace(device,xdp::xoclp::platform::device::data()).first;
           }
-          DeviceIntf* dInt = &(itr->second.mDeviceIntf);
+          DeviceIntf* dInt = itr->second.mDeviceIntf.get();
           // Assumption : debug_ip_layout has been read
   
           numStallSlots  += dInt->getNumMonitors(XCL_PERF_MON_STALL);
@@ -532,7 +655,7 @@ namespace xdp {
       xdp::xoclp::platform::device::data* info = &(itr->second);
       DeviceIntf* dInt = nullptr;
       if ((Plugin->getFlowMode() == xdp::RTUtil::DEVICE) || (Plugin->getFlowMode() == xdp::RTUtil::HW_EM && Plugin->getSystemDPAEmulation())) {
-        dInt = &(itr->second.mDeviceIntf);
+        dInt = itr->second.mDeviceIntf.get();
         dInt->setDevice(new xdp::XrtDevice(xdevice));
       }
 
@@ -622,7 +745,7 @@ namespace xdp {
       xdp::xoclp::platform::device::data* info = &(itr->second);
       DeviceIntf* dInt = nullptr;
       if ((Plugin->getFlowMode() == xdp::RTUtil::DEVICE) || (Plugin->getFlowMode() == xdp::RTUtil::HW_EM && Plugin->getSystemDPAEmulation())) {
-        dInt = &(itr->second.mDeviceIntf);
+        dInt = itr->second.mDeviceIntf.get();
         dInt->setDevice(new xdp::XrtDevice(xdevice));
       }
 
@@ -872,6 +995,10 @@ namespace xdp {
   void OCLProfiler::reset()
   {
     // resetDeviceProfilingFlag();
+    // Samplers hold pointers into DeviceData
+    stopCounterSampling();
+    if (TraceSampler)
+      TraceSampler->stop_sampling();
     DeviceData.clear();  
   }
 
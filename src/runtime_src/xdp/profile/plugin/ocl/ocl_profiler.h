@@ -20,12 +20,18 @@
 #include <CL/opencl.h>
 #include <string>
 #include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include "xocl_plugin.h"
 #include "xocl_profile.h"
 #include "xdp/profile/core/rt_util.h"
 #include "xdp/profile/writer/csv_trace.h"
+#include "xdp/profile/writer/chrome_trace.h"
 #include "xdp/profile/plugin/ocl/ocl_power_profile.h"
+#include "xdp/profile/device/counter_sampler.h"
+#include "xdp/profile/plugin/ocl/ocl_trace_sampler.h"
 
 namespace xdp {
 
@@ -57,6 +63,7 @@ namespace xdp {
     inline xdp::XoclPlugin* getPlugin() { return Plugin.get(); }
     inline xdp::RTProfile* getProfileManager() { return ProfileMgr.get(); }
     inline xocl::platform* getclPlatformID() { return Platform.get(); }
+    inline xdp::OclTraceSampler* getTraceSampler() { return TraceSampler.get(); }
 
   // Device metadata
   public:
@@ -81,8 +88,13 @@ namespace xdp {
     void startProfiling();
     void endProfiling();
     void configureWriters();
+    void startSummarySnapshots(unsigned int intervalSec);
+    void stopSummarySnapshots();
+    void writeSummarySnapshot();
     void logDeviceCounters(bool firstReadAfterProgram, bool forceReadCounters, bool logAllMonitors, xclPerfMonType type = XCL_PERF_MON_MEMORY);
     void startCounters();
+    void startCounterSampling();
+    void stopCounterSampling();
     void startTrace();
     void endTrace();
     int  logTrace(xclPerfMonType type, bool forceRead, bool logAllMonitors = true);
@@ -115,6 +127,14 @@ namespace xdp {
     std::shared_ptr<XoclPlugin> Plugin;
     std::unique_ptr<RTProfile> ProfileMgr;
     std::vector<std::unique_ptr<OclPowerProfile>> PowerProfileList;
+    std::vector<std::unique_ptr<DeviceCounterSampler>> CounterSamplerList;
+    std::unique_ptr<OclTraceSampler> TraceSampler;
+
+    // Periodic profile summary snapshots
+    std::thread SnapshotThread;
+    std::mutex SnapshotLock;
+    std::condition_variable SnapshotCond;
+    bool SnapshotRunning = false;
 
     // Buffer on Device DDR for Trace
     uint64_t mDDRBufferSz = 0;
@@ -0,0 +1,141 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "xdp/profile/plugin/ocl/ocl_trace_sampler.h"
+#include "xdp/profile/device/device_intf.h"
+
+namespace xdp {
+
+OclTraceSampler::OclTraceSampler(const std::string& mode_str, uint32_t windowMsec,
+                                 uint32_t periodMsec, uint32_t kernelRate)
+    : mode(TraceSamplingMode::OFF)
+    , window(windowMsec)
+    , period(periodMsec)
+    , kernel_rate(kernelRate ? kernelRate : 1)
+{
+    if (mode_str == "window" && windowMsec > 0 && periodMsec > windowMsec)
+        mode = TraceSamplingMode::WINDOW;
+    else if (mode_str == "kernel" && kernelRate > 1)
+        mode = TraceSamplingMode::KERNEL;
+}
+
+OclTraceSampler::~OclTraceSampler() {
+    stop_sampling();
+}
+
+void OclTraceSampler::add_device(DeviceIntf* dIntf) {
+    std::lock_guard<std::mutex> lock(sampler_lock);
+    devices.push_back(dIntf);
+}
+
+void OclTraceSampler::start_sampling() {
+    std::lock_guard<std::mutex> lock(sampler_lock);
+    if (!isEnabled() || running || devices.empty())
+        return;
+
+    running = true;
+    // Trace is only let through inside a sample
+    gate_open = true;
+    set_gate(false);
+    sampling_start = std::chrono::steady_clock::now();
+    if (mode == TraceSamplingMode::WINDOW)
+        window_thread = std::thread(&OclTraceSampler::window_loop, this);
+}
+
+void OclTraceSampler::stop_sampling() {
+    {
+        std::lock_guard<std::mutex> lock(sampler_lock);
+        if (!running)
+            return;
+        running = false;
+    }
+    sampler_cv.notify_all();
+    if (window_thread.joinable())
+        window_thread.join();
+
+    std::lock_guard<std::mutex> lock(sampler_lock);
+    total_time += std::chrono::steady_clock::now() - sampling_start;
+    sampled_events.clear();
+    // Device interfaces are owned by the profiler and may go away
+    devices.clear();
+}
+
+void OclTraceSampler::kernel_submitted(uint64_t eventId) {
+    if (mode != TraceSamplingMode::KERNEL)
+        return;
+
+    std::lock_guard<std::mutex> lock(sampler_lock);
+    if (!running)
+        return;
+    if ((kernels_total++ % kernel_rate) != 0)
+        return;
+
+    ++kernels_sampled;
+    sampled_events.insert(eventId);
+    set_gate(true);
+}
+
+void OclTraceSampler::kernel_completed(uint64_t eventId) {
+    if (mode != TraceSamplingMode::KERNEL)
+        return;
+
+    std::lock_guard<std::mutex> lock(sampler_lock);
+    if (sampled_events.erase(eventId) && sampled_events.empty() && running)
+        set_gate(false);
+}
+
+double OclTraceSampler::getSampleRatio() {
+    std::lock_guard<std::mutex> lock(sampler_lock);
+    if (mode == TraceSamplingMode::WINDOW) {
+        auto total = total_time;
+        if (running)
+            total += std::chrono::steady_clock::now() - sampling_start;
+        if (total.count() <= 0 || sampled_time.count() <= 0)
+            return 1.0;
+        double ratio = static_cast<double>(sampled_time.count()) / total.count();
+        return (ratio > 1.0) ? 1.0 : ratio;
+    }
+    if (mode == TraceSamplingMode::KERNEL) {
+        if (kernels_total == 0 || kernels_sampled == 0)
+            return 1.0;
+        return static_cast<double>(kernels_sampled) / kernels_total;
+    }
+    return 1.0;
+}
+
+void OclTraceSampler::window_loop() {
+    std::unique_lock<std::mutex> lock(sampler_lock);
+    while (running) {
+        auto open_time = std::chrono::steady_clock::now();
+        set_gate(true);
+        sampler_cv.wait_for(lock, window, [this] { return !running; });
+        set_gate(false);
+        sampled_time += std::chrono::steady_clock::now() - open_time;
+
+        sampler_cv.wait_for(lock, period - window, [this] { return !running; });
+    }
+}
+
+// Caller holds sampler_lock
+void OclTraceSampler::set_gate(bool open) {
+    if (gate_open == open)
+        return;
+    for (auto dIntf : devices)
+        dIntf->gateTrace(open);
+    gate_open = open;
+}
+
+}
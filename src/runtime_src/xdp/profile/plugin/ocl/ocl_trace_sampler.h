@@ -0,0 +1,98 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef XDP_PROFILE_OCL_TRACE_SAMPLER_H_
+#define XDP_PROFILE_OCL_TRACE_SAMPLER_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace xdp {
+
+class DeviceIntf;
+
+enum class TraceSamplingMode {
+    OFF,
+    WINDOW,
+    KERNEL
+};
+
+/**
+ * Statistical sampling of device trace
+ *
+ * Instead of tracing every AIM/AM/ASM transaction, the monitors'
+ * trace output is gated on only
+ *   WINDOW : for windowMsec out of every periodMsec
+ *   KERNEL : while one in every kernelRate kernel executions runs
+ * The fraction of activity that was traced is reported through
+ * getSampleRatio() so that summary totals can be extrapolated.
+ */
+class OclTraceSampler {
+public:
+    OclTraceSampler(const std::string& mode, uint32_t windowMsec,
+                    uint32_t periodMsec, uint32_t kernelRate);
+    ~OclTraceSampler();
+
+    bool isEnabled() const { return mode != TraceSamplingMode::OFF; }
+    TraceSamplingMode getMode() const { return mode; }
+
+    void add_device(DeviceIntf* dIntf);
+    void start_sampling();
+    void stop_sampling();
+
+    // KERNEL mode hooks, eventId identifies one kernel execution
+    void kernel_submitted(uint64_t eventId);
+    void kernel_completed(uint64_t eventId);
+
+    // Fraction (0,1] of device activity captured in trace
+    double getSampleRatio();
+
+private:
+    void window_loop();
+    void set_gate(bool open);
+
+private:
+    TraceSamplingMode mode;
+    std::chrono::milliseconds window;
+    std::chrono::milliseconds period;
+    uint32_t kernel_rate;
+
+    std::mutex sampler_lock;
+    std::condition_variable sampler_cv;
+    bool running = false;
+    bool gate_open = true;
+    std::thread window_thread;
+    std::vector<DeviceIntf*> devices;
+
+    // WINDOW statistics
+    std::chrono::steady_clock::time_point sampling_start;
+    std::chrono::steady_clock::duration sampled_time {0};
+    std::chrono::steady_clock::duration total_time {0};
+
+    // KERNEL statistics
+    uint64_t kernels_total = 0;
+    uint64_t kernels_sampled = 0;
+    std::set<uint64_t> sampled_events;
+};
+
+}
+
+#endif
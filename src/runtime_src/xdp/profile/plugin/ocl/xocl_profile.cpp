@@ -462,7 +462,7 @@ DeviceIntf* get_device_interface(key k)
   if (itr == device_data.end()) {
     itr = device_data.emplace(k,data()).first;
   }
-  return  &(itr->second.mDeviceIntf);
+  return  itr->second.mDeviceIntf.get();
 }
 
 unsigned int
@@ -144,7 +144,8 @@ struct data
   uint32_t mLastTraceNumSamples[XCL_PERF_MON_TOTAL_PROFILE] = {0};
   std::chrono::steady_clock::time_point mLastCountersSampleTime;
   std::chrono::steady_clock::time_point mLastTraceTrainingTime[XCL_PERF_MON_TOTAL_PROFILE];
-  DeviceIntf mDeviceIntf;
+  // Samplers and callbacks hold on to the interface, it never moves
+  std::unique_ptr<DeviceIntf> mDeviceIntf = std::make_unique<DeviceIntf>();
   bool ts2mm_en = false;
 };
 
@@ -164,6 +164,14 @@ cb_action_ndrange(xocl::event* event,cl_int status,const std::string& cu_name, c
     std::string uniqueName = "KERNEL|" + uniqueDeviceName + "|" + xname + "|" + CuInfo + "|";
     std::string traceString = uniqueName + std::to_string(workGroupSize);
     OCLProfiler::Instance()->getPlugin()->setTraceStringForComputeUnit(kname, traceString);
+    // Sampled device trace follows selected kernel executions
+    auto traceSampler = OCLProfiler::Instance()->getTraceSampler();
+    if (traceSampler) {
+      if (status == CL_SUBMITTED)
+        traceSampler->kernel_submitted(reinterpret_cast<uint64_t>(event));
+      else if (status == CL_COMPLETE)
+        traceSampler->kernel_completed(reinterpret_cast<uint64_t>(event));
+    }
     // Finally log the execution
     OCLProfiler::Instance()->getProfileManager()->logKernelExecution
       ( reinterpret_cast<uint64_t>(kernel)
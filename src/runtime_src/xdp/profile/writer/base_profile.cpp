@@ -55,6 +55,17 @@ namespace xdp {
     profile->writeAPISummary(this);
     writeTableFooter(getStream());
 
+    // Table 1a: API Call latency distribution
+    if (mEnLatencyTable) {
+      std::vector<std::string> APILatencyColumnLabels = { "API Name",
+          "Number Of Calls", "50th Percentile (ms)", "90th Percentile (ms)",
+          "99th Percentile (ms)", "99.9th Percentile (ms)" };
+
+      writeTableHeader(getStream(), "OpenCL API Call Latency", APILatencyColumnLabels);
+      profile->writeAPILatencySummary(this);
+      writeTableFooter(getStream());
+    }
+
     // Table 2: Kernel Execution Summary
     std::vector<std::string> KernelExecutionSummaryColumnLabels = {
         "Kernel", "Number Of Enqueues", "Total Time (ms)",
@@ -182,6 +193,15 @@ namespace xdp {
     writeTableRowEnd(getStream());
   }
 
+  void ProfileWriterI::writeLatencyStats(const std::string& name, const LatencyHistogram& latency)
+  {
+    writeTableRowStart(getStream());
+    writeTableCells(getStream(), name, latency.getCount(),
+                    latency.getPercentile(50), latency.getPercentile(90),
+                    latency.getPercentile(99), latency.getPercentile(99.9));
+    writeTableRowEnd(getStream());
+  }
+
   void ProfileWriterI::writeStallSummary(std::string& cuName, uint32_t cuRunCount,
       double cuRunTimeMsec, double cuStallExt, double cuStallStr, double cuStallInt)
   {
@@ -56,6 +56,7 @@ namespace xdp {
       inline void enableStallTable() { mEnStallTable = true; }
       inline void enableStreamTable() { mEnStreamTable = true; }
       inline void enableShellTables() { mEnShellTables = true; }
+      inline void enableLatencyTable() { mEnLatencyTable = true; }
 
       // Returns the output file name for the writer
       virtual const std::string getFileName() { return mFileName; }
@@ -63,6 +64,8 @@ namespace xdp {
       // Functions for Summary
       // Write Kernel Execution Time stats
       virtual void writeTimeStats(const std::string& name, const TimeStats& stats);
+      // Write API call latency percentiles
+      virtual void writeLatencyStats(const std::string& name, const LatencyHistogram& latency);
       // Write Read Buffer of Write Buffer transfer stats
       virtual void writeBufferStats(const std::string& name, const BufferStats& stats);
       // Write Kernel Execution Time Trace
@@ -169,6 +172,7 @@ namespace xdp {
       bool mEnStallTable = false;
       bool mEnStreamTable = false;
       bool mEnShellTables = false;
+      bool mEnLatencyTable = false;
     };
 
 } // xdp
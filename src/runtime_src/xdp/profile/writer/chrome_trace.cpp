@@ -0,0 +1,470 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "chrome_trace.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <set>
+
+namespace xdp {
+
+  namespace {
+
+    // Buffered output is written to file in chunks of this size
+    const size_t ChunkSize = 1 << 20;
+    // Completed events remembered as possible dependency sources
+    const size_t MaxCompleted = 1 << 16;
+    // Overlapping activities on one track beyond this share the last lane
+    const size_t MaxLanes = 64;
+    // Activities waiting for their END; starts beyond this are not traced
+    const size_t MaxPending = 1 << 16;
+
+    std::vector<std::string> splitFields(const std::string& str)
+    {
+      std::vector<std::string> fields;
+      size_t start = 0;
+      size_t pos = 0;
+      while ((pos = str.find('|', start)) != std::string::npos) {
+        fields.push_back(str.substr(start, pos - start));
+        start = pos + 1;
+      }
+      fields.push_back(str.substr(start));
+      return fields;
+    }
+
+    const std::string& field(const std::vector<std::string>& fields, size_t index)
+    {
+      static const std::string empty;
+      return (index < fields.size()) ? fields[index] : empty;
+    }
+
+    // Append str as a JSON string literal
+    void appendQuoted(std::string& out, const std::string& str)
+    {
+      out += '"';
+      for (char c : str) {
+        if (c == '"' || c == '\\') {
+          out += '\\';
+          out += c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20) {
+          char esc[8];
+          std::snprintf(esc, sizeof(esc), "\\u%04x", c);
+          out += esc;
+        }
+        else {
+          out += c;
+        }
+      }
+      out += '"';
+    }
+
+  }
+
+  ChromeTraceWriter::ChromeTraceWriter(const std::string& traceFileName,
+                                       XDPPluginI* Plugin) :
+      TraceWriterI(traceFileName)
+  {
+    mPluginHandle = Plugin;
+    if (mFileName != "") {
+      mFileName += ".json";
+      openStream(Trace_ofs, mFileName);
+      mBuffer.reserve(ChunkSize + 4096);
+      mBuffer += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    }
+  }
+
+  ChromeTraceWriter::~ChromeTraceWriter()
+  {
+    if (Trace_ofs.is_open()) {
+      mBuffer += "\n]}\n";
+      flush(true);
+      Trace_ofs.close();
+    }
+  }
+
+  // ***************************************************************************
+  // Host events
+  // ***************************************************************************
+
+  void ChromeTraceWriter::writeFunction(double time, const std::string& functionName,
+      const std::string& eventName, unsigned int functionID)
+  {
+    if (!Trace_ofs.is_open())
+      return;
+
+    if (eventName == "START") {
+      auto itr = mFunctionStarts.find(functionID);
+      if (itr != mFunctionStarts.end())
+        itr->second = time;
+      else if (mFunctionStarts.size() < MaxPending)
+        mFunctionStarts.emplace(functionID, time);
+      return;
+    }
+
+    auto itr = mFunctionStarts.find(functionID);
+    if (itr == mFunctionStarts.end())
+      return;
+
+    // Function name is "<API>|<queue address or General>"
+    auto fields = splitFields(functionName);
+    std::string args = "\"queue\":";
+    appendQuoted(args, field(fields, 1));
+
+    // API callbacks run on the calling thread
+    auto track = getThreadTrack(getProcess("Host"), std::this_thread::get_id());
+    writeSlice(track, field(fields, 0), "api", itr->second, time, args);
+    mFunctionStarts.erase(itr);
+  }
+
+  void ChromeTraceWriter::writeKernel(double traceTime, const std::string& commandString,
+      const std::string& stageString, const std::string& eventString,
+      const std::string& dependString, uint64_t objId, size_t size)
+  {
+    if (!Trace_ofs.is_open())
+      return;
+
+    // Command is "KERNEL|<device>|<xclbin>|<kernel>|<local size>|all"
+    auto fields = splitFields(commandString);
+    const std::string& kernelName = field(fields, 3);
+    std::string key = "K" + (eventString.empty() ? std::to_string(objId) : eventString);
+    std::string args = "\"workgroup_size\":" + std::to_string(size) + ",\"local_size\":";
+    appendQuoted(args, field(fields, 4));
+
+    completeActivity(key, "Kernel " + kernelName, "Device " + field(fields, 1), "kernel",
+        stageString, eventString, dependString, traceTime, kernelName, args);
+  }
+
+  void ChromeTraceWriter::writeCu(double traceTime, const std::string& commandString,
+      const std::string& stageString, const std::string& eventString,
+      const std::string& dependString, uint64_t objId, size_t size, uint32_t cuId)
+  {
+    if (!Trace_ofs.is_open())
+      return;
+
+    // Command is "KERNEL|<device>|<xclbin>|<kernel>|<local size>|<cu>|"
+    auto fields = splitFields(commandString);
+    std::string key = "C" + std::to_string(cuId);
+    std::string args = "\"workgroup_size\":" + std::to_string(size);
+
+    // The kernel event carries the dependencies, CUs only nest under it
+    completeActivity(key, "CU " + field(fields, 5), "Device " + field(fields, 1), "cu",
+        stageString, "", "", traceTime, field(fields, 3), args);
+  }
+
+  void ChromeTraceWriter::writeTransfer(double traceTime, RTUtil::e_profile_command_kind kind,
+      const std::string& commandString, const std::string& stageString,
+      const std::string& eventString, const std::string& dependString, size_t size,
+      uint64_t srcAddress, const std::string& srcBank,
+      uint64_t dstAddress, const std::string& dstBank,
+      std::thread::id threadId)
+  {
+    if (!Trace_ofs.is_open())
+      return;
+
+    std::string key = "T" + eventString;
+    std::string args = "\"size\":" + std::to_string(size) + ",\"src_bank\":";
+    appendQuoted(args, srcBank);
+    if (kind == RTUtil::COPY_BUFFER || kind == RTUtil::COPY_BUFFER_P2P) {
+      args += ",\"dst_bank\":";
+      appendQuoted(args, dstBank);
+    }
+
+    completeActivity(key, commandString, "Host", "transfer", stageString,
+        eventString, dependString, traceTime, commandString, args);
+  }
+
+  void ChromeTraceWriter::writeDependency(double traceTime, const std::string& commandString,
+      const std::string& stageString, const std::string& eventString,
+      const std::string& dependString)
+  {
+    if (!Trace_ofs.is_open())
+      return;
+
+    // Logged at enqueue: dependString waits on eventString.
+    // Arrows are drawn once the waiting event completes.
+    auto itr = mDependencies.find(dependString);
+    if (itr != mDependencies.end())
+      (itr->second += "|") += eventString;
+    else if (mDependencies.size() < MaxCompleted)
+      mDependencies.emplace(dependString, eventString);
+  }
+
+  // ***************************************************************************
+  // Device events
+  // ***************************************************************************
+
+  void ChromeTraceWriter::writeDeviceTrace(const TraceParser::TraceResultVector &resultVector,
+      std::string deviceName, std::string binaryName)
+  {
+    if (!Trace_ofs.is_open())
+      return;
+
+    uint32_t pid = getProcess("Device " + deviceName);
+    double clockPeriodMsec = 1.0e-3 / mPluginHandle->getKernelClockFreqMHz(deviceName);
+
+    for (auto& tr : resultVector) {
+#ifndef XDP_VERBOSE
+      if (tr.Kind == DeviceTrace::DEVICE_BUFFER)
+        continue;
+#endif
+
+      xclPerfMonType type = XCL_PERF_MON_MEMORY;
+      std::string trackName = "AIM ";
+      std::string name = tr.Type;
+      if (tr.Kind == DeviceTrace::DEVICE_KERNEL
+          && (tr.Type == "Kernel" || tr.Type.find("Stall") != std::string::npos)) {
+        type = XCL_PERF_MON_ACCEL;
+        trackName = "CU ";
+      }
+      else if (tr.Kind == DeviceTrace::DEVICE_STREAM) {
+        type = XCL_PERF_MON_STR;
+        trackName = "ASM ";
+        name = tr.Name;
+      }
+      trackName += getSlotName(deviceName, type, tr.SlotNum);
+
+      double end = (tr.End > tr.Start) ? tr.End : tr.Start + clockPeriodMsec;
+      std::string args = "\"start_cycle\":" + std::to_string(tr.StartTime)
+                       + ",\"end_cycle\":" + std::to_string(tr.EndTime);
+      if (type == XCL_PERF_MON_MEMORY)
+        args += ",\"burst_length\":" + std::to_string(tr.BurstLength);
+
+      auto track = getLaneTrack(pid, trackName, tr.Start, end);
+      writeSlice(track, name, "device", tr.Start, end, args);
+    }
+  }
+
+  // ***************************************************************************
+  // Activities and dependencies
+  // ***************************************************************************
+
+  void ChromeTraceWriter::completeActivity(const std::string& key, const std::string& trackName,
+      const std::string& processName, const char* category, const std::string& stageString,
+      const std::string& eventString, const std::string& dependString,
+      double traceTime, const std::string& name, const std::string& args)
+  {
+    if (stageString == "START") {
+      // Starts whose END never arrives must not grow this without bound
+      auto itr = mPending.find(key);
+      if (itr != mPending.end())
+        itr->second = Pending{traceTime, name, dependString};
+      else if (mPending.size() < MaxPending)
+        mPending.emplace(key, Pending{traceTime, name, dependString});
+      return;
+    }
+    if (stageString != "END")
+      return;
+
+    auto itr = mPending.find(key);
+    if (itr == mPending.end())
+      return;
+
+    const Pending& pending = itr->second;
+    auto track = getLaneTrack(getProcess(processName), trackName, pending.start, traceTime);
+    writeSlice(track, pending.name, category, pending.start, traceTime, args);
+
+    if (!eventString.empty()) {
+      writeFlows(eventString, pending.depends, track, pending.start);
+
+      if (mCompleted.emplace(eventString, Completed{track, pending.start}).second) {
+        mCompletedOrder.push_back(eventString);
+        if (mCompletedOrder.size() > MaxCompleted) {
+          mCompleted.erase(mCompletedOrder.front());
+          mCompletedOrder.pop_front();
+        }
+      }
+    }
+    mPending.erase(itr);
+  }
+
+  void ChromeTraceWriter::writeFlows(const std::string& eventString, const std::string& depends,
+      const Track& track, double start)
+  {
+    // The same dependency can be both in the event chain and logged
+    auto chain = splitFields(depends);
+    std::set<std::string> sources(chain.begin(), chain.end());
+    auto itr = mDependencies.find(eventString);
+    if (itr != mDependencies.end()) {
+      auto logged = splitFields(itr->second);
+      sources.insert(logged.begin(), logged.end());
+      mDependencies.erase(itr);
+    }
+
+    for (auto& source : sources) {
+      auto src = mCompleted.find(source);
+      if (src == mCompleted.end())
+        continue;
+
+      // Flow start binds to the source slice, flow end to this one
+      std::string id = std::to_string(mNextFlowId++);
+      beginEvent();
+      mBuffer += "{\"ph\":\"s\",\"cat\":\"dependency\",\"name\":\"dependency\",\"id\":" + id
+               + ",\"pid\":" + std::to_string(src->second.track.pid)
+               + ",\"tid\":" + std::to_string(src->second.track.tid) + ",\"ts\":";
+      appendTime(src->second.start);
+      mBuffer += "}";
+      beginEvent();
+      mBuffer += "{\"ph\":\"f\",\"bp\":\"e\",\"cat\":\"dependency\",\"name\":\"dependency\",\"id\":" + id
+               + ",\"pid\":" + std::to_string(track.pid)
+               + ",\"tid\":" + std::to_string(track.tid) + ",\"ts\":";
+      appendTime(start);
+      mBuffer += "}";
+    }
+    flush();
+  }
+
+  // ***************************************************************************
+  // Tracks
+  // ***************************************************************************
+
+  uint32_t ChromeTraceWriter::getProcess(const std::string& processName)
+  {
+    auto itr = mProcesses.find(processName);
+    if (itr != mProcesses.end())
+      return itr->second;
+
+    uint32_t pid = mProcesses.size() + 1;
+    mProcesses.emplace(processName, pid);
+    writeMetadata("process_name", pid, 0, processName);
+    return pid;
+  }
+
+  ChromeTraceWriter::Track
+  ChromeTraceWriter::getThreadTrack(uint32_t pid, std::thread::id threadId)
+  {
+    auto key = std::make_pair(pid, threadId);
+    auto itr = mThreadTracks.find(key);
+    if (itr != mThreadTracks.end())
+      return Track{pid, itr->second};
+
+    uint32_t tid = ++mNextTid[pid];
+    mThreadTracks.emplace(key, tid);
+    writeMetadata("thread_name", pid, tid, "Thread " + std::to_string(mThreadTracks.size()));
+    return Track{pid, tid};
+  }
+
+  ChromeTraceWriter::Track
+  ChromeTraceWriter::getLaneTrack(uint32_t pid, const std::string& trackName,
+      double start, double end)
+  {
+    auto& lanes = mLanes[std::make_pair(pid, trackName)];
+    for (auto& lane : lanes) {
+      if (start >= lane.second) {
+        lane.second = end;
+        return Track{pid, lane.first};
+      }
+    }
+
+    if (lanes.size() >= MaxLanes) {
+      auto& lane = lanes.back();
+      if (end > lane.second)
+        lane.second = end;
+      return Track{pid, lane.first};
+    }
+
+    uint32_t tid = ++mNextTid[pid];
+    lanes.emplace_back(tid, end);
+    std::string name = trackName;
+    if (lanes.size() > 1)
+      name += " (" + std::to_string(lanes.size()) + ")";
+    writeMetadata("thread_name", pid, tid, name);
+    return Track{pid, tid};
+  }
+
+  const std::string& ChromeTraceWriter::getSlotName(const std::string& deviceName,
+      xclPerfMonType type, uint32_t slotNum)
+  {
+    auto key = std::make_tuple(deviceName, type, slotNum);
+    auto itr = mSlotNames.find(key);
+    if (itr != mSlotNames.end())
+      return itr->second;
+
+    std::string slotName;
+    mPluginHandle->getProfileSlotName(type, deviceName, slotNum, slotName);
+    if (slotName.empty())
+      slotName = std::to_string(slotNum);
+    return mSlotNames.emplace(key, slotName).first->second;
+  }
+
+  // ***************************************************************************
+  // Formatting
+  // ***************************************************************************
+
+  void ChromeTraceWriter::writeSlice(const Track& track, const std::string& name,
+      const char* category, double start, double end, const std::string& args)
+  {
+    beginEvent();
+    mBuffer += "{\"ph\":\"X\",\"cat\":\"";
+    mBuffer += category;
+    mBuffer += "\",\"name\":";
+    appendString(name);
+    mBuffer += ",\"pid\":" + std::to_string(track.pid)
+             + ",\"tid\":" + std::to_string(track.tid) + ",\"ts\":";
+    appendTime(start);
+    mBuffer += ",\"dur\":";
+    appendTime((end > start) ? (end - start) : 0.0);
+    if (!args.empty())
+      (mBuffer += ",\"args\":{") += args + "}";
+    mBuffer += "}";
+    flush();
+  }
+
+  void ChromeTraceWriter::writeMetadata(const char* type, uint32_t pid, uint32_t tid,
+      const std::string& name)
+  {
+    beginEvent();
+    mBuffer += "{\"ph\":\"M\",\"name\":\"";
+    mBuffer += type;
+    mBuffer += "\",\"pid\":" + std::to_string(pid) + ",\"tid\":" + std::to_string(tid)
+             + ",\"args\":{\"name\":";
+    appendString(name);
+    mBuffer += "}}";
+  }
+
+  void ChromeTraceWriter::beginEvent()
+  {
+    if (!mFirstEvent)
+      mBuffer += ",\n";
+    mFirstEvent = false;
+  }
+
+  // Trace times are in msec, Chrome timestamps in usec
+  void ChromeTraceWriter::appendTime(double msec)
+  {
+    char str[32];
+    int len = std::snprintf(str, sizeof(str), "%.3f", msec * 1000.0);
+    if (len > 0)
+      mBuffer.append(str, std::min<size_t>(len, sizeof(str) - 1));
+  }
+
+  void ChromeTraceWriter::appendString(const std::string& str)
+  {
+    appendQuoted(mBuffer, str);
+  }
+
+  void ChromeTraceWriter::flush(bool force)
+  {
+    if (!force && mBuffer.size() < ChunkSize)
+      return;
+    Trace_ofs.write(mBuffer.data(), mBuffer.size());
+    mBuffer.clear();
+    if (force)
+      Trace_ofs.flush();
+  }
+
+} // xdp
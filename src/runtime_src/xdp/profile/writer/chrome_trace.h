@@ -0,0 +1,141 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef __XDP_CHROME_TRACE_WRITER_H
+#define __XDP_CHROME_TRACE_WRITER_H
+
+#include "base_trace.h"
+
+#include <deque>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+
+namespace xdp {
+
+    /**
+     * Timeline trace in Chrome trace event format
+     *
+     * The output can be opened directly in Perfetto or chrome://tracing.
+     *   Host process   : one track per application thread for API calls,
+     *                    one track per transfer type for buffer transfers
+     *   Device process : one track per kernel for enqueued kernels, one
+     *                    track per CU, AIM and ASM slot for device trace
+     * Dependencies between events are drawn as flow arrows.
+     *
+     * Every START is matched with its END so that each activity is one
+     * complete ("X") event.  Overlapping activities on a track are spread
+     * over lanes so slices always nest.  Only a capped number of in-flight
+     * activities and a bounded window of completed ones (for dependencies)
+     * are kept; events are formatted into a fixed size buffer that is
+     * flushed to the file whenever it fills up.
+     */
+    class ChromeTraceWriter: public TraceWriterI {
+
+    public:
+      ChromeTraceWriter(const std::string& traceFileName, XDPPluginI* Plugin);
+      ~ChromeTraceWriter();
+
+    public:
+      void writeFunction(double time, const std::string& functionName,
+          const std::string& eventName, unsigned int functionID) override;
+      void writeKernel(double traceTime, const std::string& commandString,
+          const std::string& stageString, const std::string& eventString,
+          const std::string& dependString, uint64_t objId, size_t size) override;
+      void writeCu(double traceTime, const std::string& commandString,
+          const std::string& stageString, const std::string& eventString,
+          const std::string& dependString, uint64_t objId, size_t size, uint32_t cuId) override;
+      void writeTransfer(double traceTime, RTUtil::e_profile_command_kind kind,
+          const std::string& commandString, const std::string& stageString,
+          const std::string& eventString, const std::string& dependString, size_t size,
+          uint64_t srcAddress, const std::string& srcBank,
+          uint64_t dstAddress, const std::string& dstBank,
+          std::thread::id threadId) override;
+      void writeDependency(double traceTime, const std::string& commandString,
+          const std::string& stageString, const std::string& eventString,
+          const std::string& dependString) override;
+      // Counter samples are reported in the profile summary only
+      void writeDeviceCounters(xclPerfMonType, xclCounterResults&,
+          double, uint32_t, bool) override {}
+      void writeDeviceTrace(const TraceParser::TraceResultVector &resultVector,
+          std::string deviceName, std::string binaryName) override;
+
+    protected:
+      void writeTableHeader(std::ofstream&, const std::string&,
+          const std::vector<std::string>&) override {}
+
+    private:
+      // A track is a (pid, tid) pair in the trace
+      struct Track {
+        uint32_t pid;
+        uint32_t tid;
+      };
+      // Start of an activity waiting for its END
+      struct Pending {
+        double start;
+        std::string name;
+        std::string depends;
+      };
+      // Completed activity that later events may depend on
+      struct Completed {
+        Track track;
+        double start;
+      };
+
+    private:
+      uint32_t getProcess(const std::string& processName);
+      Track getThreadTrack(uint32_t pid, std::thread::id threadId);
+      Track getLaneTrack(uint32_t pid, const std::string& trackName, double start, double end);
+      void writeSlice(const Track& track, const std::string& name, const char* category,
+          double start, double end, const std::string& args = "");
+      void writeFlows(const std::string& eventString, const std::string& depends,
+          const Track& track, double start);
+      void writeMetadata(const char* type, uint32_t pid, uint32_t tid, const std::string& name);
+      void completeActivity(const std::string& key, const std::string& trackName,
+          const std::string& processName, const char* category, const std::string& stageString,
+          const std::string& eventString, const std::string& dependString,
+          double traceTime, const std::string& name, const std::string& args);
+      const std::string& getSlotName(const std::string& deviceName,
+          xclPerfMonType type, uint32_t slotNum);
+
+      void beginEvent();
+      void appendTime(double msec);
+      void appendString(const std::string& str);
+      void flush(bool force = false);
+
+    private:
+      std::string mBuffer;
+      bool mFirstEvent = true;
+      uint64_t mNextFlowId = 1;
+
+      std::map<std::string, uint32_t> mProcesses;
+      std::map<std::pair<uint32_t, std::thread::id>, uint32_t> mThreadTracks;
+      std::map<uint32_t, uint32_t> mNextTid;
+      // Per track name, the tid and last end time of each lane
+      std::map<std::pair<uint32_t, std::string>,
+               std::vector<std::pair<uint32_t, double>>> mLanes;
+      std::map<std::tuple<std::string, xclPerfMonType, uint32_t>, std::string> mSlotNames;
+
+      std::unordered_map<unsigned int, double> mFunctionStarts;
+      std::unordered_map<std::string, Pending> mPending;
+      std::unordered_map<std::string, std::string> mDependencies;
+      std::unordered_map<std::string, Completed> mCompleted;
+      std::deque<std::string> mCompletedOrder;
+    };
+
+} // xdp
+
+#endif
@@ -36,20 +36,15 @@
 
 namespace {
 
-static std::vector<char>
-read_file(const std::string& filename)
+static std::unique_ptr<xclbin::image>
+map_file(const std::string& filename)
 {
-  std::ifstream istr(filename,std::ios::binary|std::ios::ate);
-  if (!istr)
+  try {
+    return std::make_unique<xclbin::image>(filename);
+  }
+  catch (const xclbin::error&) {
     throw xocl::error(CL_BUILD_PROGRAM_FAILURE,"Cannot not open '" + filename + "' for reading");
-
-  auto pos = istr.tellg();
-  istr.seekg(0,std::ios::beg);
-
-  std::vector<char> buffer(pos);
-  istr.read (&buffer[0],pos);
-
-  return buffer;
+  }
 }
 
 }
@@ -130,9 +125,10 @@ clCreateProgramWithSource(cl_context        context,
   }
 
 
-  auto xclbin = read_file(filematch);
-  char* binary = &xclbin[0]; // char
-  size_t length=xclbin.size();
+  // Mapped, clCreateProgramWithBinary makes its own copy
+  auto xclbin = map_file(filematch);
+  const char* binary = xclbin->data(); // char
+  size_t length=xclbin->size();
 
   // hash match found clCreateProgramWithBinary and exit search
   cl_int err = CL_SUCCESS;
@@ -61,22 +61,6 @@ is_emulation_mode()
   return emulation_mode;
 }
 
-static std::vector<char>
-read_file(const std::string& filename)
-{
-  std::ifstream istr(filename,std::ios::binary|std::ios::ate);
-  if (!istr)
-    throw xocl::error(CL_BUILD_PROGRAM_FAILURE,"Cannot not open '" + filename + "' for reading");
-
-  auto pos = istr.tellg();
-  istr.seekg(0,std::ios::beg);
-
-  std::vector<char> buffer(pos);
-  istr.read (&buffer[0],pos);
-
-  return buffer;
-}
-
 static void
 init_conformance()
 {
@@ -90,7 +74,8 @@ init_conformance()
     bfs::path file(itr->path());
 
     if (bfs::exists(file) && bfs::is_regular_file(file) && file.extension()==".xclbin") {
-      auto xclbin = xocl::xclbin(read_file(file.string()));
+      // Mapped, only the meta data pages are read
+      auto xclbin = xocl::xclbin(::xclbin::binary(file.string()));
       for (auto hash : xclbin.conformance_kernel_hashes())  {
         XOCL_DEBUG(std::cout,"(hash,file)=(",hash,",",file.string(),")\n");
         global_conformance_xclbin_map.emplace(hash,file.string());
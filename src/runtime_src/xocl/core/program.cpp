@@ -31,21 +31,15 @@
 
 namespace {
 
-XOCL_UNUSED
-static std::vector<char>
-read_file(const std::string& filename)
+static std::unique_ptr<xclbin::image>
+map_file(const std::string& filename)
 {
-  std::ifstream istr(filename,std::ios::binary|std::ios::ate);
-  if (!istr)
+  try {
+    return std::make_unique<xclbin::image>(filename);
+  }
+  catch (const xclbin::error&) {
     throw xocl::error(CL_BUILD_PROGRAM_FAILURE,"Cannot not open '" + filename + "' for reading");
-
-  auto pos = istr.tellg();
-  istr.seekg(0,std::ios::beg);
-
-  std::vector<char> buffer(pos);
-  istr.read (&buffer[0],pos);
-
-  return buffer;
+  }
 }
 
 // Current list of live program objects.
@@ -292,9 +286,10 @@ build(const std::vector<device*>& devices,const std::string& options)
   if (std::remove("_temp.cl"))
     throw xocl::error(CL_BUILD_PROGRAM_FAILURE,"could not delete temporary file");
 
-  auto xclbin = read_file("xcl_verif.xclbin");
-  auto data = &xclbin[0]; // char*
-  auto size = xclbin.size();
+  // Mapped, clCreateProgramWithBinary makes its own copy
+  auto xclbin = map_file("xcl_verif.xclbin");
+  auto data = xclbin->data(); // const char*
+  auto size = xclbin->size();
 
   for (auto device : devices) {
     int status[1]={0}, err=0;
@@ -1014,7 +1014,11 @@ struct xclbin::impl
   xclbin_data_sections m_sections;
 
   impl(std::vector<char>&& xb)
-    : m_binary(std::move(xb))
+    : impl(binary_type(std::move(xb)))
+  {}
+
+  impl(const binary_type& xb)
+    : m_binary(xb)
     , m_xml(m_binary.meta_data())
     , m_sections(m_binary)
   {}
@@ -1123,6 +1127,12 @@ xclbin(std::vector<char>&& xb)
 {
 }
 
+xclbin::
+xclbin(const ::xclbin::binary& xb)
+  : m_impl(std::make_unique<xclbin::impl>(xb))
+{
+}
+
 xclbin::
 xclbin(xclbin&& rhs)
   : m_impl(std::move(rhs.m_impl))
@@ -147,6 +147,14 @@ public:
    */
   // implicit
   xclbin(std::vector<char>&& xb);
+
+  /**
+   * Construct from an existing binary, e.g. a mapped xclbin file.
+   * The binary data is shared, not copied.
+   */
+  explicit
+  xclbin(const ::xclbin::binary& xb);
+
   xclbin(xclbin&& rhs);
 
   xclbin(const xclbin& rhs);
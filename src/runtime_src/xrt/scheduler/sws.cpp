@@ -301,18 +301,6 @@ public:
 
 using xcmd_ptr = std::shared_ptr<xocl_cmd>;
 
-////////////////////////////////////////////////////////////////
-// List of new pending xocl_cmd objects
-//
-// @s_pending_cmds: populated from user space with new commands for buffer objects
-// @s_num_pending: number of pending commands
-//
-// Scheduler copies pending commands to its private queue when necessary
-////////////////////////////////////////////////////////////////
-static std::vector<xcmd_ptr> s_pending_cmds;
-static std::mutex s_pending_mutex;
-static std::atomic<unsigned int> s_num_pending {0};
-
 ////////////////////////////////////////////////////////////////
 // class xocl_cu represents a compute unit on a device
 //
@@ -425,18 +413,34 @@ public:
 
     auto size = xcmd->regmap_size();
     auto regmap = xcmd->regmap_data();
+    size_type writes = 0;
 
     if (xcmd->opcode() == ERT_EXEC_WRITE) {
-      // write address value pairs
+      // write address value pairs, pairs to consecutive registers are
+      // coalesced so that each run costs one register write
+      std::vector<value_type> values;
+      addr_type start = 0;
       for (size_type idx = 6; idx < size - 1; idx+=2) {
         addr_type offset = *(regmap + idx);
         value_type value = *(regmap + idx + 1);
-        xdev->write_register(addr + offset,&value,4);
+        if (!values.empty() && offset != start + values.size()*4) {
+          xdev->write_register(addr + start,values.data(),values.size()*4);
+          ++writes;
+          values.clear();
+        }
+        if (values.empty())
+          start = offset;
+        values.push_back(value);
+      }
+      if (!values.empty()) {
+        xdev->write_register(addr + start,values.data(),values.size()*4);
+        ++writes;
       }
     }
     else {
       // write register map consecutively from CU base
       xdev->write_register(addr,regmap,size*4);
+      ++writes;
     }
 
     // invoke callback for starting cu
@@ -449,10 +453,11 @@ public:
       xdev->write_register(addr,regmap,size*4);
     else
       xdev->write_register(addr,regmap,4);
+    ++writes;
 
     running_queue.push(xcmd);
     ++run_cnt;
-    XRT_DEBUGF("started cu(%d) xcmd(%d) done(%d) run(%d)\n",idx,xcmd->get_uid(),done_cnt,run_cnt);
+    XRT_DEBUGF("started cu(%d) xcmd(%d) done(%d) run(%d) writes(%d)\n",idx,xcmd->get_uid(),done_cnt,run_cnt,writes);
   }
 };
 
@@ -629,19 +634,23 @@ public:
 // class xocl_scheduler: The scheduler data structure
 //
 // @m_command_queue: all the commands managed by scheduler
+// @m_pending_cmds: new commands populated from user space
+// @m_thread: thread running this scheduler
 //
 // The scheduler babysits all commands launched by user. It
 // transitions the commands from state to state until the command
 // completes.
 //
 // The scheduler runs on its own thread and manages command execution
-// on execution cores.  An execution core is 1-1 with a scheduler, but
-// a scheduler can manage any number of cores.  Because the scheduler
-// is the only client of an exec_core, and exec_core is the only
-// client of xocl_cu, no locking is necessary is any of the data
-// structures.  Exception is the pending command list which is copied
-// to the scheduler command queue, the pending list is populated by
-// user thread, and harvested by scheduler thread.
+// on execution cores.  There is one scheduler per device, so that
+// devices, each emulated by its own device process in sw emulation,
+// execute commands concurrently rather than taking turns on a
+// single scheduler thread.  Because the scheduler is the only client
+// of an exec_core, and exec_core is the only client of xocl_cu, no
+// locking is necessary is any of the data structures.  Exception is
+// the pending command list which is copied to the scheduler command
+// queue, the pending list is populated by user thread, and harvested
+// by scheduler thread.
 ////////////////////////////////////////////////////////////////
 class xocl_scheduler
 {
@@ -650,26 +659,20 @@ class xocl_scheduler
 
   bool                       m_stop = false;
   std::list<xcmd_ptr>        m_command_queue;
+  std::vector<xcmd_ptr>      m_pending_cmds;
+  std::thread                m_thread;
 
   // Copy pending commands into command queue.
   void
   queue_cmds()
   {
-    std::lock_guard<std::mutex> lk(s_pending_mutex);
-    for (auto itr=s_pending_cmds.begin(); itr!=s_pending_cmds.end(); ) {
-      auto xcmd = (*itr);
-      auto exec = xcmd->get_exec();
-      if (exec->get_scheduler()==this) {
-        XRT_DEBUGF("xcmd(%d) [new->queued]\n",xcmd->get_uid());
-        itr = s_pending_cmds.erase(itr);
-        xcmd->set_int_state(ERT_CMD_STATE_QUEUED);
-        m_command_queue.push_back(std::move(xcmd));
-      }
-      else {
-        ++itr;
-      }
+    std::lock_guard<std::mutex> lk(m_mutex);
+    for (auto& xcmd : m_pending_cmds) {
+      XRT_DEBUGF("xcmd(%d) [new->queued]\n",xcmd->get_uid());
+      xcmd->set_int_state(ERT_CMD_STATE_QUEUED);
+      m_command_queue.push_back(std::move(xcmd));
     }
-    s_num_pending = s_pending_cmds.size();
+    m_pending_cmds.clear();
   }
 
   // Transition command to submitted state if possible
@@ -753,11 +756,11 @@ class xocl_scheduler
   wait()
   {
     std::unique_lock<std::mutex> lk(m_mutex);
-    while (!m_stop && !s_num_pending && m_command_queue.empty())
+    while (!m_stop && m_pending_cmds.empty() && m_command_queue.empty())
       m_work.wait(lk);
 
     if (m_stop) {
-      if (!m_command_queue.empty() || s_num_pending)
+      if (!m_command_queue.empty() || !m_pending_cmds.empty())
         throw std::runtime_error("software scheduler stopping while there are active commands");
     }
   }
@@ -772,48 +775,70 @@ class xocl_scheduler
     iterate_cmds();
   }
 
+  // Run the scheduler until it is stopped
+  void
+  run()
+  {
+    while (!m_stop)
+      loop();
+  }
+
 public:
 
-  // Wake up the scheduler if it is waiting
+  // Add a new command and wake up the scheduler if it is waiting
   void
-  notify()
+  schedule(xcmd_ptr xcmd)
   {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_pending_cmds.push_back(std::move(xcmd));
     m_work.notify_one();
   }
 
-  // Run the scheduler until it is stopped
+  // Start the scheduler thread
   void
-  run()
+  start()
   {
-    while (!m_stop)
-      loop();
+    m_stop = false;
+    m_thread = std::move(xrt::thread(&xocl_scheduler::run,this));
   }
 
-  // Stop the scheduler
+  // Stop the scheduler and wait for its thread to exit
   void
   stop()
   {
-    std::lock_guard<std::mutex> lk(m_mutex);
-    m_stop = true;
-    m_work.notify_one();
+    {
+      std::lock_guard<std::mutex> lk(m_mutex);
+      m_stop = true;
+      m_work.notify_one();
+    }
+    if (m_thread.joinable())
+      m_thread.join();
   }
 
 };
 
 ////////////////////////////////////////////////////////////////
-// One static scheduler currently on a single thread
-static xocl_scheduler s_global_scheduler;
-static std::thread s_scheduler_thread;
+// One scheduler, each on its own thread, per device
+static std::map<const xrt::device*, std::unique_ptr<xocl_scheduler>> s_device_scheduler;
 static bool s_running=false;
 
 // Each device has a execution core
 static std::map<const xrt::device*, std::unique_ptr<exec_core>> s_device_exec_core;
 
-// Thread routine for scheduler loop
-static void
-scheduler_loop()
+// Guards the device maps against concurrent init and schedule
+static std::mutex s_device_mutex;
+
+// Get the scheduler of a device, create and start it if necessary
+static xocl_scheduler*
+get_scheduler(const xrt::device* xdev)
 {
-  s_global_scheduler.run();
+  auto& xs = s_device_scheduler[xdev];
+  if (!xs) {
+    xs = std::make_unique<xocl_scheduler>();
+    if (s_running)
+      xs->start();
+  }
+  return xs.get();
 }
 
 } // namespace
@@ -825,14 +850,10 @@ schedule(const cmd_ptr& cmd)
 {
   auto device = cmd->get_device();
 
+  std::lock_guard<std::mutex> lk(s_device_mutex);
   auto& exec = s_device_exec_core[device];
   auto xcmd = xocl_cmd::create(exec.get(),cmd);
-  auto scheduler = exec->get_scheduler();
-
-  std::lock_guard<std::mutex> lk(s_pending_mutex);
-  s_pending_cmds.push_back(xcmd);
-  ++s_num_pending;
-  scheduler->notify();
+  exec->get_scheduler()->schedule(std::move(xcmd));
 }
 
 void
@@ -841,9 +862,13 @@ start()
   if (s_running)
     throw std::runtime_error("software command scheduler is already started");
 
-  s_scheduler_thread = std::move(xrt::thread(scheduler_loop));
   if (threaded_notification)
     notifier = std::move(xrt::thread(xrt::task::worker,std::ref(notify_queue)));
+
+  // Restart the schedulers of devices initialized before a stop
+  std::lock_guard<std::mutex> lk(s_device_mutex);
+  for (auto& entry : s_device_scheduler)
+    entry.second->start();
   s_running = true;
 }
 
@@ -853,8 +878,11 @@ stop()
   if (!s_running)
     return;
 
-  s_global_scheduler.stop();
-  s_scheduler_thread.join();
+  {
+    std::lock_guard<std::mutex> lk(s_device_mutex);
+    for (auto& entry : s_device_scheduler)
+      entry.second->stop();
+  }
 
   if (threaded_notification) {
     // wait for notifier to drain
@@ -878,10 +906,11 @@ init(xrt::device* xdev, const std::vector<uint64_t>& cu_addr_map)
   std::vector<addr_type> amap(cu_addr_map.begin(),cu_addr_map.end());
   auto slots = ERT_CQ_SIZE / xrt::config::get_ert_slotsize();
   cu_trace_enabled = xrt::config::get_profile();
+  std::lock_guard<std::mutex> lk(s_device_mutex);
   s_device_exec_core.erase(xdev);
   s_device_exec_core.insert
     (std::make_pair
-     (xdev,std::make_unique<exec_core>(xdev,&s_global_scheduler,slots,amap)));
+     (xdev,std::make_unique<exec_core>(xdev,get_scheduler(xdev),slots,amap)));
 }
 
 void
@@ -890,12 +919,14 @@ init(xrt::device* xdev, const axlf* top)
   // create execution core for this device
   auto slots = ERT_CQ_SIZE / xrt::config::get_ert_slotsize();
   cu_trace_enabled = xrt::config::get_profile();
-  auto cuaddrs = xrt_core::xclbin::get_cus(top);
+  auto index = xrt_core::xclbin::load_index(xdev,top);
+  const auto& cuaddrs = index->cu_addrs();
   std::vector<addr_type> amap(cuaddrs.begin(),cuaddrs.end());
+  std::lock_guard<std::mutex> lk(s_device_mutex);
   s_device_exec_core.erase(xdev);
   s_device_exec_core.insert
     (std::make_pair
-     (xdev,std::make_unique<exec_core>(xdev,&s_global_scheduler,slots,amap)));
+     (xdev,std::make_unique<exec_core>(xdev,get_scheduler(xdev),slots,amap)));
 }
 
 }} // sws,xrt
@@ -133,6 +133,12 @@ typedef struct XmaFrame
     int32_t            is_last_frame; /**< flag indicating this is the last frame to encode */
 } XmaFrame;
 
+/**
+ * XmaFramePool - Opaque pool of frames that xma_frame_free() recycles
+ * instead of freeing
+*/
+typedef struct XmaFramePool XmaFramePool;
+
 /**
  * struct XmaDataBuffer - A structure describing a raw data buffer
 */
@@ -213,6 +219,54 @@ xma_frame_from_device_buffers(XmaFrameProperties *frame_props,
 void
 xma_frame_free(XmaFrame *frame);
 
+/**
+ * xma_frame_inc_ref() - Take another reference to a frame. Each reference
+ * is dropped with xma_frame_free(); the frame (or, for pooled frames, its
+ * return to the pool) happens when the last one is dropped. Safe to call
+ * from multiple threads, e.g. when a frame is shared by pipeline stages.
+ *
+ * @frame: frame to reference
+ *
+ * RETURN: reference count after incrementing it, XMA_ERROR_INVALID if
+ * frame is NULL
+*/
+int32_t
+xma_frame_inc_ref(XmaFrame *frame);
+
+/**
+ * xma_frame_pool_create() - Create a pool of host frames. Frames taken
+ * with xma_frame_pool_get() go back to the pool, planes and all, when
+ * their last reference is dropped with xma_frame_free().
+ *
+ * @frame_props: Description of the frames in the pool
+ * @max_frames: Maximum number of frames the pool hands out at a time
+ *
+ * RETURN: XmaFramePool pointer or NULL on failure
+*/
+XmaFramePool*
+xma_frame_pool_create(XmaFrameProperties *frame_props, int32_t max_frames);
+
+/**
+ * xma_frame_pool_get() - Take a frame from a pool, with a reference count
+ * of 1. Side data, pts and flags are cleared; plane contents are not.
+ *
+ * @pool: Pool created with xma_frame_pool_create() or
+ * xma_plg_frame_pool_create()
+ *
+ * RETURN: XmaFrame pointer, NULL when max_frames frames are in use
+*/
+XmaFrame*
+xma_frame_pool_get(XmaFramePool *pool);
+
+/**
+ * xma_frame_pool_destroy() - Destroy a frame pool. Frames still in use
+ * stay valid and are freed when their last reference is dropped.
+ *
+ * @pool: Pool to destroy
+*/
+void
+xma_frame_pool_destroy(XmaFramePool *pool);
+
 /**
  * xma_side_data_alloc() - Allocates side data handle, with
  * reference count equal to 1. The side data buffer 'side_data'
@@ -123,8 +123,8 @@ typedef struct XmaEncoderProperties
     XmaParameter    *params;
     /** count of custom parameters for port */
     uint32_t        param_cnt;
-    int32_t         dev_index;
-    int32_t         cu_index;
+    int32_t         dev_index;//XMA_AUTO_PLACEMENT to use the least loaded device with a matching CU
+    int32_t         cu_index;//XMA_AUTO_PLACEMENT to use the least loaded CU named (or of kernel) cu_name
     char            *cu_name;
     int32_t         ddr_bank_index;//Used for allocating device buffers. Used only if valid index is provide (>= 0); value of -1 imples that XMA should select automatically and then XMA will set it with bank index used automatically
     int32_t         channel_id;
@@ -17,6 +17,9 @@
 #ifndef _XMA_HW_H_
 #define _XMA_HW_H_
 
+#include <stdint.h>
+#include "app/xmalimits.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -31,9 +34,69 @@ typedef struct XmaHwSession
     uint32_t         dev_index;
     int32_t         bank_index;//default bank to use
     XmaHwKernel     *kernel_info;
-    uint32_t         reserved[4];
+    void            *private_do_not_use;//Work item queue of the session
+    uint32_t         reserved[2];
 } XmaHwSession;
 
+/**
+ * struct XmaCULoad - Load of one CU as used for automatic session placement
+ */
+typedef struct XmaCULoad
+{
+    int32_t     dev_index;
+    int32_t     cu_index;
+    char        cu_name[MAX_CU_NAME];
+    int32_t     num_sessions; /**< sessions created or being created on the CU */
+    int32_t     in_flight; /**< work items submitted and not yet completed */
+    uint64_t    completed; /**< work items completed since xma_initialize */
+    uint32_t    completion_rate; /**< work items completed per second recently */
+    int32_t     bank_index; /**< default DDR bank of the CU */
+    uint32_t    bank_used_pct; /**< occupancy of bank_index in percent; 0 if unknown */
+    uint32_t    load; /**< placement score; the lowest is picked */
+    uint32_t    reserved[4];
+} XmaCULoad;
+
+/**
+ * struct XmaLatencyHistogram - Latencies of completed work items
+ *
+ * bucket[0] counts latencies below 1 us and bucket[i] those below 2^i us;
+ * the last bucket also holds everything longer.
+ */
+typedef struct XmaLatencyHistogram
+{
+    uint64_t    count;
+    uint64_t    total_us;
+    uint64_t    max_us;
+    uint64_t    bucket[XMA_LATENCY_BUCKETS];
+} XmaLatencyHistogram;
+
+/**
+ * struct XmaPerfStats - Work item and buffer counters of a session or a CU
+ *
+ * Counted since the session was created or, for a CU, since its first
+ * session.  Work items are timed on the host: queue_wait is the time from
+ * submission until the CU finished the work item before it, exec the
+ * time from then until completion was seen.
+ */
+typedef struct XmaPerfStats
+{
+    int32_t     dev_index;
+    int32_t     cu_index;
+    char        cu_name[MAX_CU_NAME];
+    int32_t     session_id; /**< -1 for a CU */
+    int32_t     num_sessions; /**< sessions created on the CU; 1 for a session */
+    uint64_t    submitted; /**< work items submitted */
+    uint64_t    completed; /**< work items completed */
+    uint64_t    failed; /**< work items completed with an error */
+    uint64_t    in_flight; /**< work items submitted and not yet completed */
+    uint64_t    bytes_written; /**< moved to the device by xma_plg_buffer_write() */
+    uint64_t    bytes_read; /**< moved from the device by xma_plg_buffer_read() */
+    uint64_t    busy_us; /**< time with at least one work item in flight */
+    XmaLatencyHistogram queue_wait;
+    XmaLatencyHistogram exec;
+    uint32_t    reserved[8];
+} XmaPerfStats;
+
 
 #ifdef __cplusplus
 }
@@ -23,4 +23,9 @@
 #define MAX_VENDOR_NAME         256
 #define XMA_MAX_PLANES           3
 #define MAX_CONNECTION_ENTRIES  64
+#define MAX_CU_NAME             256
+//dev_index and/or cu_index of session properties: XMA picks the least loaded one
+#define XMA_AUTO_PLACEMENT      -2
+//log2 buckets of microseconds in XmaLatencyHistogram
+#define XMA_LATENCY_BUCKETS     24
 #endif
@@ -24,6 +24,9 @@
 //#include "lib/xmares.h"
 #include "lib/xmalogger.h"
 #include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 typedef struct XmaSingleton
@@ -52,6 +55,11 @@ typedef struct XmaSingleton
     //std::vector<XmaKernelPlugin*> kernels;
     //XmaResources      shm_res_cfg;
     //bool              shm_freed;
+    //Periodic dump of the CU counters; see xma_stats_dump()
+    std::thread       stats_thread;
+    std::mutex        stats_lock;
+    std::condition_variable stats_cv;
+    int32_t           stats_interval_ms;
     uint32_t          reserved[4];
 
   XmaSingleton() {
@@ -62,6 +70,7 @@ typedef struct XmaSingleton
     num_scalers = 0;
     num_filters = 0;
     num_kernels = 0;
+    stats_interval_ms = 0;
   }
 } XmaSingleton;
 
@@ -25,13 +25,22 @@
 #include "app/xmahw.h"
 #include "app/xmaparam.h"
 #include "plg/xmasess.h"
+#include "app/xmabuffers.h"
 #include "xrt.h"
+#include <algorithm>
 #include <atomic>
 #include <vector>
 #include <memory>
 #include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 
-#define MIN_EXECBO_POOL_SIZE      16
+#define MIN_EXECBO_POOL_SIZE      16//execBOs per CU regardless of the number of sessions
+#define EXECBO_POOL_PER_SESSION   4
+#define MAX_EXECBO_PER_CU         128//Power of 2; size of per CU free list and in-flight FIFO
+#define WORK_ITEM_RING_SIZE       16//Power of 2; work items of a session that can be reported on
+#define MAX_CACHED_BUFFERS        32//Freed device buffers kept per session for reuse
 #define MAX_EXECBO_BUFF_SIZE      4096// 4KB
 #define MAX_KERNEL_REGMAP_SIZE    4032//Some space used by ert pkt
 #define MAX_REGMAP_ENTRIES        1024//Int32 entries; So 4B x 1024 = 4K Bytes
@@ -50,6 +59,8 @@
  */
 constexpr std::uint64_t signature = 0xF42F1F8F4F2F1F0F;
 
+typedef struct XmaHwBufferPool XmaHwBufferPool;
+
 typedef struct XmaBufferObjPrivate
 {
     void*    dummy;
@@ -60,6 +71,8 @@ typedef struct XmaBufferObjPrivate
     uint64_t boHandle;
     bool     device_only_buffer;
     xclDeviceHandle dev_handle;
+    uint8_t* data;//Host mapping; NULL for device only buffers
+    XmaHwBufferPool* pool;//Pool the buffer goes back to when freed
     uint32_t reserved[4];
 
   XmaBufferObjPrivate() {
@@ -70,9 +83,360 @@ typedef struct XmaBufferObjPrivate
    dev_handle = NULL;
    device_only_buffer = false;
    boHandle = 0;
+   data = NULL;
+   pool = NULL;
   }
 } XmaBufferObjPrivate;
 
+/**
+ * Device buffers of one session that are recycled instead of freed
+ *
+ * Freed buffers are cached by bank, size and type; alloc takes a cached
+ * one before asking XRT for a new BO.  Buffers may be freed from any
+ * thread, including after the session is gone (e.g. frames handed to
+ * the next stage of a pipeline), so the pool is reference counted by its
+ * session and every buffer it handed out.
+ */
+typedef struct XmaHwBufferPool
+{
+    std::mutex      lock;
+    xclDeviceHandle dev_handle;
+    int32_t         dev_index;
+    int32_t         refs;
+    bool            closed;
+    std::vector<XmaBufferObjPrivate*> cached;
+
+  XmaHwBufferPool(xclDeviceHandle handle, int32_t index) {
+    dev_handle = handle;
+    dev_index = index;
+    refs = 1;
+    closed = false;
+  }
+
+  //Returns NULL if XRT could not allocate the buffer
+  XmaBufferObjPrivate* acquire(uint64_t size, int32_t bank, bool device_only) {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        refs++;
+        for (auto itr = cached.begin(); itr != cached.end(); itr++) {
+            XmaBufferObjPrivate* priv = *itr;
+            if (priv->size == size && priv->bank_index == bank && priv->device_only_buffer == device_only) {
+                cached.erase(itr);
+                priv->dummy = (void*)(((uint64_t)priv) | signature);
+                return priv;
+            }
+        }
+    }
+    uint64_t bo_handle = xclAllocBO(dev_handle, size, 0, device_only ? (XCL_BO_FLAGS_DEV_ONLY | bank) : bank);
+    if (bo_handle == NULLBO) {
+        release_ref();
+        return NULL;
+    }
+    XmaBufferObjPrivate* priv = new XmaBufferObjPrivate;
+    priv->dummy = (void*)(((uint64_t)priv) | signature);
+    priv->size = size;
+    priv->paddr = xclGetDeviceAddr(dev_handle, bo_handle);
+    priv->bank_index = bank;
+    priv->dev_index = dev_index;
+    priv->boHandle = bo_handle;
+    priv->device_only_buffer = device_only;
+    priv->dev_handle = dev_handle;
+    if (!device_only)
+        priv->data = (uint8_t*) xclMapBO(dev_handle, bo_handle, true);
+    priv->pool = this;
+    return priv;
+  }
+
+  //Cache a buffer that is no longer used; frees it once the session is gone
+  void release(XmaBufferObjPrivate* priv) {
+    priv->dummy = NULL;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (!closed && cached.size() < MAX_CACHED_BUFFERS) {
+            cached.push_back(priv);
+            priv = NULL;
+        }
+    }
+    if (priv) {
+        xclFreeBO(dev_handle, priv->boHandle);
+        delete priv;
+    }
+    release_ref();
+  }
+
+  //Called when the owning session is destroyed
+  void close() {
+    std::vector<XmaBufferObjPrivate*> to_free;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        closed = true;
+        to_free.swap(cached);
+    }
+    for (auto priv : to_free) {
+        xclFreeBO(dev_handle, priv->boHandle);
+        delete priv;
+    }
+    release_ref();
+  }
+
+  void add_ref() {
+    std::lock_guard<std::mutex> guard(lock);
+    refs++;
+  }
+
+  void release_ref() {
+    bool last;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        last = (--refs == 0);
+    }
+    if (last)
+        delete this;
+  }
+} XmaHwBufferPool;
+
+/**
+ * Latency histogram updated without locks; see XmaLatencyHistogram
+ */
+typedef struct XmaHwLatency
+{
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> total_ns;
+    std::atomic<uint64_t> max_ns;
+    std::atomic<uint64_t> bucket[XMA_LATENCY_BUCKETS];
+
+  XmaHwLatency(): count(0), total_ns(0), max_ns(0) {
+    for (uint32_t i = 0; i < XMA_LATENCY_BUCKETS; i++)
+        bucket[i] = 0;
+  }
+
+  void add(uint64_t ns) {
+    uint64_t us = ns / 1000;
+    uint32_t b = us ? 64 - __builtin_clzll(us) : 0;
+    if (b >= XMA_LATENCY_BUCKETS)
+        b = XMA_LATENCY_BUCKETS - 1;
+    bucket[b].fetch_add(1, std::memory_order_relaxed);
+    total_ns.fetch_add(ns, std::memory_order_relaxed);
+    uint64_t max = max_ns.load(std::memory_order_relaxed);
+    while (ns > max && !max_ns.compare_exchange_weak(max, ns, std::memory_order_relaxed))
+        ;
+    count.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void get(XmaLatencyHistogram *hist) const {
+    hist->count = count.load(std::memory_order_relaxed);
+    hist->total_us = total_ns.load(std::memory_order_relaxed) / 1000;
+    hist->max_us = max_ns.load(std::memory_order_relaxed) / 1000;
+    for (uint32_t i = 0; i < XMA_LATENCY_BUCKETS; i++)
+        hist->bucket[i] = bucket[i].load(std::memory_order_relaxed);
+  }
+} XmaHwLatency;
+
+/**
+ * Performance counters of a session or a CU; see XmaPerfStats
+ *
+ * Updated with relaxed atomics from whichever thread submits or retires
+ * a work item, so readers may see counters a few work items apart.
+ */
+typedef struct XmaHwStats
+{
+    std::atomic<uint64_t> submitted;
+    std::atomic<uint64_t> completed;
+    std::atomic<uint64_t> failed;
+    std::atomic<uint64_t> bytes_written;
+    std::atomic<uint64_t> bytes_read;
+    XmaHwLatency          queue_wait;
+    XmaHwLatency          exec;
+    //Union of the submit to done intervals; dataflow CUs overlap work items
+    std::atomic<uint64_t> busy_ns;
+    std::atomic<uint64_t> busy_until_ns;
+
+  XmaHwStats(): submitted(0), completed(0), failed(0), bytes_written(0), bytes_read(0),
+                busy_ns(0), busy_until_ns(0) {}
+
+  //Intervals arrive in order of their end, so only the part after the
+  //latest end seen so far is new busy time
+  void add_busy(uint64_t start, uint64_t end) {
+    uint64_t until = busy_until_ns.load(std::memory_order_relaxed);
+    while (until < end && !busy_until_ns.compare_exchange_weak(until, end, std::memory_order_relaxed))
+        ;
+    if (until >= end)
+        return;
+    busy_ns.fetch_add(end - std::max(start, until), std::memory_order_relaxed);
+  }
+
+  void get(XmaPerfStats *stats) const {
+    stats->submitted = submitted.load(std::memory_order_relaxed);
+    stats->completed = completed.load(std::memory_order_relaxed);
+    stats->failed = failed.load(std::memory_order_relaxed);
+    uint64_t done = stats->completed + stats->failed;
+    stats->in_flight = stats->submitted > done ? stats->submitted - done : 0;
+    stats->bytes_written = bytes_written.load(std::memory_order_relaxed);
+    stats->bytes_read = bytes_read.load(std::memory_order_relaxed);
+    queue_wait.get(&stats->queue_wait);
+    exec.get(&stats->exec);
+    stats->busy_us = busy_ns.load(std::memory_order_relaxed) / 1000;
+  }
+} XmaHwStats;
+
+/**
+ * Per CU pool of execBOs
+ *
+ * Slots are handed out from a bounded lock free free-list and, once
+ * submitted, tracked in an in-flight FIFO in submission order.  Any
+ * session on the CU may retire completed slots; only the session
+ * holding the CU regmap lock submits, so the FIFO has a single producer.
+ * Slots are only ever added (under the CU session lock at session
+ * creation) and never removed, so bo_handle/bo_data need no lock.
+ */
+typedef struct XmaHwExecBOPool
+{
+    //SLOT_TRACKED slots are owned by a session queue and never in the FIFO
+    enum : uint8_t { SLOT_FREE = 0, SLOT_SUBMITTED, SLOT_RETIRED, SLOT_TRACKED };
+
+    struct FreeCell {
+        std::atomic<uint64_t> seq;
+        int32_t               slot;
+    };
+
+    uint32_t              bo_handle[MAX_EXECBO_PER_CU];
+    char*                 bo_data[MAX_EXECBO_PER_CU];//execBO size is 4096 in xmahw_hal.cpp
+    std::atomic<uint8_t>  slot_state[MAX_EXECBO_PER_CU];
+    std::atomic<int32_t>  num_slots;
+    int32_t               num_sessions;
+
+    FreeCell              free_list[MAX_EXECBO_PER_CU];
+    std::atomic<uint64_t> free_head;
+    std::atomic<uint64_t> free_tail;
+
+    int32_t               inflight[MAX_EXECBO_PER_CU];
+    std::atomic<uint64_t> inflight_head;
+    std::atomic<uint64_t> inflight_tail;
+
+    //Completed work items not yet reported by xma_plg_is_work_item_done
+    std::atomic<int32_t>  complete_count;
+    //All completed work items; sampled for placement under the CU session lock
+    std::atomic<uint64_t> completed_total;
+    uint64_t              sample_completed;
+    uint64_t              sample_time_ns;
+    uint32_t              completion_rate;
+
+    //Submission time of the work item in each slot and last completion seen
+    uint64_t              submit_ns[MAX_EXECBO_PER_CU];
+    std::atomic<uint64_t> last_done_ns;
+    XmaHwStats            stats;
+
+    //SLOT_TRACKED slots of destroyed sessions whose work items had not
+    //finished; returned to the free list once the CU is done with them
+    std::mutex            orphan_lock;
+    int32_t               orphaned[MAX_EXECBO_PER_CU];
+    std::atomic<int32_t>  num_orphaned;//Written under orphan_lock
+
+  XmaHwExecBOPool(): num_slots(0), num_sessions(0), free_head(0), free_tail(0),
+                     inflight_head(0), inflight_tail(0), complete_count(0),
+                     completed_total(0), sample_completed(0), sample_time_ns(0),
+                     completion_rate(0), last_done_ns(0), num_orphaned(0) {
+    for (uint32_t i = 0; i < MAX_EXECBO_PER_CU; i++) {
+        bo_handle[i] = 0;
+        bo_data[i] = NULL;
+        slot_state[i] = SLOT_FREE;
+        free_list[i].seq = i;
+        free_list[i].slot = -1;
+        inflight[i] = -1;
+        submit_ns[i] = 0;
+        orphaned[i] = -1;
+    }
+  }
+
+  void orphan_push(int32_t slot) {
+    std::lock_guard<std::mutex> guard(orphan_lock);
+    int32_t count = num_orphaned.load(std::memory_order_relaxed);
+    orphaned[count] = slot;
+    num_orphaned.store(count + 1, std::memory_order_release);
+  }
+
+  bool free_push(int32_t slot) {
+    uint64_t pos = free_tail.load(std::memory_order_relaxed);
+    FreeCell* cell;
+    for (;;) {
+        cell = &free_list[pos & (MAX_EXECBO_PER_CU - 1)];
+        uint64_t seq = cell->seq.load(std::memory_order_acquire);
+        int64_t diff = (int64_t)seq - (int64_t)pos;
+        if (diff == 0) {
+            if (free_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = free_tail.load(std::memory_order_relaxed);
+        }
+    }
+    cell->slot = slot;
+    cell->seq.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  int32_t free_pop() {
+    uint64_t pos = free_head.load(std::memory_order_relaxed);
+    FreeCell* cell;
+    for (;;) {
+        cell = &free_list[pos & (MAX_EXECBO_PER_CU - 1)];
+        uint64_t seq = cell->seq.load(std::memory_order_acquire);
+        int64_t diff = (int64_t)seq - (int64_t)(pos + 1);
+        if (diff == 0) {
+            if (free_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        } else if (diff < 0) {
+            return -1;
+        } else {
+            pos = free_head.load(std::memory_order_relaxed);
+        }
+    }
+    int32_t slot = cell->slot;
+    cell->seq.store(pos + MAX_EXECBO_PER_CU, std::memory_order_release);
+    return slot;
+  }
+
+  //Caller holds the CU regmap lock
+  void inflight_push(int32_t slot) {
+    uint64_t pos = inflight_tail.load(std::memory_order_relaxed);
+    slot_state[slot].store(SLOT_SUBMITTED, std::memory_order_release);
+    inflight[pos & (MAX_EXECBO_PER_CU - 1)] = slot;
+    inflight_tail.store(pos + 1, std::memory_order_release);
+  }
+} XmaHwExecBOPool;
+
+/**
+ * XMA private state of a session, reached through
+ * XmaHwSession::private_do_not_use
+ *
+ * Work items submitted with xma_plg_submit_work_item(): ids are positions
+ * in the ring; head..tail are in flight and the status of retired ones is
+ * kept until the ring wraps.  A session is used from one thread at a time
+ * so the queue needs no locking.
+ */
+typedef struct XmaHwSessionPrivate
+{
+    XmaHwBufferPool *buffer_pool;
+    int32_t     depth;
+    uint64_t    head;//Oldest work item not yet retired
+    uint64_t    tail;//Id of the next work item
+    int32_t     slot[WORK_ITEM_RING_SIZE];
+    int32_t     status[WORK_ITEM_RING_SIZE];
+    XmaHwStats  stats;
+
+  XmaHwSessionPrivate() {
+    buffer_pool = NULL;
+    depth = 1;
+    head = 0;
+    tail = 0;
+    for (uint32_t i = 0; i < WORK_ITEM_RING_SIZE; i++) {
+        slot[i] = -1;
+        status[i] = 0;
+    }
+  }
+} XmaHwSessionPrivate;
+
 typedef struct XmaHwKernel
 {
     uint8_t     name[MAX_KERNEL_NAME];
@@ -89,9 +453,12 @@ typedef struct XmaHwKernel
     uint32_t    cu_mask2;
     uint32_t    cu_mask3;
     int32_t    regmap_max;
-    //For execbo:
-    int32_t     kernel_complete_count;
-    //std::unique_ptr<std::atomic<bool>> kernel_complete_locked;
+    //For execbo: created on first session with this CU
+    std::unique_ptr<XmaHwExecBOPool> execbo_pool;
+    //Guards execbo_pool growth, its session count and load samples
+    std::unique_ptr<std::mutex> session_lock;
+    //Sessions placed on the CU and not yet attached; under session_lock
+    int32_t     reserved_sessions;
 
     uint32_t    reg_map[MAX_REGMAP_ENTRIES];//4KB = 4B x 1024; Supported Max regmap of 4032 Bytes only in xmaplugin.cpp; execBO size is 4096 = 4KB in xmahw_hal.cpp
     //pthread_mutex_t *lock;
@@ -106,7 +473,7 @@ typedef struct XmaHwKernel
     //bool             have_lock;
     uint32_t    reserved[16];
 
-  XmaHwKernel(): reg_map_locked(new std::atomic<bool>) {
+  XmaHwKernel(): session_lock(new std::mutex), reg_map_locked(new std::atomic<bool>) {
     in_use = false;
     cu_index = -1;
     regmap_max = -1;
@@ -116,10 +483,10 @@ typedef struct XmaHwKernel
     cu_mask1 = 0;
     cu_mask2 = 0;
     cu_mask3 = 0;
-    kernel_complete_count = 0;
     soft_kernel = false;
     kernel_channels = false;
     max_channel_id = 0;
+    reserved_sessions = 0;
     //*kernel_complete_locked = false;
     *reg_map_locked = false;
     locked_by_session_id = -100;
@@ -127,6 +494,33 @@ typedef struct XmaHwKernel
   }
 } XmaHwKernel;
 
+/**
+ * Placement reservation of a session on a CU; dropped when it goes
+ * out of scope unless released before
+ */
+typedef struct XmaHwReservation
+{
+    XmaHwKernel *kernel;
+
+  XmaHwReservation(): kernel(NULL) {}
+  ~XmaHwReservation() { release(); }
+  XmaHwReservation(const XmaHwReservation&) = delete;
+  XmaHwReservation& operator=(const XmaHwReservation&) = delete;
+
+  void reserve(XmaHwKernel *cu) {
+    release();
+    kernel = cu;
+  }
+
+  void release() {
+    if (kernel == NULL)
+        return;
+    std::lock_guard<std::mutex> guard(*kernel->session_lock);
+    kernel->reserved_sessions--;
+    kernel = NULL;
+  }
+} XmaHwReservation;
+
 typedef struct XmaHwDevice
 {
     //char        dsa[MAX_DSA_NAME];
@@ -140,21 +534,16 @@ typedef struct XmaHwDevice
     //bool        in_use;
     //XmaHwKernel kernels[MAX_KERNEL_CONFIGS];
     std::vector<XmaHwKernel> kernels;
+    //CU name -> index in kernels; built once in xma_initialize
+    std::unordered_map<std::string, int32_t> cu_index_by_name;
 
-    std::unique_ptr<std::atomic<bool>> execbo_locked;
-    std::vector<uint32_t> kernel_execbo_handle;
-    std::vector<char*> kernel_execbo_data;//execBO size is 4096 in xmahw_hal.cpp
-    std::vector<bool> kernel_execbo_inuse;
-    std::vector<int32_t> kernel_execbo_cu_index;
-    int32_t    num_execbo_allocated;
+    //execBOs are allocated per CU; see XmaHwExecBOPool
 
-  XmaHwDevice(): execbo_locked(new std::atomic<bool>) {
+  XmaHwDevice() {
     //in_use = false;
     dev_index = -1;
     number_of_cus = 0;
-    *execbo_locked = false;
     number_of_mem_banks = 0;
-    num_execbo_allocated = -1;
     handle = NULL;
   }
 } XmaHwDevice;
@@ -232,6 +621,133 @@ bool xma_hw_configure(XmaHwCfg *hwcfg, XmaSystemCfg *systemcfg, bool hw_cfg_stat
  */
 bool xma_hw_configure(XmaHwCfg *hwcfg, XmaXclbinParameter *devXclbins, int32_t num_parms);
 
+/**
+ *  @brief Account for a session on a CU and size its execBO pool
+ *
+ *  Grows the per CU execBO pool to EXECBO_POOL_PER_SESSION slots
+ *  per session using the CU, at least MIN_EXECBO_POOL_SIZE and at
+ *  most MAX_EXECBO_PER_CU, and creates the work item queue and
+ *  device buffer pool of the session.  The execBO pool never
+ *  shrinks as slots may still be in flight.
+ *  Takes the session lock of the CU; sessions on other CUs are
+ *  created in parallel.
+ *
+ *  @param session   Session with hw_session filled in
+ *
+ *  @return          XMA_SUCCESS on success
+ *                   XMA_ERROR on failure
+ */
+int32_t xma_hw_session_attach(XmaSession *session);
+
+/**
+ *  @brief Release a session's share of the CU execBO pool
+ *
+ *  Waits briefly for work items the session still has in flight
+ *  and frees its work item queue.  execBOs of work items that are
+ *  still running are handed to the CU pool, which frees them on a
+ *  later allocation or completion check once the CU is done with
+ *  them.  Device buffers still held by the application stay valid
+ *  until they are freed.
+ *  Takes the session lock of the CU after draining.
+ *
+ *  @param session   Session being destroyed
+ */
+void xma_hw_session_detach(XmaSession *session);
+
+/**
+ *  @brief Create a frame pool with planes in device buffers
+ *
+ *  Backs xma_plg_frame_pool_create(); planes come from the
+ *  buffer pool of the plugin session.
+ *
+ *  @param frame_props  Description of the frames in the pool
+ *  @param max_frames   Maximum number of frames handed out at a time
+ *  @param buffer_pool  Buffer pool of the session
+ *  @param bank_index   DDR bank of the planes
+ *  @param device_only  Planes have no host mapping
+ *
+ *  @return          XmaFramePool pointer or NULL on failure
+ */
+XmaFramePool* xma_frame_pool_create_on_device(XmaFrameProperties *frame_props, int32_t max_frames,
+                                              XmaHwBufferPool *buffer_pool, int32_t bank_index,
+                                              bool device_only);
+
+/**
+ *  @brief Pick the least loaded CU for a session
+ *
+ *  Candidates are the CUs whose name or kernel name is cu_name, on
+ *  device dev_index unless that is XMA_AUTO_PLACEMENT, with index
+ *  cu_index unless that is XMA_AUTO_PLACEMENT, connected to
+ *  ddr_bank_index if that is set and accepting channel_id.
+ *  Each CU is sampled and reserved in one step under its session
+ *  lock, and reservations count as sessions, so that sessions
+ *  placed at the same time spread over the CUs.  The reservation
+ *  of the CU picked is held by reservation until it is released,
+ *  once the session is attached or creating it failed.
+ *
+ *  @param hwcfg          Configured hardware
+ *  @param dev_index      In: device or XMA_AUTO_PLACEMENT; out: device picked
+ *  @param cu_index       In: CU or XMA_AUTO_PLACEMENT; out: CU picked
+ *  @param cu_name        CU or kernel name the plugin drives
+ *  @param ddr_bank_index Required DDR bank or -1
+ *  @param channel_id     Channel of the session
+ *  @param reservation    Holds the reservation of the CU picked
+ *
+ *  @return          XMA_SUCCESS on success
+ *                   XMA_ERROR if no CU matches
+ */
+int32_t xma_hw_place_session(XmaHwCfg *hwcfg, int32_t *dev_index, int32_t *cu_index,
+                             const char *cu_name, int32_t ddr_bank_index, int32_t channel_id,
+                             XmaHwReservation *reservation);
+
+/**
+ *  @brief Fill the load table returned by xma_get_cu_load()
+ *
+ *
+ *  @return          Number of CUs
+ */
+int32_t xma_hw_cu_load(XmaHwCfg *hwcfg, XmaCULoad *table, int32_t max_entries);
+
+/**
+ *  @brief Fill the table returned by xma_get_cu_stats()
+ *
+ *
+ *  @return          Number of CUs
+ */
+int32_t xma_hw_cu_stats(XmaHwCfg *hwcfg, XmaPerfStats *table, int32_t max_entries);
+
+/**
+ *  @brief Snapshot the counters of a session for xma_get_session_stats()
+ *
+ *  @param session   Session attached with xma_hw_session_attach()
+ *  @param stats     Filled with the counters of the session
+ *
+ *  @return          XMA_SUCCESS or XMA_ERROR if the session is not attached
+ */
+int32_t xma_hw_session_stats(XmaSession *session, XmaPerfStats *stats);
+
+/**
+ *  @brief Make the device planes of a frame usable by a session
+ *
+ *  Planes in a device buffer the CU of the session can reach are
+ *  passed as is.  Other device planes are copied into buffers from
+ *  the session buffer pool: device to device (P2P across devices)
+ *  when possible, through host memory otherwise.  Host planes are
+ *  shared with the original frame.
+ *
+ *  @param session   Session the frame is sent to
+ *  @param frame     Frame from the application
+ *  @param staged    Set to frame, or to a new frame with a reference
+ *                   count of 1 that holds a reference to frame.  The
+ *                   caller drops it with xma_frame_free() once the
+ *                   plugin returns; a plugin that keeps the frame takes
+ *                   its own reference with xma_frame_inc_ref()
+ *
+ *  @return          XMA_SUCCESS on success
+ *                   XMA_ERROR on failure
+ */
+int32_t xma_frame_stage_for_session(XmaSession *session, XmaFrame *frame, XmaFrame **staged);
+
 /**
  *  @}
  */
@@ -35,6 +35,13 @@
 #define XMA_MAX_LOGMSG_SIZE          255
 #define XMA_MAX_LOGMSG_Q_ENTRIES     128
 
+/* Warning messages a module may log per window;
+ * the rest are counted and reported once the window closes
+ */
+#define XMA_LOGMSG_RATE_LIMIT        20
+#define XMA_LOGMSG_RATE_WINDOW_MS    1000
+#define XMA_MAX_LOG_MODULES          64
+
 //#ifdef __cplusplus
 //extern "C" {
 //#endif
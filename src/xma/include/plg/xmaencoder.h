@@ -60,7 +60,9 @@ typedef struct XmaEncoderPlugin
     size_t          plugin_data_size;
     /** Initalization callback.  Called during session_create() */
     int32_t         (*init)(XmaEncoderSession *enc_session);
-    /** Callback called when application calls xma_enc_send_frame() */
+    /** Callback called when application calls xma_enc_send_frame().
+     *  A plugin that uses frame after returning takes a reference with
+     *  xma_frame_inc_ref() and drops it with xma_frame_free() */
     int32_t         (*send_frame)(XmaEncoderSession *enc_session,
                                   XmaFrame          *frame);
     /** Callback called when application calls xma_enc_recv_data() */
@@ -37,7 +37,9 @@ typedef struct XmaFilterPlugin
     size_t          plugin_data_size; /**< session-specific private data */
     /** init callback used to perpare kernel and allocate device buffers */
     int32_t         (*init)(XmaFilterSession *session);
-    /** Callback called when application calls xma_filter_send_frame() */
+    /** Callback called when application calls xma_filter_send_frame().
+     *  A plugin that uses frame after returning takes a reference with
+     *  xma_frame_inc_ref() and drops it with xma_frame_free() */
     int32_t         (*send_frame)(XmaFilterSession  *session,
                                   XmaFrame         *frame);
     /** Callback called when application calls xma_filter_recv_data() */
@@ -43,7 +43,9 @@ typedef struct XmaScalerPlugin
     size_t          plugin_data_size; /**< plugin session private data size */
      /** callback to initalize kernel and kernel buffers*/
     int32_t         (*init)(XmaScalerSession *session);
-    /** callback to process input frame from client */
+    /** callback to process input frame from client.  A plugin that uses
+     *  frame after returning takes a reference with xma_frame_inc_ref()
+     *  and drops it with xma_frame_free() */
     int32_t         (*send_frame)(XmaScalerSession  *session,
                                   XmaFrame         *frame);
     /** callback to send output data to client */
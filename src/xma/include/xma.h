@@ -23,6 +23,7 @@
 #include "app/xmadecoder.h"
 #include "app/xmaencoder.h"
 #include "app/xmaerror.h"
+#include "app/xmahw.h"
 #include "app/xmascaler.h"
 #include "app/xmafilter.h"
 #include "app/xmakernel.h"
@@ -30,6 +31,9 @@
 #ifdef __cplusplus
 extern "C" {
 #endif
+
+struct XmaSession;
+
 /**
  * DOC: XMA Application Interface
  * The interface used by stand-alone XMA applications or plugins
@@ -51,6 +55,70 @@ extern "C" {
 */
 int32_t xma_initialize(XmaXclbinParameter *devXclbins, int32_t num_parms);
 
+/**
+ *  xma_get_cu_load() - Snapshot of the load of every CU
+ *
+ *  Sessions created with dev_index and/or cu_index set to XMA_AUTO_PLACEMENT
+ *  are placed on the CU with the lowest load among those matching cu_name,
+ *  the requested device, DDR bank and channel_id.  The load grows with
+ *  the sessions on the CU, its work items in flight, its recent completion
+ *  rate and the occupancy of its DDR bank.
+ *
+ *  @table: array filled with one entry per CU
+ *
+ *  @max_entries: number of elements in above array
+ *
+ * RETURN: number of CUs on success (may be more than max_entries)
+ *         XMA_ERROR_INVALID if XMA is not initialized
+ *
+*/
+int32_t xma_get_cu_load(XmaCULoad *table, int32_t max_entries);
+
+/**
+ *  xma_get_cu_stats() - Snapshot of the performance counters of every CU
+ *
+ *  Counters are updated without locks as work items are submitted and
+ *  retired and as buffers are moved, so the entries of a snapshot may be
+ *  a few work items apart.
+ *
+ *  @table: array filled with one entry per CU
+ *
+ *  @max_entries: number of elements in above array
+ *
+ * RETURN: number of CUs on success (may be more than max_entries)
+ *         XMA_ERROR_INVALID if XMA is not initialized
+ *
+*/
+int32_t xma_get_cu_stats(XmaPerfStats *table, int32_t max_entries);
+
+/**
+ *  xma_get_session_stats() - Snapshot of the performance counters of a session
+ *
+ *  Work items scheduled with xma_plg_schedule_work_item() are only timed
+ *  per CU, as any session on the CU may retire them.
+ *
+ *  @session: base of the session, e.g. &enc_session->base
+ *
+ *  @stats: filled with the counters of the session
+ *
+ * RETURN: XMA_SUCCESS or XMA_ERROR
+ *
+*/
+int32_t xma_get_session_stats(struct XmaSession *session, XmaPerfStats *stats);
+
+/**
+ *  xma_stats_dump() - Periodically log the counters of busy CUs
+ *
+ *  Every interval_ms the counters of each CU that has seen work are logged
+ *  at info level, with its busy time over the interval.
+ *
+ *  @interval_ms: dump period; 0 stops the dump
+ *
+ * RETURN: XMA_SUCCESS or XMA_ERROR_INVALID
+ *
+*/
+int32_t xma_stats_dump(int32_t interval_ms);
+
 #ifdef __cplusplus
 }
 #endif
@@ -42,6 +42,27 @@
 extern "C" {
 #endif
 
+/**
+ * DOC:
+ * @def @XMA_MAX_WORK_ITEM_DEPTH - Maximum number of work items a session may
+ * have in flight with xma_plg_submit_work_item()
+*/
+#define XMA_MAX_WORK_ITEM_DEPTH 4
+
+/**
+ * typedef struct XmaWorkItem - Handle to a work item submitted with
+ * xma_plg_submit_work_item()
+ *
+ * @id:       Submission sequence number of the work item within its session
+ * @cu_index: CU executing the work item
+*/
+typedef struct XmaWorkItem
+{
+    uint64_t id;
+    int32_t  cu_index;
+    uint32_t reserved[4];
+} XmaWorkItem;
+
 /**
  *  xma_plg_buffer_alloc)() - Allocate device memory
  *  This function allocates memory on the FPGA DDR and
@@ -97,6 +118,9 @@ XmaBufferObj xma_plg_buffer_alloc_arg_num(XmaSession s_handle, size_t size, bool
  *  xma_plg_buffer_free() - Free a device buffer
  *  This function frees a previous allocated buffer that was obtained
  *  using the @ref xma_plg_buffer_alloc() function.
+ *  Freed buffers are kept by the session and handed out again by
+ *  later allocations of the same size, bank and type; they are
+ *  returned to XRT when the session is destroyed.
  *
  *  @s_handle:  The session handle associated with this plugin instance
  *  @b_obj:  The BufferObject returned from
@@ -105,6 +129,29 @@ XmaBufferObj xma_plg_buffer_alloc_arg_num(XmaSession s_handle, size_t size, bool
  */
 void xma_plg_buffer_free(XmaSession s_handle, XmaBufferObj b_obj);
 
+/**
+ *  xma_plg_frame_pool_create() - Create a pool of frames whose planes are
+ *  device buffers on the default DDR bank of this session.  Frames are taken
+ *  with xma_frame_pool_get() and go back to the pool, device buffers and all,
+ *  when their last reference is dropped with xma_frame_free(), so a plugin
+ *  can hand frames to the next stage without allocating per frame.  Planes
+ *  of pooled frames are owned by the pool and must not be freed on their own.
+ *  Destroy the pool with xma_frame_pool_destroy(); frames still in use remain
+ *  valid, even after this session is destroyed.
+ *
+ *  @s_handle:    The session handle associated with this plugin instance
+ *  @frame_props: Description of the frames in the pool
+ *  @max_frames:  Maximum number of frames the pool hands out at a time
+ *  @device_only_buffer: Planes have no host mapping
+ *
+ *  RETURN:       XmaFramePool pointer or NULL on failure
+ *
+ */
+XmaFramePool* xma_plg_frame_pool_create(XmaSession s_handle,
+                                        XmaFrameProperties *frame_props,
+                                        int32_t max_frames,
+                                        bool device_only_buffer);
+
 /**
  *  xma_plg_buffer_write() - Write data from host to device buffer
  *  This function copies data from host memory to device memory.
@@ -187,6 +234,65 @@ int32_t xma_plg_schedule_work_item(XmaSession s_handle);
  */
 int32_t xma_plg_is_work_item_done(XmaSession s_handle, int32_t timeout_in_ms);
 
+/**
+ * xma_plg_work_item_depth() - Set how many work items this session may have
+ * in flight with xma_plg_submit_work_item().  A depth of two or more lets a
+ * plugin transfer the data of frame N+1 while the CU computes frame N.
+ * The default depth is 1.  Should be called from the plugin init() function.
+ *
+ * @s_handle: The session handle associated with this plugin instance
+ * @depth:    Maximum number of outstanding work items; 1 to
+ *            XMA_MAX_WORK_ITEM_DEPTH
+ *
+ * RETURN:    XMA_SUCCESS on success
+ *
+ * XMA_ERROR_INVALID if depth is out of range
+ *
+ */
+int32_t xma_plg_work_item_depth(XmaSession s_handle, int32_t depth);
+
+/**
+ * xma_plg_submit_work_item() - Same as xma_plg_schedule_work_item() but the
+ * work item is tracked by this session and a handle to it is returned.
+ * Completion of tracked work items is reported per handle by
+ * xma_plg_wait_work_item() and never by xma_plg_is_work_item_done(); a
+ * session should use one scheme or the other.
+ *
+ * @s_handle:  The session handle associated with this plugin instance
+ * @work_item: Filled with the handle of the submitted work item
+ *
+ * RETURN:     XMA_SUCCESS on success
+ *
+ * XMA_TRY_AGAIN if the session already has depth work items in flight, or
+ * if every execBO of the CU is in use by other sessions; wait for the oldest
+ * work item of the session, if any, and submit again
+ *
+ * XMA_ERROR on failure
+ *
+ */
+int32_t xma_plg_submit_work_item(XmaSession s_handle, XmaWorkItem *work_item);
+
+/**
+ * xma_plg_wait_work_item() - Wait for a work item submitted with
+ * xma_plg_submit_work_item() to complete.  Work items of a session complete
+ * in submission order, so every earlier work item of the session is retired
+ * as well.
+ *
+ * @s_handle:      The session handle associated with this plugin instance
+ * @work_item:     Handle returned by xma_plg_submit_work_item()
+ * @timeout_in_ms: A timeout value in milliseconds; 0 only polls
+ *
+ * RETURN:         XMA_SUCCESS if the work item completed
+ *
+ * XMA_ERROR_TIMEOUT if it is still running when the timeout expires
+ *
+ * XMA_ERROR if the work item failed
+ *
+ * XMA_ERROR_INVALID if the handle is unknown or too old to report on
+ *
+ */
+int32_t xma_plg_wait_work_item(XmaSession s_handle, XmaWorkItem work_item, int32_t timeout_in_ms);
+
 /**
  * xma_plg_kernel_lock_regmap() - This function acquires register map lock
  * so that prep_write & schedule_work_items can be called
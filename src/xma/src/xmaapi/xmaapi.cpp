@@ -192,8 +192,104 @@ int32_t xma_initialize(XmaXclbinParameter *devXclbins, int32_t num_parms)
     return XMA_SUCCESS;
 }
 
+int32_t xma_get_cu_load(XmaCULoad *table, int32_t max_entries)
+{
+    if (g_xma_singleton == NULL || !g_xma_singleton->xma_initialized)
+        return XMA_ERROR_INVALID;
+    if (table == NULL)
+        max_entries = 0;
+
+    return xma_hw_cu_load(&g_xma_singleton->hwcfg, table, max_entries);
+}
+
+int32_t xma_get_cu_stats(XmaPerfStats *table, int32_t max_entries)
+{
+    if (g_xma_singleton == NULL || !g_xma_singleton->xma_initialized)
+        return XMA_ERROR_INVALID;
+    if (table == NULL)
+        max_entries = 0;
+
+    return xma_hw_cu_stats(&g_xma_singleton->hwcfg, table, max_entries);
+}
+
+int32_t xma_get_session_stats(XmaSession *session, XmaPerfStats *stats)
+{
+    if (session == NULL || stats == NULL) {
+        xma_logmsg(XMA_ERROR_LOG, XMAAPI_MOD, "xma_get_session_stats: session or stats is NULL\n");
+        return XMA_ERROR;
+    }
+    if (session->session_signature != (void*)(((uint64_t)session->hw_session.kernel_info) | ((uint64_t)session->hw_session.dev_handle))) {
+        xma_logmsg(XMA_ERROR_LOG, XMAAPI_MOD, "xma_get_session_stats failed. XMASession is corrupted.\n");
+        return XMA_ERROR;
+    }
+    return xma_hw_session_stats(session, stats);
+}
+
+static void xma_stats_dump_cu(const XmaPerfStats& stats, uint64_t busy_us, int32_t interval_ms)
+{
+    uint64_t busy_pct = interval_ms ? busy_us / (interval_ms * 10ULL) : 0;
+    xma_logmsg(XMA_INFO_LOG, XMAAPI_MOD,
+               "Dev# %d CU# %d %s: sessions %d, submitted %lu, completed %lu, failed %lu, in flight %lu, "
+               "queue wait avg %lu us max %lu us, exec avg %lu us max %lu us, busy %lu%%, written %lu KB, read %lu KB\n",
+               stats.dev_index, stats.cu_index, stats.cu_name, stats.num_sessions,
+               stats.submitted, stats.completed, stats.failed, stats.in_flight,
+               stats.queue_wait.count ? stats.queue_wait.total_us / stats.queue_wait.count : 0,
+               stats.queue_wait.max_us,
+               stats.exec.count ? stats.exec.total_us / stats.exec.count : 0,
+               stats.exec.max_us, busy_pct > 100 ? 100 : busy_pct,
+               stats.bytes_written >> 10, stats.bytes_read >> 10);
+}
+
+static void xma_stats_dump_thread()
+{
+    std::vector<XmaPerfStats> table;
+    std::vector<uint64_t> last_busy;
+    std::unique_lock<std::mutex> guard(g_xma_singleton->stats_lock);
+    while (g_xma_singleton->stats_interval_ms > 0) {
+        int32_t interval_ms = g_xma_singleton->stats_interval_ms;
+        g_xma_singleton->stats_cv.wait_for(guard, std::chrono::milliseconds(interval_ms));
+        if (g_xma_singleton->stats_interval_ms <= 0)
+            break;
+
+        int32_t num_cus = xma_hw_cu_stats(&g_xma_singleton->hwcfg, NULL, 0);
+        table.resize(num_cus);
+        last_busy.resize(num_cus, 0);
+        xma_hw_cu_stats(&g_xma_singleton->hwcfg, table.data(), num_cus);
+        for (int32_t i = 0; i < num_cus; i++) {
+            if (table[i].submitted == 0)
+                continue;
+            xma_stats_dump_cu(table[i], table[i].busy_us - last_busy[i], interval_ms);
+            last_busy[i] = table[i].busy_us;
+        }
+    }
+}
+
+int32_t xma_stats_dump(int32_t interval_ms)
+{
+    if (g_xma_singleton == NULL || !g_xma_singleton->xma_initialized || interval_ms < 0)
+        return XMA_ERROR_INVALID;
+
+    // Serializes starting and stopping the thread; stats_lock only guards the interval
+    static std::mutex control;
+    std::lock_guard<std::mutex> control_guard(control);
+    std::unique_lock<std::mutex> guard(g_xma_singleton->stats_lock);
+    g_xma_singleton->stats_interval_ms = interval_ms;
+    if (interval_ms > 0 && !g_xma_singleton->stats_thread.joinable()) {
+        g_xma_singleton->stats_thread = std::thread(xma_stats_dump_thread);
+        return XMA_SUCCESS;
+    }
+    g_xma_singleton->stats_cv.notify_all();
+    if (interval_ms == 0 && g_xma_singleton->stats_thread.joinable()) {
+        guard.unlock();
+        g_xma_singleton->stats_thread.join();
+    }
+    return XMA_SUCCESS;
+}
+
 void xma_exit(void)
 {
+    if (g_xma_singleton && g_xma_singleton->stats_thread.joinable())
+        xma_stats_dump(0);
 /*
     extern XmaSingleton *g_xma_singleton;
     if (!g_xma_singleton->shm_freed)
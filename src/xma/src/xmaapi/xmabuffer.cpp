@@ -16,6 +16,7 @@
  */
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 #include "app/xmabuffers.h"
 #include "app/xmalogger.h"
@@ -24,6 +25,9 @@
 //#include <cstdio>
 #include <iostream>
 #include <cstring>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 #define XMA_BUFFER_MOD "xmabuffer"
 
@@ -34,6 +38,58 @@ typedef struct XmaFrameSideData
     enum XmaFrameSideDataType type;
 } XmaFrameSideData;
 
+struct XmaFramePool
+{
+    std::mutex              lock;
+    XmaFrameProperties      frame_props;
+    int32_t                 num_planes;
+    size_t                  plane_size[XMA_MAX_PLANES];
+    int32_t                 max_frames;
+    int32_t                 num_frames;//Frames allocated, free or in use
+    bool                    destroyed;
+    std::vector<XmaFrame*>  free_frames;
+    //Device planes; NULL for host frames
+    XmaHwBufferPool        *buffer_pool;
+    int32_t                 bank_index;
+    bool                    device_only;
+};
+
+//Pool of each pooled frame, and frame each staged copy shares planes
+//with. Kept out of XmaFrame, which applications allocate themselves,
+//so that its layout stays as it was
+typedef struct XmaFrameOwner
+{
+    XmaFramePool *pool;
+    XmaFrame     *source;//Referenced until the staged copy is freed
+} XmaFrameOwner;
+
+static std::mutex frame_owners_lock;
+static std::unordered_map<XmaFrame*, XmaFrameOwner> frame_owners;
+
+static XmaFrameOwner
+xma_frame_owner_get(XmaFrame *frame)
+{
+    std::lock_guard<std::mutex> guard(frame_owners_lock);
+    auto it = frame_owners.find(frame);
+    return it == frame_owners.end() ? XmaFrameOwner{NULL, NULL} : it->second;
+}
+
+static void
+xma_frame_owner_set(XmaFrame *frame, XmaFramePool *pool, XmaFrame *source)
+{
+    std::lock_guard<std::mutex> guard(frame_owners_lock);
+    frame_owners[frame] = XmaFrameOwner{pool, source};
+}
+
+static void
+xma_frame_owner_clear(XmaFrame *frame)
+{
+    std::lock_guard<std::mutex> guard(frame_owners_lock);
+    frame_owners.erase(frame);
+}
+
+static void xma_frame_pool_release(XmaFramePool *pool, XmaFrame *frame);
+
 int32_t
 xma_frame_planes_get(XmaFrameProperties *frame_props)
 {
@@ -191,12 +247,16 @@ xma_device_buffer_free(XmaBufferObj *b_obj)
     }
     XmaBufferObjPrivate* b_obj_priv = (XmaBufferObjPrivate*) b_obj->private_do_not_touch;
 
-    xclFreeBO(b_obj_priv->dev_handle, b_obj_priv->boHandle);
-    b_obj_priv->dummy = NULL;
-    b_obj_priv->size = -1;
-    b_obj_priv->bank_index = -1;
-    b_obj_priv->dev_index = -1;
-    free(b_obj_priv);
+    if (b_obj_priv->pool) {
+        b_obj_priv->pool->release(b_obj_priv);
+    } else {
+        xclFreeBO(b_obj_priv->dev_handle, b_obj_priv->boHandle);
+        b_obj_priv->dummy = NULL;
+        b_obj_priv->size = -1;
+        b_obj_priv->bank_index = -1;
+        b_obj_priv->dev_index = -1;
+        free(b_obj_priv);
+    }
     b_obj->data = NULL;
     b_obj->size = -1;
     b_obj->bank_index = -1;
@@ -216,13 +276,25 @@ xma_frame_free(XmaFrame *frame)
                "%s() Free frame %p\n", __func__, frame);
     num_planes = xma_frame_planes_get(&frame->frame_props);
 
-    for (int32_t i = 0; i < num_planes; i++)
-        frame->data[i].refcount--;
+    int32_t refcount = 0;
+    for (int32_t i = 0; i < num_planes; i++) {
+        int32_t count = __atomic_sub_fetch(&frame->data[i].refcount, 1, __ATOMIC_ACQ_REL);
+        if (i == 0)
+            refcount = count;
+    }
+
+    if (refcount > 0)
+        return;
 
-    if (frame->data[0].refcount > 0)
+    XmaFrameOwner owner = xma_frame_owner_get(frame);
+    if (owner.pool) {
+        xma_frame_pool_release(owner.pool, frame);
         return;
+    }
 
-    for (int32_t i = 0; i < num_planes && !frame->data[i].is_clone; i++) {
+    for (int32_t i = 0; i < num_planes; i++) {
+        if (frame->data[i].is_clone)
+            continue;
         if (frame->data[i].buffer_type == XMA_DEVICE_ONLY_BUFFER_TYPE || frame->data[i].buffer_type == XMA_DEVICE_BUFFER_TYPE) {
             xma_device_buffer_free(frame->data[i].xma_device_buf);
         } else {
@@ -233,10 +305,416 @@ xma_frame_free(XmaFrame *frame)
     }
 
     xma_frame_clear_all_side_data(frame);
+    if (owner.source) {
+        // Staged copy; its clone planes belonged to source
+        xma_frame_owner_clear(frame);
+        xma_frame_free(owner.source);
+    }
     free(frame);
     frame = NULL;
 }
 
+int32_t
+xma_frame_inc_ref(XmaFrame *frame)
+{
+    if (!frame) return XMA_ERROR_INVALID;
+    int32_t num_planes = xma_frame_planes_get(&frame->frame_props);
+    int32_t refcount = 0;
+    for (int32_t i = 0; i < num_planes; i++) {
+        int32_t count = __atomic_add_fetch(&frame->data[i].refcount, 1, __ATOMIC_ACQ_REL);
+        if (i == 0)
+            refcount = count;
+    }
+    return refcount;
+}
+
+// Bytes in plane of a frame; chroma planes of 4:2:0 and 4:2:2 are subsampled
+static size_t
+xma_frame_plane_size(XmaFrameProperties *frame_props, int32_t plane)
+{
+    size_t bytes_per_sample = frame_props->bits_per_pixel > 8 ? 2 : 1;
+    size_t width = frame_props->width;
+    size_t height = frame_props->height;
+    switch (frame_props->format) {
+        case XMA_YUV420_FMT_TYPE:
+            if (plane > 0) {
+                width = (width + 1) / 2;
+                height = (height + 1) / 2;
+            }
+            break;
+        case XMA_YUV422_FMT_TYPE:
+            if (plane > 0)
+                width = (width + 1) / 2;
+            break;
+        case XMA_RGB888_FMT_TYPE:
+            width *= 3;
+            break;
+        default:
+            break;
+    }
+    return width * height * bytes_per_sample;
+}
+
+static XmaFramePool*
+xma_frame_pool_new(XmaFrameProperties *frame_props, int32_t max_frames)
+{
+    if (frame_props == NULL || max_frames <= 0 ||
+        frame_props->width <= 0 || frame_props->height <= 0) {
+        xma_logmsg(XMA_ERROR_LOG, XMA_BUFFER_MOD,
+                   "%s() Invalid frame properties or max_frames\n", __func__);
+        return NULL;
+    }
+    XmaFramePool *pool = new XmaFramePool;
+    pool->frame_props = *frame_props;
+    pool->num_planes = xma_frame_planes_get(frame_props);
+    for (int32_t i = 0; i < pool->num_planes; i++)
+        pool->plane_size[i] = xma_frame_plane_size(frame_props, i);
+    pool->max_frames = max_frames;
+    pool->num_frames = 0;
+    pool->destroyed = false;
+    pool->buffer_pool = NULL;
+    pool->bank_index = -1;
+    pool->device_only = false;
+    pool->free_frames.reserve(max_frames);
+    return pool;
+}
+
+XmaFramePool*
+xma_frame_pool_create(XmaFrameProperties *frame_props, int32_t max_frames)
+{
+    xma_logmsg(XMA_DEBUG_LOG, XMA_BUFFER_MOD, "%s()\n", __func__);
+    return xma_frame_pool_new(frame_props, max_frames);
+}
+
+XmaFramePool*
+xma_frame_pool_create_on_device(XmaFrameProperties *frame_props, int32_t max_frames,
+                                XmaHwBufferPool *buffer_pool, int32_t bank_index,
+                                bool device_only)
+{
+    xma_logmsg(XMA_DEBUG_LOG, XMA_BUFFER_MOD, "%s()\n", __func__);
+    XmaFramePool *pool = xma_frame_pool_new(frame_props, max_frames);
+    if (pool == NULL)
+        return NULL;
+    buffer_pool->add_ref();
+    pool->buffer_pool = buffer_pool;
+    pool->bank_index = bank_index;
+    pool->device_only = device_only;
+    return pool;
+}
+
+// Free the planes and container of a frame owned by pool
+static void
+xma_frame_pool_free_frame(XmaFramePool *pool, XmaFrame *frame)
+{
+    for (int32_t i = 0; i < pool->num_planes; i++) {
+        XmaBufferObj *b_obj = frame->data[i].xma_device_buf;
+        if (b_obj) {
+            ((XmaBufferObjPrivate*)b_obj->private_do_not_touch)->pool->release(
+                (XmaBufferObjPrivate*)b_obj->private_do_not_touch);
+            free(b_obj);
+        } else {
+            free(frame->data[i].buffer);
+        }
+    }
+    xma_frame_owner_clear(frame);
+    free(frame);
+}
+
+static void
+xma_frame_pool_delete(XmaFramePool *pool)
+{
+    if (pool->buffer_pool)
+        pool->buffer_pool->release_ref();
+    delete pool;
+}
+
+static XmaFrame*
+xma_frame_pool_alloc_frame(XmaFramePool *pool)
+{
+    XmaFrame *frame = (XmaFrame*) calloc(1, sizeof(XmaFrame));
+    if (frame == NULL)
+        return NULL;
+    frame->frame_props = pool->frame_props;
+    xma_frame_owner_set(frame, pool, NULL);
+    for (int32_t i = 0; i < pool->num_planes; i++) {
+        frame->data[i].is_clone = false;
+        if (pool->buffer_pool == NULL) {
+            frame->data[i].buffer_type = XMA_HOST_BUFFER_TYPE;
+            frame->data[i].buffer = malloc(pool->plane_size[i]);
+            if (frame->data[i].buffer == NULL)
+                break;
+            continue;
+        }
+        XmaBufferObjPrivate *priv = pool->buffer_pool->acquire(pool->plane_size[i], pool->bank_index, pool->device_only);
+        XmaBufferObj *b_obj = priv ? (XmaBufferObj*) malloc(sizeof(XmaBufferObj)) : NULL;
+        if (b_obj == NULL) {
+            if (priv)
+                pool->buffer_pool->release(priv);
+            break;
+        }
+        b_obj->data = priv->data;
+        b_obj->size = priv->size;
+        b_obj->paddr = priv->paddr;
+        b_obj->bank_index = priv->bank_index;
+        b_obj->dev_index = priv->dev_index;
+        b_obj->device_only_buffer = priv->device_only_buffer;
+        b_obj->private_do_not_touch = priv;
+        frame->data[i].buffer_type = pool->device_only ? XMA_DEVICE_ONLY_BUFFER_TYPE : XMA_DEVICE_BUFFER_TYPE;
+        frame->data[i].buffer = priv->data;
+        frame->data[i].xma_device_buf = b_obj;
+    }
+    for (int32_t i = 0; i < pool->num_planes; i++) {
+        if (frame->data[i].buffer == NULL && frame->data[i].xma_device_buf == NULL) {
+            xma_logmsg(XMA_ERROR_LOG, XMA_BUFFER_MOD,
+                       "%s() Failed to allocate frame plane %d\n", __func__, i);
+            xma_frame_pool_free_frame(pool, frame);
+            return NULL;
+        }
+    }
+    return frame;
+}
+
+XmaFrame*
+xma_frame_pool_get(XmaFramePool *pool)
+{
+    if (pool == NULL)
+        return NULL;
+
+    XmaFrame *frame = NULL;
+    {
+        std::lock_guard<std::mutex> guard(pool->lock);
+        if (!pool->free_frames.empty()) {
+            frame = pool->free_frames.back();
+            pool->free_frames.pop_back();
+        } else if (pool->num_frames < pool->max_frames) {
+            // Reserve the frame; allocate outside of the lock
+            pool->num_frames++;
+        } else {
+            return NULL;
+        }
+    }
+    if (frame == NULL) {
+        frame = xma_frame_pool_alloc_frame(pool);
+        if (frame == NULL) {
+            std::lock_guard<std::mutex> guard(pool->lock);
+            pool->num_frames--;
+            return NULL;
+        }
+    }
+
+    frame->side_data = NULL;
+    frame->time_base.numerator = 0;
+    frame->time_base.denominator = 0;
+    frame->frame_rate.numerator = 0;
+    frame->frame_rate.denominator = 0;
+    frame->pts = 0;
+    frame->is_idr = 0;
+    frame->do_not_encode = 0;
+    frame->is_last_frame = 0;
+    for (int32_t i = 0; i < pool->num_planes; i++)
+        frame->data[i].refcount = 1;
+    return frame;
+}
+
+static void
+xma_frame_pool_release(XmaFramePool *pool, XmaFrame *frame)
+{
+    xma_frame_clear_all_side_data(frame);
+
+    bool delete_pool = false;
+    {
+        std::lock_guard<std::mutex> guard(pool->lock);
+        if (!pool->destroyed) {
+            pool->free_frames.push_back(frame);
+            return;
+        }
+        pool->num_frames--;
+        delete_pool = (pool->num_frames == 0);
+    }
+    xma_frame_pool_free_frame(pool, frame);
+    if (delete_pool)
+        xma_frame_pool_delete(pool);
+}
+
+void
+xma_frame_pool_destroy(XmaFramePool *pool)
+{
+    xma_logmsg(XMA_DEBUG_LOG, XMA_BUFFER_MOD, "%s()\n", __func__);
+    if (pool == NULL)
+        return;
+
+    std::vector<XmaFrame*> to_free;
+    bool delete_pool = false;
+    {
+        std::lock_guard<std::mutex> guard(pool->lock);
+        pool->destroyed = true;
+        to_free.swap(pool->free_frames);
+        pool->num_frames -= to_free.size();
+        delete_pool = (pool->num_frames == 0);
+    }
+    for (auto frame : to_free)
+        xma_frame_pool_free_frame(pool, frame);
+    if (delete_pool)
+        xma_frame_pool_delete(pool);
+}
+
+// True if the CU of the session can use the plane where it is
+static bool
+xma_frame_plane_reachable(XmaSession *session, XmaBufferObjPrivate *b_obj_priv)
+{
+    if (b_obj_priv->dev_handle != session->hw_session.dev_handle)
+        return false;
+    if (b_obj_priv->bank_index == session->hw_session.bank_index)
+        return true;
+    XmaHwKernel *kernel_info = session->hw_session.kernel_info;
+    return b_obj_priv->bank_index < MAX_DDR_MAP &&
+           (kernel_info->ip_ddr_mapping & (1ULL << b_obj_priv->bank_index));
+}
+
+// Device to device copy; P2P when the buffers are on different devices
+static int32_t
+xma_frame_plane_copy_p2p(XmaBufferObjPrivate *dst, XmaBufferObjPrivate *src)
+{
+    if (src->dev_handle == dst->dev_handle) {
+        return xclCopyBO(dst->dev_handle, dst->boHandle, src->boHandle,
+                         src->size, 0, 0) == 0 ? XMA_SUCCESS : XMA_ERROR;
+    }
+    int fd = xclExportBO(src->dev_handle, src->boHandle);
+    if (fd < 0)
+        return XMA_ERROR;
+    int32_t rc = XMA_ERROR;
+    unsigned int imported = xclImportBO(dst->dev_handle, fd, 0);
+    if (imported != NULLBO) {
+        if (xclCopyBO(dst->dev_handle, dst->boHandle, imported, src->size, 0, 0) == 0)
+            rc = XMA_SUCCESS;
+        xclFreeBO(dst->dev_handle, imported);
+    }
+    close(fd);
+    return rc;
+}
+
+// Copy through host memory when the devices cannot copy between them
+static int32_t
+xma_frame_plane_copy_host(XmaBufferObjPrivate *dst, XmaBufferObjPrivate *src)
+{
+    if (src->data) {
+        if (xclSyncBO(src->dev_handle, src->boHandle, XCL_BO_SYNC_BO_FROM_DEVICE, src->size, 0) != 0)
+            return XMA_ERROR;
+        memcpy(dst->data, src->data, src->size);
+    } else if (xclUnmgdPread(src->dev_handle, 0, dst->data, src->size, src->paddr) < 0) {
+        return XMA_ERROR;
+    }
+    if (xclSyncBO(dst->dev_handle, dst->boHandle, XCL_BO_SYNC_BO_TO_DEVICE, src->size, 0) != 0)
+        return XMA_ERROR;
+    return XMA_SUCCESS;
+}
+
+int32_t
+xma_frame_stage_for_session(XmaSession *session, XmaFrame *frame, XmaFrame **staged)
+{
+    *staged = frame;
+    if (frame == NULL)
+        return XMA_SUCCESS;
+
+    int32_t num_planes = xma_frame_planes_get(&frame->frame_props);
+    bool reachable = true;
+    for (int32_t i = 0; i < num_planes; i++) {
+        XmaBufferRef *plane = &frame->data[i];
+        if (plane->buffer_type == XMA_HOST_BUFFER_TYPE || plane->xma_device_buf == NULL)
+            continue;
+        if (xma_check_device_buffer(plane->xma_device_buf) != XMA_SUCCESS)
+            return XMA_ERROR;
+        if (!xma_frame_plane_reachable(session,
+                (XmaBufferObjPrivate*)plane->xma_device_buf->private_do_not_touch)) {
+            reachable = false;
+        }
+    }
+    if (reachable)
+        return XMA_SUCCESS;
+
+    XmaHwSessionPrivate *priv = (XmaHwSessionPrivate*)session->hw_session.private_do_not_use;
+    if (priv == NULL || priv->buffer_pool == NULL) {
+        xma_logmsg(XMA_ERROR_LOG, XMA_BUFFER_MOD,
+                   "%s() Frame is not reachable by the session and session has no buffer pool\n", __func__);
+        return XMA_ERROR;
+    }
+
+    XmaFrame *copy = (XmaFrame*) malloc(sizeof(XmaFrame));
+    if (copy == NULL)
+        return XMA_ERROR;
+    memcpy(copy, frame, sizeof(XmaFrame));
+    copy->side_data = NULL;
+    for (int32_t i = 0; i < num_planes; i++) {
+        copy->data[i].refcount = 1;
+        copy->data[i].is_clone = true;
+    }
+
+    int32_t rc = XMA_SUCCESS;
+    for (int32_t i = 0; i < num_planes && rc == XMA_SUCCESS; i++) {
+        XmaBufferRef *plane = &frame->data[i];
+        if (plane->buffer_type == XMA_HOST_BUFFER_TYPE || plane->xma_device_buf == NULL)
+            continue;
+        XmaBufferObjPrivate *src = (XmaBufferObjPrivate*)plane->xma_device_buf->private_do_not_touch;
+        if (xma_frame_plane_reachable(session, src))
+            continue;
+
+        //Staged planes are host mapped so that the host bounce is always possible
+        XmaBufferObjPrivate *dst = priv->buffer_pool->acquire(src->size, session->hw_session.bank_index, false);
+        XmaBufferObj *b_obj = (XmaBufferObj*) malloc(sizeof(XmaBufferObj));
+        if (dst == NULL || b_obj == NULL) {
+            xma_logmsg(XMA_ERROR_LOG, XMA_BUFFER_MOD,
+                       "%s() Unable to allocate staging buffer for plane %d\n", __func__, i);
+            if (dst)
+                priv->buffer_pool->release(dst);
+            free(b_obj);
+            rc = XMA_ERROR;
+            break;
+        }
+        b_obj->data = dst->data;
+        b_obj->size = dst->size;
+        b_obj->paddr = dst->paddr;
+        b_obj->bank_index = dst->bank_index;
+        b_obj->dev_index = dst->dev_index;
+        b_obj->device_only_buffer = false;
+        b_obj->private_do_not_touch = dst;
+        copy->data[i].buffer_type = XMA_DEVICE_BUFFER_TYPE;
+        copy->data[i].buffer = dst->data;
+        copy->data[i].xma_device_buf = b_obj;
+        copy->data[i].is_clone = false;
+
+        if (xma_frame_plane_copy_p2p(dst, src) != XMA_SUCCESS) {
+            xma_logmsg(XMA_DEBUG_LOG, XMA_BUFFER_MOD,
+                       "%s() Device copy of plane %d failed, copying through host\n", __func__, i);
+            rc = xma_frame_plane_copy_host(dst, src);
+            if (rc != XMA_SUCCESS) {
+                xma_logmsg(XMA_ERROR_LOG, XMA_BUFFER_MOD,
+                           "%s() Unable to copy plane %d to the session device\n", __func__, i);
+            }
+        }
+    }
+
+    if (rc != XMA_SUCCESS) {
+        for (int32_t i = 0; i < num_planes; i++) {
+            if (!copy->data[i].is_clone)
+                xma_device_buffer_free(copy->data[i].xma_device_buf);
+        }
+        free(copy);
+        return rc;
+    }
+
+    if (frame->side_data) {
+        for (uint32_t i = 0; i < XMA_FRAME_SIDE_DATA_MAX_COUNT; i++) {
+            if (frame->side_data[i])
+                xma_frame_add_side_data(copy, frame->side_data[i]);
+        }
+    }
+    // Host planes are shared, so frame lives as long as the copy does
+    xma_frame_inc_ref(frame);
+    xma_frame_owner_set(copy, NULL, frame);
+    *staged = copy;
+    return XMA_SUCCESS;
+}
+
 XmaSideDataHandle
 xma_side_data_alloc(void                      *side_data,
                     enum XmaFrameSideDataType sd_type,
@@ -96,24 +96,31 @@ xma_dec_session_create(XmaDecoderProperties *dec_props)
     dec_session->base.session_type = XMA_DECODER;
     dec_session->decoder_plugin = plg;
 
-    bool expected = false;
-    bool desired = true;
-    while (!(g_xma_singleton->locked).compare_exchange_weak(expected, desired)) {
-        expected = false;
-    }
-    //Singleton lock acquired
-
     int32_t rc, dev_index, cu_index;
     dev_index = dec_props->dev_index;
     cu_index = dec_props->cu_index;
     //dec_handle = dec_props->cu_index;
     
     XmaHwCfg *hwcfg = &g_xma_singleton->hwcfg;
+    //Counts as a session on the CU picked until attached or failed
+    XmaHwReservation reservation;
+    if (dev_index == XMA_AUTO_PLACEMENT || cu_index == XMA_AUTO_PLACEMENT) {
+        if (xma_hw_place_session(hwcfg, &dev_index, &cu_index, dec_props->cu_name,
+                                 dec_props->ddr_bank_index, dec_props->channel_id, &reservation) != XMA_SUCCESS) {
+            xma_logmsg(XMA_ERROR_LOG, XMA_DECODER_MOD,
+                       "XMA session creation failed. No CU found for automatic placement\n");
+            free(dec_session);
+            return NULL;
+        }
+        //Report the placement back in the properties
+        dec_props->dev_index = dev_index;
+        dec_props->cu_index = cu_index;
+        dec_session->decoder_props.dev_index = dev_index;
+        dec_session->decoder_props.cu_index = cu_index;
+    }
     if (dev_index >= hwcfg->num_devices || dev_index < 0) {
         xma_logmsg(XMA_ERROR_LOG, XMA_DECODER_MOD,
                    "XMA session creation failed. dev_index not found\n");
-        //Release singleton lock
-        g_xma_singleton->locked = false;
         free(dec_session);
         return NULL;
     }
@@ -130,47 +137,28 @@ xma_dec_session_create(XmaDecoderProperties *dec_props)
     if (!found) {
         xma_logmsg(XMA_ERROR_LOG, XMA_DECODER_MOD,
                    "XMA session creation failed. dev_index not loaded with xclbin\n");
-        //Release singleton lock
-        g_xma_singleton->locked = false;
         free(dec_session);
         return NULL;
     }
     if ((uint32_t)cu_index >= hwcfg->devices[hwcfg_dev_index].number_of_cus || (cu_index < 0 && dec_props->cu_name == NULL)) {
         xma_logmsg(XMA_ERROR_LOG, XMA_DECODER_MOD,
                    "XMA session creation failed. Invalid cu_index = %d\n", cu_index);
-        //Release singleton lock
-        g_xma_singleton->locked = false;
         free(dec_session);
         return NULL;
     }
     if (cu_index < 0) {
         std::string cu_name = std::string(dec_props->cu_name);
-        found = false;
-        for (XmaHwKernel& kernel: g_xma_singleton->hwcfg.devices[hwcfg_dev_index].kernels) {
-            if (std::string((char*)kernel.name) == cu_name) {
-                found = true;
-                cu_index = kernel.cu_index;
-                break;
-            }
-        }
-        if (!found) {
+        auto cu_itr = hwcfg->devices[hwcfg_dev_index].cu_index_by_name.find(cu_name);
+        if (cu_itr != hwcfg->devices[hwcfg_dev_index].cu_index_by_name.end()) {
+            cu_index = cu_itr->second;
+        } else {
             xma_logmsg(XMA_ERROR_LOG, XMA_DECODER_MOD,
                     "XMA session creation failed. cu %s not found\n", cu_name.c_str());
-            //Release singleton lock
-            g_xma_singleton->locked = false;
             free(dec_session);
             return NULL;
         }
     }
 
-    if (hwcfg->devices[hwcfg_dev_index].kernels[cu_index].in_use) {
-        xma_logmsg(XMA_INFO_LOG, XMA_DECODER_MOD,
-                   "XMA session sharing CU: %s\n", hwcfg->devices[hwcfg_dev_index].kernels[cu_index].name);
-    } else {
-        xma_logmsg(XMA_INFO_LOG, XMA_DECODER_MOD,
-                   "XMA session with CU: %s\n", hwcfg->devices[hwcfg_dev_index].kernels[cu_index].name);
-    }
-
     dec_session->base.hw_session.dev_handle = hwcfg->devices[hwcfg_dev_index].handle;
     //For execbo:
     dec_session->base.hw_session.kernel_info = &hwcfg->devices[hwcfg_dev_index].kernels[cu_index];
@@ -209,8 +197,6 @@ xma_dec_session_create(XmaDecoderProperties *dec_props)
                 xma_logmsg(XMA_ERROR_LOG, XMA_DECODER_MOD,
                     "User supplied default ddr_bank is invalid. Valid ddr_bank mapping for this CU: %s\n", tmp_bset.to_string());
                 
-                //Release singleton lock
-                g_xma_singleton->locked = false;
                 free(dec_session);
                 return NULL;
             }
@@ -222,8 +208,6 @@ xma_dec_session_create(XmaDecoderProperties *dec_props)
             xma_logmsg(XMA_ERROR_LOG, XMA_DECODER_MOD,
                 "Selected dataflow CU with channels has ini setting with max channel_id of %d. Cannot create session with higher channel_id of %d\n", dec_session->base.hw_session.kernel_info->max_channel_id, dec_session->base.channel_id);
             
-            //Release singleton lock
-            g_xma_singleton->locked = false;
             free(dec_session);
             return NULL;
         }
@@ -237,8 +221,6 @@ xma_dec_session_create(XmaDecoderProperties *dec_props)
     if ((xma_main_ver == 2019 && xma_sub_ver < 2) || xma_main_ver < 2019 || rc < 0) {
         xma_logmsg(XMA_ERROR_LOG, XMA_DECODER_MOD,
                    "Initalization of plugin failed. Plugin is incompatible with this XMA version\n");
-        //Release singleton lock
-        g_xma_singleton->locked = false;
         free(dec_session);
         return NULL;
     }
@@ -247,25 +229,28 @@ xma_dec_session_create(XmaDecoderProperties *dec_props)
     dec_session->base.plugin_data =
         calloc(dec_session->decoder_plugin->plugin_data_size, sizeof(uint8_t));
 
-    dec_session->base.session_id = g_xma_singleton->num_decoders + 1;
+    dec_session->base.session_id = ++g_xma_singleton->num_decoders;
     dec_session->base.session_signature = (void*)(((uint64_t)dec_session->base.hw_session.kernel_info) | ((uint64_t)dec_session->base.hw_session.dev_handle));
     xma_logmsg(XMA_INFO_LOG, XMA_DECODER_MOD,
                 "XMA session channel_id: %d; decoder_id: %d\n", dec_session->base.channel_id, dec_session->base.session_id);
 
+    if (xma_hw_session_attach(&dec_session->base) != XMA_SUCCESS) {
+        xma_logmsg(XMA_ERROR_LOG, XMA_DECODER_MOD,
+                   "Unable to allocate execBOs for this session\n");
+        free(dec_session->base.plugin_data);
+        free(dec_session);
+        return NULL;
+    }
+    reservation.release();
+
     if (dec_session->decoder_plugin->init(dec_session)) {
         xma_logmsg(XMA_ERROR_LOG, XMA_DECODER_MOD,
                    "Initalization of plugin failed\n");
-        //Release singleton lock
-        g_xma_singleton->locked = false;
+        xma_hw_session_detach(&dec_session->base);
         free(dec_session->base.plugin_data);
         free(dec_session);
         return NULL;
     }
-    dec_session->base.hw_session.kernel_info->in_use = true;
-    g_xma_singleton->num_decoders = dec_session->base.session_id;
-
-    //Release singleton lock
-    g_xma_singleton->locked = false;
 
     return dec_session;
 }
@@ -276,29 +261,14 @@ xma_dec_session_destroy(XmaDecoderSession *session)
     int32_t rc;
 
     xma_logmsg(XMA_DEBUG_LOG, XMA_DECODER_MOD, "%s()\n", __func__);
-    bool expected = false;
-    bool desired = true;
-    while (!(g_xma_singleton->locked).compare_exchange_weak(expected, desired)) {
-        expected = false;
-    }
-    //Singleton lock acquired
-
     if (session == NULL) {
         xma_logmsg(XMA_ERROR_LOG, XMA_DECODER_MOD,
                    "Session is already released\n");
-
-        //Release singleton lock
-        g_xma_singleton->locked = false;
-
         return XMA_ERROR;
     }
     if (session->decoder_plugin == NULL) {
         xma_logmsg(XMA_ERROR_LOG, XMA_DECODER_MOD,
                    "Session is corrupted\n");
-
-        //Release singleton lock
-        g_xma_singleton->locked = false;
-
         return XMA_ERROR;
     }
     rc  = session->decoder_plugin->close(session);
@@ -321,6 +291,7 @@ xma_dec_session_destroy(XmaDecoderSession *session)
     session->base.plugin_data = NULL;
     session->base.stats = NULL;
     session->decoder_plugin = NULL;
+    xma_hw_session_detach(&session->base);
     session->base.hw_session.dev_handle = NULL;
     session->base.hw_session.kernel_info = NULL;
     //do not change kernel in_use as it maybe in use by another plugin
@@ -329,9 +300,6 @@ xma_dec_session_destroy(XmaDecoderSession *session)
     free(session);
     session = NULL;
 
-    //Release singleton lock
-    g_xma_singleton->locked = false;
-
     return XMA_SUCCESS;
 }
 
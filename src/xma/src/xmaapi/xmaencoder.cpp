@@ -134,24 +134,31 @@ xma_enc_session_create(XmaEncoderProperties *enc_props)
     enc_session->base.stats = NULL;
     enc_session->encoder_plugin = plg;
 
-    bool expected = false;
-    bool desired = true;
-    while (!(g_xma_singleton->locked).compare_exchange_weak(expected, desired)) {
-        expected = false;
-    }
-    //Singleton lock acquired
-
     int32_t rc, dev_index, cu_index;
     dev_index = enc_props->dev_index;
     cu_index = enc_props->cu_index;
     //enc_handle = enc_props->cu_index;
 
     XmaHwCfg *hwcfg = &g_xma_singleton->hwcfg;
+    //Counts as a session on the CU picked until attached or failed
+    XmaHwReservation reservation;
+    if (dev_index == XMA_AUTO_PLACEMENT || cu_index == XMA_AUTO_PLACEMENT) {
+        if (xma_hw_place_session(hwcfg, &dev_index, &cu_index, enc_props->cu_name,
+                                 enc_props->ddr_bank_index, enc_props->channel_id, &reservation) != XMA_SUCCESS) {
+            xma_logmsg(XMA_ERROR_LOG, XMA_ENCODER_MOD,
+                       "XMA session creation failed. No CU found for automatic placement\n");
+            free(enc_session);
+            return NULL;
+        }
+        //Report the placement back in the properties
+        enc_props->dev_index = dev_index;
+        enc_props->cu_index = cu_index;
+        enc_session->encoder_props.dev_index = dev_index;
+        enc_session->encoder_props.cu_index = cu_index;
+    }
     if (dev_index >= hwcfg->num_devices || dev_index < 0) {
         xma_logmsg(XMA_ERROR_LOG, XMA_ENCODER_MOD,
                    "XMA session creation failed. dev_index not found\n");
-        //Release singleton lock
-        g_xma_singleton->locked = false;
         free(enc_session);
         return NULL;
     }
@@ -168,47 +175,28 @@ xma_enc_session_create(XmaEncoderProperties *enc_props)
     if (!found) {
         xma_logmsg(XMA_ERROR_LOG, XMA_ENCODER_MOD,
                    "XMA session creation failed. dev_index not loaded with xclbin\n");
-        //Release singleton lock
-        g_xma_singleton->locked = false;
         free(enc_session);
         return NULL;
     }
     if ((uint32_t)cu_index >= hwcfg->devices[hwcfg_dev_index].number_of_cus || (cu_index < 0 && enc_props->cu_name == NULL)) {
         xma_logmsg(XMA_ERROR_LOG, XMA_ENCODER_MOD,
                    "XMA session creation failed. Invalid cu_index = %d\n", cu_index);
-        //Release singleton lock
-        g_xma_singleton->locked = false;
         free(enc_session);
         return NULL;
     }
     if (cu_index < 0) {
         std::string cu_name = std::string(enc_props->cu_name);
-        found = false;
-        for (XmaHwKernel& kernel: g_xma_singleton->hwcfg.devices[hwcfg_dev_index].kernels) {
-            if (std::string((char*)kernel.name) == cu_name) {
-                found = true;
-                cu_index = kernel.cu_index;
-                break;
-            }
-        }
-        if (!found) {
+        auto cu_itr = hwcfg->devices[hwcfg_dev_index].cu_index_by_name.find(cu_name);
+        if (cu_itr != hwcfg->devices[hwcfg_dev_index].cu_index_by_name.end()) {
+            cu_index = cu_itr->second;
+        } else {
             xma_logmsg(XMA_ERROR_LOG, XMA_ENCODER_MOD,
                     "XMA session creation failed. cu %s not found\n", cu_name.c_str());
-            //Release singleton lock
-            g_xma_singleton->locked = false;
             free(enc_session);
             return NULL;
         }
     }
 
-    if (hwcfg->devices[hwcfg_dev_index].kernels[cu_index].in_use) {
-        xma_logmsg(XMA_INFO_LOG, XMA_ENCODER_MOD,
-                   "XMA session sharing CU: %s\n", hwcfg->devices[hwcfg_dev_index].kernels[cu_index].name);
-    } else {
-        xma_logmsg(XMA_INFO_LOG, XMA_ENCODER_MOD,
-                   "XMA session with CU: %s\n", hwcfg->devices[hwcfg_dev_index].kernels[cu_index].name);
-    }
-
     enc_session->base.hw_session.dev_handle = hwcfg->devices[hwcfg_dev_index].handle;
 
     //For execbo:
@@ -248,8 +236,6 @@ xma_enc_session_create(XmaEncoderProperties *enc_props)
                 xma_logmsg(XMA_ERROR_LOG, XMA_ENCODER_MOD,
                     "User supplied default ddr_bank is invalid. Valid ddr_bank mapping for this CU: %s\n", tmp_bset.to_string());
                 
-                //Release singleton lock
-                g_xma_singleton->locked = false;
                 free(enc_session);
                 return NULL;
             }
@@ -261,8 +247,6 @@ xma_enc_session_create(XmaEncoderProperties *enc_props)
             xma_logmsg(XMA_ERROR_LOG, XMA_ENCODER_MOD,
                 "Selected dataflow CU with channels has ini setting with max channel_id of %d. Cannot create session with higher channel_id of %d\n", enc_session->base.hw_session.kernel_info->max_channel_id, enc_session->base.channel_id);
             
-            //Release singleton lock
-            g_xma_singleton->locked = false;
             free(enc_session);
             return NULL;
         }
@@ -276,8 +260,6 @@ xma_enc_session_create(XmaEncoderProperties *enc_props)
     if ((xma_main_ver == 2019 && xma_sub_ver < 2) || xma_main_ver < 2019 || rc < 0) {
         xma_logmsg(XMA_ERROR_LOG, XMA_ENCODER_MOD,
                    "Initalization of plugin failed. Plugin is incompatible with this XMA version\n");
-        //Release singleton lock
-        g_xma_singleton->locked = false;
         free(enc_session);
         return NULL;
     }
@@ -286,18 +268,26 @@ xma_enc_session_create(XmaEncoderProperties *enc_props)
     enc_session->base.plugin_data =
         calloc(enc_session->encoder_plugin->plugin_data_size, sizeof(uint8_t));
 
-    enc_session->base.session_id = g_xma_singleton->num_encoders + 1;
+    enc_session->base.session_id = ++g_xma_singleton->num_encoders;
     enc_session->base.session_signature = (void*)(((uint64_t)enc_session->base.hw_session.kernel_info) | ((uint64_t)enc_session->base.hw_session.dev_handle));
     xma_logmsg(XMA_INFO_LOG, XMA_ENCODER_MOD,
                 "XMA session channel_id: %d; encoder_id: %d\n", enc_session->base.channel_id, enc_session->base.session_id);
 
+    if (xma_hw_session_attach(&enc_session->base) != XMA_SUCCESS) {
+        xma_logmsg(XMA_ERROR_LOG, XMA_ENCODER_MOD,
+                   "Unable to allocate execBOs for this session\n");
+        free(enc_session->base.plugin_data);
+        free(enc_session);
+        return NULL;
+    }
+    reservation.release();
+
     rc = enc_session->encoder_plugin->init(enc_session);
     if (rc) {
         xma_logmsg(XMA_ERROR_LOG, XMA_ENCODER_MOD,
                    "Initalization of encoder plugin failed. Return code %d\n",
                    rc);
-        //Release singleton lock
-        g_xma_singleton->locked = false;
+        xma_hw_session_detach(&enc_session->base);
         free(enc_session->base.plugin_data);
         free(enc_session);
         return NULL;
@@ -306,12 +296,6 @@ xma_enc_session_create(XmaEncoderProperties *enc_props)
     // Create encoder file if it does not exist and initialize all fields 
     xma_enc_session_statsfile_init(enc_session);
 
-    enc_session->base.hw_session.kernel_info->in_use = true;
-    g_xma_singleton->num_encoders = enc_session->base.session_id;
-
-    //Release singleton lock
-    g_xma_singleton->locked = false;
-
     return enc_session;
 }
 
@@ -322,29 +306,14 @@ xma_enc_session_destroy(XmaEncoderSession *session)
 
     xma_logmsg(XMA_DEBUG_LOG, XMA_ENCODER_MOD, "%s()\n", __func__);
 
-    bool expected = false;
-    bool desired = true;
-    while (!(g_xma_singleton->locked).compare_exchange_weak(expected, desired)) {
-        expected = false;
-    }
-    //Singleton lock acquired
-
     if (session == NULL) {
         xma_logmsg(XMA_ERROR_LOG, XMA_ENCODER_MOD,
                    "Session is already released\n");
-
-        //Release singleton lock
-        g_xma_singleton->locked = false;
-
         return XMA_ERROR;
     }
     if (session->encoder_plugin == NULL) {
         xma_logmsg(XMA_ERROR_LOG, XMA_ENCODER_MOD,
                    "Session is corrupted\n");
-
-        //Release singleton lock
-        g_xma_singleton->locked = false;
-
         return XMA_ERROR;
     }
     // Clean up the stats file, but don't delete it 
@@ -364,6 +333,7 @@ xma_enc_session_destroy(XmaEncoderSession *session)
     session->base.plugin_data = NULL;
     session->base.stats = NULL;
     session->encoder_plugin = NULL;
+    xma_hw_session_detach(&session->base);
     session->base.hw_session.dev_handle = NULL;
     session->base.hw_session.kernel_info = NULL;
     //do not change kernel in_use as it maybe in use by another plugin
@@ -372,9 +342,6 @@ xma_enc_session_destroy(XmaEncoderSession *session)
     free(session);
     session = NULL;
 
-    //Release singleton lock
-    g_xma_singleton->locked = false;
-
     return XMA_SUCCESS;
 }
 
@@ -401,7 +368,15 @@ xma_enc_session_send_frame(XmaEncoderSession *session,
   
     clock_gettime(CLOCK_MONOTONIC, &ts);  
     timestamp = (ts.tv_sec * 1000000000) + ts.tv_nsec;
-    rc = session->encoder_plugin->send_frame(session, frame);
+    XmaFrame *staged;
+    if (xma_frame_stage_for_session(&session->base, frame, &staged) != XMA_SUCCESS) {
+        xma_logmsg(XMA_ERROR_LOG, XMA_ENCODER_MOD, "Unable to copy frame to the session device\n");
+        return XMA_ERROR;
+    }
+    rc = session->encoder_plugin->send_frame(session, staged);
+    // Plugins that keep the staged frame hold their own reference
+    if (staged != frame)
+        xma_frame_free(staged);
     if (frame->do_not_encode == false)
     {
         frame_size = frame->frame_props.width * frame->frame_props.height; 
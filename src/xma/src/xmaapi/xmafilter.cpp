@@ -92,24 +92,31 @@ xma_filter_session_create(XmaFilterProperties *filter_props)
     filter_session->base.stats = NULL;
     filter_session->filter_plugin = plg;
 
-    bool expected = false;
-    bool desired = true;
-    while (!(g_xma_singleton->locked).compare_exchange_weak(expected, desired)) {
-        expected = false;
-    }
-    //Singleton lock acquired
-
     int32_t rc, dev_index, cu_index;
     dev_index = filter_props->dev_index;
     cu_index = filter_props->cu_index;
     //filter_handle = filter_props->cu_index;
 
     XmaHwCfg *hwcfg = &g_xma_singleton->hwcfg;
+    //Counts as a session on the CU picked until attached or failed
+    XmaHwReservation reservation;
+    if (dev_index == XMA_AUTO_PLACEMENT || cu_index == XMA_AUTO_PLACEMENT) {
+        if (xma_hw_place_session(hwcfg, &dev_index, &cu_index, filter_props->cu_name,
+                                 filter_props->ddr_bank_index, filter_props->channel_id, &reservation) != XMA_SUCCESS) {
+            xma_logmsg(XMA_ERROR_LOG, XMA_FILTER_MOD,
+                       "XMA session creation failed. No CU found for automatic placement\n");
+            free(filter_session);
+            return NULL;
+        }
+        //Report the placement back in the properties
+        filter_props->dev_index = dev_index;
+        filter_props->cu_index = cu_index;
+        filter_session->props.dev_index = dev_index;
+        filter_session->props.cu_index = cu_index;
+    }
     if (dev_index >= hwcfg->num_devices || dev_index < 0) {
         xma_logmsg(XMA_ERROR_LOG, XMA_FILTER_MOD,
                    "XMA session creation failed. dev_index not found\n");
-        //Release singleton lock
-        g_xma_singleton->locked = false;
         free(filter_session);
         return NULL;
     }
@@ -126,47 +133,28 @@ xma_filter_session_create(XmaFilterProperties *filter_props)
     if (!found) {
         xma_logmsg(XMA_ERROR_LOG, XMA_FILTER_MOD,
                    "XMA session creation failed. dev_index not loaded with xclbin\n");
-        //Release singleton lock
-        g_xma_singleton->locked = false;
         free(filter_session);
         return NULL;
     }
     if ((uint32_t)cu_index >= hwcfg->devices[hwcfg_dev_index].number_of_cus || (cu_index < 0 && filter_props->cu_name == NULL)) {
         xma_logmsg(XMA_ERROR_LOG, XMA_FILTER_MOD,
                    "XMA session creation failed. Invalid cu_index = %d\n", cu_index);
-        //Release singleton lock
-        g_xma_singleton->locked = false;
         free(filter_session);
         return NULL;
     }
     if (cu_index < 0) {
         std::string cu_name = std::string(filter_props->cu_name);
-        found = false;
-        for (XmaHwKernel& kernel: g_xma_singleton->hwcfg.devices[hwcfg_dev_index].kernels) {
-            if (std::string((char*)kernel.name) == cu_name) {
-                found = true;
-                cu_index = kernel.cu_index;
-                break;
-            }
-        }
-        if (!found) {
+        auto cu_itr = hwcfg->devices[hwcfg_dev_index].cu_index_by_name.find(cu_name);
+        if (cu_itr != hwcfg->devices[hwcfg_dev_index].cu_index_by_name.end()) {
+            cu_index = cu_itr->second;
+        } else {
             xma_logmsg(XMA_ERROR_LOG, XMA_FILTER_MOD,
                     "XMA session creation failed. cu %s not found\n", cu_name.c_str());
-            //Release singleton lock
-            g_xma_singleton->locked = false;
             free(filter_session);
             return NULL;
         }
     }
 
-    if (hwcfg->devices[hwcfg_dev_index].kernels[cu_index].in_use) {
-        xma_logmsg(XMA_INFO_LOG, XMA_FILTER_MOD,
-                   "XMA session sharing CU: %s\n", hwcfg->devices[hwcfg_dev_index].kernels[cu_index].name);
-    } else {
-        xma_logmsg(XMA_INFO_LOG, XMA_FILTER_MOD,
-                   "XMA session with CU: %s\n", hwcfg->devices[hwcfg_dev_index].kernels[cu_index].name);
-    }
-
     filter_session->base.hw_session.dev_handle = hwcfg->devices[hwcfg_dev_index].handle;
 
     //For execbo:
@@ -207,8 +195,6 @@ xma_filter_session_create(XmaFilterProperties *filter_props)
                 xma_logmsg(XMA_ERROR_LOG, XMA_FILTER_MOD,
                     "User supplied default ddr_bank is invalid. Valid ddr_bank mapping for this CU: %s\n", tmp_bset.to_string());
                 
-                //Release singleton lock
-                g_xma_singleton->locked = false;
                 free(filter_session);
                 return NULL;
             }
@@ -220,8 +206,6 @@ xma_filter_session_create(XmaFilterProperties *filter_props)
             xma_logmsg(XMA_ERROR_LOG, XMA_FILTER_MOD,
                 "Selected dataflow CU with channels has ini setting with max channel_id of %d. Cannot create session with higher channel_id of %d\n", filter_session->base.hw_session.kernel_info->max_channel_id, filter_session->base.channel_id);
             
-            //Release singleton lock
-            g_xma_singleton->locked = false;
             free(filter_session);
             return NULL;
         }
@@ -235,8 +219,6 @@ xma_filter_session_create(XmaFilterProperties *filter_props)
     if ((xma_main_ver == 2019 && xma_sub_ver < 2) || xma_main_ver < 2019 || rc < 0) {
         xma_logmsg(XMA_ERROR_LOG, XMA_FILTER_MOD,
                    "Initalization of plugin failed. Plugin is incompatible with this XMA version\n");
-        //Release singleton lock
-        g_xma_singleton->locked = false;
         free(filter_session);
         return NULL;
     }
@@ -245,29 +227,31 @@ xma_filter_session_create(XmaFilterProperties *filter_props)
     filter_session->base.plugin_data =
         calloc(filter_session->filter_plugin->plugin_data_size, sizeof(uint8_t));
 
-    filter_session->base.session_id = g_xma_singleton->num_filters + 1;
+    filter_session->base.session_id = ++g_xma_singleton->num_filters;
     filter_session->base.session_signature = (void*)(((uint64_t)filter_session->base.hw_session.kernel_info) | ((uint64_t)filter_session->base.hw_session.dev_handle));
     xma_logmsg(XMA_INFO_LOG, XMA_FILTER_MOD,
                 "XMA session channel_id: %d; filter_id: %d\n", filter_session->base.channel_id, filter_session->base.session_id);
 
+    if (xma_hw_session_attach(&filter_session->base) != XMA_SUCCESS) {
+        xma_logmsg(XMA_ERROR_LOG, XMA_FILTER_MOD,
+                   "Unable to allocate execBOs for this session\n");
+        free(filter_session->base.plugin_data);
+        free(filter_session);
+        return NULL;
+    }
+    reservation.release();
+
     rc = filter_session->filter_plugin->init(filter_session);
     if (rc) {
         xma_logmsg(XMA_ERROR_LOG, XMA_FILTER_MOD,
                    "Initalization of filter plugin failed. Return code %d\n",
                    rc);
-        //Release singleton lock
-        g_xma_singleton->locked = false;
+        xma_hw_session_detach(&filter_session->base);
         free(filter_session->base.plugin_data);
         free(filter_session);
         return NULL;
     }
 
-    g_xma_singleton->num_filters = filter_session->base.session_id;
-    filter_session->base.hw_session.kernel_info->in_use = true;
-
-    //Release singleton lock
-    g_xma_singleton->locked = false;
-
     return filter_session;
 }
 
@@ -277,29 +261,14 @@ xma_filter_session_destroy(XmaFilterSession *session)
     int32_t rc;
 
     xma_logmsg(XMA_DEBUG_LOG, XMA_FILTER_MOD, "%s()\n", __func__);
-    bool expected = false;
-    bool desired = true;
-    while (!(g_xma_singleton->locked).compare_exchange_weak(expected, desired)) {
-        expected = false;
-    }
-    //Singleton lock acquired
-
     if (session == NULL) {
         xma_logmsg(XMA_ERROR_LOG, XMA_FILTER_MOD,
                    "Session is already released\n");
-
-        //Release singleton lock
-        g_xma_singleton->locked = false;
-
         return XMA_ERROR;
     }
     if (session->filter_plugin == NULL) {
         xma_logmsg(XMA_ERROR_LOG, XMA_FILTER_MOD,
                    "Session is corrupted\n");
-
-        //Release singleton lock
-        g_xma_singleton->locked = false;
-
         return XMA_ERROR;
     }
     rc  = session->filter_plugin->close(session);
@@ -314,6 +283,7 @@ xma_filter_session_destroy(XmaFilterSession *session)
     session->base.plugin_data = NULL;
     session->base.stats = NULL;
     session->filter_plugin = NULL;
+    xma_hw_session_detach(&session->base);
     session->base.hw_session.dev_handle = NULL;
     session->base.hw_session.kernel_info = NULL;
     //do not change kernel in_use as it maybe in use by another plugin
@@ -322,9 +292,6 @@ xma_filter_session_destroy(XmaFilterSession *session)
     free(session);
     session = NULL;
 
-    //Release singleton lock
-    g_xma_singleton->locked = false;
-
     return XMA_SUCCESS;
 }
 
@@ -338,7 +305,16 @@ xma_filter_session_send_frame(XmaFilterSession  *session,
         return XMA_ERROR;
     }
 
-    return session->filter_plugin->send_frame(session, frame);
+    XmaFrame *staged;
+    if (xma_frame_stage_for_session(&session->base, frame, &staged) != XMA_SUCCESS) {
+        xma_logmsg(XMA_ERROR_LOG, XMA_FILTER_MOD, "Unable to copy frame to the session device\n");
+        return XMA_ERROR;
+    }
+    int32_t rc = session->filter_plugin->send_frame(session, staged);
+    // Plugins that keep the staged frame hold their own reference
+    if (staged != frame)
+        xma_frame_free(staged);
+    return rc;
 }
 
 int32_t
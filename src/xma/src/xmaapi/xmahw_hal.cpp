@@ -23,6 +23,7 @@
 #include <fcntl.h>
 #include <sys/ioctl.h>
 #include <unistd.h>
+#include <time.h>
 #include "xrt.h"
 #include "app/xmaerror.h"
 #include "app/xmalogger.h"
@@ -32,6 +33,10 @@
 #include <dlfcn.h>
 #include <iostream>
 #include <bitset>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <thread>
 #include "ert.h"
 
 //#define xma_logmsg(f_, ...) printf((f_), ##__VA_ARGS__)
@@ -71,13 +76,6 @@ int load_xclbin_to_device(xclDeviceHandle dev_handle, const char *buffer)
 {
     int rc;
 
-    rc = xclLockDevice(dev_handle);
-    if (rc != 0)
-    {
-        printf("Failed to lock device\n");
-        return rc;
-    }
-
     printf("load_xclbin_to_device handle = %p\n", dev_handle);
     rc = xclLoadXclBin(dev_handle, (const xclBin*)buffer);
     if (rc != 0)
@@ -166,10 +164,184 @@ bool hal_is_compatible(XmaHwCfg *hwcfg, XmaXclbinParameter *devXclbins, int32_t
 }
 
 
+/* An xclbin read and parsed once for all the devices it is loaded on */
+typedef struct XmaXclbinImage
+{
+    char          *buffer;
+    XmaXclbinInfo  info;
+
+  XmaXclbinImage() {
+    buffer = NULL;
+  }
+  ~XmaXclbinImage() {
+    free(buffer);
+  }
+} XmaXclbinImage;
+
+static double elapsed_ms(const std::chrono::steady_clock::time_point& start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/* Return the index of the first hardware CU, -1 if the xclbin has none */
+static int32_t first_hw_cu(const XmaXclbinInfo& info)
+{
+    for (uint32_t d = 0; d < info.number_of_kernels; d++) {
+        if (!info.ip_layout[d].soft_kernel)
+            return (int32_t)d;
+    }
+    return -1;
+}
+
+static bool hal_configure_device(XmaHwDevice& dev_tmp1, int32_t dev_index,
+                                 const std::string& xclbin, XmaXclbinImage& image)
+{
+    XmaXclbinInfo& info = image.info;
+    int32_t rc;
+
+    auto start = std::chrono::steady_clock::now();
+    dev_tmp1.handle = xclOpen(dev_index, NULL, XCL_QUIET);
+    if (dev_tmp1.handle == NULL){
+        xma_logmsg(XMA_ERROR_LOG, XMAAPI_MOD, "Unable to open device  id: %d\n", dev_index);
+        return false;
+    }
+    dev_tmp1.dev_index = dev_index;
+    xma_logmsg(XMA_INFO_LOG, XMAAPI_MOD, "xclOpen handle = %p\n",
+        dev_tmp1.handle);
+    rc = xclGetDeviceInfo2(dev_tmp1.handle, &dev_tmp1.info);
+    if (rc != 0)
+    {
+        xma_logmsg(XMA_ERROR_LOG, XMAAPI_MOD, "xclGetDeviceInfo2 failed for device id: %d, rc=%d\n", dev_index, rc);
+        return false;
+    }
+    double open_ms = elapsed_ms(start);
+
+    /* The device is locked whether or not the xclbin has to be loaded.
+     * The driver only grants a CU context for the xclbin currently on the
+     * device, so a successful context on the first hardware CU means the
+     * requested xclbin is already loaded and only the download is skipped.
+     * That context is kept and not opened again below.
+     */
+    start = std::chrono::steady_clock::now();
+    rc = xclLockDevice(dev_tmp1.handle);
+    if (rc != 0) {
+        xma_logmsg(XMA_ERROR_LOG, XMAAPI_MOD, "Failed to lock device %d\n", dev_index);
+        return false;
+    }
+    int32_t probe_cu = first_hw_cu(info);
+    bool loaded = probe_cu >= 0 &&
+                  xclOpenContext(dev_tmp1.handle, info.uuid, probe_cu, true) == 0;
+    if (!loaded) {
+        probe_cu = -1;
+        rc = load_xclbin_to_device(dev_tmp1.handle, image.buffer);
+        if (rc != 0) {
+            xma_logmsg(XMA_ERROR_LOG, XMAAPI_MOD, "Could not download xclbin file %s to device %d\n",
+                        xclbin.c_str(), dev_index);
+            return false;
+        }
+    }
+    double load_ms = elapsed_ms(start);
+
+    start = std::chrono::steady_clock::now();
+    uuid_copy(dev_tmp1.uuid, info.uuid); 
+    dev_tmp1.number_of_cus = info.number_of_kernels;
+    dev_tmp1.number_of_mem_banks = info.number_of_mem_banks;
+    dev_tmp1.kernels.reserve(dev_tmp1.number_of_cus);
+
+    xma_logmsg(XMA_DEBUG_LOG, XMAAPI_MOD,"For device id: %d; CUs are:\n", dev_index);
+    for (uint32_t d = 0; d < info.number_of_kernels; d++) {
+        dev_tmp1.kernels.emplace_back(XmaHwKernel{});
+        XmaHwKernel& tmp1 = dev_tmp1.kernels.back();
+        strcpy((char*)tmp1.name,
+            (const char*)info.ip_layout[d].kernel_name);
+        tmp1.base_address = info.ip_layout[d].base_addr;
+        tmp1.cu_index = (int32_t)d;
+        dev_tmp1.cu_index_by_name.emplace(std::string((const char*)tmp1.name), (int32_t)d);
+        if (info.ip_layout[d].soft_kernel) {
+            tmp1.soft_kernel = true;
+            tmp1.default_ddr_bank = 0;
+        } else {
+            if (info.ip_layout[d].kernel_channels) {
+                tmp1.kernel_channels = true;
+                tmp1.max_channel_id = info.ip_layout[d].max_channel_id;
+            }
+            rc = xma_xclbin_map2ddr(info.ip_ddr_mapping[d], &tmp1.default_ddr_bank);
+
+            //XMA now supports multiple DDR Banks per Kernel
+            tmp1.ip_ddr_mapping = info.ip_ddr_mapping[d];
+            for(uint32_t c = 0; c < info.number_of_connections; c++)
+            {
+                XmaAXLFConnectivity *xma_conn = &info.connectivity[c];
+                if (xma_conn->m_ip_layout_index == (int32_t)d) {
+                    tmp1.CU_arg_to_mem_info.emplace(xma_conn->arg_index, xma_conn->mem_data_index);
+                }
+            }
+
+            if (tmp1.default_ddr_bank < 0) {
+                xma_logmsg(XMA_WARNING_LOG, XMAAPI_MOD,"\tCU# %d - %s - DDR bank: NONE\n", d, tmp1.name);
+            } else {
+                xma_logmsg(XMA_DEBUG_LOG, XMAAPI_MOD,"\tCU# %d - %s - DDR bank:%d\n", d, tmp1.name, tmp1.default_ddr_bank);
+            }
+            if ((int32_t)d != probe_cu &&
+                xclOpenContext(dev_tmp1.handle, info.uuid, d, true) != 0) {
+                xma_logmsg(XMA_ERROR_LOG, XMAAPI_MOD, "Failed to open context to this CU\n");
+                return false;
+            }
+        }
+        tmp1.private_do_not_use = (void*) &dev_tmp1;
+    }
+
+    std::bitset<MAX_XILINX_KERNELS> cu_mask;
+    uint64_t base_addr1 = 0;
+    for (uint32_t d1 = 0; d1 < info.number_of_hardware_kernels; d1++) {
+        base_addr1 = dev_tmp1.kernels[d1].base_address;
+        //uint64_t cu_mask = 1;
+        cu_mask.reset();
+        cu_mask.set(0);
+
+        for (uint32_t d2 = 0; d2 < info.number_of_kernels; d2++) {
+            if (d1 != d2) {
+                if (dev_tmp1.kernels[d2].base_address < base_addr1) {
+                    cu_mask = cu_mask << 1;
+                }
+            }
+        }
+        //dev_tmp1.kernels[d1].cu_mask0 = cu_mask & 0xFFFFFFFF;
+        //dev_tmp1.kernels[d1].cu_mask1 = ((uint64_t)(cu_mask >> 32)) & 0xFFFFFFFF;
+        dev_tmp1.kernels[d1].cu_mask0 = cu_mask.to_ulong();
+        cu_mask = cu_mask >> 32;
+        dev_tmp1.kernels[d1].cu_mask1 = cu_mask.to_ulong();
+        cu_mask = cu_mask >> 32;
+        dev_tmp1.kernels[d1].cu_mask2 = cu_mask.to_ulong();
+        cu_mask = cu_mask >> 32;
+        dev_tmp1.kernels[d1].cu_mask3 = cu_mask.to_ulong();
+    }
+
+    cu_mask.reset();
+    cu_mask.set(0);
+    std::bitset<MAX_XILINX_KERNELS> cu_mask_tmp;
+    for (uint32_t d1 = info.number_of_hardware_kernels; d1 < info.number_of_kernels; d1++) {
+        cu_mask_tmp = cu_mask;
+        dev_tmp1.kernels[d1].cu_mask0 = cu_mask_tmp.to_ulong();
+        cu_mask_tmp = cu_mask_tmp >> 32;
+        dev_tmp1.kernels[d1].cu_mask1 = cu_mask_tmp.to_ulong();
+        cu_mask_tmp = cu_mask_tmp >> 32;
+        dev_tmp1.kernels[d1].cu_mask2 = cu_mask_tmp.to_ulong();
+        cu_mask_tmp = cu_mask_tmp >> 32;
+        dev_tmp1.kernels[d1].cu_mask3 = cu_mask_tmp.to_ulong();
+
+        cu_mask = cu_mask << 1;
+    }
+
+    //execBOs are allocated per CU as sessions are created
+    xma_logmsg(XMA_INFO_LOG, XMAAPI_MOD, "Device %d configured: open %.1f ms, xclbin %s %.1f ms, CU setup %.1f ms\n",
+               dev_index, open_ms, loaded ? "already loaded" : "download", load_ms, elapsed_ms(start));
+    return true;
+}
+
 //bool hal_configure(XmaHwCfg *hwcfg, XmaSystemCfg *systemcfg, bool hw_configured)
 bool hal_configure(XmaHwCfg *hwcfg, XmaXclbinParameter *devXclbins, int32_t num_parms)
 {
-    XmaXclbinInfo info;
     if (hwcfg == NULL) {
         xma_logmsg(XMA_ERROR_LOG, XMAAPI_MOD, "hwcfg is NULL\n");
         return false;
@@ -180,195 +352,365 @@ bool hal_configure(XmaHwCfg *hwcfg, XmaXclbinParameter *devXclbins, int32_t num_
         return false;
     }
 
-    /* Download the requested image to the associated device */
+    /* Read and parse each distinct xclbin once */
+    auto start = std::chrono::steady_clock::now();
+    auto total_start = start;
+    std::map<std::string, std::unique_ptr<XmaXclbinImage>> images;
+    std::bitset<MAX_XILINX_DEVICES> dev_requested;
     for (int32_t i = 0; i < num_parms; i++) {
         std::string xclbin = std::string(devXclbins[i].xclbin_name);
         int32_t dev_index = devXclbins[i].device_id;
-        if (dev_index >= hwcfg->num_devices || dev_index < 0) {
+        if (dev_index >= hwcfg->num_devices || dev_index < 0 || dev_index >= MAX_XILINX_DEVICES) {
             xma_logmsg(XMA_ERROR_LOG, XMAAPI_MOD, "Illegal dev_index for xclbin to load into. dev_index = %d\n",
                        dev_index);
             return false;
         }
-        char *buffer = xma_xclbin_file_open(xclbin.c_str());
-        if (!buffer)
+        if (dev_requested.test(dev_index)) {
+            xma_logmsg(XMA_ERROR_LOG, XMAAPI_MOD, "dev_index %d is given more than once\n", dev_index);
+            return false;
+        }
+        dev_requested.set(dev_index);
+        if (images.find(xclbin) != images.end())
+            continue;
+
+        std::unique_ptr<XmaXclbinImage> image(new XmaXclbinImage);
+        image->buffer = xma_xclbin_file_open(xclbin.c_str());
+        if (!image->buffer)
         {
             xma_logmsg(XMA_ERROR_LOG, XMAAPI_MOD, "Could not open xclbin file %s\n",
                        xclbin.c_str());
             return false;
         }
-        int32_t rc = xma_xclbin_info_get(buffer, &info);
+        int32_t rc = xma_xclbin_info_get(image->buffer, &image->info);
         if (rc != XMA_SUCCESS)
         {
             xma_logmsg(XMA_ERROR_LOG, XMAAPI_MOD, "Could not get info for xclbin file %s\n",
                        xclbin.c_str());
-            free(buffer);
             return false;
         }
+        if (image->info.number_of_kernels > MAX_XILINX_KERNELS + MAX_XILINX_SOFT_KERNELS) {
+            xma_logmsg(XMA_ERROR_LOG, XMAAPI_MOD, "Could not download xclbin file %s\n",
+                        xclbin.c_str());
+            xma_logmsg(XMA_ERROR_LOG, XMAAPI_MOD, "XMA & XRT supports max of %d CUs but xclbin has %d number of CUs\n", MAX_XILINX_KERNELS + MAX_XILINX_SOFT_KERNELS, image->info.number_of_kernels);
+            return false;
+        }
+        images.emplace(xclbin, std::move(image));
+    }
+    xma_logmsg(XMA_INFO_LOG, XMAAPI_MOD, "Read %d xclbin file(s) for %d device(s) in %.1f ms\n",
+               (int32_t)images.size(), num_parms, elapsed_ms(start));
+
+    /* Devices are opened, loaded and set up in parallel.  The devices
+     * vector is sized up front so each thread owns its own entry and
+     * the CUs' pointers back to their device stay valid.
+     */
+    start = std::chrono::steady_clock::now();
+    hwcfg->devices.resize(num_parms);
+    std::vector<char> configured(num_parms, 0);
+    std::vector<std::thread> threads;
+    threads.reserve(num_parms);
+    for (int32_t i = 0; i < num_parms; i++) {
+        threads.emplace_back([&, i]() {
+            std::string xclbin = std::string(devXclbins[i].xclbin_name);
+            configured[i] = hal_configure_device(hwcfg->devices[i], devXclbins[i].device_id,
+                                                 xclbin, *images.at(xclbin));
+        });
+    }
+    for (auto& thread: threads) {
+        thread.join();
+    }
+    xma_logmsg(XMA_INFO_LOG, XMAAPI_MOD, "Configured %d device(s) in %.1f ms, xma hw configure took %.1f ms\n",
+               num_parms, elapsed_ms(start), elapsed_ms(total_start));
+
+    for (int32_t i = 0; i < num_parms; i++) {
+        if (!configured[i])
+            return false;
+    }
+    return true;
+}
 
-        hwcfg->devices.emplace_back(XmaHwDevice{});
+int32_t xma_hw_session_attach(XmaSession *session)
+{
+    xclDeviceHandle dev_handle = session->hw_session.dev_handle;
+    XmaHwKernel *kernel = session->hw_session.kernel_info;
+    std::lock_guard<std::mutex> guard(*kernel->session_lock);
+    if (kernel->in_use) {
+        xma_logmsg(XMA_INFO_LOG, XMAAPI_MOD, "XMA session sharing CU: %s\n", kernel->name);
+    } else {
+        xma_logmsg(XMA_INFO_LOG, XMAAPI_MOD, "XMA session with CU: %s\n", kernel->name);
+    }
+    if (!kernel->execbo_pool)
+        kernel->execbo_pool.reset(new XmaHwExecBOPool);
+
+    XmaHwExecBOPool *pool = kernel->execbo_pool.get();
+    pool->num_sessions++;
+    //A single session may keep as many work items in flight as the old device wide pool
+    int32_t num_execbo = pool->num_sessions * EXECBO_POOL_PER_SESSION;
+    if (num_execbo < MIN_EXECBO_POOL_SIZE)
+        num_execbo = MIN_EXECBO_POOL_SIZE;
+    if (num_execbo > MAX_EXECBO_PER_CU)
+        num_execbo = MAX_EXECBO_PER_CU;
+
+    for (int32_t d = pool->num_slots; d < num_execbo; d++) {
+        uint32_t  bo_handle;
+        int       execBO_size = MAX_EXECBO_BUFF_SIZE;
+        char     *bo_data;
+        bo_handle = xclAllocBO(dev_handle,
+                                execBO_size,
+                                0,
+                                XCL_BO_FLAGS_EXECBUF);
+        if (!bo_handle || bo_handle == mNullBO)
+        {
+            xma_logmsg(XMA_ERROR_LOG, XMAAPI_MOD, "Unable to create bo for cu start\n");
+            break;
+        }
+        bo_data = (char*)xclMapBO(dev_handle, bo_handle, true);
+        memset((void*)bo_data, 0x0, execBO_size);
+        pool->bo_handle[d] = bo_handle;
+        pool->bo_data[d] = bo_data;
+        pool->num_slots = d + 1;
+        pool->free_push(d);
+    }
+    xma_logmsg(XMA_DEBUG_LOG, XMAAPI_MOD, "CU %s: %d sessions; %d execBOs\n", kernel->name, pool->num_sessions, pool->num_slots.load());
 
-        XmaHwDevice& dev_tmp1 = hwcfg->devices.back();
-        //dev_tmp1.kernels.reserve(LIKELY_KERNEL_CONFIGS); Reserving below based on number of CUs
+    // Running with fewer slots than asked for only limits pipelining
+    if (pool->num_slots == 0) {
+        pool->num_sessions--;
+        return XMA_ERROR;
+    }
+    XmaHwSessionPrivate *priv = new XmaHwSessionPrivate;
+    priv->buffer_pool = new XmaHwBufferPool(dev_handle, session->hw_session.dev_index);
+    session->hw_session.private_do_not_use = priv;
+    kernel->in_use = true;
+    return XMA_SUCCESS;
+}
 
-        dev_tmp1.handle = xclOpen(dev_index, NULL, XCL_QUIET);
-        if (dev_tmp1.handle == NULL){
-            xma_logmsg(XMA_ERROR_LOG, XMAAPI_MOD, "Unable to open device  id: %d\n", dev_index);
-            free(buffer);
-            return false;
+void xma_hw_session_detach(XmaSession *session)
+{
+    XmaHwKernel *kernel = session->hw_session.kernel_info;
+    XmaHwSessionPrivate *priv = (XmaHwSessionPrivate*)session->hw_session.private_do_not_use;
+    XmaHwExecBOPool *pool = kernel ? kernel->execbo_pool.get() : NULL;
+    if (pool == NULL)
+        return;
+
+    if (priv) {
+        // Slots of unfinished work items are still owned by the CU
+        int32_t give_up = 0;
+        while (priv->head != priv->tail && give_up < 3) {
+            int32_t slot = priv->slot[priv->head & (WORK_ITEM_RING_SIZE - 1)];
+            ert_start_kernel_cmd *cu_cmd = (ert_start_kernel_cmd*)pool->bo_data[slot];
+            if (cu_cmd->state == ERT_CMD_STATE_COMPLETED ||
+                cu_cmd->state == ERT_CMD_STATE_ERROR ||
+                cu_cmd->state == ERT_CMD_STATE_ABORT) {
+                pool->slot_state[slot] = XmaHwExecBOPool::SLOT_FREE;
+                pool->free_push(slot);
+                priv->head++;
+                continue;
+            }
+            if (xclExecWait(session->hw_session.dev_handle, 100) <= 0)
+                give_up++;
         }
-        dev_tmp1.dev_index = dev_index;
-        xma_logmsg(XMA_INFO_LOG, XMAAPI_MOD, "xclOpen handle = %p\n",
-            dev_tmp1.handle);
-        rc = xclGetDeviceInfo2(dev_tmp1.handle, &dev_tmp1.info);
-        if (rc != 0)
-        {
-            xma_logmsg(XMA_ERROR_LOG, XMAAPI_MOD, "xclGetDeviceInfo2 failed for device id: %d, rc=%d\n", dev_index, rc);
-            free(buffer);
-            return false;
+        if (priv->head != priv->tail) {
+            xma_logmsg(XMA_WARNING_LOG, XMAAPI_MOD, "CU %s: session destroyed with %d work items in flight\n",
+                       kernel->name, (int32_t)(priv->tail - priv->head));
+            // The CU still writes these execBOs; reclaimed once it is done
+            for (; priv->head != priv->tail; priv->head++)
+                pool->orphan_push(priv->slot[priv->head & (WORK_ITEM_RING_SIZE - 1)]);
         }
+        if (priv->buffer_pool)
+            priv->buffer_pool->close();
+        delete priv;
+        session->hw_session.private_do_not_use = NULL;
+    }
+    std::lock_guard<std::mutex> guard(*kernel->session_lock);
+    if (pool->num_sessions > 0)
+        pool->num_sessions--;
+    kernel->in_use = (pool->num_sessions > 0);
+}
 
-        /* Always attempt download xclbin */
-        rc = load_xclbin_to_device(dev_tmp1.handle, buffer);
-        if (rc != 0) {
-            free(buffer);
-            xma_logmsg(XMA_ERROR_LOG, XMAAPI_MOD, "Could not download xclbin file %s to device %d\n",
-                        xclbin.c_str(), dev_index);
-            return false;
+// CU name is "kernel:instance"; sessions may ask for either the CU or its kernel
+static bool xma_hw_cu_name_match(const XmaHwKernel& kernel, const char *cu_name)
+{
+    const char *name = (const char*)kernel.name;
+    size_t len = strlen(cu_name);
+    if (strncmp(name, cu_name, len) != 0)
+        return false;
+    return name[len] == '\0' || name[len] == ':';
+}
+
+// Sample the load of a CU and add reserve to its reserved sessions in one step
+static void xma_hw_cu_load_get(XmaHwDevice& device, XmaHwKernel& kernel, int32_t bank,
+                               const xclDeviceUsage *usage, XmaCULoad *load, int32_t reserve = 0)
+{
+    memset(load, 0, sizeof(XmaCULoad));
+    load->dev_index = device.dev_index;
+    load->cu_index = kernel.cu_index;
+    strncpy(load->cu_name, (const char*)kernel.name, MAX_CU_NAME - 1);
+    load->bank_index = bank;
+
+    std::unique_lock<std::mutex> guard(*kernel.session_lock);
+    load->num_sessions = kernel.reserved_sessions;
+    kernel.reserved_sessions += reserve;
+    XmaHwExecBOPool *pool = kernel.execbo_pool.get();
+    if (pool) {
+        load->num_sessions += pool->num_sessions;
+        for (int32_t d = 0; d < pool->num_slots; d++) {
+            uint8_t state = pool->slot_state[d].load(std::memory_order_relaxed);
+            if (state == XmaHwExecBOPool::SLOT_SUBMITTED || state == XmaHwExecBOPool::SLOT_TRACKED)
+                load->in_flight++;
         }
-        uuid_copy(dev_tmp1.uuid, info.uuid); 
-        dev_tmp1.number_of_cus = info.number_of_kernels;
-        dev_tmp1.number_of_mem_banks = info.number_of_mem_banks;
-        if (dev_tmp1.number_of_cus > MAX_XILINX_KERNELS + MAX_XILINX_SOFT_KERNELS) {
-            free(buffer);
-            xma_logmsg(XMA_ERROR_LOG, XMAAPI_MOD, "Could not download xclbin file %s to device %d\n",
-                        xclbin.c_str(), dev_index);
-            xma_logmsg(XMA_ERROR_LOG, XMAAPI_MOD, "XMA & XRT supports max of %d CUs but xclbin has %d number of CUs\n", MAX_XILINX_KERNELS + MAX_XILINX_SOFT_KERNELS, dev_tmp1.number_of_cus);
-            return false;
+        // Rate over the time since the previous sample; short windows keep the last rate
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        uint64_t now = (ts.tv_sec * 1000000000ULL) + ts.tv_nsec;
+        uint64_t completed = pool->completed_total.load();
+        if (pool->sample_time_ns == 0) {
+            pool->sample_time_ns = now;
+            pool->sample_completed = completed;
+        } else if (now - pool->sample_time_ns >= 100000000ULL) {
+            pool->completion_rate = (uint32_t)((completed - pool->sample_completed) * 1000000000ULL / (now - pool->sample_time_ns));
+            pool->sample_time_ns = now;
+            pool->sample_completed = completed;
         }
-        dev_tmp1.kernels.reserve(dev_tmp1.number_of_cus);
-
-        xma_logmsg(XMA_DEBUG_LOG, XMAAPI_MOD,"For device id: %d; CUs are:\n", dev_index);
-        for (uint32_t d = 0; d < info.number_of_kernels; d++) {
-            dev_tmp1.kernels.emplace_back(XmaHwKernel{});
-            XmaHwKernel& tmp1 = dev_tmp1.kernels.back();
-            strcpy((char*)tmp1.name,
-                (const char*)info.ip_layout[d].kernel_name);
-            tmp1.base_address = info.ip_layout[d].base_addr;
-            tmp1.cu_index = (int32_t)d;
-            if (info.ip_layout[d].soft_kernel) {
-                tmp1.soft_kernel = true;
-                tmp1.default_ddr_bank = 0;
-            } else {
-                if (info.ip_layout[d].kernel_channels) {
-                    tmp1.kernel_channels = true;
-                    tmp1.max_channel_id = info.ip_layout[d].max_channel_id;
-                }
-                rc = xma_xclbin_map2ddr(info.ip_ddr_mapping[d], &tmp1.default_ddr_bank);
-
-                //XMA now supports multiple DDR Banks per Kernel
-                tmp1.ip_ddr_mapping = info.ip_ddr_mapping[d];
-                for(uint32_t c = 0; c < info.number_of_connections; c++)
-                {
-                    XmaAXLFConnectivity *xma_conn = &info.connectivity[c];
-                    if (xma_conn->m_ip_layout_index == (int32_t)d) {
-                        tmp1.CU_arg_to_mem_info.emplace(xma_conn->arg_index, xma_conn->mem_data_index);
-                    }
-                }
+        load->completed = completed;
+        load->completion_rate = pool->completion_rate;
+    }
+    guard.unlock();
 
-                if (tmp1.default_ddr_bank < 0) {
-                    xma_logmsg(XMA_WARNING_LOG, XMAAPI_MOD,"\tCU# %d - %s - DDR bank: NONE\n", d, tmp1.name);
-                } else {
-                    xma_logmsg(XMA_DEBUG_LOG, XMAAPI_MOD,"\tCU# %d - %s - DDR bank:%d\n", d, tmp1.name, tmp1.default_ddr_bank);
-                }
-                if (xclOpenContext(dev_tmp1.handle, info.uuid, d, true) != 0) {
-                    free(buffer);
-                    xma_logmsg(XMA_ERROR_LOG, XMAAPI_MOD, "Failed to open context to this CU\n");
-                    return false;
-                }
+    // Usage is only reported for the first 8 banks
+    if (usage && bank >= 0 && bank < 8 && device.info.mDDRBankCount && device.info.mDDRSize) {
+        uint64_t bank_size = device.info.mDDRSize / device.info.mDDRBankCount;
+        uint64_t pct = bank_size ? (usage->ddrMemUsed[bank] * 100) / bank_size : 0;
+        load->bank_used_pct = pct > 100 ? 100 : (uint32_t)pct;
+    }
+
+    // Sessions dominate; the rest breaks ties between equally shared CUs
+    uint32_t rate = load->completion_rate / 10;
+    load->load = load->num_sessions * 1000 + load->in_flight * 100 +
+                 (rate > 100 ? 100 : rate) + load->bank_used_pct;
+}
+
+int32_t xma_hw_cu_load(XmaHwCfg *hwcfg, XmaCULoad *table, int32_t max_entries)
+{
+    int32_t count = 0;
+    for (XmaHwDevice& device: hwcfg->devices) {
+        xclDeviceUsage usage;
+        bool have_usage = (xclGetUsageInfo(device.handle, &usage) == 0);
+        for (XmaHwKernel& kernel: device.kernels) {
+            if (count < max_entries) {
+                int32_t bank = kernel.soft_kernel ? 0 : kernel.default_ddr_bank;
+                xma_hw_cu_load_get(device, kernel, bank, have_usage ? &usage : NULL, &table[count]);
             }
-            tmp1.private_do_not_use = (void*) &hwcfg->devices[hwcfg->devices.size()-1];
+            count++;
         }
+    }
+    return count;
+}
 
-        std::bitset<MAX_XILINX_KERNELS> cu_mask;
-        uint64_t base_addr1 = 0;
-        for (uint32_t d1 = 0; d1 < info.number_of_hardware_kernels; d1++) {
-            base_addr1 = dev_tmp1.kernels[d1].base_address;
-            //uint64_t cu_mask = 1;
-            cu_mask.reset();
-            cu_mask.set(0);
-
-            for (uint32_t d2 = 0; d2 < info.number_of_kernels; d2++) {
-                if (d1 != d2) {
-                    if (dev_tmp1.kernels[d2].base_address < base_addr1) {
-                        cu_mask = cu_mask << 1;
-                    }
-                }
+int32_t xma_hw_cu_stats(XmaHwCfg *hwcfg, XmaPerfStats *table, int32_t max_entries)
+{
+    int32_t count = 0;
+    for (XmaHwDevice& device: hwcfg->devices) {
+        for (XmaHwKernel& kernel: device.kernels) {
+            if (count < max_entries) {
+                XmaPerfStats *stats = &table[count];
+                memset(stats, 0, sizeof(XmaPerfStats));
+                stats->dev_index = device.dev_index;
+                stats->cu_index = kernel.cu_index;
+                strncpy(stats->cu_name, (const char*)kernel.name, MAX_CU_NAME - 1);
+                stats->session_id = -1;
+
+                // The pool is created under the lock; its counters are read without it
+                std::unique_lock<std::mutex> guard(*kernel.session_lock);
+                XmaHwExecBOPool *pool = kernel.execbo_pool.get();
+                if (pool)
+                    stats->num_sessions = pool->num_sessions;
+                guard.unlock();
+                if (pool)
+                    pool->stats.get(stats);
             }
-            //dev_tmp1.kernels[d1].cu_mask0 = cu_mask & 0xFFFFFFFF;
-            //dev_tmp1.kernels[d1].cu_mask1 = ((uint64_t)(cu_mask >> 32)) & 0xFFFFFFFF;
-            dev_tmp1.kernels[d1].cu_mask0 = cu_mask.to_ulong();
-            cu_mask = cu_mask >> 32;
-            dev_tmp1.kernels[d1].cu_mask1 = cu_mask.to_ulong();
-            cu_mask = cu_mask >> 32;
-            dev_tmp1.kernels[d1].cu_mask2 = cu_mask.to_ulong();
-            cu_mask = cu_mask >> 32;
-            dev_tmp1.kernels[d1].cu_mask3 = cu_mask.to_ulong();
+            count++;
         }
+    }
+    return count;
+}
 
-        cu_mask.reset();
-        cu_mask.set(0);
-        std::bitset<MAX_XILINX_KERNELS> cu_mask_tmp;
-        for (uint32_t d1 = info.number_of_hardware_kernels; d1 < info.number_of_kernels; d1++) {
-            cu_mask_tmp = cu_mask;
-            dev_tmp1.kernels[d1].cu_mask0 = cu_mask_tmp.to_ulong();
-            cu_mask_tmp = cu_mask_tmp >> 32;
-            dev_tmp1.kernels[d1].cu_mask1 = cu_mask_tmp.to_ulong();
-            cu_mask_tmp = cu_mask_tmp >> 32;
-            dev_tmp1.kernels[d1].cu_mask2 = cu_mask_tmp.to_ulong();
-            cu_mask_tmp = cu_mask_tmp >> 32;
-            dev_tmp1.kernels[d1].cu_mask3 = cu_mask_tmp.to_ulong();
-
-            cu_mask = cu_mask << 1;
-        }
+int32_t xma_hw_session_stats(XmaSession *session, XmaPerfStats *stats)
+{
+    XmaHwKernel *kernel = session->hw_session.kernel_info;
+    XmaHwSessionPrivate *priv = (XmaHwSessionPrivate*)session->hw_session.private_do_not_use;
+    if (kernel == NULL || priv == NULL)
+        return XMA_ERROR;
 
-        int32_t num_execbo = 0;
-        if (dev_tmp1.number_of_cus > MIN_EXECBO_POOL_SIZE) {
-            num_execbo = dev_tmp1.number_of_cus;
-        } else {
-            num_execbo = MIN_EXECBO_POOL_SIZE;
-        }
-        dev_tmp1.kernel_execbo_handle.reserve(num_execbo);
-        dev_tmp1.kernel_execbo_data.reserve(num_execbo);
-        dev_tmp1.kernel_execbo_inuse.reserve(num_execbo);
-        dev_tmp1.kernel_execbo_cu_index.reserve(num_execbo);
-        dev_tmp1.num_execbo_allocated = num_execbo;
-        for (int32_t d = 0; d < num_execbo; d++) {
-            uint32_t  bo_handle;
-            int       execBO_size = MAX_EXECBO_BUFF_SIZE;
-            //uint32_t  execBO_flags = (1<<31);
-            char     *bo_data;
-            bo_handle = xclAllocBO(dev_tmp1.handle, 
-                                    execBO_size, 
-                                    0, 
-                                    XCL_BO_FLAGS_EXECBUF);
-            if (!bo_handle || bo_handle == mNullBO) 
-            {
-                free(buffer);
-                xma_logmsg(XMA_ERROR_LOG, XMAAPI_MOD, "Unable to create bo for cu start\n");
-                return false;
-            }
-            bo_data = (char*)xclMapBO(dev_tmp1.handle, bo_handle, true);
-            memset((void*)bo_data, 0x0, execBO_size);
-            dev_tmp1.kernel_execbo_handle.emplace_back(bo_handle);
-            dev_tmp1.kernel_execbo_data.emplace_back(bo_data);
-            dev_tmp1.kernel_execbo_inuse.emplace_back(false);
-            dev_tmp1.kernel_execbo_cu_index.emplace_back(-1);
-        }
+    memset(stats, 0, sizeof(XmaPerfStats));
+    stats->dev_index = session->hw_session.dev_index;
+    stats->cu_index = kernel->cu_index;
+    strncpy(stats->cu_name, (const char*)kernel->name, MAX_CU_NAME - 1);
+    stats->session_id = session->session_id;
+    stats->num_sessions = 1;
+    priv->stats.get(stats);
+    return XMA_SUCCESS;
+}
 
-        free(buffer);
+int32_t xma_hw_place_session(XmaHwCfg *hwcfg, int32_t *dev_index, int32_t *cu_index,
+                             const char *cu_name, int32_t ddr_bank_index, int32_t channel_id,
+                             XmaHwReservation *reservation)
+{
+    if (cu_name == NULL && *cu_index == XMA_AUTO_PLACEMENT) {
+        xma_logmsg(XMA_ERROR_LOG, XMAAPI_MOD, "Automatic placement needs cu_name to be set\n");
+        return XMA_ERROR;
     }
 
-    return true;
+    XmaCULoad best;
+    bool found = false;
+    for (XmaHwDevice& device: hwcfg->devices) {
+        if (*dev_index != XMA_AUTO_PLACEMENT && (int32_t)device.dev_index != *dev_index)
+            continue;
+        xclDeviceUsage usage;
+        bool have_usage = false;
+        for (XmaHwKernel& kernel: device.kernels) {
+            if (*cu_index != XMA_AUTO_PLACEMENT) {
+                if (kernel.cu_index != *cu_index)
+                    continue;
+            } else if (!xma_hw_cu_name_match(kernel, cu_name)) {
+                continue;
+            }
+            int32_t bank = kernel.soft_kernel ? 0 : kernel.default_ddr_bank;
+            if (ddr_bank_index >= 0) {
+                if (kernel.soft_kernel ? ddr_bank_index != 0 :
+                    (ddr_bank_index >= MAX_DDR_MAP || !(kernel.ip_ddr_mapping & (1ULL << ddr_bank_index))))
+                    continue;
+                bank = ddr_bank_index;
+            }
+            if (kernel.kernel_channels && channel_id > (int32_t)kernel.max_channel_id)
+                continue;
+            if (!have_usage)
+                have_usage = (xclGetUsageInfo(device.handle, &usage) == 0);
+
+            // Every CU looked at is reserved while it is compared, so a
+            // concurrent placement sees it as taken; all but the best are
+            // handed back
+            XmaCULoad load;
+            xma_hw_cu_load_get(device, kernel, bank, have_usage ? &usage : NULL, &load, 1);
+            if (!found || load.load < best.load) {
+                reservation->reserve(&kernel);
+                best = load;
+                found = true;
+            } else {
+                std::lock_guard<std::mutex> guard(*kernel.session_lock);
+                kernel.reserved_sessions--;
+            }
+        }
+    }
+    if (!found) {
+        xma_logmsg(XMA_ERROR_LOG, XMAAPI_MOD, "Automatic placement found no CU matching %s\n",
+                   cu_name ? cu_name : "cu_index");
+        return XMA_ERROR;
+    }
+    xma_logmsg(XMA_INFO_LOG, XMAAPI_MOD, "Automatic placement: device %d CU %s with load %u\n",
+               best.dev_index, best.cu_name, best.load);
+    *dev_index = best.dev_index;
+    *cu_index = best.cu_index;
+    return XMA_SUCCESS;
 }
 
 XmaHwInterface hw_if = {
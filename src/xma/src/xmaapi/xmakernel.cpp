@@ -92,23 +92,30 @@ xma_kernel_session_create(XmaKernelProperties *props)
     session->base.stats = NULL;
     session->kernel_plugin = plg;
 
-    bool expected = false;
-    bool desired = true;
-    while (!(g_xma_singleton->locked).compare_exchange_weak(expected, desired)) {
-        expected = false;
-    }
-    //Singleton lock acquired
-
     int32_t rc, dev_index, cu_index;
     dev_index = props->dev_index;
     cu_index = props->cu_index;
 
     XmaHwCfg *hwcfg = &g_xma_singleton->hwcfg;
+    //Counts as a session on the CU picked until attached or failed
+    XmaHwReservation reservation;
+    if (dev_index == XMA_AUTO_PLACEMENT || cu_index == XMA_AUTO_PLACEMENT) {
+        if (xma_hw_place_session(hwcfg, &dev_index, &cu_index, props->cu_name,
+                                 props->ddr_bank_index, props->channel_id, &reservation) != XMA_SUCCESS) {
+            xma_logmsg(XMA_ERROR_LOG, XMA_KERNEL_MOD,
+                       "XMA session creation failed. No CU found for automatic placement\n");
+            free(session);
+            return NULL;
+        }
+        //Report the placement back in the properties
+        props->dev_index = dev_index;
+        props->cu_index = cu_index;
+        session->kernel_props.dev_index = dev_index;
+        session->kernel_props.cu_index = cu_index;
+    }
     if (dev_index >= hwcfg->num_devices || dev_index < 0) {
         xma_logmsg(XMA_ERROR_LOG, XMA_KERNEL_MOD,
                    "XMA session creation failed. dev_index not found\n");
-        //Release singleton lock
-        g_xma_singleton->locked = false;
         free(session);
         return NULL;
     }
@@ -125,47 +132,28 @@ xma_kernel_session_create(XmaKernelProperties *props)
     if (!found) {
         xma_logmsg(XMA_ERROR_LOG, XMA_KERNEL_MOD,
                    "XMA session creation failed. dev_index not loaded with xclbin\n");
-        //Release singleton lock
-        g_xma_singleton->locked = false;
         free(session);
         return NULL;
     }
     if ((uint32_t)cu_index >= hwcfg->devices[hwcfg_dev_index].number_of_cus || (cu_index < 0 && props->cu_name == NULL)) {
         xma_logmsg(XMA_ERROR_LOG, XMA_KERNEL_MOD,
                    "XMA session creation failed. Invalid cu_index = %d\n", cu_index);
-        //Release singleton lock
-        g_xma_singleton->locked = false;
         free(session);
         return NULL;
     }
     if (cu_index < 0) {
         std::string cu_name = std::string(props->cu_name);
-        found = false;
-        for (XmaHwKernel& kernel: g_xma_singleton->hwcfg.devices[hwcfg_dev_index].kernels) {
-            if (std::string((char*)kernel.name) == cu_name) {
-                found = true;
-                cu_index = kernel.cu_index;
-                break;
-            }
-        }
-        if (!found) {
+        auto cu_itr = hwcfg->devices[hwcfg_dev_index].cu_index_by_name.find(cu_name);
+        if (cu_itr != hwcfg->devices[hwcfg_dev_index].cu_index_by_name.end()) {
+            cu_index = cu_itr->second;
+        } else {
             xma_logmsg(XMA_ERROR_LOG, XMA_KERNEL_MOD,
                     "XMA session creation failed. cu %s not found\n", cu_name.c_str());
-            //Release singleton lock
-            g_xma_singleton->locked = false;
             free(session);
             return NULL;
         }
     }
 
-    if (hwcfg->devices[hwcfg_dev_index].kernels[cu_index].in_use) {
-        xma_logmsg(XMA_INFO_LOG, XMA_KERNEL_MOD,
-                   "XMA session sharing CU: %s\n", hwcfg->devices[hwcfg_dev_index].kernels[cu_index].name);
-    } else {
-        xma_logmsg(XMA_INFO_LOG, XMA_KERNEL_MOD,
-                   "XMA session with CU: %s\n", hwcfg->devices[hwcfg_dev_index].kernels[cu_index].name);
-    }
-
     session->base.hw_session.dev_handle = hwcfg->devices[hwcfg_dev_index].handle;
 
     //For execbo:
@@ -205,8 +193,6 @@ xma_kernel_session_create(XmaKernelProperties *props)
                 xma_logmsg(XMA_ERROR_LOG, XMA_KERNEL_MOD,
                     "User supplied default ddr_bank is invalid. Valid ddr_bank mapping for this CU: %s\n", tmp_bset.to_string());
                 
-                //Release singleton lock
-                g_xma_singleton->locked = false;
                 free(session);
                 return NULL;
             }
@@ -218,8 +204,6 @@ xma_kernel_session_create(XmaKernelProperties *props)
             xma_logmsg(XMA_ERROR_LOG, XMA_KERNEL_MOD,
                 "Selected dataflow CU with channels has ini setting with max channel_id of %d. Cannot create session with higher channel_id of %d\n", session->base.hw_session.kernel_info->max_channel_id, session->base.channel_id);
             
-            //Release singleton lock
-            g_xma_singleton->locked = false;
             free(session);
             return NULL;
         }
@@ -233,8 +217,6 @@ xma_kernel_session_create(XmaKernelProperties *props)
     if ((xma_main_ver == 2019 && xma_sub_ver < 2) || xma_main_ver < 2019 || rc < 0) {
         xma_logmsg(XMA_ERROR_LOG, XMA_KERNEL_MOD,
                    "Initalization of plugin failed. Plugin is incompatible with this XMA version\n");
-        //Release singleton lock
-        g_xma_singleton->locked = false;
         free(session);
         return NULL;
     }
@@ -243,7 +225,7 @@ xma_kernel_session_create(XmaKernelProperties *props)
     session->base.plugin_data =
         calloc(session->kernel_plugin->plugin_data_size, sizeof(uint8_t));
 
-    session->base.session_id = g_xma_singleton->num_kernels + 1;
+    session->base.session_id = ++g_xma_singleton->num_kernels;
     session->base.session_signature = (void*)(((uint64_t)session->base.hw_session.kernel_info) | ((uint64_t)session->base.hw_session.dev_handle));
     //Sarab: TODO Allow user selected ddr bank per XMA session
     session->base.hw_session.bank_index = -1;
@@ -251,24 +233,26 @@ xma_kernel_session_create(XmaKernelProperties *props)
     xma_logmsg(XMA_INFO_LOG, XMA_KERNEL_MOD,
                 "XMA session channel_id: %d; kernel_id: %d\n", session->base.channel_id, session->base.session_id);
 
+    if (xma_hw_session_attach(&session->base) != XMA_SUCCESS) {
+        xma_logmsg(XMA_ERROR_LOG, XMA_KERNEL_MOD,
+                   "Unable to allocate execBOs for this session\n");
+        free(session->base.plugin_data);
+        free(session);
+        return NULL;
+    }
+    reservation.release();
+
     rc = session->kernel_plugin->init(session);
     if (rc) {
         xma_logmsg(XMA_ERROR_LOG, XMA_KERNEL_MOD,
                    "Initalization of kernel plugin failed. Return code %d\n",
                    rc);
-        //Release singleton lock
-        g_xma_singleton->locked = false;
+        xma_hw_session_detach(&session->base);
         free(session->base.plugin_data);
         free(session);
         return NULL;
     }
 
-    session->base.hw_session.kernel_info->in_use = true;
-    g_xma_singleton->num_kernels = session->base.session_id;
-
-    //Release singleton lock
-    g_xma_singleton->locked = false;
-
     return session;
 }
 
@@ -278,29 +262,14 @@ xma_kernel_session_destroy(XmaKernelSession *session)
     int32_t rc;
 
     xma_logmsg(XMA_DEBUG_LOG, XMA_KERNEL_MOD, "%s()\n", __func__);
-    bool expected = false;
-    bool desired = true;
-    while (!(g_xma_singleton->locked).compare_exchange_weak(expected, desired)) {
-        expected = false;
-    }
-    //Singleton lock acquired
-
     if (session == NULL) {
         xma_logmsg(XMA_ERROR_LOG, XMA_KERNEL_MOD,
                    "Session is already released\n");
-
-        //Release singleton lock
-        g_xma_singleton->locked = false;
-
         return XMA_ERROR;
     }
     if (session->kernel_plugin == NULL) {
         xma_logmsg(XMA_ERROR_LOG, XMA_KERNEL_MOD,
                    "Session is corrupted\n");
-
-        //Release singleton lock
-        g_xma_singleton->locked = false;
-
         return XMA_ERROR;
     }
     rc  = session->kernel_plugin->close(session);
@@ -315,6 +284,7 @@ xma_kernel_session_destroy(XmaKernelSession *session)
     session->base.plugin_data = NULL;
     session->base.stats = NULL;
     session->kernel_plugin = NULL;
+    xma_hw_session_detach(&session->base);
     session->base.hw_session.dev_handle = NULL;
     session->base.hw_session.kernel_info = NULL;
     //do not change kernel in_use as it maybe in use by another plugin
@@ -323,9 +293,6 @@ xma_kernel_session_destroy(XmaKernelSession *session)
     free(session);
     session = NULL;
 
-    //Release singleton lock
-    g_xma_singleton->locked = false;
-
     return XMA_SUCCESS;
 }
 
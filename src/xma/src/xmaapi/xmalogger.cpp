@@ -33,11 +33,16 @@
 #include <string>
 #include <fstream>
 #include <iostream>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 #include "lib/xmaapi.h"
 #include "app/xmalogger.h"
 #include "lib/xmalogger.h"
 #include "xrt.h"
+#include "core/common/config_reader.h"
 
 #ifdef XMA_DEBUG
 #define XMA_DBG_PRINTF(format, ...) \
@@ -48,33 +53,201 @@
 
 extern XmaSingleton *g_xma_singleton;
 
+namespace {
+
+// One formatted message waiting for the logger thread
+struct XmaLogEntry
+{
+    XmaLogLevelType level;
+    char            msg[XMA_MAX_LOGMSG_SIZE];
+};
+
+// Rate limit state of one module
+struct XmaLogModule
+{
+    char     name[40];
+    uint64_t window_start_ms;
+    uint32_t count;
+    uint32_t suppressed;
+};
+
+// Messages are formatted by the caller and written out by one logger
+// thread so that a slow log sink never stalls a stream thread
+struct XmaLogQueue
+{
+    std::mutex              lock;
+    std::condition_variable cv;
+    std::condition_variable space_cv;//Errors waiting for room in the queue
+    XmaLogEntry             entries[XMA_MAX_LOGMSG_Q_ENTRIES];
+    int32_t                 front = 0;
+    int32_t                 num_entries = 0;
+    uint32_t                dropped = 0;
+    bool                    stopped = false;
+    std::thread             thread;
+
+    XmaLogModule            modules[XMA_MAX_LOG_MODULES];
+    int32_t                 num_modules = 0;
+};
+
+uint64_t xma_log_now_ms()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void xma_log_thread(XmaLogQueue *queue)
+{
+    XmaLogEntry entry;
+    std::unique_lock<std::mutex> guard(queue->lock);
+    while (true) {
+        queue->cv.wait(guard, [queue] { return queue->num_entries > 0 || queue->stopped; });
+        if (queue->num_entries == 0)
+            break;
+        entry = queue->entries[queue->front];
+        queue->front = (queue->front + 1) % XMA_MAX_LOGMSG_Q_ENTRIES;
+        queue->num_entries--;
+        uint32_t dropped = queue->dropped;
+        queue->dropped = 0;
+        guard.unlock();
+        queue->space_cv.notify_all();
+
+        if (dropped)
+            xclLogMsg(NULL, XRT_WARNING, "XMA", "%s XMA %u log messages dropped, log queue full",
+                      program_invocation_short_name, dropped);
+        xclLogMsg(NULL, entry.level, "XMA", "%s", entry.msg);
+        guard.lock();
+    }
+}
+
+XmaLogQueue *xma_log_queue();
+
+// Writes out what is queued before the process exits; later messages are
+// logged by the caller
+void xma_log_flush()
+{
+    XmaLogQueue *queue = xma_log_queue();
+    {
+        std::lock_guard<std::mutex> guard(queue->lock);
+        queue->stopped = true;
+    }
+    queue->cv.notify_all();
+    if (queue->thread.joinable())
+        queue->thread.join();
+}
+
+XmaLogQueue *xma_log_queue()
+{
+    // Never freed: messages may still be logged from other atexit handlers
+    static XmaLogQueue *queue = [] {
+        XmaLogQueue *q = new XmaLogQueue;
+        q->thread = std::thread(xma_log_thread, q);
+        atexit(xma_log_flush);
+        return q;
+    }();
+    return queue;
+}
+
+// Returns false when the module has used up its messages for this window;
+// otherwise *suppressed is the number dropped in the window before.
+// Called with the queue locked.
+bool xma_log_admit(XmaLogQueue *queue, const char *name, uint32_t *suppressed)
+{
+    XmaLogModule *module = NULL;
+    for (int32_t i = 0; i < queue->num_modules; i++) {
+        if (strncmp(queue->modules[i].name, name, sizeof(module->name) - 1) == 0) {
+            module = &queue->modules[i];
+            break;
+        }
+    }
+    if (module == NULL) {
+        if (queue->num_modules == XMA_MAX_LOG_MODULES)
+            return true;
+        module = &queue->modules[queue->num_modules++];
+        memset(module, 0, sizeof(XmaLogModule));
+        strncpy(module->name, name, sizeof(module->name) - 1);
+    }
+
+    uint64_t now = xma_log_now_ms();
+    *suppressed = 0;
+    if (now - module->window_start_ms >= XMA_LOGMSG_RATE_WINDOW_MS) {
+        *suppressed = module->suppressed;
+        module->window_start_ms = now;
+        module->count = 0;
+        module->suppressed = 0;
+    }
+    if (module->count == XMA_LOGMSG_RATE_LIMIT) {
+        module->suppressed++;
+        return false;
+    }
+    module->count++;
+    return true;
+}
+
+// Errors are never dropped; when the queue is full they wait for room so
+// that they stay in order with the messages queued before them
+void xma_log_enqueue(XmaLogQueue *queue, XmaLogLevelType level, const char *msg)
+{
+    std::unique_lock<std::mutex> guard(queue->lock);
+    if (level <= XMA_ERROR_LOG) {
+        queue->space_cv.wait(guard, [queue] {
+            return queue->num_entries < XMA_MAX_LOGMSG_Q_ENTRIES || queue->stopped;
+        });
+    }
+    if (!queue->stopped && queue->num_entries < XMA_MAX_LOGMSG_Q_ENTRIES) {
+        int32_t back = (queue->front + queue->num_entries) % XMA_MAX_LOGMSG_Q_ENTRIES;
+        queue->entries[back].level = level;
+        strncpy(queue->entries[back].msg, msg, XMA_MAX_LOGMSG_SIZE - 1);
+        queue->entries[back].msg[XMA_MAX_LOGMSG_SIZE - 1] = '\0';
+        queue->num_entries++;
+        guard.unlock();
+        queue->cv.notify_one();
+        return;
+    }
+    if (!queue->stopped && level > XMA_ERROR_LOG) {
+        queue->dropped++;
+        return;
+    }
+    guard.unlock();
+    xclLogMsg(NULL, level, "XMA", "%s", msg);
+}
+
+} // namespace
+
 void
 xma_logmsg(XmaLogLevelType level, const char *name, const char *msg, ...)
 {
+    /* Filter before any formatting; XRT drops these anyway */
+    if ((uint32_t)level > xrt_core::config::get_verbosity())
+        return;
+
     /* Handle variable arguments */
     va_list ap;
 
     /* Create message buffer on the stack */
     char            msg_buff[XMA_MAX_LOGMSG_SIZE];
-    char            log_name[40] = {0};
+    const char     *log_name = name ? name : "XMA-default";
     int32_t         hdr_offset;
+    uint32_t        suppressed = 0;
 
-    memset(msg_buff, 0, sizeof(msg_buff));
+    XmaLogQueue *queue = xma_log_queue();
+    /* Info and debug are asked for explicitly with the verbosity */
+    if (level == XMA_WARNING_LOG) {
+        std::lock_guard<std::mutex> guard(queue->lock);
+        if (!xma_log_admit(queue, log_name, &suppressed))
+            return;
+    }
+    if (suppressed) {
+        snprintf(msg_buff, sizeof(msg_buff), "%s %.39s %u messages suppressed\n",
+                 program_invocation_short_name, log_name, suppressed);
+        xma_log_enqueue(queue, XMA_WARNING_LOG, msg_buff);
+    }
 
-    /* Set component name */
-    if (name == NULL)
-        strncpy(log_name, "XMA-default", sizeof(log_name));
-    else
-        strncpy(log_name, name, sizeof(log_name)-1);
-
-
-    sprintf(msg_buff, "%s %s ", program_invocation_short_name, log_name);
-    hdr_offset = strlen(msg_buff);
+    hdr_offset = snprintf(msg_buff, sizeof(msg_buff), "%s %.39s ",
+                          program_invocation_short_name, log_name);
+    if (hdr_offset < 0 || hdr_offset >= XMA_MAX_LOGMSG_SIZE)
+        hdr_offset = XMA_MAX_LOGMSG_SIZE - 1;
     va_start(ap, msg);
     vsnprintf(&msg_buff[hdr_offset], (XMA_MAX_LOGMSG_SIZE - hdr_offset), msg, ap);
     va_end(ap);
-    //xclLogMsg(NULL, xrtLogMsgLevel::XRT_INFO, "XMA",logmsg);
-    xclLogMsg(NULL, (xrtLogMsgLevel)level, "XMA", msg_buff);
-
+    xma_log_enqueue(queue, level, msg_buff);
 }
-
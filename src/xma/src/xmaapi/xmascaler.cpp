@@ -187,24 +187,31 @@ xma_scaler_session_create(XmaScalerProperties *sc_props)
     sc_session->base.stats = NULL;
     sc_session->scaler_plugin = plg;
 
-    bool expected = false;
-    bool desired = true;
-    while (!(g_xma_singleton->locked).compare_exchange_weak(expected, desired)) {
-        expected = false;
-    }
-    //Singleton lock acquired
-
     int32_t rc, dev_index, cu_index;
     dev_index = sc_props->dev_index;
     cu_index = sc_props->cu_index;
     //enc_handle = enc_props->cu_index;
 
     XmaHwCfg *hwcfg = &g_xma_singleton->hwcfg;
+    //Counts as a session on the CU picked until attached or failed
+    XmaHwReservation reservation;
+    if (dev_index == XMA_AUTO_PLACEMENT || cu_index == XMA_AUTO_PLACEMENT) {
+        if (xma_hw_place_session(hwcfg, &dev_index, &cu_index, sc_props->cu_name,
+                                 sc_props->ddr_bank_index, sc_props->channel_id, &reservation) != XMA_SUCCESS) {
+            xma_logmsg(XMA_ERROR_LOG, XMA_SCALER_MOD,
+                       "XMA session creation failed. No CU found for automatic placement\n");
+            free(sc_session);
+            return NULL;
+        }
+        //Report the placement back in the properties
+        sc_props->dev_index = dev_index;
+        sc_props->cu_index = cu_index;
+        sc_session->props.dev_index = dev_index;
+        sc_session->props.cu_index = cu_index;
+    }
     if (dev_index >= hwcfg->num_devices || dev_index < 0) {
         xma_logmsg(XMA_ERROR_LOG, XMA_SCALER_MOD,
                    "XMA session creation failed. dev_index not found\n");
-        //Release singleton lock
-        g_xma_singleton->locked = false;
         free(sc_session);
         return NULL;
     }
@@ -221,47 +228,28 @@ xma_scaler_session_create(XmaScalerProperties *sc_props)
     if (!found) {
         xma_logmsg(XMA_ERROR_LOG, XMA_SCALER_MOD,
                    "XMA session creation failed. dev_index not loaded with xclbin\n");
-        //Release singleton lock
-        g_xma_singleton->locked = false;
         free(sc_session);
         return NULL;
     }
     if ((uint32_t)cu_index >= hwcfg->devices[hwcfg_dev_index].number_of_cus || (cu_index < 0 && sc_props->cu_name == NULL)) {
         xma_logmsg(XMA_ERROR_LOG, XMA_SCALER_MOD,
                    "XMA session creation failed. Invalid cu_index = %d\n", cu_index);
-        //Release singleton lock
-        g_xma_singleton->locked = false;
         free(sc_session);
         return NULL;
     }
     if (cu_index < 0) {
         std::string cu_name = std::string(sc_props->cu_name);
-        found = false;
-        for (XmaHwKernel& kernel: g_xma_singleton->hwcfg.devices[hwcfg_dev_index].kernels) {
-            if (std::string((char*)kernel.name) == cu_name) {
-                found = true;
-                cu_index = kernel.cu_index;
-                break;
-            }
-        }
-        if (!found) {
+        auto cu_itr = hwcfg->devices[hwcfg_dev_index].cu_index_by_name.find(cu_name);
+        if (cu_itr != hwcfg->devices[hwcfg_dev_index].cu_index_by_name.end()) {
+            cu_index = cu_itr->second;
+        } else {
             xma_logmsg(XMA_ERROR_LOG, XMA_SCALER_MOD,
                     "XMA session creation failed. cu %s not found\n", cu_name.c_str());
-            //Release singleton lock
-            g_xma_singleton->locked = false;
             free(sc_session);
             return NULL;
         }
     }
 
-    if (hwcfg->devices[hwcfg_dev_index].kernels[cu_index].in_use) {
-        xma_logmsg(XMA_INFO_LOG, XMA_SCALER_MOD,
-                   "XMA session sharing CU: %s\n", hwcfg->devices[hwcfg_dev_index].kernels[cu_index].name);
-    } else {
-        xma_logmsg(XMA_INFO_LOG, XMA_SCALER_MOD,
-                   "XMA session with CU: %s\n", hwcfg->devices[hwcfg_dev_index].kernels[cu_index].name);
-    }
-
     sc_session->base.hw_session.dev_handle = hwcfg->devices[hwcfg_dev_index].handle;
 
     //For execbo:
@@ -301,8 +289,6 @@ xma_scaler_session_create(XmaScalerProperties *sc_props)
                 xma_logmsg(XMA_ERROR_LOG, XMA_SCALER_MOD,
                     "User supplied default ddr_bank is invalid. Valid ddr_bank mapping for this CU: %s\n", tmp_bset.to_string());
                 
-                //Release singleton lock
-                g_xma_singleton->locked = false;
                 free(sc_session);
                 return NULL;
             }
@@ -314,8 +300,6 @@ xma_scaler_session_create(XmaScalerProperties *sc_props)
             xma_logmsg(XMA_ERROR_LOG, XMA_SCALER_MOD,
                 "Selected dataflow CU with channels has ini setting with max channel_id of %d. Cannot create session with higher channel_id of %d\n", sc_session->base.hw_session.kernel_info->max_channel_id, sc_session->base.channel_id);
             
-            //Release singleton lock
-            g_xma_singleton->locked = false;
             free(sc_session);
             return NULL;
         }
@@ -329,8 +313,6 @@ xma_scaler_session_create(XmaScalerProperties *sc_props)
     if ((xma_main_ver == 2019 && xma_sub_ver < 2) || xma_main_ver < 2019 || rc < 0) {
         xma_logmsg(XMA_ERROR_LOG, XMA_SCALER_MOD,
                    "Initalization of plugin failed. Plugin is incompatible with this XMA version\n");
-        //Release singleton lock
-        g_xma_singleton->locked = false;
         free(sc_session);
         return NULL;
     }
@@ -339,27 +321,30 @@ xma_scaler_session_create(XmaScalerProperties *sc_props)
     sc_session->base.plugin_data =
         calloc(sc_session->scaler_plugin->plugin_data_size, sizeof(uint8_t));
 
-    sc_session->base.session_id = g_xma_singleton->num_scalers + 1;
+    sc_session->base.session_id = ++g_xma_singleton->num_scalers;
     sc_session->base.session_signature = (void*)(((uint64_t)sc_session->base.hw_session.kernel_info) | ((uint64_t)sc_session->base.hw_session.dev_handle));
     xma_logmsg(XMA_INFO_LOG, XMA_SCALER_MOD,
                 "XMA session channel_id: %d; scaler_id: %d\n", sc_session->base.channel_id, sc_session->base.session_id);
 
+    if (xma_hw_session_attach(&sc_session->base) != XMA_SUCCESS) {
+        xma_logmsg(XMA_ERROR_LOG, XMA_SCALER_MOD,
+                   "Unable to allocate execBOs for this session\n");
+        free(sc_session->base.plugin_data);
+        free(sc_session);
+        return NULL;
+    }
+    reservation.release();
+
     rc = sc_session->scaler_plugin->init(sc_session);
     if (rc) {
         xma_logmsg(XMA_ERROR_LOG, XMA_SCALER_MOD,
                    "Initalization of plugin failed. Return code %d\n",
                    rc);
-        //Release singleton lock
-        g_xma_singleton->locked = false;
+        xma_hw_session_detach(&sc_session->base);
         free(sc_session->base.plugin_data);
         free(sc_session);
         return NULL;
     }
-    sc_session->base.hw_session.kernel_info->in_use = true;
-    g_xma_singleton->num_scalers = sc_session->base.session_id;
-
-    //Release singleton lock
-    g_xma_singleton->locked = false;
 
     return sc_session;
 }
@@ -370,29 +355,14 @@ xma_scaler_session_destroy(XmaScalerSession *session)
     int32_t rc;
 
     xma_logmsg(XMA_DEBUG_LOG, XMA_SCALER_MOD, "%s()\n", __func__);
-    bool expected = false;
-    bool desired = true;
-    while (!(g_xma_singleton->locked).compare_exchange_weak(expected, desired)) {
-        expected = false;
-    }
-    //Singleton lock acquired
-
     if (session == NULL) {
         xma_logmsg(XMA_ERROR_LOG, XMA_SCALER_MOD,
                    "Session is already released\n");
-
-        //Release singleton lock
-        g_xma_singleton->locked = false;
-
         return XMA_ERROR;
     }
     if (session->scaler_plugin == NULL) {
         xma_logmsg(XMA_ERROR_LOG, XMA_SCALER_MOD,
                    "Session is corrupted\n");
-
-        //Release singleton lock
-        g_xma_singleton->locked = false;
-
         return XMA_ERROR;
     }
     rc  = session->scaler_plugin->close(session);
@@ -407,6 +377,7 @@ xma_scaler_session_destroy(XmaScalerSession *session)
     session->base.plugin_data = NULL;
     session->base.stats = NULL;
     session->scaler_plugin = NULL;
+    xma_hw_session_detach(&session->base);
     session->base.hw_session.dev_handle = NULL;
     session->base.hw_session.kernel_info = NULL;
     //do not change kernel in_use as it maybe in use by another plugin
@@ -415,9 +386,6 @@ xma_scaler_session_destroy(XmaScalerSession *session)
     free(session);
     session = NULL;
 
-    //Release singleton lock
-    g_xma_singleton->locked = false;
-
     return XMA_SUCCESS;
 }
 
@@ -433,7 +401,16 @@ xma_scaler_session_send_frame(XmaScalerSession  *session,
         return XMA_ERROR;
     }
 
-    return session->scaler_plugin->send_frame(session, frame);
+    XmaFrame *staged;
+    if (xma_frame_stage_for_session(&session->base, frame, &staged) != XMA_SUCCESS) {
+        xma_logmsg(XMA_ERROR_LOG, XMA_SCALER_MOD, "Unable to copy frame to the session device\n");
+        return XMA_ERROR;
+    }
+    int32_t rc = session->scaler_plugin->send_frame(session, staged);
+    // Plugins that keep the staged frame hold their own reference
+    if (staged != frame)
+        xma_frame_free(staged);
+    return rc;
 }
 
 int32_t
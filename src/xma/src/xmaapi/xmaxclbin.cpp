@@ -24,6 +24,7 @@
 #include "app/xmalogger.h"
 #include "lib/xmaxclbin.h"
 #include "core/common/config_reader.h"
+#include "core/common/xclbin_parser.h"
 
 #define XMAAPI_MOD "xmaxclbin"
 
@@ -55,30 +56,6 @@ char *xma_xclbin_file_open(const char *xclbin_name)
     return buffer;
 }
 
-static int32_t kernel_max_channel_id(const ip_data& ip, std::string kernel_channels)
-{
-  if (kernel_channels.empty())
-    return -1;
-
-  std::string knm = std::string(reinterpret_cast<const char*>(ip.m_name));
-  knm = knm.substr(0,knm.find(":"));
-
-  auto pos1 = kernel_channels.find("{"+knm+":");
-  if (pos1 == std::string::npos)
-    return -1;
-
-  auto pos2 = kernel_channels.find("}",pos1);
-  if (pos2 == std::string::npos || pos2 < pos1+knm.size()+2)
-    return -2;
-
-  auto ctxid_str = kernel_channels.substr(pos1+knm.size()+2,pos2);
-  auto ctxid = std::stoi(ctxid_str);
-  if (ctxid < 0 || ctxid > 31)
-    return -3;
-  
-  return ctxid;
-}
-
 static int get_xclbin_iplayout(char *buffer, XmaXclbinInfo *xclbin_info)
 {
     axlf *xclbin = reinterpret_cast<axlf *>(buffer);
@@ -91,7 +68,9 @@ static int get_xclbin_iplayout(char *buffer, XmaXclbinInfo *xclbin_info)
         //XmaIpLayout* layout = xclbin_info->ip_layout;
         xclbin_info->number_of_kernels = 0;
         xclbin_info->number_of_hardware_kernels = 0;
+        // Only quoted in the error messages below, the index holds the parsed max channel ids
         std::string kernel_channels_info = xrt_core::config::get_kernel_channel_info();
+        auto xclbin_index = xrt_core::xclbin::get_index(xclbin);
         uint32_t j = 0;
         for (int i = 0; i < ipl->m_count; i++)
         {
@@ -112,7 +91,8 @@ static int get_xclbin_iplayout(char *buffer, XmaXclbinInfo *xclbin_info)
             //layout[j].base_addr = ipl->m_ip_data[i].m_base_address;
             xclbin_info->ip_layout[j].base_addr = ipl->m_ip_data[i].m_base_address;
             if (((ipl->m_ip_data[i].properties & IP_CONTROL_MASK) >> IP_CONTROL_SHIFT) == AP_CTRL_CHAIN) {
-                int32_t max_channel_id = kernel_max_channel_id(ipl->m_ip_data[i], kernel_channels_info);
+                auto cu = xclbin_index->find_ip_cu(i);
+                int32_t max_channel_id = cu ? cu->max_channel_id : -1;
                 if (max_channel_id >= 0) {
                     xma_logmsg(XMA_INFO_LOG, XMAAPI_MOD, "kernel \"%s\" is a dataflow kernel. channel_id will be handled by XMA. host app and plugins should not use reserved channle_id registers. Max channel_id is: %d\n", str_tmp1.c_str(), max_channel_id);
                     xclbin_info->ip_layout[j].kernel_channels = true;
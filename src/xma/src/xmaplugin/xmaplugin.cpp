@@ -25,6 +25,7 @@
 #include <cstring>
 #include <thread>
 #include <chrono>
+#include <algorithm>
 using namespace std;
 
 #define XMAPLUGIN_MOD "xmapluginlib"
@@ -34,6 +35,56 @@ using namespace std;
 //NULL data pointer in buffer obj implies it is device only buffer..
 //Remove read/write before SyncBO.. As plugin should manage that using host mapped data pointer..
 
+// Get a device buffer from the session buffer pool, or straight from XRT
+// for sessions without one
+static int32_t
+xma_plg_buffer_obj_get(XmaSession& s_handle, size_t size, bool device_only_buffer, uint32_t ddr_bank, XmaBufferObj* b_obj)
+{
+    XmaHwSessionPrivate *priv = (XmaHwSessionPrivate*)s_handle.hw_session.private_do_not_use;
+    XmaBufferObjPrivate* tmp1 = NULL;
+    if (priv && priv->buffer_pool) {
+        tmp1 = priv->buffer_pool->acquire(size, ddr_bank, device_only_buffer);
+        if (tmp1 == NULL)
+            return XMA_ERROR;
+    } else {
+        /*
+        #define XRT_BO_FLAGS_MEMIDX_MASK        (0xFFFFFFUL)
+        #define XCL_BO_FLAGS_CACHEABLE          (1 << 24)
+        #define XCL_BO_FLAGS_SVM                (1 << 27)
+        #define XCL_BO_FLAGS_DEV_ONLY           (1 << 28)
+        #define XCL_BO_FLAGS_HOST_ONLY          (1 << 29)
+        #define XCL_BO_FLAGS_P2P                (1 << 30)
+        #define XCL_BO_FLAGS_EXECBUF            (1 << 31)
+        */
+        xclDeviceHandle dev_handle = s_handle.hw_session.dev_handle;
+        uint64_t b_obj_handle = 0;
+        if (device_only_buffer) {
+            b_obj_handle = xclAllocBO(dev_handle, size, 0, XCL_BO_FLAGS_DEV_ONLY | ddr_bank);
+        } else {
+            b_obj_handle = xclAllocBO(dev_handle, size, 0, ddr_bank);
+        }
+        if (b_obj_handle == NULLBO)
+            return XMA_ERROR;
+        tmp1 = new XmaBufferObjPrivate;
+        tmp1->dummy = (void*)(((uint64_t)tmp1) | signature);
+        tmp1->size = size;
+        tmp1->paddr = xclGetDeviceAddr(dev_handle, b_obj_handle);
+        tmp1->bank_index = ddr_bank;
+        tmp1->dev_index = s_handle.hw_session.dev_index;
+        tmp1->boHandle = b_obj_handle;
+        tmp1->device_only_buffer = device_only_buffer;
+        tmp1->dev_handle = dev_handle;
+        if (!device_only_buffer) {
+            tmp1->data = (uint8_t*) xclMapBO(dev_handle, b_obj_handle, true);
+        }
+    }
+    b_obj->paddr = tmp1->paddr;
+    b_obj->data = tmp1->data;
+    b_obj->device_only_buffer = device_only_buffer;
+    b_obj->private_do_not_touch = (void*) tmp1;
+    return XMA_SUCCESS;
+}
+
 XmaBufferObj
 xma_plg_buffer_alloc(XmaSession s_handle, size_t size, bool device_only_buffer, int32_t* return_code)
 {
@@ -49,7 +100,6 @@ xma_plg_buffer_alloc(XmaSession s_handle, size_t size, bool device_only_buffer,
     b_obj.device_only_buffer = false;
     b_obj.private_do_not_touch = NULL;
 
-    xclDeviceHandle dev_handle = s_handle.hw_session.dev_handle;
     uint32_t ddr_bank = s_handle.hw_session.bank_index;
     b_obj.bank_index = ddr_bank;
     b_obj.size = size;
@@ -62,45 +112,11 @@ xma_plg_buffer_alloc(XmaSession s_handle, size_t size, bool device_only_buffer,
         return b_obj_error;
     }
 
-    /*
-    #define XRT_BO_FLAGS_MEMIDX_MASK        (0xFFFFFFUL)
-    #define XCL_BO_FLAGS_CACHEABLE          (1 << 24)
-    #define XCL_BO_FLAGS_SVM                (1 << 27)
-    #define XCL_BO_FLAGS_DEV_ONLY           (1 << 28)
-    #define XCL_BO_FLAGS_HOST_ONLY          (1 << 29)
-    #define XCL_BO_FLAGS_P2P                (1 << 30)
-    #define XCL_BO_FLAGS_EXECBUF            (1 << 31)
-    */
-    uint64_t b_obj_handle = 0;
-    if (device_only_buffer) {
-        b_obj_handle = xclAllocBO(dev_handle, size, 0, XCL_BO_FLAGS_DEV_ONLY | ddr_bank);
-        b_obj.device_only_buffer = true;
-    } else {
-        b_obj_handle = xclAllocBO(dev_handle, size, 0, ddr_bank);
-    }
-    /*BO handlk is uint64_t
-    if (b_obj_handle < 0) {
-        std::cout << "ERROR: xma_plg_buffer_alloc failed. handle=0x" << std::hex << b_obj_handle << std::endl;
-        //printf("xclAllocBO failed. handle=0x%ullx\n", b_obj_handle);
+    if (xma_plg_buffer_obj_get(s_handle, size, device_only_buffer, ddr_bank, &b_obj) != XMA_SUCCESS) {
         xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "xclAllocBO failed.\n");
         if (return_code) *return_code = XMA_ERROR;
         return b_obj_error;
     }
-    */
-    b_obj.paddr = xclGetDeviceAddr(dev_handle, b_obj_handle);
-    if (!device_only_buffer) {
-        b_obj.data = (uint8_t*) xclMapBO(dev_handle, b_obj_handle, true);
-    }
-    XmaBufferObjPrivate* tmp1 = new XmaBufferObjPrivate;
-    b_obj.private_do_not_touch = (void*) tmp1;
-    tmp1->dummy = (void*)(((uint64_t)tmp1) | signature);
-    tmp1->size = size;
-    tmp1->paddr = b_obj.paddr;
-    tmp1->bank_index = b_obj.bank_index;
-    tmp1->dev_index = b_obj.dev_index;
-    tmp1->boHandle = b_obj_handle;
-    tmp1->device_only_buffer = b_obj.device_only_buffer;
-    tmp1->dev_handle = dev_handle;
 
     if (return_code) *return_code = XMA_SUCCESS;
     return b_obj;
@@ -120,7 +136,6 @@ XmaBufferObj xma_plg_buffer_alloc_arg_num(XmaSession s_handle, size_t size, bool
     b_obj.device_only_buffer = false;
     b_obj.private_do_not_touch = NULL;
 
-    xclDeviceHandle dev_handle = s_handle.hw_session.dev_handle;
     uint32_t ddr_bank = s_handle.hw_session.bank_index;
     b_obj.bank_index = ddr_bank;
     b_obj.size = size;
@@ -146,36 +161,11 @@ XmaBufferObj xma_plg_buffer_alloc_arg_num(XmaSession s_handle, size_t size, bool
         }
     }
 
-    /*
-    #define XRT_BO_FLAGS_MEMIDX_MASK        (0xFFFFFFUL)
-    #define XCL_BO_FLAGS_CACHEABLE          (1 << 24)
-    #define XCL_BO_FLAGS_SVM                (1 << 27)
-    #define XCL_BO_FLAGS_DEV_ONLY           (1 << 28)
-    #define XCL_BO_FLAGS_HOST_ONLY          (1 << 29)
-    #define XCL_BO_FLAGS_P2P                (1 << 30)
-    #define XCL_BO_FLAGS_EXECBUF            (1 << 31)
-    */
-    uint64_t b_obj_handle = 0;
-    if (device_only_buffer) {
-        b_obj_handle = xclAllocBO(dev_handle, size, 0, XCL_BO_FLAGS_DEV_ONLY | ddr_bank);
-        b_obj.device_only_buffer = true;
-    } else {
-        b_obj_handle = xclAllocBO(dev_handle, size, 0, ddr_bank);
-    }
-    b_obj.paddr = xclGetDeviceAddr(dev_handle, b_obj_handle);
-    if (!device_only_buffer) {
-        b_obj.data = (uint8_t*) xclMapBO(dev_handle, b_obj_handle, true);
-    }
-    XmaBufferObjPrivate* tmp1 = new XmaBufferObjPrivate;
-    b_obj.private_do_not_touch = (void*) tmp1;
-    tmp1->dummy = (void*)(((uint64_t)tmp1) | signature);
-    tmp1->size = size;
-    tmp1->paddr = b_obj.paddr;
-    tmp1->bank_index = b_obj.bank_index;
-    tmp1->dev_index = b_obj.dev_index;
-    tmp1->boHandle = b_obj_handle;
-    tmp1->device_only_buffer = b_obj.device_only_buffer;
-    tmp1->dev_handle = dev_handle;
+    if (xma_plg_buffer_obj_get(s_handle, size, device_only_buffer, ddr_bank, &b_obj) != XMA_SUCCESS) {
+        xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "xclAllocBO failed.\n");
+        if (return_code) *return_code = XMA_ERROR;
+        return b_obj_error;
+    }
 
     if (return_code) *return_code = XMA_SUCCESS;
     return b_obj;
@@ -224,6 +214,10 @@ xma_plg_buffer_free(XmaSession s_handle, XmaBufferObj b_obj)
         return;
     }
     XmaBufferObjPrivate* b_obj_priv = (XmaBufferObjPrivate*) b_obj.private_do_not_touch;
+    if (b_obj_priv->pool) {
+        b_obj_priv->pool->release(b_obj_priv);
+        return;
+    }
     //xclDeviceHandle dev_handle = s_handle.hw_session.dev_handle;
     xclFreeBO(b_obj_priv->dev_handle, b_obj_priv->boHandle);
     b_obj_priv->dummy = NULL;
@@ -233,6 +227,22 @@ xma_plg_buffer_free(XmaSession s_handle, XmaBufferObj b_obj)
     free(b_obj_priv);
 }
 
+XmaFramePool*
+xma_plg_frame_pool_create(XmaSession s_handle, XmaFrameProperties *frame_props, int32_t max_frames, bool device_only_buffer)
+{
+    if (s_handle.session_signature != (void*)(((uint64_t)s_handle.hw_session.kernel_info) | ((uint64_t)s_handle.hw_session.dev_handle))) {
+        xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "xma_plg_frame_pool_create failed. XMASession is corrupted.\n");
+        return NULL;
+    }
+    XmaHwSessionPrivate *priv = (XmaHwSessionPrivate*)s_handle.hw_session.private_do_not_use;
+    if (priv == NULL || priv->buffer_pool == NULL) {
+        xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "xma_plg_frame_pool_create failed. Session has no buffer pool.\n");
+        return NULL;
+    }
+    return xma_frame_pool_create_on_device(frame_props, max_frames, priv->buffer_pool,
+                                           s_handle.hw_session.bank_index, device_only_buffer);
+}
+
 /*Sarab: padd API not required with buffer Object
 uint64_t
 xma_plg_get_paddr(XmaHwSession s_handle, XmaBufferObj b_obj)
@@ -247,6 +257,64 @@ xma_plg_get_paddr(XmaHwSession s_handle, XmaBufferObj b_obj)
 }
 */
 
+static uint64_t xma_plg_time_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Count bytes moved by a session in its own and its CU's counters
+static void xma_plg_stats_bytes(XmaSession& s_handle, size_t size, bool write)
+{
+    XmaHwSessionPrivate *priv = (XmaHwSessionPrivate*)s_handle.hw_session.private_do_not_use;
+    XmaHwExecBOPool *pool = s_handle.hw_session.kernel_info->execbo_pool.get();
+    std::atomic<uint64_t> *counters[2] = {
+        priv ? (write ? &priv->stats.bytes_written : &priv->stats.bytes_read) : NULL,
+        pool ? (write ? &pool->stats.bytes_written : &pool->stats.bytes_read) : NULL };
+    for (auto counter: counters) {
+        if (counter)
+            counter->fetch_add(size, std::memory_order_relaxed);
+    }
+}
+
+// Count a work item handed to the CU in execBO slot at submit_ns; only
+// called once xclExecBuf took it
+static void xma_plg_stats_submit(XmaSession& s_handle, XmaHwExecBOPool *pool, int32_t slot, uint64_t submit_ns)
+{
+    XmaHwSessionPrivate *priv = (XmaHwSessionPrivate*)s_handle.hw_session.private_do_not_use;
+    pool->submit_ns[slot] = submit_ns;
+    pool->stats.submitted.fetch_add(1, std::memory_order_relaxed);
+    if (priv)
+        priv->stats.submitted.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Time a finished work item.  A CU that runs one work item at a time
+// started it on the later of its submission and the last completion on
+// the CU; for a dataflow CU that overlaps work items this is the time
+// between outputs.  Busy time counts overlapping work items once.
+static void xma_plg_stats_done(XmaHwExecBOPool *pool, XmaHwStats *session_stats, int32_t slot, bool ok)
+{
+    uint64_t now = xma_plg_time_ns();
+    uint64_t submit = pool->submit_ns[slot];
+    uint64_t last = pool->last_done_ns.load(std::memory_order_relaxed);
+    while (last < now && !pool->last_done_ns.compare_exchange_weak(last, now, std::memory_order_relaxed))
+        ;
+    uint64_t start = std::min(std::max(submit, last), now);
+    XmaHwStats *all[2] = { &pool->stats, session_stats };
+    for (auto stats: all) {
+        if (stats == NULL)
+            continue;
+        if (ok) {
+            stats->completed.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            stats->failed.fetch_add(1, std::memory_order_relaxed);
+        }
+        stats->queue_wait.add(start - submit);
+        stats->exec.add(now - start);
+        stats->add_busy(submit, now);
+    }
+}
+
 int32_t
 xma_plg_buffer_write(XmaSession s_handle,
                      XmaBufferObj  b_obj,
@@ -279,6 +347,8 @@ xma_plg_buffer_write(XmaSession s_handle,
     if (rc != 0) {
         //std::cout << "ERROR: xma_plg_buffer_write xclSyncBO failed " << std::dec << rc << std::endl;
         xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "xclSyncBO failed %d\n", rc);
+    } else {
+        xma_plg_stats_bytes(s_handle, size, true);
     }
 
     return XMA_SUCCESS;
@@ -322,6 +392,7 @@ xma_plg_buffer_read(XmaSession s_handle,
         xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "xma_plg_buffer_read xclSyncBO failed. Check device status with \"xbutil/awssak query\" cmmand\n");
         return XMA_ERROR;
     }
+    xma_plg_stats_bytes(s_handle, size, false);
 
     return XMA_SUCCESS;
 }
@@ -415,75 +486,131 @@ int32_t xma_plg_kernel_unlock_regmap(XmaSession s_handle)
     return XMA_SUCCESS;
 }
 
-int32_t xma_plg_execbo_avail_get(XmaSession s_handle)
+// Free execBOs left behind by destroyed sessions once their work items finished
+static void xma_plg_execbo_reclaim(XmaHwExecBOPool *pool)
 {
-    //std::cout << "Sarab: Debug - " << __func__ << "; " << __LINE__ << std::endl;
-    XmaHwKernel* kernel_tmp1 = s_handle.hw_session.kernel_info;
-    XmaHwDevice *dev_tmp1 = (XmaHwDevice*)kernel_tmp1->private_do_not_use;
-    if (dev_tmp1 == NULL) {
-        xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "Session XMA private pointer is NULL\n");
-        return -1;
-    }
-    int32_t num_execbo = dev_tmp1->num_execbo_allocated;
-    if (num_execbo <= 0) {
-        xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "Session XMA private: No execbo allocated\n");
-        return -1;
-    }
-    int32_t i;
-    int32_t rc = -1;
-    bool    found = false;
-    bool expected = false;
-    bool desired = true;
-    while (!(*(dev_tmp1->execbo_locked)).compare_exchange_weak(expected, desired)) {
-        expected = false;
+    if (pool->num_orphaned.load(std::memory_order_acquire) == 0)
+        return;
+    // Another session sweeping is as good as this one
+    std::unique_lock<std::mutex> guard(pool->orphan_lock, std::try_to_lock);
+    if (!guard.owns_lock())
+        return;
+
+    int32_t kept = 0;
+    int32_t count = pool->num_orphaned.load(std::memory_order_relaxed);
+    for (int32_t i = 0; i < count; i++) {
+        int32_t slot = pool->orphaned[i];
+        ert_start_kernel_cmd *cu_cmd = (ert_start_kernel_cmd*)pool->bo_data[slot];
+        switch(cu_cmd->state)
+        {
+            case ERT_CMD_STATE_COMPLETED:
+            case ERT_CMD_STATE_ERROR:
+            case ERT_CMD_STATE_ABORT:
+            {
+                bool ok = cu_cmd->state == ERT_CMD_STATE_COMPLETED;
+                if (ok)
+                    pool->completed_total++;
+                xma_plg_stats_done(pool, NULL, slot, ok);
+                pool->slot_state[slot] = XmaHwExecBOPool::SLOT_FREE;
+                pool->free_push(slot);
+            }
+            break;
+            default:
+                pool->orphaned[kept++] = slot;
+            break;
+        }
     }
-    //kernel completion lock acquired
-
-    for (i = 0; i < num_execbo; i++) {
-        ert_start_kernel_cmd *cu_cmd = 
-            (ert_start_kernel_cmd*)dev_tmp1->kernel_execbo_data[i];
-        if (dev_tmp1->kernel_execbo_inuse[i]) {
-            if (dev_tmp1->kernel_execbo_cu_index[i] == kernel_tmp1->cu_index) {
-                switch(cu_cmd->state)
-                {
-                    case ERT_CMD_STATE_NEW:
-                    case ERT_CMD_STATE_QUEUED:
-                    case ERT_CMD_STATE_RUNNING:
-                        continue;
-                    break;
-                    case ERT_CMD_STATE_COMPLETED:
-                        found = true;
-                        // Update count of completed work items
-                        kernel_tmp1->kernel_complete_count++;
+    pool->num_orphaned.store(kept, std::memory_order_release);
+}
 
+// Retire completed slots of the CU; returns number of newly completed work items
+static int32_t xma_plg_execbo_retire(XmaHwExecBOPool *pool)
+{
+    xma_plg_execbo_reclaim(pool);
+
+    int32_t count = 0;
+    uint64_t tail = pool->inflight_tail.load(std::memory_order_acquire);
+    for (uint64_t pos = pool->inflight_head.load(std::memory_order_acquire); pos < tail; pos++) {
+        int32_t slot = pool->inflight[pos & (MAX_EXECBO_PER_CU - 1)];
+        if (pool->slot_state[slot].load(std::memory_order_acquire) != XmaHwExecBOPool::SLOT_SUBMITTED)
+            continue;
+        ert_start_kernel_cmd *cu_cmd =
+            (ert_start_kernel_cmd*)pool->bo_data[slot];
+        switch(cu_cmd->state)
+        {
+            case ERT_CMD_STATE_COMPLETED:
+            case ERT_CMD_STATE_ERROR:
+            case ERT_CMD_STATE_ABORT:
+            {
+                uint8_t expected = XmaHwExecBOPool::SLOT_SUBMITTED;
+                if (!pool->slot_state[slot].compare_exchange_strong(expected, XmaHwExecBOPool::SLOT_RETIRED))
                     break;
-                    case ERT_CMD_STATE_ERROR:
-                    case ERT_CMD_STATE_ABORT:
-                        xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD,
-                                "Could not find free execBO cmd buffer\n");
-                    break;
+                bool ok = cu_cmd->state == ERT_CMD_STATE_COMPLETED;
+                xma_plg_stats_done(pool, NULL, slot, ok);
+                if (ok) {
+                    count++;
+                } else {
+                    xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD,
+                            "Work item failed with ERT state %d\n", cu_cmd->state);
                 }
             }
+            break;
+            default:
+            break;
         }
-        else
-            found = true;
+    }
+    if (count) {
+        pool->complete_count += count;
+        pool->completed_total += count;
+    }
 
-        if (found) {
-            dev_tmp1->kernel_execbo_inuse[i] = true;
-            dev_tmp1->kernel_execbo_cu_index[i] = kernel_tmp1->cu_index;
-            rc = i;
+    // Return retired slots at the head of the FIFO to the free list
+    for (;;) {
+        uint64_t head = pool->inflight_head.load(std::memory_order_acquire);
+        if (head == pool->inflight_tail.load(std::memory_order_acquire))
+            break;
+        int32_t slot = pool->inflight[head & (MAX_EXECBO_PER_CU - 1)];
+        if (pool->slot_state[slot].load(std::memory_order_acquire) != XmaHwExecBOPool::SLOT_RETIRED)
             break;
+        if (pool->inflight_head.compare_exchange_strong(head, head + 1)) {
+            pool->slot_state[slot].store(XmaHwExecBOPool::SLOT_FREE, std::memory_order_release);
+            pool->free_push(slot);
         }
     }
-    //std::cout << "Sarab: Debug - " << __func__ << "; " << __LINE__ << std::endl;
-    //Release completion lock
-    *(dev_tmp1->execbo_locked) = false;
+    return count;
+}
+
+// Take one completed work item of the CU if there is any
+static bool xma_plg_execbo_take_completion(XmaHwExecBOPool *pool)
+{
+    int32_t available = pool->complete_count.load();
+    while (available > 0) {
+        if (pool->complete_count.compare_exchange_weak(available, available - 1))
+            return true;
+    }
+    return false;
+}
+
+int32_t xma_plg_execbo_avail_get(XmaSession s_handle)
+{
+    XmaHwKernel* kernel_tmp1 = s_handle.hw_session.kernel_info;
+    XmaHwExecBOPool *pool = kernel_tmp1->execbo_pool.get();
+    if (pool == NULL || pool->num_slots <= 0) {
+        xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "Session XMA private: No execbo allocated\n");
+        return -1;
+    }
 
-    return rc;
+    xma_plg_execbo_reclaim(pool);
+    int32_t slot = pool->free_pop();
+    if (slot < 0) {
+        xma_plg_execbo_retire(pool);
+        slot = pool->free_pop();
+    }
+    return slot;
 }
 
-int32_t
-xma_plg_schedule_work_item(XmaSession s_handle)
+// Checks shared by all work item submissions
+static int32_t xma_plg_work_item_check(XmaSession& s_handle)
 {
     if (s_handle.session_signature != (void*)(((uint64_t)s_handle.hw_session.kernel_info) | ((uint64_t)s_handle.hw_session.dev_handle))) {
         //std::cout << "ERROR: xma_plg_schedule_work_item failed. XMASession is corrupted" << std::endl;
@@ -496,18 +623,12 @@ xma_plg_schedule_work_item(XmaSession s_handle)
         xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "Session XMA private pointer is NULL\n");
         return XMA_ERROR;
     }
-    uint8_t *src = (uint8_t*)kernel_tmp1->reg_map;
-    
     //size_t  size = MAX_KERNEL_REGMAP_SIZE;//Max regmap in xmahw.h is 4KB; execBO size is 4096; Supported max regmap size is 4032 Bytes only
-    int32_t size = s_handle.hw_session.kernel_info->regmap_max;
-    if (size < 0) {
+    if (kernel_tmp1->regmap_max < 0) {
         xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "Use xma_plg_register_prep_write to prepare regmap for CU before scheduling work item \n");
         return XMA_ERROR;
     }
 
-    int32_t bo_idx;
-    int32_t rc = XMA_SUCCESS;
-    
     if (*(kernel_tmp1->reg_map_locked)) {
         if (s_handle.session_id != kernel_tmp1->locked_by_session_id || s_handle.session_type != kernel_tmp1->locked_by_session_type) {
             xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "regamp is locked by another session\n");
@@ -517,16 +638,20 @@ xma_plg_schedule_work_item(XmaSession s_handle)
         xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "Must lock kernel regamp before writing to it and submitting work item\n");
         return XMA_ERROR;
     }
+    return XMA_SUCCESS;
+}
+
+// Setup ert_start_kernel_cmd in execBO bo_idx of the CU and submit it
+static int32_t xma_plg_work_item_exec(XmaSession& s_handle, int32_t bo_idx)
+{
+    XmaHwKernel* kernel_tmp1 = s_handle.hw_session.kernel_info;
+    XmaHwDevice *dev_tmp1 = (XmaHwDevice*)kernel_tmp1->private_do_not_use;
+    XmaHwExecBOPool *pool = kernel_tmp1->execbo_pool.get();
+    uint8_t *src = (uint8_t*)kernel_tmp1->reg_map;
+    int32_t size = kernel_tmp1->regmap_max;
 
-    // Find an available execBO buffer
-    bo_idx = xma_plg_execbo_avail_get(s_handle);
-    if (bo_idx == -1) {
-        xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "Unable to find free execbo to use\n");
-        return XMA_ERROR;
-    }
-    // Setup ert_start_kernel_cmd 
     ert_start_kernel_cmd *cu_cmd = 
-        (ert_start_kernel_cmd*)dev_tmp1->kernel_execbo_data[bo_idx];
+        (ert_start_kernel_cmd*)pool->bo_data[bo_idx];
     cu_cmd->state = ERT_CMD_STATE_NEW;
     if (kernel_tmp1->soft_kernel) {
         cu_cmd->opcode = ERT_SK_START;
@@ -558,13 +683,151 @@ xma_plg_schedule_work_item(XmaSession s_handle)
     cu_cmd->count = (size >> 2) + 4;
     
     if (xclExecBuf(s_handle.hw_session.dev_handle, 
-                    dev_tmp1->kernel_execbo_handle[bo_idx]) != 0)
+                    pool->bo_handle[bo_idx]) != 0)
     {
         xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD,
                     "Failed to submit kernel start with xclExecBuf\n");
-        rc = XMA_ERROR;
+        return XMA_ERROR;
+    }
+    return XMA_SUCCESS;
+}
+
+int32_t
+xma_plg_schedule_work_item(XmaSession s_handle)
+{
+    if (xma_plg_work_item_check(s_handle) != XMA_SUCCESS)
+        return XMA_ERROR;
+
+    // Find an available execBO buffer
+    int32_t bo_idx = xma_plg_execbo_avail_get(s_handle);
+    if (bo_idx == -1) {
+        xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "Unable to find free execbo to use\n");
+        return XMA_ERROR;
+    }
+
+    XmaHwExecBOPool *pool = s_handle.hw_session.kernel_info->execbo_pool.get();
+    uint64_t submit_ns = xma_plg_time_ns();
+    if (xma_plg_work_item_exec(s_handle, bo_idx) != XMA_SUCCESS) {
+        pool->free_push(bo_idx);
+        return XMA_ERROR;
+    }
+    xma_plg_stats_submit(s_handle, pool, bo_idx, submit_ns);
+    pool->inflight_push(bo_idx);
+    return XMA_SUCCESS;
+}
+
+int32_t xma_plg_work_item_depth(XmaSession s_handle, int32_t depth)
+{
+    if (s_handle.session_signature != (void*)(((uint64_t)s_handle.hw_session.kernel_info) | ((uint64_t)s_handle.hw_session.dev_handle))) {
+        xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "xma_plg_work_item_depth failed. XMASession is corrupted.\n");
+        return XMA_ERROR;
+    }
+    XmaHwSessionPrivate *queue = (XmaHwSessionPrivate*)s_handle.hw_session.private_do_not_use;
+    if (queue == NULL) {
+        xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "Session has no work item queue\n");
+        return XMA_ERROR;
+    }
+    if (depth < 1 || depth > XMA_MAX_WORK_ITEM_DEPTH) {
+        xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "Work item depth %d is out of range; max is %d\n", depth, XMA_MAX_WORK_ITEM_DEPTH);
+        return XMA_ERROR_INVALID;
+    }
+    queue->depth = depth;
+    return XMA_SUCCESS;
+}
+
+int32_t xma_plg_submit_work_item(XmaSession s_handle, XmaWorkItem *work_item)
+{
+    if (xma_plg_work_item_check(s_handle) != XMA_SUCCESS)
+        return XMA_ERROR;
+    XmaHwSessionPrivate *queue = (XmaHwSessionPrivate*)s_handle.hw_session.private_do_not_use;
+    XmaHwExecBOPool *pool = s_handle.hw_session.kernel_info->execbo_pool.get();
+    if (queue == NULL || pool == NULL || pool->num_slots <= 0) {
+        xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "Session has no work item queue\n");
+        return XMA_ERROR;
+    }
+    if (queue->tail - queue->head >= (uint64_t)queue->depth)
+        return XMA_TRY_AGAIN;
+
+    // All execBOs of the CU are busy with work items of other sessions
+    int32_t bo_idx = xma_plg_execbo_avail_get(s_handle);
+    if (bo_idx == -1)
+        return XMA_TRY_AGAIN;
+    pool->slot_state[bo_idx] = XmaHwExecBOPool::SLOT_TRACKED;
+    uint64_t submit_ns = xma_plg_time_ns();
+    if (xma_plg_work_item_exec(s_handle, bo_idx) != XMA_SUCCESS) {
+        pool->slot_state[bo_idx] = XmaHwExecBOPool::SLOT_FREE;
+        pool->free_push(bo_idx);
+        return XMA_ERROR;
+    }
+    xma_plg_stats_submit(s_handle, pool, bo_idx, submit_ns);
+
+    uint32_t pos = queue->tail & (WORK_ITEM_RING_SIZE - 1);
+    queue->slot[pos] = bo_idx;
+    queue->status[pos] = XMA_TRY_AGAIN;
+    work_item->id = queue->tail;
+    work_item->cu_index = s_handle.hw_session.kernel_info->cu_index;
+    queue->tail++;
+    return XMA_SUCCESS;
+}
+
+// Retire the oldest work item of the session if it has finished
+static bool xma_plg_work_item_retire(XmaHwSessionPrivate *queue, XmaHwExecBOPool *pool)
+{
+    uint32_t pos = queue->head & (WORK_ITEM_RING_SIZE - 1);
+    int32_t slot = queue->slot[pos];
+    ert_start_kernel_cmd *cu_cmd = (ert_start_kernel_cmd*)pool->bo_data[slot];
+    switch(cu_cmd->state)
+    {
+        case ERT_CMD_STATE_COMPLETED:
+            queue->status[pos] = XMA_SUCCESS;
+            pool->completed_total++;
+            xma_plg_stats_done(pool, &queue->stats, slot, true);
+        break;
+        case ERT_CMD_STATE_ERROR:
+        case ERT_CMD_STATE_ABORT:
+            xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD,
+                    "Work item %lu failed with ERT state %d\n", queue->head, cu_cmd->state);
+            queue->status[pos] = XMA_ERROR;
+            xma_plg_stats_done(pool, &queue->stats, slot, false);
+        break;
+        default:
+            return false;
+    }
+    pool->slot_state[slot] = XmaHwExecBOPool::SLOT_FREE;
+    pool->free_push(slot);
+    queue->head++;
+    return true;
+}
+
+int32_t xma_plg_wait_work_item(XmaSession s_handle, XmaWorkItem work_item, int32_t timeout_ms)
+{
+    if (s_handle.session_signature != (void*)(((uint64_t)s_handle.hw_session.kernel_info) | ((uint64_t)s_handle.hw_session.dev_handle))) {
+        xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "xma_plg_wait_work_item failed. XMASession is corrupted.\n");
+        return XMA_ERROR;
+    }
+    XmaHwSessionPrivate *queue = (XmaHwSessionPrivate*)s_handle.hw_session.private_do_not_use;
+    XmaHwExecBOPool *pool = s_handle.hw_session.kernel_info->execbo_pool.get();
+    if (queue == NULL || pool == NULL) {
+        xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "Session has no work item queue\n");
+        return XMA_ERROR;
+    }
+    if (work_item.id >= queue->tail || work_item.id + WORK_ITEM_RING_SIZE < queue->tail) {
+        xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "Unknown work item %lu\n", work_item.id);
+        return XMA_ERROR_INVALID;
     }
-    return rc;
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (queue->head <= work_item.id) {
+        if (xma_plg_work_item_retire(queue, pool))
+            continue;
+
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+        if (remaining <= 0)
+            return XMA_ERROR_TIMEOUT;
+        // Wait for a notification
+        xclExecWait(s_handle.hw_session.dev_handle, (int)remaining);
+    }
+    return queue->status[work_item.id & (WORK_ITEM_RING_SIZE - 1)];
 }
 
 int32_t xma_plg_is_work_item_done(XmaSession s_handle, int32_t timeout_ms)
@@ -580,76 +843,35 @@ int32_t xma_plg_is_work_item_done(XmaSession s_handle, int32_t timeout_ms)
         xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "Session XMA private pointer is NULL\n");
         return XMA_ERROR;
     }
-    int32_t num_execbo = dev_tmp1->num_execbo_allocated;
-    if (num_execbo <= 0) {
+    XmaHwExecBOPool *pool = kernel_tmp1->execbo_pool.get();
+    if (pool == NULL || pool->num_slots <= 0) {
         xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD, "Session XMA private: No execbo allocated\n");
         return XMA_ERROR;
     }
 
-    int32_t count = 0;
     int32_t give_up = 0;
-    // Keep track of the number of kernel completions
-    while (count == 0)
+    // Completions of this CU may already have been counted by another session
+    while (!xma_plg_execbo_take_completion(pool))
     {
-        bool expected = false;
-        bool desired = true;
-        while (!(*(dev_tmp1->execbo_locked)).compare_exchange_weak(expected, desired)) {
-            expected = false;
-        }
-        //kernel completion lock acquired
-
-        // Look for inuse commands that have completed and increment the count
-        for (int32_t i = 0; i < num_execbo; i++)
-        {
-            if (dev_tmp1->kernel_execbo_inuse[i] && (dev_tmp1->kernel_execbo_cu_index[i] == kernel_tmp1->cu_index))
-            {
-                ert_start_kernel_cmd *cu_cmd = 
-                    (ert_start_kernel_cmd*)dev_tmp1->kernel_execbo_data[i];
-                if (cu_cmd->state == ERT_CMD_STATE_COMPLETED)
-                {
-                    // Increment completed kernel count and make BO buffer available
-                    count++;
-                    dev_tmp1->kernel_execbo_inuse[i] = false;
-                } 
-            }
-        }
-        //Release completion lock
-        *(dev_tmp1->execbo_locked) = false;
-
-        if (count)
-            break;
+        if (xma_plg_execbo_retire(pool))
+            continue;
 
         // Wait for a notification
         give_up++;
-        if (xclExecWait(s_handle.hw_session.dev_handle, timeout_ms) <= 0 && give_up >= 3)
-            break;
-    }
-
-    bool expected = false;
-    bool desired = true;
-    while (!(*(dev_tmp1->execbo_locked)).compare_exchange_weak(expected, desired)) {
-        expected = false;
-    }
-    //kernel completion lock acquired
-
-    kernel_tmp1->kernel_complete_count += count;
-    if (kernel_tmp1->kernel_complete_count)
-    {
-        kernel_tmp1->kernel_complete_count--;
-        
-        //Release completion lock
-        *(dev_tmp1->execbo_locked) = false;
-        return XMA_SUCCESS;
-    }
-    else
-    {
-        //Release completion lock
-        *(dev_tmp1->execbo_locked) = false;
-        xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD,
-                    "Could not find completed work item\n");
-        return XMA_ERROR;
+        if (xclExecWait(s_handle.hw_session.dev_handle, timeout_ms) <= 0 && give_up >= 3) {
+            xma_plg_execbo_retire(pool);
+            if (xma_plg_execbo_take_completion(pool))
+                break;
+            xma_logmsg(XMA_ERROR_LOG, XMAPLUGIN_MOD,
+                        "Could not find completed work item\n");
+            return XMA_ERROR;
+        }
     }
 
+    // Which work item completed is not known; it is only timed per CU
+    XmaHwSessionPrivate *priv = (XmaHwSessionPrivate*)s_handle.hw_session.private_do_not_use;
+    if (priv)
+        priv->stats.completed.fetch_add(1, std::memory_order_relaxed);
     return XMA_SUCCESS;
 }
 
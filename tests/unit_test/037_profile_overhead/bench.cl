@@ -0,0 +1,30 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+//------------------------------------------------------------------------------
+//
+// kernel:  bench
+//
+// Purpose: Minimal copy so that kernel launches are dominated by runtime
+//          and profiling overhead rather than by compute
+//
+
+__kernel void __attribute__ ((reqd_work_group_size(1, 1, 1)))
+bench(__global const int* in, __global int* out, int count)
+{
+  for (int i = 0; i < count; ++i)
+    out[i] = in[i];
+}
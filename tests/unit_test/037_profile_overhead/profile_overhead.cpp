@@ -0,0 +1,278 @@
+/**
+ * Copyright (C) 2019 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Measure the host side cost of XDP profiling.
+//
+// The same mix of OpenCL calls is timed call by call; run it once per
+// profiling configuration (see run.sh) and compare the reports.
+//
+// g++ -g -std=c++14 -I$XILINX_XRT/include -L$XILINX_XRT/lib -I.. -o host.exe profile_overhead.cpp -lxilinxopencl
+
+#include "hostsrc/utils.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+
+namespace {
+
+using utils::throw_if_error;
+
+static void
+help(const char* exe)
+{
+  std::cout << "usage: " << exe << " <bitstream>  [options] \n\n";
+  std::cout << "  [-d <index>] : index of device to use (default: 0)\n";
+  std::cout << "  [-i <iters>] : number of iterations of the call mix (default: 1000)\n";
+  std::cout << "  [-s <bytes>] : size of each buffer (default: 4096)\n";
+  std::cout << "  [-w <count>] : clEnqueueWriteBuffer calls per iteration (default: 1)\n";
+  std::cout << "  [-r <count>] : clEnqueueReadBuffer calls per iteration (default: 1)\n";
+  std::cout << "  [-m <count>] : clEnqueueMigrateMemObjects calls per iteration (default: 0)\n";
+  std::cout << "  [-k <count>] : kernel launches per iteration (default: 1)\n";
+  std::cout << "  [-f <count>] : clFinish every <count> iterations, 0 for only at end (default: 1)\n";
+  std::cout << "  [-b]         : blocking reads and writes (default: off)\n";
+  std::cout << "* Bitstream is required\n";
+}
+
+// Resident set size of this process in kB
+static long
+rss_kb(const char* field = "VmRSS:")
+{
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.compare(0, std::strlen(field), field) == 0)
+      return std::stol(line.substr(std::strlen(field)));
+  }
+  return 0;
+}
+
+// Per API call durations in ns
+class call_stats
+{
+  std::map<std::string, std::vector<unsigned long long>> m_samples;
+
+public:
+  template <typename Call>
+  cl_int
+  time(const std::string& api, Call&& call)
+  {
+    auto start = utils::time_ns();
+    cl_int err = call();
+    m_samples[api].push_back(utils::time_ns() - start);
+    return err;
+  }
+
+  void
+  reserve(size_t count)
+  {
+    for (auto api : {"clEnqueueWriteBuffer", "clEnqueueReadBuffer", "clEnqueueMigrateMemObjects",
+                     "clSetKernelArg", "clEnqueueTask", "clFinish"})
+      m_samples[api].reserve(count);
+  }
+
+  void
+  report()
+  {
+    std::cout << "api,calls,p50_us,p99_us,mean_us,total_ms\n";
+    for (auto& entry : m_samples) {
+      auto& samples = entry.second;
+      if (samples.empty())
+        continue;
+      std::sort(samples.begin(), samples.end());
+      unsigned long long total = 0;
+      for (auto ns : samples)
+        total += ns;
+      auto pct = [&samples](double p) {
+        size_t idx = static_cast<size_t>(p * (samples.size() - 1) + 0.5);
+        return samples[idx] * 1e-3;
+      };
+      std::cout << entry.first << "," << samples.size() << ","
+                << pct(0.50) << "," << pct(0.99) << ","
+                << (total * 1e-3) / samples.size() << "," << total * 1e-6 << "\n";
+    }
+  }
+};
+
+int
+run(int argc, char* argv[])
+{
+  std::string xclbin;
+  unsigned int device_index = 0;
+  size_t iterations = 1000;
+  size_t bytes = 4096;
+  size_t writes = 1;
+  size_t reads = 1;
+  size_t migrates = 0;
+  size_t kernels = 1;
+  size_t finish = 1;
+  bool blocking = false;
+
+  std::vector<std::string> args(argv+1,argv+argc);
+  std::string cur;
+  for (auto& arg : args) {
+    if (arg == "-h") {
+      help(argv[0]);
+      return 1;
+    }
+    if (arg == "-b") {
+      blocking = true;
+      continue;
+    }
+
+    if (arg[0] == '-') {
+      cur = arg;
+      continue;
+    }
+
+    if (cur == "-d")
+      device_index = std::stoi(arg);
+    else if (cur == "-i")
+      iterations = std::stoul(arg);
+    else if (cur == "-s")
+      bytes = std::stoul(arg);
+    else if (cur == "-w")
+      writes = std::stoul(arg);
+    else if (cur == "-r")
+      reads = std::stoul(arg);
+    else if (cur == "-m")
+      migrates = std::stoul(arg);
+    else if (cur == "-k")
+      kernels = std::stoul(arg);
+    else if (cur == "-f")
+      finish = std::stoul(arg);
+    else {
+      xclbin = arg;
+      continue;
+    }
+    cur.clear();
+  }
+
+  if (xclbin.empty()) {
+    help(argv[0]);
+    return 1;
+  }
+
+  auto platform = utils::open_platform("Xilinx","Xilinx");
+  auto device = utils::get_device(platform,device_index);
+
+  cl_int err = CL_SUCCESS;
+  auto context = clCreateContext(nullptr, 1, &device, nullptr, nullptr, &err);
+  throw_if_error(err,"clCreateContext failed");
+
+  auto queue = clCreateCommandQueue(context, device, 0, &err);
+  throw_if_error(err || !queue,"clCreateCommandQueue failed");
+
+  auto bitstream = utils::read_xclbin(xclbin);
+  auto size = bitstream.size();
+  auto data = reinterpret_cast<const unsigned char*>(bitstream.data());
+  auto program = clCreateProgramWithBinary(context, 1, &device, &size, &data, nullptr, &err);
+  throw_if_error(err || !program,"clCreateProgramWithBinary failed");
+
+  auto kernel = clCreateKernel(program, "bench", &err);
+  throw_if_error(err || !kernel,"clCreateKernel failed");
+
+  std::vector<int, utils::aligned_allocator<int>> h_in(bytes / sizeof(int), 1);
+  std::vector<int, utils::aligned_allocator<int>> h_out(bytes / sizeof(int), 0);
+  auto d_in = clCreateBuffer(context, CL_MEM_READ_ONLY | CL_MEM_USE_HOST_PTR, bytes, h_in.data(), &err);
+  throw_if_error(err || !d_in,"clCreateBuffer failed");
+  auto d_out = clCreateBuffer(context, CL_MEM_WRITE_ONLY | CL_MEM_USE_HOST_PTR, bytes, h_out.data(), &err);
+  throw_if_error(err || !d_out,"clCreateBuffer failed");
+  cl_int count = static_cast<cl_int>(bytes / sizeof(int));
+
+  // Warm up so that buffer allocation and xclbin load are not measured
+  throw_if_error(clSetKernelArg(kernel, 0, sizeof(cl_mem), &d_in),"clSetKernelArg failed");
+  throw_if_error(clSetKernelArg(kernel, 1, sizeof(cl_mem), &d_out),"clSetKernelArg failed");
+  throw_if_error(clSetKernelArg(kernel, 2, sizeof(cl_int), &count),"clSetKernelArg failed");
+  throw_if_error(clEnqueueMigrateMemObjects(queue, 1, &d_in, 0, 0, nullptr, nullptr),"clEnqueueMigrateMemObjects failed");
+  throw_if_error(clEnqueueTask(queue, kernel, 0, nullptr, nullptr),"clEnqueueTask failed");
+  throw_if_error(clFinish(queue),"clFinish failed");
+
+  call_stats stats;
+  stats.reserve(iterations * std::max({writes, reads, migrates, kernels * 3, size_t(1)}));
+  auto rss_start = rss_kb();
+  auto start = utils::time_ns();
+
+  for (size_t iter = 0; iter < iterations; ++iter) {
+    for (size_t i = 0; i < writes; ++i)
+      throw_if_error(stats.time("clEnqueueWriteBuffer", [&] {
+        return clEnqueueWriteBuffer(queue, d_in, blocking, 0, bytes, h_in.data(), 0, nullptr, nullptr);
+      }),"clEnqueueWriteBuffer failed");
+
+    for (size_t i = 0; i < migrates; ++i)
+      throw_if_error(stats.time("clEnqueueMigrateMemObjects", [&] {
+        return clEnqueueMigrateMemObjects(queue, 1, &d_in, 0, 0, nullptr, nullptr);
+      }),"clEnqueueMigrateMemObjects failed");
+
+    for (size_t i = 0; i < kernels; ++i) {
+      throw_if_error(stats.time("clSetKernelArg", [&] {
+        return clSetKernelArg(kernel, 2, sizeof(cl_int), &count);
+      }),"clSetKernelArg failed");
+      throw_if_error(stats.time("clEnqueueTask", [&] {
+        return clEnqueueTask(queue, kernel, 0, nullptr, nullptr);
+      }),"clEnqueueTask failed");
+    }
+
+    for (size_t i = 0; i < reads; ++i)
+      throw_if_error(stats.time("clEnqueueReadBuffer", [&] {
+        return clEnqueueReadBuffer(queue, d_out, blocking, 0, bytes, h_out.data(), 0, nullptr, nullptr);
+      }),"clEnqueueReadBuffer failed");
+
+    if (finish && ((iter + 1) % finish) == 0)
+      throw_if_error(stats.time("clFinish", [&] { return clFinish(queue); }),"clFinish failed");
+  }
+  throw_if_error(stats.time("clFinish", [&] { return clFinish(queue); }),"clFinish failed");
+
+  auto end = utils::time_ns();
+  auto rss_end = rss_kb();
+
+  stats.report();
+  std::cout << "total (ms): " << (end-start)*1e-6 << "\n";
+  std::cout << "per iteration (us): " << (end-start)*1e-3/iterations << "\n";
+  // Growth is dominated by what the profiler collected while running
+  std::cout << "rss start (kB): " << rss_start << "\n";
+  std::cout << "rss growth (kB): " << (rss_end - rss_start) << "\n";
+  std::cout << "rss peak (kB): " << rss_kb("VmHWM:") << "\n";
+
+  clReleaseMemObject(d_in);
+  clReleaseMemObject(d_out);
+  clReleaseKernel(kernel);
+  clReleaseProgram(program);
+  clReleaseCommandQueue(queue);
+  clReleaseContext(context);
+  clReleaseDevice(device);
+
+  return 0;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+  try {
+    auto ret = run(argc,argv);
+    std::cout << "SUCCESS\n";
+    return ret;
+  }
+  catch (const std::exception& ex) {
+    std::cout << "FAIL: " << ex.what() << "\n";
+    return 1;
+  }
+  catch (...) {
+    std::cout << "FAIL\n";
+    return 1;
+  }
+}
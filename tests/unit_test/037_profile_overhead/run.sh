@@ -0,0 +1,61 @@
+#!/usr/bin/env bash
+#
+# Run the profile overhead benchmark once per XDP configuration.
+#
+# usage: run.sh <host.exe> <bench.xclbin> [benchmark options]
+#
+# Each configuration runs in its own directory with its own xrt.ini so
+# that profile output of one run does not affect the next.  For software
+# emulation set XCL_EMULATION_MODE=sw_emu and generate emconfig.json
+# with emconfigutil before running.
+
+set -e
+
+if [ $# -lt 2 ]; then
+  echo "usage: $0 <host.exe> <bench.xclbin> [benchmark options]"
+  exit 1
+fi
+
+HOST=$(readlink -f $1)
+XCLBIN=$(readlink -f $2)
+shift 2
+
+ROOT=$PWD
+OUT=$ROOT/overhead
+
+declare -A CONFIGS
+CONFIGS[00_off]=""
+CONFIGS[01_profile]="profile = true"
+CONFIGS[02_timeline]="profile = true\ntimeline_trace = true"
+CONFIGS[03_dtt_coarse]="profile = true\ntimeline_trace = true\ndata_transfer_trace = coarse"
+CONFIGS[04_dtt_fine]="profile = true\ntimeline_trace = true\ndata_transfer_trace = fine"
+CONFIGS[05_stall_memory]="profile = true\ntimeline_trace = true\ndata_transfer_trace = fine\nstall_trace = memory"
+CONFIGS[06_stall_all]="profile = true\ntimeline_trace = true\ndata_transfer_trace = fine\nstall_trace = all"
+
+rm -rf $OUT
+mkdir -p $OUT
+
+for config in $(echo ${!CONFIGS[@]} | tr ' ' '\n' | sort); do
+  mkdir -p $OUT/$config
+  cd $OUT/$config
+  [ -f $ROOT/emconfig.json ] && cp $ROOT/emconfig.json .
+  printf "[Debug]\n${CONFIGS[$config]}\n" > xrt.ini
+  echo "RUN $config"
+  $HOST $XCLBIN "$@" > result.txt
+  cd $ROOT
+done
+
+# Side by side summary, one line per configuration and API
+printf "\n%-16s %-28s %10s %10s %10s\n" config api calls p50_us p99_us
+for config in $(ls $OUT); do
+  grep -E "^cl[A-Za-z]+," $OUT/$config/result.txt | \
+    awk -F, -v c=$config '{ printf "%-16s %-28s %10d %10.2f %10.2f\n", c, $1, $2, $3, $4 }'
+done
+
+printf "\n%-16s %12s %16s %14s\n" config total_ms rss_growth_kB rss_peak_kB
+for config in $(ls $OUT); do
+  total=$(grep "total (ms)" $OUT/$config/result.txt | cut -d: -f2)
+  growth=$(grep "rss growth" $OUT/$config/result.txt | cut -d: -f2)
+  peak=$(grep "rss peak" $OUT/$config/result.txt | cut -d: -f2)
+  printf "%-16s %12.2f %16d %14d\n" $config $total $growth $peak
+done
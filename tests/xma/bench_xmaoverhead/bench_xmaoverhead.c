@@ -0,0 +1,457 @@
+/*
+ * Copyright (C) 2019, Xilinx Inc - All rights reserved
+ * Xilinx SDAccel Media Accelerator API
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Measure the cost of XMA itself, without kernels.
+//
+// N sessions of the stand-in plugin (xma_bench_plg.so) each push frames
+// from their own thread.  Per call latency of send and receive, frames per
+// second, heap allocations and context switches per frame are reported,
+// first for one session and then for all of them, so that contention
+// between sessions shows up as lost scaling.
+//
+// usage: bench_xmaoverhead.exe <xclbin> [options]
+//   [-t enc|dec|scl] : session type (default: enc)
+//   [-s <sessions>]  : concurrent sessions (default: 8)
+//   [-n <frames>]    : frames per session (default: 10000)
+//   [-w <width>]     : frame width (default: 1920)
+//   [-h <height>]    : frame height (default: 1080)
+//   [-c <cu_name>]   : place sessions automatically on CUs named cu_name
+//                      (default: CU 0 of device 0)
+//   [-m <mode>]      : plugin mode noop, copy or device (default: noop)
+//
+// Run against the emulation HAL with XCL_EMULATION_MODE=sw_emu and an
+// emconfig.json for the platform of the xclbin; any xclbin will do unless
+// the mode is device, which needs the loopback kernel.
+
+#include <dlfcn.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "xma.h"
+#include "xmaplugin.h"
+
+#define PLUGIN_LIB "./xma_bench_plg.so"
+
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t nmemb, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+}
+
+// Heap allocations of the whole process while measuring
+static std::atomic<bool> count_allocs(false);
+static std::atomic<uint64_t> num_allocs(0);
+
+extern "C" void *malloc(size_t size)
+{
+    if (count_allocs.load(std::memory_order_relaxed))
+        num_allocs.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t nmemb, size_t size)
+{
+    if (count_allocs.load(std::memory_order_relaxed))
+        num_allocs.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(nmemb, size);
+}
+
+extern "C" void *realloc(void *ptr, size_t size)
+{
+    if (count_allocs.load(std::memory_order_relaxed))
+        num_allocs.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(ptr, size);
+}
+
+struct BenchConfig
+{
+    std::string type = "enc";
+    int32_t     sessions = 8;
+    int32_t     frames = 10000;
+    int32_t     width = 1920;
+    int32_t     height = 1080;
+    const char *cu_name = NULL;
+};
+
+struct BenchResult
+{
+    double   seconds = 0;
+    uint64_t frames = 0;
+    uint64_t allocs = 0;
+    uint64_t vol_switches = 0;
+    uint64_t invol_switches = 0;
+    uint64_t plugin_ns = 0;
+    std::vector<uint64_t> send_ns;
+    std::vector<uint64_t> recv_ns;
+    bool     ok = true;
+};
+
+// One session and what it sends and receives
+struct BenchStream
+{
+    XmaSession    *base = NULL;
+    XmaEncoderSession *enc = NULL;
+    XmaDecoderSession *dec = NULL;
+    XmaScalerSession  *scl = NULL;
+    XmaFrame      *frame = NULL;
+    XmaDataBuffer *data = NULL;
+    std::vector<uint64_t> send_ns;
+    std::vector<uint64_t> recv_ns;
+    bool           ok = true;
+};
+
+static std::atomic<uint64_t> *plugin_ns = NULL;
+
+static uint64_t now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void set_placement(const BenchConfig& cfg, int32_t *dev_index, int32_t *cu_index,
+                          char **cu_name, int32_t *ddr_bank_index, char **plugin_lib)
+{
+    *dev_index = cfg.cu_name ? XMA_AUTO_PLACEMENT : 0;
+    *cu_index = cfg.cu_name ? XMA_AUTO_PLACEMENT : 0;
+    *cu_name = (char*) cfg.cu_name;
+    *ddr_bank_index = -1;
+    *plugin_lib = (char*) PLUGIN_LIB;
+}
+
+static bool stream_create(const BenchConfig& cfg, BenchStream& stream)
+{
+    XmaFrameProperties fprops;
+    memset(&fprops, 0, sizeof(XmaFrameProperties));
+    fprops.format = XMA_YUV420_FMT_TYPE;
+    fprops.width = cfg.width;
+    fprops.height = cfg.height;
+    fprops.bits_per_pixel = 8;
+
+    if (cfg.type == "enc") {
+        XmaEncoderProperties props;
+        memset(&props, 0, sizeof(XmaEncoderProperties));
+        props.hwencoder_type = XMA_COPY_ENCODER_TYPE;
+        strncpy(props.hwvendor_string, "Xilinx", (MAX_VENDOR_NAME - 1));
+        props.format = XMA_YUV420_FMT_TYPE;
+        props.bits_per_pixel = 8;
+        props.width = cfg.width;
+        props.height = cfg.height;
+        set_placement(cfg, &props.dev_index, &props.cu_index, &props.cu_name,
+                      &props.ddr_bank_index, &props.plugin_lib);
+        stream.enc = xma_enc_session_create(&props);
+        if (stream.enc)
+            stream.base = &stream.enc->base;
+        stream.frame = xma_frame_alloc(&fprops);
+        stream.data = xma_data_buffer_alloc(cfg.width * cfg.height);
+    } else if (cfg.type == "dec") {
+        XmaDecoderProperties props;
+        memset(&props, 0, sizeof(XmaDecoderProperties));
+        props.hwdecoder_type = XMA_H264_DECODER_TYPE;
+        strncpy(props.hwvendor_string, "Xilinx", (MAX_VENDOR_NAME - 1));
+        props.bits_per_pixel = 8;
+        props.width = cfg.width;
+        props.height = cfg.height;
+        set_placement(cfg, &props.dev_index, &props.cu_index, &props.cu_name,
+                      &props.ddr_bank_index, &props.plugin_lib);
+        stream.dec = xma_dec_session_create(&props);
+        if (stream.dec)
+            stream.base = &stream.dec->base;
+        stream.frame = xma_frame_alloc(&fprops);
+        stream.data = xma_data_buffer_alloc(cfg.width * cfg.height);
+    } else {
+        XmaScalerProperties *props = (XmaScalerProperties*) calloc(1, sizeof(XmaScalerProperties));
+        props->hwscaler_type = XMA_POLYPHASE_SCALER_TYPE;
+        strncpy(props->hwvendor_string, "Xilinx", (MAX_VENDOR_NAME - 1));
+        props->num_outputs = 1;
+        props->max_dest_cnt = 1;
+        props->input.format = XMA_YUV420_FMT_TYPE;
+        props->input.bits_per_pixel = 8;
+        props->input.width = cfg.width;
+        props->input.height = cfg.height;
+        props->output[0] = props->input;
+        set_placement(cfg, &props->dev_index, &props->cu_index, &props->cu_name,
+                      &props->ddr_bank_index, &props->plugin_lib);
+        stream.scl = xma_scaler_session_create(props);
+        if (stream.scl)
+            stream.base = &stream.scl->base;
+        stream.frame = xma_frame_alloc(&fprops);
+        free(props);
+    }
+    stream.send_ns.reserve(cfg.frames);
+    stream.recv_ns.reserve(cfg.frames);
+    return stream.base && stream.frame && (cfg.type == "scl" || stream.data);
+}
+
+static void stream_destroy(BenchStream& stream)
+{
+    if (stream.enc)
+        xma_enc_session_destroy(stream.enc);
+    if (stream.dec)
+        xma_dec_session_destroy(stream.dec);
+    if (stream.scl)
+        xma_scaler_session_destroy(stream.scl);
+    if (stream.frame)
+        xma_frame_free(stream.frame);
+    if (stream.data)
+        xma_data_buffer_free(stream.data);
+}
+
+static int32_t stream_send(BenchStream& stream)
+{
+    if (stream.enc)
+        return xma_enc_session_send_frame(stream.enc, stream.frame);
+    if (stream.dec) {
+        int32_t data_used = 0;
+        return xma_dec_session_send_data(stream.dec, stream.data, &data_used);
+    }
+    return xma_scaler_session_send_frame(stream.scl, stream.frame);
+}
+
+static int32_t stream_recv(BenchStream& stream)
+{
+    if (stream.enc) {
+        int32_t data_size = 0;
+        return xma_enc_session_recv_data(stream.enc, stream.data, &data_size);
+    }
+    if (stream.dec)
+        return xma_dec_session_recv_frame(stream.dec, stream.frame);
+    XmaFrame *frame_list[MAX_SCALER_OUTPUTS] = { stream.frame };
+    return xma_scaler_session_recv_frame_list(stream.scl, frame_list);
+}
+
+static void stream_run(BenchStream& stream, int32_t frames)
+{
+    for (int32_t i = 0; i < frames; i++) {
+        uint64_t t0 = now_ns();
+        int32_t rc = stream_send(stream);
+        uint64_t t1 = now_ns();
+        if (rc != XMA_SUCCESS) {
+            stream.ok = false;
+            return;
+        }
+        rc = stream_recv(stream);
+        uint64_t t2 = now_ns();
+        if (rc != XMA_SUCCESS) {
+            stream.ok = false;
+            return;
+        }
+        stream.send_ns.push_back(t1 - t0);
+        stream.recv_ns.push_back(t2 - t1);
+    }
+}
+
+static BenchResult run_phase(const BenchConfig& cfg, int32_t sessions)
+{
+    BenchResult result;
+    std::vector<BenchStream> streams(sessions);
+    for (auto& stream : streams) {
+        if (!stream_create(cfg, stream)) {
+            std::cout << "FAIL: unable to create " << cfg.type << " session" << std::endl;
+            result.ok = false;
+        }
+    }
+
+    if (result.ok) {
+        // Start all streams at once once their threads exist
+        std::mutex lock;
+        std::condition_variable cv;
+        bool go = false;
+        std::vector<std::thread> threads;
+        for (auto& stream : streams) {
+            threads.emplace_back([&, frames = cfg.frames]() {
+                {
+                    std::unique_lock<std::mutex> guard(lock);
+                    cv.wait(guard, [&] { return go; });
+                }
+                stream_run(stream, frames);
+            });
+        }
+
+        struct rusage ru_start, ru_end;
+        uint64_t plugin_start = plugin_ns ? plugin_ns->load() : 0;
+        getrusage(RUSAGE_SELF, &ru_start);
+        num_allocs = 0;
+        count_allocs = true;
+        uint64_t start = now_ns();
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            go = true;
+        }
+        cv.notify_all();
+        for (auto& thread : threads)
+            thread.join();
+        uint64_t end = now_ns();
+        count_allocs = false;
+        getrusage(RUSAGE_SELF, &ru_end);
+
+        result.seconds = (end - start) * 1e-9;
+        result.allocs = num_allocs;
+        result.vol_switches = ru_end.ru_nvcsw - ru_start.ru_nvcsw;
+        result.invol_switches = ru_end.ru_nivcsw - ru_start.ru_nivcsw;
+        result.plugin_ns = plugin_ns ? plugin_ns->load() - plugin_start : 0;
+        for (auto& stream : streams) {
+            result.ok &= stream.ok;
+            result.frames += stream.send_ns.size();
+            result.send_ns.insert(result.send_ns.end(), stream.send_ns.begin(), stream.send_ns.end());
+            result.recv_ns.insert(result.recv_ns.end(), stream.recv_ns.begin(), stream.recv_ns.end());
+        }
+    }
+
+    for (auto& stream : streams)
+        stream_destroy(stream);
+    return result;
+}
+
+static void report_latency(const char *name, std::vector<uint64_t>& samples)
+{
+    if (samples.empty())
+        return;
+    std::sort(samples.begin(), samples.end());
+    uint64_t total = 0;
+    for (auto ns : samples)
+        total += ns;
+    auto pct = [&samples](double p) {
+        size_t idx = static_cast<size_t>(p * (samples.size() - 1) + 0.5);
+        return samples[idx] * 1e-3;
+    };
+    std::cout << name << "," << samples.size() << "," << pct(0.50) << "," << pct(0.99)
+              << "," << samples.back() * 1e-3 << "," << (total * 1e-3) / samples.size() << "\n";
+}
+
+static void report(const char *phase, int32_t sessions, BenchResult& result)
+{
+    double frames = result.frames ? (double)result.frames : 1.0;
+    uint64_t call_ns = 0;
+    for (auto ns : result.send_ns)
+        call_ns += ns;
+    for (auto ns : result.recv_ns)
+        call_ns += ns;
+    uint64_t xma_ns = call_ns > result.plugin_ns ? call_ns - result.plugin_ns : 0;
+
+    std::cout << "== " << phase << ": " << sessions << " session(s), " << result.frames << " frames\n";
+    std::cout << "call,calls,p50_us,p99_us,max_us,mean_us\n";
+    report_latency("send", result.send_ns);
+    report_latency("recv", result.recv_ns);
+    std::cout << "frames/sec: " << result.frames / result.seconds << "\n";
+    std::cout << "xma us/frame (excluding plugin): " << (xma_ns * 1e-3) / frames << "\n";
+    std::cout << "allocations/frame: " << result.allocs / frames << "\n";
+    std::cout << "voluntary context switches/frame: " << result.vol_switches / frames << "\n";
+    std::cout << "involuntary context switches/frame: " << result.invol_switches / frames << "\n";
+}
+
+static void report_cu_stats()
+{
+    std::vector<XmaPerfStats> table(256);
+    int32_t num_cus = xma_get_cu_stats(table.data(), table.size());
+    for (int32_t i = 0; i < num_cus && i < (int32_t)table.size(); i++) {
+        if (table[i].submitted == 0)
+            continue;
+        std::cout << "CU " << table[i].dev_index << ":" << table[i].cu_name
+                  << " work items " << table[i].completed
+                  << " queue wait avg us " << (table[i].queue_wait.count ? table[i].queue_wait.total_us / table[i].queue_wait.count : 0)
+                  << " exec avg us " << (table[i].exec.count ? table[i].exec.total_us / table[i].exec.count : 0) << "\n";
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    BenchConfig cfg;
+    const char *xclbin = NULL;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg[0] != '-') {
+            xclbin = argv[i];
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cout << "FAIL: " << arg << " needs a value" << std::endl;
+            return 1;
+        }
+        const char *val = argv[++i];
+        if (arg == "-t")
+            cfg.type = val;
+        else if (arg == "-s")
+            cfg.sessions = atoi(val);
+        else if (arg == "-n")
+            cfg.frames = atoi(val);
+        else if (arg == "-w")
+            cfg.width = atoi(val);
+        else if (arg == "-h")
+            cfg.height = atoi(val);
+        else if (arg == "-c")
+            cfg.cu_name = val;
+        else if (arg == "-m")
+            setenv("XMA_BENCH_MODE", val, 1);
+    }
+    if (xclbin == NULL || cfg.sessions < 1 || cfg.frames < 1 ||
+        (cfg.type != "enc" && cfg.type != "dec" && cfg.type != "scl")) {
+        std::cout << "usage: " << argv[0] << " <xclbin> [-t enc|dec|scl] [-s sessions] [-n frames]"
+                  << " [-w width] [-h height] [-c cu_name] [-m noop|copy|device]" << std::endl;
+        return 1;
+    }
+
+    XmaXclbinParameter xclbin_param;
+    xclbin_param.xclbin_name = (char*) xclbin;
+    xclbin_param.device_id = 0;
+    if (xma_initialize(&xclbin_param, 1) != XMA_SUCCESS) {
+        std::cout << "FAIL: xma_initialize" << std::endl;
+        return 1;
+    }
+
+    // The plugin is already loaded by the first session; look up its timer then
+    int rc = 0;
+    BenchResult single = run_phase(cfg, 1);
+    void *plugin = dlopen(PLUGIN_LIB, RTLD_NOW | RTLD_NOLOAD);
+    if (plugin)
+        plugin_ns = (std::atomic<uint64_t>*) dlsym(plugin, "xma_bench_plugin_ns");
+    if (!single.ok) {
+        std::cout << "FAIL: single session run" << std::endl;
+        return 1;
+    }
+    if (plugin_ns)
+        single = run_phase(cfg, 1);
+    report("baseline", 1, single);
+
+    if (cfg.sessions > 1) {
+        BenchResult all = run_phase(cfg, cfg.sessions);
+        if (!all.ok) {
+            std::cout << "FAIL: " << cfg.sessions << " session run" << std::endl;
+            return 1;
+        }
+        report("concurrent", cfg.sessions, all);
+        // Below 1.0 when sessions wait on each other inside XMA (or run out of cores)
+        double fps1 = single.frames / single.seconds;
+        double fpsn = all.frames / all.seconds;
+        std::cout << "scaling efficiency: " << fpsn / (fps1 * cfg.sessions) << "\n";
+    }
+    report_cu_stats();
+    if (plugin)
+        dlclose(plugin);
+
+    std::cout << "PASS" << std::endl;
+    return rc;
+}
@@ -0,0 +1,274 @@
+/*
+ * Copyright (C) 2019, Xilinx Inc - All rights reserved
+ * Xilinx SDAccel Media Accelerator API
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Stand-in encoder, decoder and scaler plugin for bench_xmaoverhead.
+//
+// XMA_BENCH_MODE selects what each frame costs the plugin:
+//   noop   : nothing; only XMA itself is measured (default)
+//   copy   : memcpy of the first plane into plugin memory
+//   device : buffer write, one work item on the CU and buffer read back;
+//            the CU must take (out, in, length) like the loopback kernel
+//            of profiling/03_loopback_xma
+// Time spent inside the plugin is summed in xma_bench_plugin_ns so the
+// benchmark can subtract it from the time spent in XMA calls.
+
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <xmaplugin.h>
+
+#define BENCH_MODE_NOOP   0
+#define BENCH_MODE_COPY   1
+#define BENCH_MODE_DEVICE 2
+
+// Loopback kernel register map
+#define BENCH_REG_OUT     0x10
+#define BENCH_REG_IN      0x1c
+#define BENCH_REG_LENGTH  0x28
+
+extern "C" {
+std::atomic<uint64_t> xma_bench_plugin_ns(0);
+}
+
+typedef struct BenchContext
+{
+    int32_t      mode;
+    size_t       size;
+    uint8_t     *copy_buf;
+    XmaBufferObj in;
+    XmaBufferObj out;
+    int32_t      pending;
+} BenchContext;
+
+static uint64_t bench_now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static int32_t bench_init(XmaSession *s, size_t size)
+{
+    BenchContext *ctx = (BenchContext*)s->plugin_data;
+    const char *mode = getenv("XMA_BENCH_MODE");
+    int32_t rc = XMA_SUCCESS;
+
+    memset(ctx, 0, sizeof(BenchContext));
+    ctx->size = size;
+    if (mode && strcmp(mode, "copy") == 0) {
+        ctx->mode = BENCH_MODE_COPY;
+        ctx->copy_buf = (uint8_t*)malloc(size);
+        return ctx->copy_buf ? XMA_SUCCESS : XMA_ERROR;
+    }
+    if (mode && strcmp(mode, "device") == 0) {
+        ctx->mode = BENCH_MODE_DEVICE;
+        ctx->in = xma_plg_buffer_alloc(*s, size, false, &rc);
+        if (rc != XMA_SUCCESS)
+            return rc;
+        ctx->out = xma_plg_buffer_alloc(*s, size, false, &rc);
+        if (rc != XMA_SUCCESS) {
+            xma_plg_buffer_free(*s, ctx->in);
+            return rc;
+        }
+        if (xma_plg_work_item_depth(*s, 1) != XMA_SUCCESS)
+            return XMA_ERROR;
+    }
+    return XMA_SUCCESS;
+}
+
+static int32_t bench_process(XmaSession *s, const void *src)
+{
+    BenchContext *ctx = (BenchContext*)s->plugin_data;
+    uint64_t start = bench_now_ns();
+    int32_t rc = XMA_SUCCESS;
+
+    if (ctx->mode == BENCH_MODE_COPY && src) {
+        memcpy(ctx->copy_buf, src, ctx->size);
+    } else if (ctx->mode == BENCH_MODE_DEVICE) {
+        if (src)
+            memcpy(ctx->in.data, src, ctx->size);
+        rc = xma_plg_buffer_write(*s, ctx->in, ctx->size, 0);
+
+        uint32_t length = (uint32_t)ctx->size;
+        XmaWorkItem item;
+        if (rc == XMA_SUCCESS)
+            rc = xma_plg_kernel_lock_regmap(*s);
+        if (rc == XMA_SUCCESS) {
+            xma_plg_register_prep_write(*s, &ctx->out.paddr, sizeof(uint64_t), BENCH_REG_OUT);
+            xma_plg_register_prep_write(*s, &ctx->in.paddr, sizeof(uint64_t), BENCH_REG_IN);
+            xma_plg_register_prep_write(*s, &length, sizeof(uint32_t), BENCH_REG_LENGTH);
+            rc = xma_plg_submit_work_item(*s, &item);
+            xma_plg_kernel_unlock_regmap(*s);
+        }
+        if (rc == XMA_SUCCESS)
+            rc = xma_plg_wait_work_item(*s, item, 10000);
+        if (rc == XMA_SUCCESS)
+            rc = xma_plg_buffer_read(*s, ctx->out, ctx->size, 0);
+    }
+    if (rc == XMA_SUCCESS)
+        ctx->pending++;
+    xma_bench_plugin_ns += bench_now_ns() - start;
+    return rc;
+}
+
+// Hand back one processed frame if there is any
+static int32_t bench_complete(XmaSession *s)
+{
+    BenchContext *ctx = (BenchContext*)s->plugin_data;
+    if (ctx->pending == 0)
+        return XMA_SEND_MORE_DATA;
+    ctx->pending--;
+    return XMA_SUCCESS;
+}
+
+static int32_t bench_close(XmaSession *s)
+{
+    BenchContext *ctx = (BenchContext*)s->plugin_data;
+    if (ctx->mode == BENCH_MODE_DEVICE) {
+        xma_plg_buffer_free(*s, ctx->in);
+        xma_plg_buffer_free(*s, ctx->out);
+    }
+    free(ctx->copy_buf);
+    return 0;
+}
+
+static int32_t bench_version(int32_t *main_version, int32_t *sub_version)
+{
+    *main_version = 2019;
+    *sub_version = 2;
+    return 0;
+}
+
+static int32_t bench_enc_init(XmaEncoderSession *sess)
+{
+    return bench_init(&sess->base, (size_t)sess->encoder_props.width * sess->encoder_props.height);
+}
+
+static int32_t bench_enc_send(XmaEncoderSession *sess, XmaFrame *frame)
+{
+    return bench_process(&sess->base, frame->data[0].buffer);
+}
+
+static int32_t bench_enc_recv(XmaEncoderSession *sess, XmaDataBuffer *data,
+                              int32_t *data_size)
+{
+    *data_size = 0;
+    int32_t rc = bench_complete(&sess->base);
+    if (rc == XMA_SUCCESS)
+        *data_size = data->alloc_size;
+    return rc;
+}
+
+static int32_t bench_enc_close(XmaEncoderSession *sess)
+{
+    return bench_close(&sess->base);
+}
+
+static int32_t bench_dec_init(XmaDecoderSession *sess)
+{
+    return bench_init(&sess->base, (size_t)sess->decoder_props.width * sess->decoder_props.height);
+}
+
+static int32_t bench_dec_send(XmaDecoderSession *sess, XmaDataBuffer *data,
+                              int32_t *data_used)
+{
+    *data_used = data->alloc_size;
+    return bench_process(&sess->base, data->data.buffer);
+}
+
+static int32_t bench_dec_get_properties(XmaDecoderSession *sess,
+                                        XmaFrameProperties *fprops)
+{
+    fprops->format = XMA_YUV420_FMT_TYPE;
+    fprops->width = sess->decoder_props.width;
+    fprops->height = sess->decoder_props.height;
+    fprops->bits_per_pixel = 8;
+    return XMA_SUCCESS;
+}
+
+static int32_t bench_dec_recv(XmaDecoderSession *sess, XmaFrame *frame)
+{
+    return bench_complete(&sess->base);
+}
+
+static int32_t bench_dec_close(XmaDecoderSession *sess)
+{
+    return bench_close(&sess->base);
+}
+
+static int32_t bench_scaler_init(XmaScalerSession *sess)
+{
+    return bench_init(&sess->base, (size_t)sess->props.input.width * sess->props.input.height);
+}
+
+static int32_t bench_scaler_send(XmaScalerSession *sess, XmaFrame *frame)
+{
+    return bench_process(&sess->base, frame->data[0].buffer);
+}
+
+static int32_t bench_scaler_recv(XmaScalerSession *sess, XmaFrame **frame_list)
+{
+    return bench_complete(&sess->base);
+}
+
+static int32_t bench_scaler_close(XmaScalerSession *sess)
+{
+    return bench_close(&sess->base);
+}
+
+extern "C" {
+
+XmaEncoderPlugin encoder_plugin = {
+    .hwencoder_type = XMA_COPY_ENCODER_TYPE,
+    .hwvendor_string = "Xilinx",
+    .format = XMA_YUV420_FMT_TYPE,
+    .bits_per_pixel = 8,
+    .plugin_data_size = sizeof(BenchContext),
+    .init = bench_enc_init,
+    .send_frame = bench_enc_send,
+    .recv_data = bench_enc_recv,
+    .close = bench_enc_close,
+    .xma_version = bench_version
+};
+
+XmaDecoderPlugin decoder_plugin = {
+    .hwdecoder_type = XMA_H264_DECODER_TYPE,
+    .hwvendor_string = "Xilinx",
+    .plugin_data_size = sizeof(BenchContext),
+    .init = bench_dec_init,
+    .send_data = bench_dec_send,
+    .get_properties = bench_dec_get_properties,
+    .recv_frame = bench_dec_recv,
+    .close = bench_dec_close,
+    .xma_version = bench_version
+};
+
+XmaScalerPlugin scaler_plugin = {
+    .hwscaler_type = XMA_POLYPHASE_SCALER_TYPE,
+    .hwvendor_string = "Xilinx",
+    .input_format = XMA_YUV420_FMT_TYPE,
+    .output_format = XMA_YUV420_FMT_TYPE,
+    .bits_per_pixel = 8,
+    .plugin_data_size = sizeof(BenchContext),
+    .init = bench_scaler_init,
+    .send_frame = bench_scaler_send,
+    .recv_frame_list = bench_scaler_recv,
+    .close = bench_scaler_close,
+    .xma_version = bench_version
+};
+
+}
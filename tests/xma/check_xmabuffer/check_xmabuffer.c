@@ -25,6 +25,7 @@
 #include "lib/xmares.h"
 #include "lib/xmahw.h"
 #include "lib/xmahw_private.h"
+#include "lib/xmahw_lib.h"
 #include "lib/xmacfg.h"
 
 int ck_assert_int_eq(int rc1, int rc2) {
@@ -385,6 +386,215 @@ int xma_frame_free_tst()
     return rc;
 }
 
+static void xma_frame_pool_props(XmaFrameProperties *frame_props)
+{
+    memset(frame_props, 0, sizeof(XmaFrameProperties));
+    frame_props->format = XMA_YUV420_FMT_TYPE;
+    frame_props->width = 1280;
+    frame_props->height = 720;
+    frame_props->bits_per_pixel = 8;
+}
+
+/* a freed pool frame comes back from the pool, planes and all */
+int xma_frame_pool_reuse_tst()
+{
+    XmaFrameProperties frame_props;
+    XmaFramePool *pool;
+    XmaFrame *frame, *frame2, *frame3;
+    uint8_t *luma;
+    int rc;
+
+    xma_frame_pool_props(&frame_props);
+    pool = xma_frame_pool_create(&frame_props, 2);
+    rc = ck_assert(pool != NULL);
+    if (rc != 0)
+        return rc;
+
+    frame = xma_frame_pool_get(pool);
+    rc |= ck_assert(frame != NULL);
+    if (rc != 0) {
+        xma_frame_pool_destroy(pool);
+        return rc;
+    }
+    rc |= ck_assert_int_eq(frame->data[0].refcount, 1);
+    luma = (uint8_t*)frame->data[0].buffer;
+    frame->pts = 42;
+
+    xma_frame_free(frame);
+    frame2 = xma_frame_pool_get(pool);
+    rc |= ck_assert(frame2 == frame);
+    rc |= ck_assert(frame2->data[0].buffer == luma);
+    rc |= ck_assert_int_eq(frame2->data[0].refcount, 1);
+    rc |= ck_assert(frame2->pts == 0);
+
+    /* max_frames frames in use */
+    frame3 = xma_frame_pool_get(pool);
+    rc |= ck_assert(frame3 != NULL && frame3 != frame2);
+    rc |= ck_assert(xma_frame_pool_get(pool) == NULL);
+
+    xma_frame_free(frame3);
+    xma_frame_free(frame2);
+    xma_frame_pool_destroy(pool);
+
+    return rc;
+}
+
+/* a pool frame goes back to the pool on its last reference only */
+int xma_frame_pool_refcount_tst()
+{
+    XmaFrameProperties frame_props;
+    XmaFramePool *pool;
+    XmaFrame *frame, *frame2;
+    int rc;
+
+    xma_frame_pool_props(&frame_props);
+    pool = xma_frame_pool_create(&frame_props, 1);
+    rc = ck_assert(pool != NULL);
+    if (rc != 0)
+        return rc;
+
+    frame = xma_frame_pool_get(pool);
+    rc |= ck_assert(frame != NULL);
+    if (rc != 0) {
+        xma_frame_pool_destroy(pool);
+        return rc;
+    }
+    rc |= ck_assert_int_eq(xma_frame_inc_ref(frame), 2);
+    rc |= ck_assert_int_eq(xma_frame_inc_ref(NULL), XMA_ERROR_INVALID);
+
+    xma_frame_free(frame);
+    rc |= ck_assert_int_eq(frame->data[0].refcount, 1);
+    rc |= ck_assert_int_eq(frame->data[2].refcount, 1);
+    rc |= ck_assert(xma_frame_pool_get(pool) == NULL);
+
+    xma_frame_free(frame);
+    frame2 = xma_frame_pool_get(pool);
+    rc |= ck_assert(frame2 == frame);
+
+    /* frames still in use outlive the pool */
+    xma_frame_pool_destroy(pool);
+    rc |= ck_assert(frame2->data[0].buffer != NULL);
+    memset(frame2->data[0].buffer, 0x80, 1280);
+    xma_frame_free(frame2);
+
+    return rc;
+}
+
+/* device planes as a decoder on dev_handle hands them out; not owned by the frame */
+static XmaFrame* xma_frame_on_device(XmaFrameProperties *frame_props, void *dev_handle,
+                                     int32_t bank_index, XmaBufferObj *b_obj,
+                                     XmaBufferObjPrivate *b_obj_priv)
+{
+    XmaFrameData frame_data;
+    int32_t plane_cnt = xma_frame_planes_get(frame_props);
+
+    memset(&frame_data, 0, sizeof(frame_data));
+    for (int32_t i = 0; i < plane_cnt; i++) {
+        b_obj_priv[i].dummy = (void*)(((uint64_t)&b_obj_priv[i]) | signature);
+        b_obj_priv[i].size = 4096;
+        b_obj_priv[i].bank_index = bank_index;
+        b_obj_priv[i].dev_index = 0;
+        b_obj_priv[i].dev_handle = dev_handle;
+        b_obj_priv[i].device_only_buffer = true;
+        memset(&b_obj[i], 0, sizeof(XmaBufferObj));
+        b_obj[i].size = 4096;
+        b_obj[i].bank_index = bank_index;
+        b_obj[i].device_only_buffer = true;
+        b_obj[i].private_do_not_touch = &b_obj_priv[i];
+        frame_data.dev_buf[i] = &b_obj[i];
+    }
+    return xma_frame_from_device_buffers(frame_props, &frame_data, true);
+}
+
+/* device planes the encoder CU can reach are passed without a copy */
+int xma_frame_stage_reachable_tst()
+{
+    XmaFrameProperties frame_props;
+    XmaBufferObj b_obj[3];
+    XmaBufferObjPrivate b_obj_priv[3];
+    XmaHwKernel kernel_info;
+    XmaSession session;
+    XmaFrame *frame, *staged = NULL;
+    int dev;
+    int rc;
+
+    xma_frame_pool_props(&frame_props);
+    memset(&session, 0, sizeof(session));
+    session.session_type = XMA_ENCODER;
+    session.hw_session.dev_handle = &dev;
+    session.hw_session.bank_index = 0;
+    kernel_info.ip_ddr_mapping = (1ULL << 0) | (1ULL << 2);
+    session.hw_session.kernel_info = &kernel_info;
+
+    /* bank of the session */
+    frame = xma_frame_on_device(&frame_props, &dev, 0, b_obj, b_obj_priv);
+    rc = ck_assert(frame != NULL);
+    if (rc != 0)
+        return rc;
+    rc |= ck_assert_int_eq(frame->data[0].buffer_type, XMA_DEVICE_ONLY_BUFFER_TYPE);
+    rc |= ck_assert_int_eq(xma_frame_stage_for_session(&session, frame, &staged), XMA_SUCCESS);
+    rc |= ck_assert(staged == frame);
+    rc |= ck_assert_int_eq(frame->data[0].refcount, 1);
+    xma_frame_free(frame);
+
+    /* other bank connected to the CU */
+    frame = xma_frame_on_device(&frame_props, &dev, 2, b_obj, b_obj_priv);
+    rc |= ck_assert(frame != NULL);
+    if (rc != 0)
+        return rc;
+    staged = NULL;
+    rc |= ck_assert_int_eq(xma_frame_stage_for_session(&session, frame, &staged), XMA_SUCCESS);
+    rc |= ck_assert(staged == frame);
+    xma_frame_free(frame);
+
+    /* no frame, e.g. encoder flush */
+    rc |= ck_assert_int_eq(xma_frame_stage_for_session(&session, NULL, &staged), XMA_SUCCESS);
+    rc |= ck_assert(staged == NULL);
+
+    return rc;
+}
+
+/* device planes out of reach need the buffer pool of the session to be staged */
+int neg_xma_frame_stage_no_pool_tst()
+{
+    XmaFrameProperties frame_props;
+    XmaBufferObj b_obj[3];
+    XmaBufferObjPrivate b_obj_priv[3];
+    XmaHwKernel kernel_info;
+    XmaSession session;
+    XmaFrame *frame, *staged = NULL;
+    int dev, other_dev;
+    int rc;
+
+    xma_frame_pool_props(&frame_props);
+    memset(&session, 0, sizeof(session));
+    session.session_type = XMA_ENCODER;
+    session.hw_session.dev_handle = &dev;
+    session.hw_session.bank_index = 0;
+    kernel_info.ip_ddr_mapping = 1ULL << 0;
+    session.hw_session.kernel_info = &kernel_info;
+
+    /* decoded on another device */
+    frame = xma_frame_on_device(&frame_props, &other_dev, 0, b_obj, b_obj_priv);
+    rc = ck_assert(frame != NULL);
+    if (rc != 0)
+        return rc;
+    rc |= ck_assert_int_eq(xma_frame_stage_for_session(&session, frame, &staged), XMA_ERROR);
+    rc |= ck_assert(staged == frame);
+    rc |= ck_assert_int_eq(frame->data[0].refcount, 1);
+    xma_frame_free(frame);
+
+    /* bank the CU is not connected to */
+    frame = xma_frame_on_device(&frame_props, &dev, 1, b_obj, b_obj_priv);
+    rc |= ck_assert(frame != NULL);
+    if (rc != 0)
+        return rc;
+    rc |= ck_assert_int_eq(xma_frame_stage_for_session(&session, frame, &staged), XMA_ERROR);
+    xma_frame_free(frame);
+
+    return rc;
+}
+
 static inline int32_t check_xmaapi_probe(XmaHwCfg *hwcfg) {
     return 0;
 }
@@ -479,6 +689,26 @@ int main()
       number_failed++;
     }
 
+    rc = xma_frame_pool_reuse_tst();
+    if (rc != 0) {
+      number_failed++;
+    }
+
+    rc = xma_frame_pool_refcount_tst();
+    if (rc != 0) {
+      number_failed++;
+    }
+
+    rc = xma_frame_stage_reachable_tst();
+    if (rc != 0) {
+      number_failed++;
+    }
+
+    rc = neg_xma_frame_stage_no_pool_tst();
+    if (rc != 0) {
+      number_failed++;
+    }
+
 
    if (number_failed == 0) {
      printf("XMA check_xmabuffer test completed successfully\n");
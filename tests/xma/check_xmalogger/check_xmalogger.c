@@ -22,6 +22,11 @@
 //#include <strings.h
 #include <string>
 #include <iostream>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <stdarg.h>
 #include "xma.h"
 #include "xma_test_plg.h"
 #include "lib/xmahw.h"
@@ -30,6 +35,7 @@
 #include "lib/xmares.h"
 
 #include "app/xmalogger.h"
+#include "lib/xmalogger.h"
 
 
 int ck_assert_int_lt(int rc1, int rc2) {
@@ -116,6 +122,85 @@ int test_logger_init()
 }
 
 
+/* Messages the logger thread wrote out, in order; replaces the XRT log sink */
+static std::mutex g_logged_lock;
+static std::vector<std::pair<int, std::string>> g_logged;
+
+int xclLogMsg(xclDeviceHandle handle, enum xrtLogMsgLevel level, const char* tag, const char* format, ...)
+{
+    char buf[XMA_MAX_LOGMSG_SIZE];
+    va_list ap;
+    va_start(ap, format);
+    vsnprintf(buf, sizeof(buf), format, ap);
+    va_end(ap);
+    std::lock_guard<std::mutex> guard(g_logged_lock);
+    g_logged.push_back(std::make_pair((int)level, std::string(buf)));
+    return 0;
+}
+
+/* Wait for the logger thread to write out msg */
+static bool wait_logged(const char *msg)
+{
+    for (int i = 0; i < 500; i++) {
+        {
+            std::lock_guard<std::mutex> guard(g_logged_lock);
+            for (auto &entry : g_logged) {
+                if (entry.second.find(msg) != std::string::npos)
+                    return true;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+}
+
+/* Warnings over the rate limit are dropped; errors logged between them
+ * never are, and are written out in the order they were logged
+ */
+int test_logger_errors_kept_in_order()
+{
+    const int num_errors = 4 * XMA_MAX_LOGMSG_Q_ENTRIES;
+    int rc = 0;
+    int i;
+
+    {
+        std::lock_guard<std::mutex> guard(g_logged_lock);
+        g_logged.clear();
+    }
+
+    std::thread flood([] {
+        for (int j = 0; j < 8 * XMA_MAX_LOGMSG_Q_ENTRIES; j++)
+            xma_logmsg(XMA_WARNING_LOG, "check_xmalogger", "warning %d\n", j);
+    });
+    for (i = 0; i < num_errors; i++) {
+        xma_logmsg(XMA_WARNING_LOG, "check_xmalogger", "warning before error %d\n", i);
+        xma_logmsg(XMA_ERROR_LOG, "check_xmalogger", "error %d\n", i);
+    }
+    flood.join();
+    xma_logmsg(XMA_ERROR_LOG, "check_xmalogger", "last error\n");
+    rc |= ck_assert(wait_logged("last error"));
+
+    std::lock_guard<std::mutex> guard(g_logged_lock);
+    int next_error = 0;
+    int warnings = 0;
+    for (auto &entry : g_logged) {
+        if (entry.first == XMA_ERROR_LOG) {
+            if (entry.second.find("last error") != std::string::npos)
+                continue;
+            char expected[32];
+            snprintf(expected, sizeof(expected), "error %d\n", next_error);
+            rc |= ck_assert(entry.second.find(expected) != std::string::npos);
+            next_error++;
+        } else if (entry.first == XMA_WARNING_LOG) {
+            warnings++;
+        }
+    }
+    rc |= ck_assert_int_eq(next_error, num_errors);
+    rc |= ck_assert_int_lt(warnings, 9 * XMA_MAX_LOGMSG_Q_ENTRIES + num_errors);
+
+    return rc;
+}
+
 int main()
 {
     int number_failed = 0;
@@ -132,6 +217,11 @@ int main()
       number_failed++;
     }
 
+    rc = test_logger_errors_kept_in_order();
+    if (rc != 0) {
+      number_failed++;
+    }
+
     
    if (number_failed == 0) {
      printf("XMA check_xmalogger test completed successfully\n");
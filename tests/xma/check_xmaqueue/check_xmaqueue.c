@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2019, Xilinx Inc - All rights reserved
+ * Xilinx SDAccel Media Accelerator API
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Tracked work items of xma_plg_submit_work_item: submission up to the
+// session depth, completion in submission order, and XMA_TRY_AGAIN once
+// the session or the execBOs of its CU are used up.
+//
+// usage: check_xmaqueue.exe <xclbin>
+// The xclbin may also be given with XMA_TEST_XCLBIN; the test is skipped
+// without one.  Work items run on CU 0 of device 0 with all registers
+// cleared, so that CU must finish when started with zero arguments.
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <iostream>
+#include <vector>
+#include "xma.h"
+#include "xmaplugin.h"
+#include "lib/xmahw_lib.h"
+
+#define PLUGIN_LIB "../plugins/xma_kernel_tst_plg.so"
+#define WAIT_MS    1000
+
+int ck_assert_int_eq(int rc1, int rc2) {
+  if (rc1 != rc2) {
+    return -1;
+  } else {
+    return 0;
+  }
+}
+
+int ck_assert(bool result) {
+  if (!result) {
+    return -1;
+  } else {
+    return 0;
+  }
+}
+
+static XmaKernelSession *create_session()
+{
+    XmaKernelProperties props;
+    memset(&props, 0, sizeof(XmaKernelProperties));
+    props.hwkernel_type = XMA_KERNEL_TYPE;
+    strncpy(props.hwvendor_string, "Xilinx", (MAX_VENDOR_NAME - 1));
+    props.plugin_lib = (char*) PLUGIN_LIB;
+    props.ddr_bank_index = -1;
+    props.dev_index = 0;
+    props.cu_index = 0;
+    XmaKernelSession *sess = xma_kernel_session_create(&props);
+    if (sess && xma_plg_work_item_depth(sess->base, XMA_MAX_WORK_ITEM_DEPTH) != XMA_SUCCESS) {
+        xma_kernel_session_destroy(sess);
+        return NULL;
+    }
+    return sess;
+}
+
+// Start the CU with cleared registers as a tracked work item
+static int32_t submit(XmaKernelSession *sess, XmaWorkItem *work_item)
+{
+    uint32_t regs[4] = {0, 0, 0, 0};
+    int32_t rc = xma_plg_kernel_lock_regmap(sess->base);
+    if (rc != XMA_SUCCESS)
+        return rc;
+    rc = xma_plg_register_prep_write(sess->base, regs, sizeof(regs), 0x10);
+    if (rc == XMA_SUCCESS)
+        rc = xma_plg_submit_work_item(sess->base, work_item);
+    xma_plg_kernel_unlock_regmap(sess->base);
+    return rc;
+}
+
+int test_submit_in_order()
+{
+    XmaKernelSession *sess = create_session();
+    if (ck_assert(sess != NULL))
+        return -1;
+
+    int rc = 0;
+    std::vector<XmaWorkItem> items(XMA_MAX_WORK_ITEM_DEPTH);
+    for (auto& item : items)
+        rc |= ck_assert_int_eq(submit(sess, &item), XMA_SUCCESS);
+    for (size_t i = 1; i < items.size(); i++)
+        rc |= ck_assert(items[i].id == items[i - 1].id + 1);
+
+    // The session is at its depth until its oldest work item retires
+    XmaWorkItem extra;
+    rc |= ck_assert_int_eq(submit(sess, &extra), XMA_TRY_AGAIN);
+
+    // Waiting for the newest work item retires every earlier one, and
+    // their results stay available
+    rc |= ck_assert_int_eq(xma_plg_wait_work_item(sess->base, items.back(), WAIT_MS), XMA_SUCCESS);
+    for (auto& item : items)
+        rc |= ck_assert_int_eq(xma_plg_wait_work_item(sess->base, item, 0), XMA_SUCCESS);
+
+    rc |= ck_assert_int_eq(submit(sess, &extra), XMA_SUCCESS);
+    rc |= ck_assert(extra.id == items.back().id + 1);
+    rc |= ck_assert_int_eq(xma_plg_wait_work_item(sess->base, extra, WAIT_MS), XMA_SUCCESS);
+
+    rc |= ck_assert_int_eq(xma_kernel_session_destroy(sess), XMA_SUCCESS);
+    return rc;
+}
+
+// Tracked work items hold their execBO until waited for; with more
+// sessions than the capped pool of the CU has execBOs for, the sessions
+// submitting last are told to try again rather than failing
+int test_execbo_exhausted()
+{
+    int32_t num_sessions = MAX_EXECBO_PER_CU / XMA_MAX_WORK_ITEM_DEPTH + 1;
+    std::vector<XmaKernelSession*> sessions;
+    int rc = 0;
+    for (int32_t i = 0; i < num_sessions; i++) {
+        XmaKernelSession *sess = create_session();
+        rc |= ck_assert(sess != NULL);
+        if (sess)
+            sessions.push_back(sess);
+    }
+    if (rc) {
+        for (auto sess : sessions)
+            xma_kernel_session_destroy(sess);
+        return rc;
+    }
+
+    std::vector<std::vector<XmaWorkItem>> items(num_sessions);
+    int32_t submitted = 0, try_again = 0;
+    for (int32_t i = 0; i < num_sessions; i++) {
+        for (int32_t d = 0; d < XMA_MAX_WORK_ITEM_DEPTH; d++) {
+            XmaWorkItem item;
+            int32_t ret = submit(sessions[i], &item);
+            if (ret == XMA_SUCCESS) {
+                items[i].push_back(item);
+                submitted++;
+            } else if (ret == XMA_TRY_AGAIN) {
+                try_again++;
+            } else {
+                rc = -1;
+            }
+        }
+    }
+    rc |= ck_assert_int_eq(submitted, MAX_EXECBO_PER_CU);
+    rc |= ck_assert_int_eq(try_again, num_sessions * XMA_MAX_WORK_ITEM_DEPTH - MAX_EXECBO_PER_CU);
+
+    // Retiring one work item gives its execBO to the session that was
+    // told to try again
+    XmaWorkItem item;
+    rc |= ck_assert_int_eq(xma_plg_wait_work_item(sessions[0]->base, items[0].front(), WAIT_MS), XMA_SUCCESS);
+    rc |= ck_assert_int_eq(submit(sessions.back(), &item), XMA_SUCCESS);
+    items.back().push_back(item);
+
+    for (int32_t i = 0; i < num_sessions; i++) {
+        if (!items[i].empty())
+            rc |= ck_assert_int_eq(xma_plg_wait_work_item(sessions[i]->base, items[i].back(), WAIT_MS), XMA_SUCCESS);
+        rc |= ck_assert_int_eq(xma_kernel_session_destroy(sessions[i]), XMA_SUCCESS);
+    }
+    return rc;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *xclbin = argc > 1 ? argv[1] : getenv("XMA_TEST_XCLBIN");
+    int number_failed = 0;
+
+    if (xclbin == NULL) {
+        std::cout << "SKIP: no xclbin given" << std::endl;
+        return 0;
+    }
+
+    XmaXclbinParameter xclbin_param;
+    xclbin_param.xclbin_name = (char*) xclbin;
+    xclbin_param.device_id = 0;
+    if (xma_initialize(&xclbin_param, 1) != XMA_SUCCESS) {
+        std::cout << "FAIL: xma_initialize" << std::endl;
+        return 1;
+    }
+
+    if (test_submit_in_order() != 0) {
+        std::cout << "FAIL: work items of a session" << std::endl;
+        number_failed++;
+    }
+    if (test_execbo_exhausted() != 0) {
+        std::cout << "FAIL: work items with every execBO of the CU in use" << std::endl;
+        number_failed++;
+    }
+
+    if (number_failed == 0) {
+        std::cout << "XMA check_xmaqueue test completed successfully" << std::endl;
+        return EXIT_SUCCESS;
+    } else {
+        std::cout << "ERROR: XMA check_xmaqueue test failed" << std::endl;
+        return EXIT_FAILURE;
+    }
+}
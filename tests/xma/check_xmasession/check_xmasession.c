@@ -0,0 +1,230 @@
+/*
+ * Copyright (C) 2019, Xilinx Inc - All rights reserved
+ * Xilinx SDAccel Media Accelerator API
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Create and destroy sessions from many threads at once.  With cu_name
+// set, also check that sessions placed at the same time spread over the
+// CUs matching cu_name instead of all landing on the least loaded one.
+//
+// usage: check_xmasession.exe <xclbin> [cu_name] [threads] [sessions per thread]
+// The xclbin may also be given with XMA_TEST_XCLBIN; the test is skipped
+// without one.  Without cu_name sessions use CU 0 of device 0, otherwise
+// they are placed automatically on the CUs named (or of kernel) cu_name.
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "xma.h"
+#include "xmaplugin.h"
+
+#define PLUGIN_LIB "../plugins/xma_kernel_tst_plg.so"
+
+int ck_assert_int_eq(int rc1, int rc2) {
+  if (rc1 != rc2) {
+    return -1;
+  } else {
+    return 0;
+  }
+}
+
+int ck_assert(bool result) {
+  if (!result) {
+    return -1;
+  } else {
+    return 0;
+  }
+}
+
+static std::atomic<int> failures(0);
+
+static void create_destroy(const char *cu_name, int sessions, std::vector<int32_t> *ids)
+{
+    for (int i = 0; i < sessions; i++) {
+        XmaKernelProperties props;
+        memset(&props, 0, sizeof(XmaKernelProperties));
+        props.hwkernel_type = XMA_KERNEL_TYPE;
+        strncpy(props.hwvendor_string, "Xilinx", (MAX_VENDOR_NAME - 1));
+        props.plugin_lib = (char*) PLUGIN_LIB;
+        props.ddr_bank_index = -1;
+        if (cu_name) {
+            props.dev_index = XMA_AUTO_PLACEMENT;
+            props.cu_index = XMA_AUTO_PLACEMENT;
+            props.cu_name = (char*) cu_name;
+        }
+
+        XmaKernelSession *sess = xma_kernel_session_create(&props);
+        if (ck_assert(sess != NULL)) {
+            failures++;
+            continue;
+        }
+        ids->push_back(sess->base.session_id);
+        if (ck_assert_int_eq(xma_kernel_session_destroy(sess), XMA_SUCCESS))
+            failures++;
+    }
+}
+
+int test_session_create_destroy_threads(const char *cu_name, int threads, int sessions)
+{
+    std::vector<std::vector<int32_t>> ids(threads);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++)
+        workers.emplace_back(create_destroy, cu_name, sessions, &ids[t]);
+    for (auto& worker : workers)
+        worker.join();
+
+    int rc = ck_assert_int_eq(failures, 0);
+
+    // Session ids are unique even when sessions are created at the same time
+    std::vector<int32_t> all_ids;
+    for (auto& thread_ids : ids)
+        all_ids.insert(all_ids.end(), thread_ids.begin(), thread_ids.end());
+    std::sort(all_ids.begin(), all_ids.end());
+    rc |= ck_assert(std::adjacent_find(all_ids.begin(), all_ids.end()) == all_ids.end());
+    rc |= ck_assert_int_eq((int)all_ids.size(), threads * sessions);
+
+    // Every session gave back its share of the CU
+    std::vector<XmaCULoad> table(256);
+    int32_t num_cus = xma_get_cu_load(table.data(), table.size());
+    rc |= ck_assert(num_cus > 0);
+    for (int32_t i = 0; i < num_cus && i < (int32_t)table.size(); i++)
+        rc |= ck_assert_int_eq(table[i].num_sessions, 0);
+
+    return rc;
+}
+
+// Same rule as automatic placement: the CU name or its kernel name
+static bool cu_name_match(const char *name, const char *cu_name)
+{
+    size_t len = strlen(cu_name);
+    return strncmp(name, cu_name, len) == 0 && (name[len] == '\0' || name[len] == ':');
+}
+
+static XmaKernelSession *create_placed(const char *cu_name)
+{
+    XmaKernelProperties props;
+    memset(&props, 0, sizeof(XmaKernelProperties));
+    props.hwkernel_type = XMA_KERNEL_TYPE;
+    strncpy(props.hwvendor_string, "Xilinx", (MAX_VENDOR_NAME - 1));
+    props.plugin_lib = (char*) PLUGIN_LIB;
+    props.ddr_bank_index = -1;
+    props.dev_index = XMA_AUTO_PLACEMENT;
+    props.cu_index = XMA_AUTO_PLACEMENT;
+    props.cu_name = (char*) cu_name;
+    return xma_kernel_session_create(&props);
+}
+
+int test_session_placement_spread(const char *cu_name, int threads)
+{
+    std::vector<XmaCULoad> table(256);
+    int32_t num_cus = xma_get_cu_load(table.data(), table.size());
+    int32_t matching = 0;
+    for (int32_t i = 0; i < num_cus && i < (int32_t)table.size(); i++)
+        matching += cu_name_match(table[i].cu_name, cu_name) ? 1 : 0;
+    if (ck_assert(matching > 0))
+        return -1;
+
+    // All threads start creating at once and keep their session until
+    // every one is placed
+    std::mutex lock;
+    std::condition_variable cv;
+    bool go = false;
+    std::vector<XmaKernelSession*> sessions(threads, NULL);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                cv.wait(guard, [&] { return go; });
+            }
+            sessions[t] = create_placed(cu_name);
+        });
+    }
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        go = true;
+    }
+    cv.notify_all();
+    for (auto& worker : workers)
+        worker.join();
+
+    int rc = 0;
+    for (auto sess : sessions)
+        rc |= ck_assert(sess != NULL);
+
+    // Sessions only dominate the placement score, so the CUs matching
+    // cu_name end up within one session of each other
+    num_cus = xma_get_cu_load(table.data(), table.size());
+    int32_t min_sessions = threads, max_sessions = 0;
+    for (int32_t i = 0; i < num_cus && i < (int32_t)table.size(); i++) {
+        if (!cu_name_match(table[i].cu_name, cu_name))
+            continue;
+        min_sessions = std::min(min_sessions, table[i].num_sessions);
+        max_sessions = std::max(max_sessions, table[i].num_sessions);
+    }
+    if (ck_assert(max_sessions - min_sessions <= 1)) {
+        std::cout << "FAIL: " << threads << " sessions on " << matching << " CUs: "
+                  << min_sessions << " to " << max_sessions << " per CU" << std::endl;
+        rc = -1;
+    }
+
+    for (auto sess : sessions) {
+        if (sess && ck_assert_int_eq(xma_kernel_session_destroy(sess), XMA_SUCCESS))
+            rc = -1;
+    }
+    return rc;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *xclbin = argc > 1 ? argv[1] : getenv("XMA_TEST_XCLBIN");
+    const char *cu_name = argc > 2 ? argv[2] : NULL;
+    int threads = argc > 3 ? atoi(argv[3]) : 32;
+    int sessions = argc > 4 ? atoi(argv[4]) : 128;
+
+    if (xclbin == NULL) {
+        std::cout << "SKIP: no xclbin given" << std::endl;
+        return 0;
+    }
+
+    XmaXclbinParameter xclbin_param;
+    xclbin_param.xclbin_name = (char*) xclbin;
+    xclbin_param.device_id = 0;
+    if (xma_initialize(&xclbin_param, 1) != XMA_SUCCESS) {
+        std::cout << "FAIL: xma_initialize" << std::endl;
+        return 1;
+    }
+
+    int rc = test_session_create_destroy_threads(cu_name, threads, sessions);
+    if (rc == 0 && cu_name) {
+        rc = test_session_placement_spread(cu_name, threads);
+        if (rc)
+            std::cout << "FAIL: concurrent placement did not spread over the CUs" << std::endl;
+    }
+    if (rc == 0) {
+        std::cout << "PASS: " << threads * sessions << " sessions from " << threads << " threads" << std::endl;
+    } else {
+        std::cout << "FAIL: " << failures << " session create/destroy failures" << std::endl;
+    }
+    return rc ? 1 : 0;
+}
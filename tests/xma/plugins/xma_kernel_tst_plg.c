@@ -29,6 +29,13 @@ static int32_t xma_kernel_close(XmaKernelSession *sess)
     return 0;
 }
 
+static int32_t xma_kernel_version(int32_t *main_version, int32_t *sub_version)
+{
+    *main_version = 2019;
+    *sub_version = 2;
+    return 0;
+}
+
 XmaKernelPlugin kernel_plugin = {
     .hwkernel_type = XMA_KERNEL_TYPE,
     .hwvendor_string = "Xilinx",
@@ -37,4 +44,5 @@ XmaKernelPlugin kernel_plugin = {
     .write = xma_kernel_write,
     .read = xma_kernel_read,
     .close = xma_kernel_close,
+    .xma_version = xma_kernel_version,
 };